@@ -0,0 +1,190 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "bench_common.h"
+
+double
+bench_time_get(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+int
+bench_daemon_start(Bench_Daemon *d)
+{
+   const char *daemon;
+   char buf[512], addr_arg[128], fd_arg[32];
+   int fds[2];
+   ssize_t r;
+   size_t len = 0;
+
+   memset(d, 0, sizeof(*d));
+   daemon = getenv("E_DBUS_BENCH_DAEMON");
+   if (!daemon) daemon = "dbus-daemon";
+
+   snprintf(d->dir, sizeof(d->dir), "/tmp/e_dbus_bench.XXXXXX");
+   if (!mkdtemp(d->dir))
+     {
+        fprintf(stderr, "ERROR: mkdtemp: %s\n", strerror(errno));
+        return 0;
+     }
+   snprintf(addr_arg, sizeof(addr_arg), "--address=unix:path=%s/bus", d->dir);
+
+   if (pipe(fds) < 0)
+     {
+        fprintf(stderr, "ERROR: pipe: %s\n", strerror(errno));
+        rmdir(d->dir);
+        return 0;
+     }
+
+   d->pid = fork();
+   if (d->pid < 0)
+     {
+        fprintf(stderr, "ERROR: fork: %s\n", strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        rmdir(d->dir);
+        return 0;
+     }
+   if (d->pid == 0)
+     {
+        close(fds[0]);
+        snprintf(fd_arg, sizeof(fd_arg), "--print-address=%d", fds[1]);
+        execlp(daemon, daemon, "--session", "--nofork", addr_arg, fd_arg,
+               (char *)NULL);
+        fprintf(stderr, "ERROR: could not exec %s: %s\n",
+                daemon, strerror(errno));
+        _exit(127);
+     }
+
+   close(fds[1]);
+   while (len < sizeof(buf) - 1)
+     {
+        r = read(fds[0], buf + len, sizeof(buf) - 1 - len);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        len += r;
+        if (memchr(buf, '\n', len)) break;
+     }
+   close(fds[0]);
+   buf[len] = '\0';
+   buf[strcspn(buf, "\n")] = '\0';
+
+   if (!buf[0])
+     {
+        fprintf(stderr, "ERROR: %s did not print its address\n", daemon);
+        bench_daemon_stop(d);
+        return 0;
+     }
+
+   d->address = strdup(buf);
+   setenv("DBUS_SESSION_BUS_ADDRESS", d->address, 1);
+   return 1;
+}
+
+void
+bench_daemon_stop(Bench_Daemon *d)
+{
+   char path[128];
+
+   if (d->pid > 0)
+     {
+        kill(d->pid, SIGTERM);
+        while (waitpid(d->pid, NULL, 0) < 0 && errno == EINTR);
+        d->pid = 0;
+     }
+   if (d->dir[0])
+     {
+        snprintf(path, sizeof(path), "%s/bus", d->dir);
+        unlink(path);
+        rmdir(d->dir);
+        d->dir[0] = '\0';
+     }
+   free(d->address);
+   d->address = NULL;
+}
+
+static int
+_bench_double_cmp(const void *a, const void *b)
+{
+   double da = *(const double *)a, db = *(const double *)b;
+
+   if (da < db) return -1;
+   if (da > db) return 1;
+   return 0;
+}
+
+double
+bench_percentile(double *samples, unsigned int count, double p)
+{
+   unsigned int idx;
+
+   if (!count) return 0.0;
+   qsort(samples, count, sizeof(double), _bench_double_cmp);
+   idx = (unsigned int)((p / 100.0) * (count - 1) + 0.5);
+   if (idx >= count) idx = count - 1;
+   return samples[idx];
+}
+
+double
+bench_cpu_time_get(pid_t pid)
+{
+   char path[64], buf[1024], *p;
+   unsigned long utime, stime;
+   struct rusage ru;
+   FILE *f;
+   size_t len;
+
+   if (pid == 0)
+     {
+        if (getrusage(RUSAGE_SELF, &ru) < 0) return -1.0;
+        return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0 +
+               ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+     }
+
+   snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+   f = fopen(path, "r");
+   if (!f) return -1.0;
+   len = fread(buf, 1, sizeof(buf) - 1, f);
+   fclose(f);
+   buf[len] = '\0';
+
+   /* comm may contain spaces, fields are counted after its ')' */
+   p = strrchr(buf, ')');
+   if (!p) return -1.0;
+   if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+              &utime, &stime) != 2)
+     return -1.0;
+   return (double)(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+void
+bench_report(const char *bench, const char *metric, double value, const char *unit)
+{
+   printf("{\"bench\":\"%s\",\"metric\":\"%s\",\"value\":%.3f,\"unit\":\"%s\"}\n",
+          bench, metric, value, unit);
+   fflush(stdout);
+}
+
+void
+bench_report_int(const char *bench, const char *metric, double value, const char *unit, const char *param, long param_value)
+{
+   printf("{\"bench\":\"%s\",\"metric\":\"%s\",\"%s\":%ld,\"value\":%.3f,\"unit\":\"%s\"}\n",
+          bench, metric, param, param_value, value, unit);
+   fflush(stdout);
+}
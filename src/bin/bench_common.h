@@ -0,0 +1,43 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <sys/types.h>
+
+/*
+ * Helpers shared by the headless benchmark programs: a private bus
+ * daemon, monotonic timing and machine readable result lines.
+ *
+ * Every result is printed on stdout as one JSON object per line:
+ *   {"bench":"latency","metric":"p99","value":123.4,"unit":"us"}
+ * so runs can be collected with a plain `grep '^{'` and diffed.
+ */
+
+typedef struct _Bench_Daemon Bench_Daemon;
+
+struct _Bench_Daemon
+{
+   pid_t pid;
+   char *address;
+   char dir[64];
+};
+
+double bench_time_get(void);
+
+/* Starts dbus-daemon --session on a socket in a temporary directory and
+ * exports its address as DBUS_SESSION_BUS_ADDRESS.  The daemon binary can
+ * be overridden with $E_DBUS_BENCH_DAEMON. */
+int    bench_daemon_start(Bench_Daemon *d);
+void   bench_daemon_stop(Bench_Daemon *d);
+
+/* Sorts the samples in place and returns the p-th (0..100) percentile. */
+double bench_percentile(double *samples, unsigned int count, double p);
+
+/* CPU time (user + system) in seconds used so far by pid, read from
+ * /proc/<pid>/stat, or by the calling process when pid is 0.  Returns a
+ * negative value if it is not available. */
+double bench_cpu_time_get(pid_t pid);
+
+void   bench_report(const char *bench, const char *metric, double value, const char *unit);
+void   bench_report_int(const char *bench, const char *metric, double value, const char *unit, const char *param, long param_value);
+
+#endif
@@ -0,0 +1,406 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <Ecore.h>
+#include "E_DBus.h"
+#include "bench_common.h"
+
+/*
+ * Signal fan-out benchmark.
+ *
+ * For every (subscribers, handlers) pair a set of subscriber processes is
+ * forked, each registering `handlers` handlers for the same signal with
+ * e_dbus_signal_handler_add(), so delivery goes through the regular match
+ * rules and cb_signal_dispatcher().  A producer process then broadcasts
+ * Tick signals carrying a CLOCK_MONOTONIC timestamp and finally Done.
+ *
+ * Reported per run (JSON lines, see bench_common.h):
+ *  - end to end latency percentiles over all subscribers
+ *  - subscriber CPU time per signal (all of its handlers included)
+ *  - dbus-daemon CPU time for the run and per signal
+ *  - signals lost on the way
+ */
+
+#define FANOUT_PATH  "/org/enlightenment/edbus/Fanout"
+#define FANOUT_IFACE "org.enlightenment.edbus.Fanout"
+
+typedef struct _Sub_Result Sub_Result;
+
+struct _Sub_Result
+{
+   unsigned int received;
+   double cpu;
+};
+
+static E_DBus_Connection *conn = NULL;
+
+static unsigned int opt_signals = 1000;
+static unsigned int opt_rate = 2000;
+static double opt_timeout = 60.0;
+
+/* subscriber **************************************************************/
+
+static double *sub_latency = NULL;
+static unsigned int sub_received = 0;
+static int sub_fd = -1;
+
+static void
+_sub_cb_tick(void *data, DBusMessage *msg)
+{
+   double ts = 0.0;
+
+   /* only the first handler samples, the others are the fan-out load */
+   if ((uintptr_t)data != 0) return;
+
+   dbus_message_get_args(msg, NULL, DBUS_TYPE_DOUBLE, &ts, DBUS_TYPE_INVALID);
+   if (sub_received < opt_signals)
+     sub_latency[sub_received] = bench_time_get() - ts;
+   sub_received++;
+}
+
+static void
+_sub_cb_done(void *data __UNUSED__, DBusMessage *msg __UNUSED__)
+{
+   ecore_main_loop_quit();
+}
+
+static Eina_Bool
+_sub_cb_timeout(void *data __UNUSED__)
+{
+   fprintf(stderr, "ERROR: subscriber %d timed out\n", (int)getpid());
+   ecore_main_loop_quit();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_sub_cb_synced(void *data __UNUSED__, DBusMessage *msg __UNUSED__, DBusError *error __UNUSED__)
+{
+   char c = 'R';
+
+   /* the bus processes our AddMatch calls in order, so all rules are in
+    * place once this reply arrives */
+   if (write(sub_fd, &c, 1) != 1)
+     ecore_main_loop_quit();
+}
+
+static int
+_subscriber_run(int fd, unsigned int handlers)
+{
+   E_DBus_Signal_Handler **shs;
+   Sub_Result res;
+   double cpu;
+   unsigned int i;
+   size_t len;
+
+   sub_fd = fd;
+   sub_latency = calloc(opt_signals, sizeof(double));
+   shs = calloc(handlers + 1, sizeof(E_DBus_Signal_Handler *));
+
+   e_dbus_init();
+   conn = e_dbus_bus_get(DBUS_BUS_SESSION);
+   if (!conn) return 1;
+
+   for (i = 0; i < handlers; i++)
+     shs[i] = e_dbus_signal_handler_add(conn, NULL, FANOUT_PATH, FANOUT_IFACE,
+                                        "Tick", _sub_cb_tick,
+                                        (void *)(uintptr_t)i);
+   shs[handlers] = e_dbus_signal_handler_add(conn, NULL, FANOUT_PATH,
+                                             FANOUT_IFACE, "Done",
+                                             _sub_cb_done, NULL);
+   e_dbus_name_has_owner(conn, "org.freedesktop.DBus", _sub_cb_synced, NULL);
+   ecore_timer_add(opt_timeout, _sub_cb_timeout, NULL);
+
+   cpu = bench_cpu_time_get(0);
+   ecore_main_loop_begin();
+
+   res.cpu = bench_cpu_time_get(0) - cpu;
+   res.received = sub_received;
+   if (res.received > opt_signals) res.received = opt_signals;
+
+   len = res.received * sizeof(double);
+   if (write(fd, &res, sizeof(res)) != sizeof(res) ||
+       write(fd, sub_latency, len) != (ssize_t)len)
+     fprintf(stderr, "ERROR: subscriber %d could not report\n", (int)getpid());
+   close(fd);
+
+   for (i = 0; i <= handlers; i++)
+     e_dbus_signal_handler_del(conn, shs[i]);
+   free(shs);
+   free(sub_latency);
+   e_dbus_connection_close(conn);
+   e_dbus_shutdown();
+   return 0;
+}
+
+/* producer ****************************************************************/
+
+static unsigned int prod_sent = 0;
+
+static void
+_prod_cb_flushed(void *data __UNUSED__, DBusMessage *msg __UNUSED__, DBusError *error __UNUSED__)
+{
+   ecore_main_loop_quit();
+}
+
+static void
+_prod_send(const char *member)
+{
+   DBusMessage *sig;
+   double ts = bench_time_get();
+   dbus_uint32_t seq = prod_sent;
+
+   sig = dbus_message_new_signal(FANOUT_PATH, FANOUT_IFACE, member);
+   dbus_message_append_args(sig, DBUS_TYPE_DOUBLE, &ts,
+                            DBUS_TYPE_UINT32, &seq, DBUS_TYPE_INVALID);
+   e_dbus_signal_send(conn, sig);
+   dbus_message_unref(sig);
+}
+
+static Eina_Bool
+_prod_cb_tick(void *data __UNUSED__)
+{
+   unsigned int i, batch = opt_rate ? 1 : 64;
+
+   for (i = 0; i < batch && prod_sent < opt_signals; i++, prod_sent++)
+     _prod_send("Tick");
+
+   if (prod_sent < opt_signals)
+     return ECORE_CALLBACK_RENEW;
+
+   _prod_send("Done");
+   /* a round trip guarantees Done left this process before we exit */
+   e_dbus_name_has_owner(conn, "org.freedesktop.DBus", _prod_cb_flushed, NULL);
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static int
+_producer_run(void)
+{
+   e_dbus_init();
+   conn = e_dbus_bus_get(DBUS_BUS_SESSION);
+   if (!conn) return 1;
+
+   if (opt_rate)
+     ecore_timer_add(1.0 / opt_rate, _prod_cb_tick, NULL);
+   else
+     ecore_idler_add(_prod_cb_tick, NULL);
+   ecore_main_loop_begin();
+
+   e_dbus_connection_close(conn);
+   e_dbus_shutdown();
+   return 0;
+}
+
+/* orchestration ***********************************************************/
+
+static void
+_report(const char *metric, unsigned int subscribers, unsigned int handlers, double value, const char *unit)
+{
+   printf("{\"bench\":\"fanout\",\"metric\":\"%s\",\"subscribers\":%u,"
+          "\"handlers\":%u,\"value\":%.3f,\"unit\":\"%s\"}\n",
+          metric, subscribers, handlers, value, unit);
+   fflush(stdout);
+}
+
+static int
+_read_full(int fd, void *buf, size_t len)
+{
+   char *p = buf;
+   ssize_t r;
+
+   while (len > 0)
+     {
+        r = read(fd, p, len);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return 0;
+        p += r;
+        len -= r;
+     }
+   return 1;
+}
+
+static int
+_fanout_run(Bench_Daemon *daemon, unsigned int subscribers, unsigned int handlers)
+{
+   pid_t *pids, producer;
+   int *fds, fd[2], ok = 1;
+   double *latency, daemon_cpu, sub_cpu = 0.0;
+   unsigned int i, total = 0, reported = 0;
+   Sub_Result res;
+   char c;
+
+   pids = calloc(subscribers, sizeof(pid_t));
+   fds = calloc(subscribers, sizeof(int));
+   latency = malloc(sizeof(double) * subscribers * opt_signals);
+
+   for (i = 0; i < subscribers; i++)
+     {
+        if (pipe(fd) < 0)
+          {
+             fprintf(stderr, "ERROR: pipe: %s\n", strerror(errno));
+             subscribers = i;
+             ok = 0;
+             break;
+          }
+        pids[i] = fork();
+        if (pids[i] == 0)
+          {
+             close(fd[0]);
+             _exit(_subscriber_run(fd[1], handlers));
+          }
+        close(fd[1]);
+        fds[i] = fd[0];
+        if (pids[i] < 0)
+          {
+             fprintf(stderr, "ERROR: fork: %s\n", strerror(errno));
+             close(fds[i]);
+             subscribers = i;
+             ok = 0;
+             break;
+          }
+     }
+
+   for (i = 0; ok && i < subscribers; i++)
+     if (!_read_full(fds[i], &c, 1) || c != 'R')
+       {
+          fprintf(stderr, "ERROR: subscriber %d did not start\n", (int)pids[i]);
+          ok = 0;
+       }
+
+   if (ok)
+     {
+        daemon_cpu = bench_cpu_time_get(daemon->pid);
+        producer = fork();
+        if (producer == 0)
+          _exit(_producer_run());
+        if (producer > 0)
+          waitpid(producer, NULL, 0);
+
+        for (i = 0; i < subscribers; i++)
+          {
+             if (!_read_full(fds[i], &res, sizeof(res)) ||
+                 !_read_full(fds[i], latency + total,
+                             res.received * sizeof(double)))
+               continue;
+             total += res.received;
+             sub_cpu += res.cpu;
+             reported++;
+          }
+        if (daemon_cpu >= 0.0)
+          daemon_cpu = bench_cpu_time_get(daemon->pid) - daemon_cpu;
+
+        for (i = 0; i < total; i++)
+          latency[i] *= 1000000.0;
+        _report("latency_p50", subscribers, handlers,
+                bench_percentile(latency, total, 50.0), "us");
+        _report("latency_p99", subscribers, handlers,
+                bench_percentile(latency, total, 99.0), "us");
+        _report("latency_p99.9", subscribers, handlers,
+                bench_percentile(latency, total, 99.9), "us");
+        _report("latency_max", subscribers, handlers,
+                total ? latency[total - 1] : 0.0, "us");
+        if (reported)
+          _report("subscriber_cpu_per_signal", subscribers, handlers,
+                  sub_cpu * 1000000.0 / reported / opt_signals, "us");
+        if (daemon_cpu >= 0.0)
+          {
+             _report("daemon_cpu", subscribers, handlers,
+                     daemon_cpu * 1000.0, "ms");
+             _report("daemon_cpu_per_signal", subscribers, handlers,
+                     daemon_cpu * 1000000.0 / opt_signals, "us");
+          }
+        _report("lost", subscribers, handlers,
+                (double)subscribers * opt_signals - total, "signals");
+     }
+
+   for (i = 0; i < subscribers; i++)
+     {
+        if (!ok) kill(pids[i], SIGTERM);
+        close(fds[i]);
+        waitpid(pids[i], NULL, 0);
+     }
+
+   free(latency);
+   free(fds);
+   free(pids);
+   return ok;
+}
+
+static unsigned int
+_list_parse(const char *str, unsigned int *values, unsigned int max)
+{
+   unsigned int n = 0;
+   char *end;
+
+   while (*str && n < max)
+     {
+        values[n] = strtoul(str, &end, 10);
+        if (end == str) break;
+        if (values[n]) n++;
+        str = end;
+        if (*str == ',') str++;
+     }
+   return n;
+}
+
+static void
+_usage(const char *prog)
+{
+   fprintf(stderr,
+           "Usage: %s [options]\n"
+           "  -s <list>     subscriber process counts (default 1,10,50,200)\n"
+           "  -H <list>     handlers per subscriber (default 1,10,100,1000)\n"
+           "  -n <signals>  signals per run (default %u)\n"
+           "  -r <rate>     signals per second, 0 floods (default %u)\n"
+           "  -t <seconds>  subscriber timeout (default %.0f)\n"
+           "\n"
+           "Results are printed to stdout as one JSON object per line.\n",
+           prog, opt_signals, opt_rate, opt_timeout);
+}
+
+int
+main(int argc, char *argv[])
+{
+   unsigned int subscribers[32] = { 1, 10, 50, 200 };
+   unsigned int handlers[32] = { 1, 10, 100, 1000 };
+   unsigned int n_subscribers = 4, n_handlers = 4, i, j;
+   Bench_Daemon daemon;
+   int opt, ret = 0;
+
+   while ((opt = getopt(argc, argv, "s:H:n:r:t:h")) != -1)
+     {
+        switch (opt)
+          {
+           case 's': n_subscribers = _list_parse(optarg, subscribers, 32); break;
+           case 'H': n_handlers = _list_parse(optarg, handlers, 32); break;
+           case 'n': opt_signals = strtoul(optarg, NULL, 10); break;
+           case 'r': opt_rate = strtoul(optarg, NULL, 10); break;
+           case 't': opt_timeout = strtod(optarg, NULL); break;
+           default:
+              _usage(argv[0]);
+              return opt == 'h' ? 0 : 1;
+          }
+     }
+   if (!opt_signals) opt_signals = 1;
+
+   if (!bench_daemon_start(&daemon))
+     return 1;
+
+   for (i = 0; i < n_subscribers; i++)
+     for (j = 0; j < n_handlers; j++)
+       if (!_fanout_run(&daemon, subscribers[i], handlers[j]))
+         ret = 1;
+
+   bench_daemon_stop(&daemon);
+   return ret;
+}
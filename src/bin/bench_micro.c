@@ -0,0 +1,176 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "E_DBus.h"
+#include "bench_common.h"
+#include "bench_micro.h"
+
+/*
+ * Micro benchmarks for the dispatch data structures, no socket involved.
+ *
+ * The static functions under test are reached by building this program
+ * from the library sources themselves (see bench_micro_dbus.c and
+ * bench_micro_connman.c), so it must not be linked against libedbus.
+ *
+ * Reports ns/op and allocations/op for every case and every n.
+ */
+
+static int alloc_counting = 0;
+static unsigned long alloc_count = 0;
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *
+malloc(size_t size)
+{
+   if (alloc_counting) alloc_count++;
+   return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+   if (alloc_counting) alloc_count++;
+   return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+   if (alloc_counting) alloc_count++;
+   return __libc_realloc(ptr, size);
+}
+# define ALLOC_COUNTING_AVAILABLE 1
+#else
+# define ALLOC_COUNTING_AVAILABLE 0
+#endif
+
+static double opt_time = 0.2;
+
+static void
+_bench_case_run(const Bench_Micro *b, unsigned int n)
+{
+   unsigned long iterations = 1, i, allocs;
+   double start, elapsed = 0.0;
+   void *ctx;
+
+   ctx = b->setup(n);
+   if (!ctx)
+     {
+        fprintf(stderr, "ERROR: %s: setup failed for %s=%u\n",
+                b->name, b->param, n);
+        return;
+     }
+
+   /* warm up caches and find an iteration count that runs long enough */
+   while (1)
+     {
+        start = bench_time_get();
+        for (i = 0; i < iterations; i++)
+          b->run(ctx);
+        elapsed = bench_time_get() - start;
+        if (elapsed >= opt_time / 10) break;
+        iterations *= 2;
+     }
+   iterations = iterations * (opt_time / elapsed) + 1;
+
+   alloc_count = 0;
+   alloc_counting = 1;
+   start = bench_time_get();
+   for (i = 0; i < iterations; i++)
+     b->run(ctx);
+   elapsed = bench_time_get() - start;
+   alloc_counting = 0;
+   allocs = alloc_count;
+
+   printf("{\"bench\":\"%s\",\"%s\":%u,\"iterations\":%lu,"
+          "\"ns_per_op\":%.1f,\"allocs_per_op\":",
+          b->name, b->param, n, iterations,
+          elapsed * 1000000000.0 / iterations);
+   if (ALLOC_COUNTING_AVAILABLE)
+     printf("%.2f}\n", (double)allocs / iterations);
+   else
+     printf("null}\n");
+   fflush(stdout);
+
+   b->teardown(ctx);
+}
+
+static void
+_bench_list_run(const Bench_Micro *list, const char *filter, const unsigned int *ns, unsigned int n_count)
+{
+   const Bench_Micro *b;
+   unsigned int i;
+
+   for (b = list; b->name; b++)
+     {
+        if (filter && !strstr(b->name, filter)) continue;
+        for (i = 0; i < n_count; i++)
+          _bench_case_run(b, ns[i]);
+     }
+}
+
+static void
+_usage(const char *prog)
+{
+   fprintf(stderr,
+           "Usage: %s [options]\n"
+           "  -n <list>     sizes to run each case with (default 1,10,100,1000)\n"
+           "  -f <string>   only run cases whose name contains string\n"
+           "  -t <seconds>  measuring time per case (default %.1f)\n"
+           "\n"
+           "Results are printed to stdout as one JSON object per line.\n",
+           prog, opt_time);
+}
+
+int
+main(int argc, char *argv[])
+{
+   unsigned int ns[32] = { 1, 10, 100, 1000 };
+   unsigned int n_count = 4;
+   const char *filter = NULL;
+   char *str, *end;
+   int opt;
+
+   while ((opt = getopt(argc, argv, "n:f:t:h")) != -1)
+     {
+        switch (opt)
+          {
+           case 'n':
+              n_count = 0;
+              for (str = optarg; *str && n_count < 32; str = end)
+                {
+                   ns[n_count] = strtoul(str, &end, 10);
+                   if (end == str) break;
+                   if (ns[n_count]) n_count++;
+                   if (*end == ',') end++;
+                }
+              break;
+           case 'f': filter = optarg; break;
+           case 't': opt_time = strtod(optarg, NULL); break;
+           default:
+              _usage(argv[0]);
+              return opt == 'h' ? 0 : 1;
+          }
+     }
+   if (opt_time <= 0.0) opt_time = 0.2;
+
+   e_dbus_init();
+
+   _bench_list_run(bench_micro_dbus, filter, ns, n_count);
+#ifdef BENCH_MICRO_CONNMAN
+   _bench_list_run(bench_micro_connman, filter, ns, n_count);
+#endif
+
+   e_dbus_shutdown();
+   return 0;
+}
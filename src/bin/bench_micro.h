@@ -0,0 +1,27 @@
+#ifndef BENCH_MICRO_H
+#define BENCH_MICRO_H
+
+/*
+ * In-process micro benchmarks.  Each case builds a fixture of size n in
+ * setup(), then run() is timed in a loop; allocations done by run() are
+ * counted through the malloc wrappers in bench_micro.c.
+ */
+
+typedef struct _Bench_Micro Bench_Micro;
+
+struct _Bench_Micro
+{
+   const char *name;
+   const char *param; /* what n counts: handlers, methods, properties... */
+   void      *(*setup)(unsigned int n);
+   void       (*run)(void *ctx);
+   void       (*teardown)(void *ctx);
+};
+
+/* both lists are terminated by an entry with a NULL name */
+extern const Bench_Micro bench_micro_dbus[];
+#ifdef BENCH_MICRO_CONNMAN
+extern const Bench_Micro bench_micro_connman[];
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* the whole library is built into this unit so its static functions can be
+ * driven directly */
+#include "e_connman.c"
+#include "e_connman_element.c"
+#include "e_connman_manager.c"
+#include "e_connman_profile.c"
+#include "e_connman_service.c"
+#include "e_connman_technology.c"
+
+#include <stdio.h>
+
+#include "bench_micro.h"
+
+#define BENCH_PATH "/bench/element"
+#define BENCH_ELEMENT_PROPERTIES 16
+
+typedef struct _Bench_Connman Bench_Connman;
+
+struct _Bench_Connman
+{
+   E_Connman_Element **elements;
+   const char **names;
+   unsigned int n_elements;
+   unsigned int n_names;
+   unsigned int next;
+   unsigned int value;
+};
+
+static Bench_Connman *
+_bench_connman_new(unsigned int n_elements, unsigned int n_names)
+{
+   Bench_Connman *b;
+   char buf[64];
+   unsigned int i, j;
+   const char *interface;
+
+   if (_e_dbus_connman_log_dom < 0)
+     _e_dbus_connman_log_dom = eina_log_domain_register
+         ("e_dbus_connman_bench", EINA_LOG_DEFAULT_COLOR);
+
+   b = calloc(1, sizeof(Bench_Connman));
+   b->n_elements = n_elements;
+   b->n_names = n_names;
+   b->elements = calloc(n_elements, sizeof(E_Connman_Element *));
+   b->names = calloc(n_names, sizeof(const char *));
+
+   for (j = 0; j < n_names; j++)
+     {
+        snprintf(buf, sizeof(buf), "Property%u", j);
+        b->names[j] = eina_stringshare_add(buf);
+     }
+
+   interface = eina_stringshare_add("net.connman.Service");
+   for (i = 0; i < n_elements; i++)
+     {
+        snprintf(buf, sizeof(buf), BENCH_PATH "%u", i);
+        b->elements[i] = e_connman_element_new(buf, interface);
+        for (j = 0; j < n_names; j++)
+          _e_connman_element_property_value_add
+            (b->elements[i], b->names[j], DBUS_TYPE_UINT32,
+             (void *)(long)j);
+     }
+   eina_stringshare_del(interface);
+
+   return b;
+}
+
+static void
+_bench_connman_teardown(void *ctx)
+{
+   Bench_Connman *b = ctx;
+   unsigned int i;
+
+   for (i = 0; i < b->n_elements; i++)
+     e_connman_element_unref(b->elements[i]);
+   for (i = 0; i < b->n_names; i++)
+     eina_stringshare_del(b->names[i]);
+   free(b->elements);
+   free(b->names);
+   free(b);
+}
+
+static void *
+_bench_properties_setup(unsigned int n)
+{
+   return _bench_connman_new(1, n);
+}
+
+static void *
+_bench_elements_setup(unsigned int n)
+{
+   return _bench_connman_new(n, BENCH_ELEMENT_PROPERTIES);
+}
+
+static void
+_bench_value_add_run(void *ctx)
+{
+   Bench_Connman *b = ctx;
+
+   /* update of the last property, value changes every time */
+   b->value++;
+   _e_connman_element_property_value_add
+     (b->elements[0], b->names[b->n_names - 1], DBUS_TYPE_UINT32,
+      (void *)(long)b->value);
+}
+
+static void
+_bench_value_add_fill_run(void *ctx)
+{
+   Bench_Connman *b = ctx;
+   E_Connman_Element *element;
+   unsigned int j;
+
+   /* a GetProperties reply worth of properties on a fresh element */
+   element = e_connman_element_new(BENCH_PATH, b->elements[0]->interface);
+   for (j = 0; j < b->n_names; j++)
+     _e_connman_element_property_value_add
+       (element, b->names[j], DBUS_TYPE_UINT32, (void *)(long)j);
+   e_connman_element_unref(element);
+}
+
+static void
+_bench_get_run(void *ctx)
+{
+   Bench_Connman *b = ctx;
+   unsigned int value;
+
+   e_connman_element_property_get_stringshared
+     (b->elements[0], b->names[b->n_names - 1], NULL, &value);
+   b->value += value;
+}
+
+static void
+_bench_get_elements_run(void *ctx)
+{
+   Bench_Connman *b = ctx;
+   unsigned int value;
+
+   e_connman_element_property_get_stringshared
+     (b->elements[b->next], b->names[b->n_names - 1], NULL, &value);
+   b->value += value;
+   if (++b->next == b->n_elements) b->next = 0;
+}
+
+const Bench_Micro bench_micro_connman[] =
+{
+   { "connman_property_value_add", "properties", _bench_properties_setup,
+     _bench_value_add_run, _bench_connman_teardown },
+   { "connman_property_value_add_fill", "properties", _bench_properties_setup,
+     _bench_value_add_fill_run, _bench_connman_teardown },
+   { "connman_property_get_stringshared", "properties",
+     _bench_properties_setup, _bench_get_run, _bench_connman_teardown },
+   { "connman_property_get_stringshared_elements", "elements",
+     _bench_elements_setup, _bench_get_elements_run, _bench_connman_teardown },
+   { NULL, NULL, NULL, NULL, NULL }
+};
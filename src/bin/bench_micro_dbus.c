@@ -0,0 +1,246 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* the whole library is built into this unit so its static functions can be
+ * driven directly */
+#include "e_dbus.c"
+#include "e_dbus_message.c"
+#include "e_dbus_methods.c"
+#include "e_dbus_interfaces.c"
+#include "e_dbus_object.c"
+#include "e_dbus_pool.c"
+#include "e_dbus_record.c"
+#include "e_dbus_util.c"
+#include "e_dbus_signal.c"
+#include "e_dbus_trace.c"
+
+#include <stdio.h>
+
+#include "bench_micro.h"
+
+#define BENCH_PATH  "/org/enlightenment/edbus/Micro"
+#define BENCH_IFACE "org.enlightenment.edbus.Micro"
+
+typedef struct _Bench_Dbus Bench_Dbus;
+
+struct _Bench_Dbus
+{
+   E_DBus_Connection conn;
+   E_DBus_Object *obj;
+   DBusMessage *msg;
+   const char *interface;
+   const char *member;
+   unsigned long calls;
+};
+
+static Bench_Dbus *
+_bench_dbus_new(void)
+{
+   Bench_Dbus *b = calloc(1, sizeof(Bench_Dbus));
+
+   if (!b) return NULL;
+   /* never connected: replies are kept in the cork queue and dropped */
+   b->conn.refcount = 1;
+   b->conn.ready = 1;
+   b->conn.corked = 1;
+   return b;
+}
+
+static void
+_bench_dbus_free(Bench_Dbus *b)
+{
+   E_DBus_Interface *iface;
+   DBusMessage *msg;
+
+   e_dbus_signal_handlers_free_all(&b->conn);
+   EINA_LIST_FREE(b->conn.corked_messages, msg)
+     dbus_message_unref(msg);
+   if (b->conn.uncorker) ecore_idle_enterer_del(b->conn.uncorker);
+
+   if (b->obj)
+     {
+        EINA_LIST_FREE(b->obj->interfaces, iface)
+          e_dbus_interface_unref(iface);
+        free(b->obj->path);
+        free(b->obj);
+     }
+   if (b->msg) dbus_message_unref(b->msg);
+   free(b);
+}
+
+/* signal dispatch *********************************************************/
+
+static void
+_bench_signal_cb(void *data, DBusMessage *msg __UNUSED__)
+{
+   Bench_Dbus *b = data;
+   b->calls++;
+}
+
+/* same as e_dbus_signal_handler_add() minus the match rules on the bus */
+static void
+_bench_signal_handler_add(Bench_Dbus *b, const char *member)
+{
+   E_DBus_Signal_Handler *sh;
+
+   sh = calloc(1, sizeof(E_DBus_Signal_Handler));
+   sh->path = strdup(BENCH_PATH);
+   sh->interface = strdup(BENCH_IFACE);
+   sh->member = strdup(member);
+   sh->cb_signal = _bench_signal_cb;
+   sh->data = b;
+   b->conn.signal_handlers = eina_list_append(b->conn.signal_handlers, sh);
+   b->conn.signal_dispatcher = cb_signal_dispatcher;
+}
+
+static void *
+_bench_signal_one_setup(unsigned int n)
+{
+   Bench_Dbus *b = _bench_dbus_new();
+   char member[32];
+   unsigned int i;
+
+   if (!b) return NULL;
+   for (i = 0; i < n; i++)
+     {
+        snprintf(member, sizeof(member), "Signal%u", i);
+        _bench_signal_handler_add(b, member);
+     }
+   /* only the last registered handler matches */
+   b->msg = dbus_message_new_signal(BENCH_PATH, BENCH_IFACE, member);
+   return b;
+}
+
+static void *
+_bench_signal_all_setup(unsigned int n)
+{
+   Bench_Dbus *b = _bench_dbus_new();
+   unsigned int i;
+
+   if (!b) return NULL;
+   for (i = 0; i < n; i++)
+     _bench_signal_handler_add(b, "Signal");
+   b->msg = dbus_message_new_signal(BENCH_PATH, BENCH_IFACE, "Signal");
+   return b;
+}
+
+static void
+_bench_signal_run(void *ctx)
+{
+   Bench_Dbus *b = ctx;
+   cb_signal_dispatcher(&b->conn, b->msg);
+}
+
+/* object methods **********************************************************/
+
+static DBusMessage *
+_bench_method_cb(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   return dbus_message_new_method_return(msg);
+}
+
+static E_DBus_Object *
+_bench_object_new(Bench_Dbus *b)
+{
+   E_DBus_Object *obj;
+
+   /* e_dbus_object_add() would register the path on the connection */
+   obj = calloc(1, sizeof(E_DBus_Object));
+   obj->conn = &b->conn;
+   obj->path = strdup(BENCH_PATH);
+   return obj;
+}
+
+static void *
+_bench_methods_setup(unsigned int n)
+{
+   Bench_Dbus *b = _bench_dbus_new();
+   E_DBus_Interface *iface;
+   char member[32];
+   unsigned int i;
+
+   if (!b) return NULL;
+   b->obj = _bench_object_new(b);
+   iface = e_dbus_interface_new(BENCH_IFACE);
+   for (i = 0; i < n; i++)
+     {
+        snprintf(member, sizeof(member), "Method%u", i);
+        e_dbus_interface_method_add(iface, member, "", "", _bench_method_cb);
+     }
+   e_dbus_object_interface_attach(b->obj, iface);
+   e_dbus_interface_unref(iface);
+
+   b->msg = dbus_message_new_method_call(NULL, BENCH_PATH, BENCH_IFACE, member);
+   b->interface = dbus_message_get_interface(b->msg);
+   b->member = dbus_message_get_member(b->msg);
+   return b;
+}
+
+static void *
+_bench_interfaces_setup(unsigned int n)
+{
+   Bench_Dbus *b = _bench_dbus_new();
+   E_DBus_Interface *iface;
+   char name[64];
+   unsigned int i;
+
+   if (!b) return NULL;
+   b->obj = _bench_object_new(b);
+   for (i = 0; i < n; i++)
+     {
+        snprintf(name, sizeof(name), BENCH_IFACE "%u", i);
+        iface = e_dbus_interface_new(name);
+        e_dbus_interface_method_add(iface, "Method", "", "", _bench_method_cb);
+        e_dbus_object_interface_attach(b->obj, iface);
+        e_dbus_interface_unref(iface);
+     }
+
+   b->msg = dbus_message_new_method_call(NULL, BENCH_PATH, name, "Method");
+   b->interface = dbus_message_get_interface(b->msg);
+   b->member = dbus_message_get_member(b->msg);
+   return b;
+}
+
+static void
+_bench_method_find_run(void *ctx)
+{
+   Bench_Dbus *b = ctx;
+
+   if (e_dbus_object_method_find(b->obj, b->interface, b->member))
+     b->calls++;
+}
+
+static void
+_bench_object_handler_run(void *ctx)
+{
+   Bench_Dbus *b = ctx;
+   DBusMessage *reply;
+
+   e_dbus_object_handler(NULL, b->msg, b->obj);
+
+   /* drop the reply queued on the fake connection */
+   EINA_LIST_FREE(b->conn.corked_messages, reply)
+     dbus_message_unref(reply);
+}
+
+static void
+_bench_dbus_teardown(void *ctx)
+{
+   _bench_dbus_free(ctx);
+}
+
+const Bench_Micro bench_micro_dbus[] =
+{
+   { "signal_dispatch_one", "handlers", _bench_signal_one_setup,
+     _bench_signal_run, _bench_dbus_teardown },
+   { "signal_dispatch_all", "handlers", _bench_signal_all_setup,
+     _bench_signal_run, _bench_dbus_teardown },
+   { "object_method_find", "methods", _bench_methods_setup,
+     _bench_method_find_run, _bench_dbus_teardown },
+   { "object_method_find_iface", "interfaces", _bench_interfaces_setup,
+     _bench_method_find_run, _bench_dbus_teardown },
+   { "object_handler", "methods", _bench_methods_setup,
+     _bench_object_handler_run, _bench_dbus_teardown },
+   { NULL, NULL, NULL, NULL, NULL }
+};
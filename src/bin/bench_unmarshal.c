@@ -0,0 +1,312 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "E_DBus.h"
+#include "bench_common.h"
+#include "bench_unmarshal.h"
+
+/*
+ * Offline message corpus unmarshalling benchmark.
+ *
+ * Every case runs in its own child process so that ru_maxrss is the peak
+ * of that case alone.  The unmarshallers are built from the library
+ * sources (see bench_unmarshal_*.c) since most of them are static.
+ *
+ * Reported per case (JSON lines, see bench_common.h): messages/s and MB/s
+ * for the whole demarshal + unmarshal + free cycle, ns per message spent
+ * in dbus_message_demarshal() and in the library, corpus size and peak
+ * resident memory.
+ */
+
+#define DEVICE_PROPERTIES 200
+
+static double opt_time = 1.0;
+static unsigned int opt_corpus = 0;
+
+static const Bench_Unmarshal *cases[] =
+{
+#ifdef BENCH_UNMARSHAL_HAL
+   &bench_unmarshal_hal,
+#endif
+#ifdef BENCH_UNMARSHAL_UKIT
+   &bench_unmarshal_ukit,
+#endif
+#ifdef BENCH_UNMARSHAL_CONNMAN
+   &bench_unmarshal_connman,
+#endif
+#ifdef BENCH_UNMARSHAL_NOTIFY
+   &bench_unmarshal_notify,
+#endif
+#ifdef BENCH_UNMARSHAL_BLUEZ
+   &bench_unmarshal_bluez,
+#endif
+   NULL
+};
+
+DBusMessage *
+bench_unmarshal_reply_new(void)
+{
+   DBusMessage *msg;
+
+   msg = dbus_message_new(DBUS_MESSAGE_TYPE_METHOD_RETURN);
+   dbus_message_set_reply_serial(msg, 1);
+   return msg;
+}
+
+void
+bench_unmarshal_dict_basic(DBusMessageIter *dict, const char *key, int type, const void *value)
+{
+   DBusMessageIter entry, variant;
+   char sig[2] = { type, '\0' };
+
+   dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+   dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+   dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, sig, &variant);
+   dbus_message_iter_append_basic(&variant, type, value);
+   dbus_message_iter_close_container(&entry, &variant);
+   dbus_message_iter_close_container(dict, &entry);
+}
+
+void
+bench_unmarshal_dict_strings(DBusMessageIter *dict, const char *key, unsigned int count)
+{
+   DBusMessageIter entry, variant, array;
+   char buf[64];
+   const char *s = buf;
+   unsigned int i;
+
+   dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+   dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+   dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, "as", &variant);
+   dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "s", &array);
+   for (i = 0; i < count; i++)
+     {
+        snprintf(buf, sizeof(buf), "%s.item%u", key, i);
+        dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING, &s);
+     }
+   dbus_message_iter_close_container(&variant, &array);
+   dbus_message_iter_close_container(&entry, &variant);
+   dbus_message_iter_close_container(dict, &entry);
+}
+
+DBusMessage *
+bench_unmarshal_device_new(unsigned int index)
+{
+   DBusMessage *msg;
+   DBusMessageIter iter, dict;
+   char key[64], value[128];
+   const char *s = value;
+   dbus_int32_t i32;
+   dbus_uint64_t u64;
+   dbus_bool_t b;
+   double d;
+   unsigned int i;
+
+   msg = bench_unmarshal_reply_new();
+   dbus_message_iter_init_append(msg, &iter);
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &dict);
+   for (i = 0; i < DEVICE_PROPERTIES; i++)
+     {
+        snprintf(key, sizeof(key), "device.property%u", i);
+        switch (i % 6)
+          {
+           case 0:
+              snprintf(value, sizeof(value), "/org/freedesktop/Hal/devices/dev%u_%u", index, i);
+              bench_unmarshal_dict_basic(&dict, key, DBUS_TYPE_STRING, &s);
+              break;
+           case 1:
+              i32 = index * i;
+              bench_unmarshal_dict_basic(&dict, key, DBUS_TYPE_INT32, &i32);
+              break;
+           case 2:
+              u64 = (dbus_uint64_t)index << 32 | i;
+              bench_unmarshal_dict_basic(&dict, key, DBUS_TYPE_UINT64, &u64);
+              break;
+           case 3:
+              b = i & 1;
+              bench_unmarshal_dict_basic(&dict, key, DBUS_TYPE_BOOLEAN, &b);
+              break;
+           case 4:
+              d = index + i / 10.0;
+              bench_unmarshal_dict_basic(&dict, key, DBUS_TYPE_DOUBLE, &d);
+              break;
+           default:
+              bench_unmarshal_dict_strings(&dict, key, 4);
+          }
+     }
+   dbus_message_iter_close_container(&iter, &dict);
+   return msg;
+}
+
+static long
+_maxrss_get(void)
+{
+   struct rusage ru;
+
+   if (getrusage(RUSAGE_SELF, &ru) < 0) return 0;
+   return ru.ru_maxrss;
+}
+
+static void
+_report(const Bench_Unmarshal *b, const char *metric, double value, const char *unit)
+{
+   printf("{\"bench\":\"unmarshal\",\"case\":\"%s\",\"metric\":\"%s\","
+          "\"value\":%.3f,\"unit\":\"%s\"}\n", b->name, metric, value, unit);
+}
+
+static int
+_case_run(const Bench_Unmarshal *b)
+{
+   unsigned int count = opt_corpus ? opt_corpus : b->corpus_size;
+   unsigned int i, passes = 0;
+   unsigned long messages = 0;
+   char **buffers;
+   int *lengths;
+   double bytes = 0.0, corpus_bytes = 0.0, t0, t1, t2, start;
+   double demarshal = 0.0, unmarshal = 0.0, elapsed;
+   long rss_corpus;
+   DBusMessage *msg;
+   DBusError err;
+
+   buffers = calloc(count, sizeof(char *));
+   lengths = calloc(count, sizeof(int));
+   for (i = 0; i < count; i++)
+     {
+        msg = b->message_new(i);
+        if (!dbus_message_get_serial(msg))
+          dbus_message_set_serial(msg, i + 1);
+        if (!dbus_message_marshal(msg, &buffers[i], &lengths[i]))
+          {
+             fprintf(stderr, "ERROR: %s: could not marshal message %u\n",
+                     b->name, i);
+             return 1;
+          }
+        corpus_bytes += lengths[i];
+        dbus_message_unref(msg);
+     }
+   rss_corpus = _maxrss_get();
+
+   dbus_error_init(&err);
+   start = bench_time_get();
+   do
+     {
+        for (i = 0; i < count; i++)
+          {
+             t0 = bench_time_get();
+             msg = dbus_message_demarshal(buffers[i], lengths[i], &err);
+             t1 = bench_time_get();
+             if (!msg)
+               {
+                  fprintf(stderr, "ERROR: %s: demarshal failed: %s\n",
+                          b->name, err.message);
+                  dbus_error_free(&err);
+                  return 1;
+               }
+             b->run(msg);
+             dbus_message_unref(msg);
+             t2 = bench_time_get();
+
+             demarshal += t1 - t0;
+             unmarshal += t2 - t1;
+          }
+        if (b->flush) b->flush();
+        passes++;
+        messages += count;
+        bytes += corpus_bytes;
+        elapsed = bench_time_get() - start;
+     }
+   while (elapsed < opt_time);
+
+   _report(b, "corpus_messages", count, "messages");
+   _report(b, "corpus_size", corpus_bytes / 1024.0, "KiB");
+   _report(b, "messages_per_sec", messages / (demarshal + unmarshal), "messages/s");
+   _report(b, "throughput", bytes / (1024.0 * 1024.0) / (demarshal + unmarshal), "MiB/s");
+   _report(b, "demarshal", demarshal * 1000000000.0 / messages, "ns/message");
+   _report(b, "unmarshal", unmarshal * 1000000000.0 / messages, "ns/message");
+   _report(b, "peak_rss", _maxrss_get(), "KiB");
+   _report(b, "peak_rss_over_corpus", _maxrss_get() - rss_corpus, "KiB");
+   fflush(stdout);
+
+   for (i = 0; i < count; i++)
+     free(buffers[i]);
+   free(buffers);
+   free(lengths);
+   return 0;
+}
+
+static void
+_usage(const char *prog)
+{
+   const Bench_Unmarshal **b;
+
+   fprintf(stderr,
+           "Usage: %s [options]\n"
+           "  -f <string>   only run cases whose name contains string\n"
+           "  -c <count>    messages per corpus (default per case)\n"
+           "  -t <seconds>  minimum run time per case (default %.1f)\n"
+           "\n"
+           "Available cases:",
+           prog, opt_time);
+   for (b = cases; *b; b++)
+     fprintf(stderr, " %s", (*b)->name);
+   fprintf(stderr, "\n\nResults are printed to stdout as one JSON object per line.\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+   const Bench_Unmarshal **b;
+   const char *filter = NULL;
+   int opt, status, ret = 0;
+   pid_t pid;
+
+   while ((opt = getopt(argc, argv, "f:c:t:h")) != -1)
+     {
+        switch (opt)
+          {
+           case 'f': filter = optarg; break;
+           case 'c': opt_corpus = strtoul(optarg, NULL, 10); break;
+           case 't': opt_time = strtod(optarg, NULL); break;
+           default:
+              _usage(argv[0]);
+              return opt == 'h' ? 0 : 1;
+          }
+     }
+
+   for (b = cases; *b; b++)
+     {
+        if (filter && !strstr((*b)->name, filter)) continue;
+
+        fflush(stdout);
+        pid = fork();
+        if (pid < 0)
+          {
+             fprintf(stderr, "ERROR: fork: %s\n", strerror(errno));
+             return 1;
+          }
+        if (pid == 0)
+          {
+             e_dbus_init();
+             status = _case_run(*b);
+             e_dbus_shutdown();
+             _exit(status);
+          }
+        if (waitpid(pid, &status, 0) < 0 ||
+            !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+          {
+             fprintf(stderr, "ERROR: case %s failed\n", (*b)->name);
+             ret = 1;
+          }
+     }
+
+   return ret;
+}
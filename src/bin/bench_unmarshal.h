@@ -0,0 +1,50 @@
+#ifndef BENCH_UNMARSHAL_H
+#define BENCH_UNMARSHAL_H
+
+#include <dbus/dbus.h>
+
+/*
+ * Offline unmarshalling benchmark cases.  A corpus of corpus_size messages
+ * is built with message_new(), serialized with dbus_message_marshal() and
+ * each timed pass demarshals every buffer and hands it to run(), which
+ * unmarshals it through the library and frees the result.  flush(), when
+ * given, is called between passes outside the timed section.
+ */
+
+typedef struct _Bench_Unmarshal Bench_Unmarshal;
+
+struct _Bench_Unmarshal
+{
+   const char   *name;
+   unsigned int  corpus_size;
+   DBusMessage *(*message_new)(unsigned int index);
+   void         (*run)(DBusMessage *msg);
+   void         (*flush)(void);
+};
+
+#ifdef BENCH_UNMARSHAL_HAL
+extern const Bench_Unmarshal bench_unmarshal_hal;
+#endif
+#ifdef BENCH_UNMARSHAL_UKIT
+extern const Bench_Unmarshal bench_unmarshal_ukit;
+#endif
+#ifdef BENCH_UNMARSHAL_CONNMAN
+extern const Bench_Unmarshal bench_unmarshal_connman;
+#endif
+#ifdef BENCH_UNMARSHAL_NOTIFY
+extern const Bench_Unmarshal bench_unmarshal_notify;
+#endif
+#ifdef BENCH_UNMARSHAL_BLUEZ
+extern const Bench_Unmarshal bench_unmarshal_bluez;
+#endif
+
+/* corpus building helpers */
+DBusMessage *bench_unmarshal_reply_new(void);
+void         bench_unmarshal_dict_basic(DBusMessageIter *dict, const char *key, int type, const void *value);
+void         bench_unmarshal_dict_strings(DBusMessageIter *dict, const char *key, unsigned int count);
+
+/* GetAllProperties reply of a HAL/UDisks style device, a{sv} with 200
+ * properties of string, int32, uint64, boolean, double and string list */
+DBusMessage *bench_unmarshal_device_new(unsigned int index);
+
+#endif
@@ -0,0 +1,95 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* the whole library is built into this unit so its static functions can be
+ * driven directly */
+#include "e_bluez.c"
+#include "e_bluez_element.c"
+#include "e_bluez_manager.c"
+#include "e_bluez_adapter.c"
+#include "e_bluez_device.c"
+#include "e_bluez_devicefound.c"
+
+#include "bench_unmarshal.h"
+
+static E_Bluez_Element *adapter = NULL;
+
+/* DeviceFound(address, properties) as emitted during discovery */
+static DBusMessage *
+_bench_bluez_device_found_new(unsigned int index)
+{
+   DBusMessage *msg;
+   DBusMessageIter iter, dict;
+   char address[32], name[64];
+   const char *s;
+   dbus_uint32_t class = 0x5a020c;
+   dbus_uint16_t rssi = 200 + index % 50;
+   dbus_bool_t no = FALSE;
+
+   msg = dbus_message_new_signal("/org/bluez/1/hci0", "org.bluez.Adapter",
+                                 "DeviceFound");
+   snprintf(address, sizeof(address), "00:1A:7D:%02X:%02X:%02X",
+            (index >> 16) & 0xff, (index >> 8) & 0xff, index & 0xff);
+   s = address;
+   dbus_message_iter_init_append(msg, &iter);
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &s);
+
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &dict);
+   bench_unmarshal_dict_basic(&dict, "Address", DBUS_TYPE_STRING, &s);
+   snprintf(name, sizeof(name), "Phone %u", index);
+   s = name;
+   bench_unmarshal_dict_basic(&dict, "Name", DBUS_TYPE_STRING, &s);
+   bench_unmarshal_dict_basic(&dict, "Alias", DBUS_TYPE_STRING, &s);
+   s = "phone";
+   bench_unmarshal_dict_basic(&dict, "Icon", DBUS_TYPE_STRING, &s);
+   bench_unmarshal_dict_basic(&dict, "Class", DBUS_TYPE_UINT32, &class);
+   bench_unmarshal_dict_basic(&dict, "RSSI", DBUS_TYPE_UINT16, &rssi);
+   bench_unmarshal_dict_basic(&dict, "Paired", DBUS_TYPE_BOOLEAN, &no);
+   bench_unmarshal_dict_basic(&dict, "Trusted", DBUS_TYPE_BOOLEAN, &no);
+   bench_unmarshal_dict_basic(&dict, "LegacyPairing", DBUS_TYPE_BOOLEAN, &no);
+   dbus_message_iter_close_container(&iter, &dict);
+   return msg;
+}
+
+static Eina_Bool
+_bench_bluez_device_found_free(void *data __UNUSED__, int type __UNUSED__, void *event)
+{
+   e_bluez_devicefound_free(event);
+   return ECORE_CALLBACK_PASS_ON;
+}
+
+static void
+_bench_bluez_run(DBusMessage *msg)
+{
+   const char *interface;
+
+   if (!adapter)
+     {
+        if (_e_dbus_bluez_log_dom < 0)
+          _e_dbus_bluez_log_dom = eina_log_domain_register
+              ("e_dbus_bluez_bench", EINA_LOG_DEFAULT_COLOR);
+        if (E_BLUEZ_EVENT_DEVICE_FOUND == 0)
+          E_BLUEZ_EVENT_DEVICE_FOUND = ecore_event_type_new();
+        ecore_event_handler_add(E_BLUEZ_EVENT_DEVICE_FOUND,
+                                _bench_bluez_device_found_free, NULL);
+        interface = eina_stringshare_add("org.bluez.Adapter");
+        adapter = e_bluez_element_new("/org/bluez/1/hci0", interface);
+        eina_stringshare_del(interface);
+     }
+
+   _device_found_callback(adapter, msg);
+}
+
+static void
+_bench_bluez_flush(void)
+{
+   /* deliver and free the queued E_BLUEZ_EVENT_DEVICE_FOUND events */
+   ecore_main_loop_iterate();
+}
+
+const Bench_Unmarshal bench_unmarshal_bluez =
+{
+   "bluez_device_found", 200,
+   _bench_bluez_device_found_new, _bench_bluez_run, _bench_bluez_flush
+};
@@ -0,0 +1,122 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* the whole library is built into this unit so its static functions can be
+ * driven directly */
+#include "e_connman.c"
+#include "e_connman_element.c"
+#include "e_connman_manager.c"
+#include "e_connman_profile.c"
+#include "e_connman_service.c"
+#include "e_connman_technology.c"
+
+#include "bench_unmarshal.h"
+
+static void
+_bench_connman_dict_open(DBusMessageIter *dict, const char *key, DBusMessageIter *entry, DBusMessageIter *variant, DBusMessageIter *sub)
+{
+   dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, entry);
+   dbus_message_iter_append_basic(entry, DBUS_TYPE_STRING, &key);
+   dbus_message_iter_open_container(entry, DBUS_TYPE_VARIANT, "a{sv}", variant);
+   dbus_message_iter_open_container(variant, DBUS_TYPE_ARRAY, "{sv}", sub);
+}
+
+static void
+_bench_connman_dict_close(DBusMessageIter *dict, DBusMessageIter *entry, DBusMessageIter *variant, DBusMessageIter *sub)
+{
+   dbus_message_iter_close_container(variant, sub);
+   dbus_message_iter_close_container(entry, variant);
+   dbus_message_iter_close_container(dict, entry);
+}
+
+/* GetProperties reply of a net.connman.Service, as sent for each of the
+ * services listed by the manager */
+static DBusMessage *
+_bench_connman_service_new(unsigned int index)
+{
+   DBusMessage *msg;
+   DBusMessageIter iter, dict, entry, variant, sub;
+   char name[64], addr[32];
+   const char *s;
+   unsigned char strength = index % 100;
+   dbus_bool_t yes = TRUE, no = FALSE;
+
+   msg = bench_unmarshal_reply_new();
+   dbus_message_iter_init_append(msg, &iter);
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &dict);
+
+   s = "wifi";
+   bench_unmarshal_dict_basic(&dict, "Type", DBUS_TYPE_STRING, &s);
+   s = index ? "idle" : "online";
+   bench_unmarshal_dict_basic(&dict, "State", DBUS_TYPE_STRING, &s);
+   snprintf(name, sizeof(name), "Access Point %u", index);
+   s = name;
+   bench_unmarshal_dict_basic(&dict, "Name", DBUS_TYPE_STRING, &s);
+   s = "managed";
+   bench_unmarshal_dict_basic(&dict, "Mode", DBUS_TYPE_STRING, &s);
+   bench_unmarshal_dict_basic(&dict, "Strength", DBUS_TYPE_BYTE, &strength);
+   bench_unmarshal_dict_basic(&dict, "Favorite", DBUS_TYPE_BOOLEAN, &no);
+   bench_unmarshal_dict_basic(&dict, "Immutable", DBUS_TYPE_BOOLEAN, &no);
+   bench_unmarshal_dict_basic(&dict, "AutoConnect", DBUS_TYPE_BOOLEAN, &yes);
+   bench_unmarshal_dict_basic(&dict, "PassphraseRequired", DBUS_TYPE_BOOLEAN, &yes);
+   bench_unmarshal_dict_basic(&dict, "LoginRequired", DBUS_TYPE_BOOLEAN, &no);
+   bench_unmarshal_dict_strings(&dict, "Security", 2);
+   bench_unmarshal_dict_strings(&dict, "Nameservers", 2);
+   bench_unmarshal_dict_strings(&dict, "Nameservers.Configuration", 0);
+   bench_unmarshal_dict_strings(&dict, "Domains", 1);
+   bench_unmarshal_dict_strings(&dict, "Domains.Configuration", 0);
+
+   _bench_connman_dict_open(&dict, "IPv4", &entry, &variant, &sub);
+   s = "dhcp";
+   bench_unmarshal_dict_basic(&sub, "Method", DBUS_TYPE_STRING, &s);
+   snprintf(addr, sizeof(addr), "10.%u.%u.2", index / 256, index % 256);
+   s = addr;
+   bench_unmarshal_dict_basic(&sub, "Address", DBUS_TYPE_STRING, &s);
+   s = "255.255.255.0";
+   bench_unmarshal_dict_basic(&sub, "Netmask", DBUS_TYPE_STRING, &s);
+   s = "10.0.0.1";
+   bench_unmarshal_dict_basic(&sub, "Gateway", DBUS_TYPE_STRING, &s);
+   _bench_connman_dict_close(&dict, &entry, &variant, &sub);
+
+   _bench_connman_dict_open(&dict, "IPv4.Configuration", &entry, &variant, &sub);
+   s = "dhcp";
+   bench_unmarshal_dict_basic(&sub, "Method", DBUS_TYPE_STRING, &s);
+   _bench_connman_dict_close(&dict, &entry, &variant, &sub);
+
+   _bench_connman_dict_open(&dict, "Ethernet", &entry, &variant, &sub);
+   s = "auto";
+   bench_unmarshal_dict_basic(&sub, "Method", DBUS_TYPE_STRING, &s);
+   s = "wlan0";
+   bench_unmarshal_dict_basic(&sub, "Interface", DBUS_TYPE_STRING, &s);
+   s = "00:11:22:33:44:55";
+   bench_unmarshal_dict_basic(&sub, "Address", DBUS_TYPE_STRING, &s);
+   _bench_connman_dict_close(&dict, &entry, &variant, &sub);
+
+   dbus_message_iter_close_container(&iter, &dict);
+   return msg;
+}
+
+static void
+_bench_connman_run(DBusMessage *msg)
+{
+   E_Connman_Element *element;
+
+   if (_e_dbus_connman_log_dom < 0)
+     _e_dbus_connman_log_dom = eina_log_domain_register
+         ("e_dbus_connman_bench", EINA_LOG_DEFAULT_COLOR);
+   if (!e_connman_iface_service)
+     e_connman_iface_service = eina_stringshare_add("net.connman.Service");
+
+   /* a fresh element, as for a service seen for the first time */
+   element = e_connman_element_new("/profile/default/wifi_bench",
+                                   e_connman_iface_service);
+   _e_connman_element_get_properties_callback(element, msg, NULL);
+   e_connman_element_unref(element);
+}
+
+const Bench_Unmarshal bench_unmarshal_connman =
+{
+   "connman_get_properties", 300,
+   _bench_connman_service_new, _bench_connman_run, NULL
+};
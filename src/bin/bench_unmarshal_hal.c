@@ -0,0 +1,31 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* the whole library is built into this unit so its static functions can be
+ * driven directly */
+#include "e_hal_device.c"
+#include "e_hal_main.c"
+#include "e_hal_manager.c"
+#include "e_hal_util.c"
+
+#include "bench_unmarshal.h"
+
+static void
+_bench_hal_run(DBusMessage *msg)
+{
+   void *ret;
+
+   if (_e_dbus_hal_log_dom < 0)
+     _e_dbus_hal_log_dom = eina_log_domain_register
+         ("e_dbus_hal_bench", E_DBUS_COLOR_DEFAULT);
+
+   ret = unmarshal_device_get_all_properties(msg, NULL);
+   free_device_get_all_properties(ret);
+}
+
+const Bench_Unmarshal bench_unmarshal_hal =
+{
+   "hal_device_get_all_properties", 100,
+   bench_unmarshal_device_new, _bench_hal_run, NULL
+};
@@ -0,0 +1,99 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* built from the library sources like the other cases; client.c and
+ * daemon.c are not needed to unmarshal */
+#include "notification.c"
+#include "marshal.c"
+
+#include "bench_unmarshal.h"
+
+#define IMAGE_SIZE 512
+
+/* Notify() call as sent by a client, with a 512x512 RGBA image-data hint */
+static DBusMessage *
+_bench_notify_new(unsigned int index)
+{
+   DBusMessage *msg;
+   DBusMessageIter iter, array, entry, variant, st, bytes;
+   char summary[64];
+   const char *s, *key;
+   dbus_uint32_t replaces = 0;
+   dbus_int32_t timeout = -1, width = IMAGE_SIZE, height = IMAGE_SIZE;
+   dbus_int32_t rowstride = IMAGE_SIZE * 4, bits = 8, channels = 4;
+   dbus_bool_t alpha = TRUE;
+   unsigned char urgency = 1, *data;
+   unsigned int i;
+
+   msg = dbus_message_new_method_call(E_NOTIFICATION_BUS_NAME,
+                                      E_NOTIFICATION_PATH,
+                                      E_NOTIFICATION_INTERFACE, "Notify");
+   dbus_message_iter_init_append(msg, &iter);
+   s = "bench";
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &s);
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT32, &replaces);
+   s = "";
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &s);
+   snprintf(summary, sizeof(summary), "Notification %u", index);
+   s = summary;
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &s);
+   s = "Body of a notification carrying an image hint.";
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &s);
+
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "s", &array);
+   s = "default";
+   dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING, &s);
+   s = "Open";
+   dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING, &s);
+   dbus_message_iter_close_container(&iter, &array);
+
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &array);
+   bench_unmarshal_dict_basic(&array, "urgency", DBUS_TYPE_BYTE, &urgency);
+   s = "im.received";
+   bench_unmarshal_dict_basic(&array, "category", DBUS_TYPE_STRING, &s);
+   s = "bench";
+   bench_unmarshal_dict_basic(&array, "desktop-entry", DBUS_TYPE_STRING, &s);
+
+   data = malloc(IMAGE_SIZE * IMAGE_SIZE * 4);
+   for (i = 0; i < IMAGE_SIZE * IMAGE_SIZE * 4; i++)
+     data[i] = (i + index) & 0xff;
+   key = "image-data";
+   dbus_message_iter_open_container(&array, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+   dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+   dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, "(iiibiiay)", &variant);
+   dbus_message_iter_open_container(&variant, DBUS_TYPE_STRUCT, NULL, &st);
+   dbus_message_iter_append_basic(&st, DBUS_TYPE_INT32, &width);
+   dbus_message_iter_append_basic(&st, DBUS_TYPE_INT32, &height);
+   dbus_message_iter_append_basic(&st, DBUS_TYPE_INT32, &rowstride);
+   dbus_message_iter_append_basic(&st, DBUS_TYPE_BOOLEAN, &alpha);
+   dbus_message_iter_append_basic(&st, DBUS_TYPE_INT32, &bits);
+   dbus_message_iter_append_basic(&st, DBUS_TYPE_INT32, &channels);
+   dbus_message_iter_open_container(&st, DBUS_TYPE_ARRAY, "y", &bytes);
+   dbus_message_iter_append_fixed_array(&bytes, DBUS_TYPE_BYTE, &data,
+                                        IMAGE_SIZE * IMAGE_SIZE * 4);
+   dbus_message_iter_close_container(&st, &bytes);
+   dbus_message_iter_close_container(&variant, &st);
+   dbus_message_iter_close_container(&entry, &variant);
+   dbus_message_iter_close_container(&array, &entry);
+   free(data);
+
+   dbus_message_iter_close_container(&iter, &array);
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_INT32, &timeout);
+   return msg;
+}
+
+static void
+_bench_notify_run(DBusMessage *msg)
+{
+   E_Notification *n;
+
+   n = e_notify_unmarshal_notify(msg, NULL);
+   if (n) e_notification_unref(n);
+}
+
+const Bench_Unmarshal bench_unmarshal_notify =
+{
+   "notify_unmarshal_notify", 16,
+   _bench_notify_new, _bench_notify_run, NULL
+};
@@ -0,0 +1,30 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* built from the library sources like the other cases; e_udisks.c and
+ * e_upower.c only issue calls and cannot share one unit */
+#include "e_ukit_util.c"
+#include "e_ukit_main.c"
+#include "e_ukit_private_util.c"
+
+#include "bench_unmarshal.h"
+
+static void
+_bench_ukit_run(DBusMessage *msg)
+{
+   void *ret;
+
+   if (_e_dbus_ukit_log_dom < 0)
+     _e_dbus_ukit_log_dom = eina_log_domain_register
+         ("e_dbus_ukit_bench", E_DBUS_COLOR_DEFAULT);
+
+   ret = unmarshal_device_get_all_properties(msg, NULL);
+   free_device_get_all_properties(ret);
+}
+
+const Bench_Unmarshal bench_unmarshal_ukit =
+{
+   "ukit_device_get_all_properties", 100,
+   bench_unmarshal_device_new, _bench_ukit_run, NULL
+};
@@ -0,0 +1,604 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <Ecore.h>
+#include "E_DBus.h"
+#include "bench_common.h"
+
+/*
+ * Headless latency/throughput benchmark for the e_dbus dispatch path.
+ *
+ * A private session bus is started on a temporary socket, a server
+ * process exporting BENCH_IFACE is forked and this process then runs,
+ * in order:
+ *
+ *  - latency:    sequential Echo calls, reports p50/p99/p99.9 round trip
+ *  - throughput: Echo calls with 1, 2, 4 ... N calls in flight
+ *  - deferred:   DeferredEcho calls (replied from an idler) with N in flight
+ *  - signals:    Emit(count) makes the server send count Tick signals
+ *
+ * Results are printed as JSON lines, see bench_common.h.
+ */
+
+#define BENCH_NAME  "org.enlightenment.edbus.Benchmark"
+#define BENCH_PATH  "/org/enlightenment/edbus/Benchmark"
+#define BENCH_IFACE "org.enlightenment.edbus.Benchmark"
+
+static E_DBus_Connection *conn = NULL;
+
+static unsigned int opt_calls = 10000;
+static unsigned int opt_concurrency = 16;
+static unsigned int opt_signals = 100000;
+static unsigned int opt_payload = 16;
+static unsigned int opt_warmup = 500;
+
+/* server side *************************************************************/
+
+static Eina_List *deferred = NULL;
+static Ecore_Idler *deferred_idler = NULL;
+static int ready_fd = -1;
+
+static DBusMessage *
+_srv_echo(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   const char *s = NULL;
+
+   dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &s, DBUS_TYPE_INVALID);
+   reply = dbus_message_new_method_return(msg);
+   if (s)
+     dbus_message_append_args(reply, DBUS_TYPE_STRING, &s, DBUS_TYPE_INVALID);
+   return reply;
+}
+
+static Eina_Bool
+_srv_deferred_flush(void *data __UNUSED__)
+{
+   DBusMessage *msg, *reply;
+
+   EINA_LIST_FREE(deferred, msg)
+     {
+        reply = _srv_echo(NULL, msg);
+        e_dbus_message_send(conn, reply, NULL, -1, NULL);
+        dbus_message_unref(reply);
+        dbus_message_unref(msg);
+     }
+   deferred_idler = NULL;
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static DBusMessage *
+_srv_deferred_echo(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   deferred = eina_list_append(deferred, dbus_message_ref(msg));
+   if (!deferred_idler)
+     deferred_idler = ecore_idler_add(_srv_deferred_flush, NULL);
+   return NULL;
+}
+
+static DBusMessage *
+_srv_emit(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *sig;
+   dbus_uint32_t count = 0, sent = 0, i;
+
+   dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT32, &count,
+                         DBUS_TYPE_INVALID);
+
+   e_dbus_connection_cork(conn);
+   for (i = 0; i < count; i++)
+     {
+        sig = dbus_message_new_signal(BENCH_PATH, BENCH_IFACE, "Tick");
+        dbus_message_append_args(sig, DBUS_TYPE_UINT32, &i, DBUS_TYPE_INVALID);
+        if (e_dbus_signal_send(conn, sig)) sent++;
+        dbus_message_unref(sig);
+     }
+   e_dbus_connection_uncork(conn);
+
+   /* the client waits for those actually sent */
+   sig = dbus_message_new_method_return(msg);
+   dbus_message_append_args(sig, DBUS_TYPE_UINT32, &sent, DBUS_TYPE_INVALID);
+   return sig;
+}
+
+static Eina_Bool
+_srv_quit_idler(void *data __UNUSED__)
+{
+   ecore_main_loop_quit();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static DBusMessage *
+_srv_quit(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   ecore_idler_add(_srv_quit_idler, NULL);
+   return dbus_message_new_method_return(msg);
+}
+
+static void
+_srv_cb_request_name(void *data __UNUSED__, DBusMessage *msg, DBusError *err)
+{
+   E_DBus_Object *obj;
+   E_DBus_Interface *iface;
+   dbus_uint32_t ret = 0;
+   char c = 'R';
+
+   if (dbus_error_is_set(err))
+     {
+        fprintf(stderr, "ERROR: server: %s: %s\n", err->name, err->message);
+        ecore_main_loop_quit();
+        return;
+     }
+   dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT32, &ret, DBUS_TYPE_INVALID);
+   if (ret != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER)
+     {
+        fprintf(stderr, "ERROR: server: could not own %s\n", BENCH_NAME);
+        ecore_main_loop_quit();
+        return;
+     }
+
+   obj = e_dbus_object_add(conn, BENCH_PATH, NULL);
+   iface = e_dbus_interface_new(BENCH_IFACE);
+   e_dbus_interface_method_add(iface, "Echo", "s", "s", _srv_echo);
+   e_dbus_interface_method_add(iface, "DeferredEcho", "s", "s",
+                               _srv_deferred_echo);
+   e_dbus_interface_method_add(iface, "Emit", "u", "u", _srv_emit);
+   e_dbus_interface_method_add(iface, "Quit", "", "", _srv_quit);
+   e_dbus_interface_signal_add(iface, "Tick", "u");
+   e_dbus_object_interface_attach(obj, iface);
+   e_dbus_interface_unref(iface);
+
+   if (write(ready_fd, &c, 1) != 1)
+     fprintf(stderr, "ERROR: server: could not signal readiness\n");
+   close(ready_fd);
+   ready_fd = -1;
+}
+
+static int
+_server_run(int fd)
+{
+   ready_fd = fd;
+   e_dbus_init();
+
+   conn = e_dbus_bus_get(DBUS_BUS_SESSION);
+   if (!conn)
+     {
+        fprintf(stderr, "ERROR: server: could not connect to the bus\n");
+        return 1;
+     }
+
+   e_dbus_request_name(conn, BENCH_NAME, DBUS_NAME_FLAG_DO_NOT_QUEUE,
+                       _srv_cb_request_name, NULL);
+   ecore_main_loop_begin();
+
+   e_dbus_connection_close(conn);
+   e_dbus_shutdown();
+   return 0;
+}
+
+/* client side *************************************************************/
+
+typedef struct _Call_Run Call_Run;
+
+struct _Call_Run
+{
+   const char *bench;
+   const char *method;
+   unsigned int total;
+   unsigned int concurrency;
+   unsigned int sent;
+   unsigned int done;
+   unsigned int errors;
+   Eina_Bool report;
+   double start;
+   double *sent_at;
+   double *rtt;
+};
+
+static Call_Run run;
+static char *payload = NULL;
+static unsigned int step = 0;
+static unsigned int signals_received = 0;
+static unsigned int signals_expected = 0;
+static Eina_Bool signals_replied = EINA_FALSE;
+static double signals_start = 0.0;
+/* a lost signal must not hang the whole benchmark */
+#define SIGNALS_TIMEOUT 60.0
+static Ecore_Timer *signals_timer = NULL;
+static int exit_code = 0;
+
+static void _bench_next(void);
+
+static Eina_Bool
+_bench_next_idler(void *data __UNUSED__)
+{
+   _bench_next();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_run_finish(void)
+{
+   double elapsed = bench_time_get() - run.start;
+   unsigned int i;
+   double sum = 0.0;
+
+   if (run.errors)
+     {
+        fprintf(stderr, "ERROR: %u of %u %s calls failed\n",
+                run.errors, run.total, run.method);
+        exit_code = 1;
+     }
+
+   if (run.report)
+     {
+        for (i = 0; i < run.total; i++)
+          {
+             run.rtt[i] *= 1000000.0;
+             sum += run.rtt[i];
+          }
+
+        if (run.concurrency == 1 && !strcmp(run.bench, "latency"))
+          {
+             bench_report(run.bench, "mean", sum / run.total, "us");
+             bench_report(run.bench, "p50",
+                          bench_percentile(run.rtt, run.total, 50.0), "us");
+             bench_report(run.bench, "p99",
+                          bench_percentile(run.rtt, run.total, 99.0), "us");
+             bench_report(run.bench, "p99.9",
+                          bench_percentile(run.rtt, run.total, 99.9), "us");
+          }
+        else
+          {
+             bench_report_int(run.bench, "calls_per_sec", run.total / elapsed,
+                              "calls/s", "concurrency", run.concurrency);
+             bench_report_int(run.bench, "p99",
+                              bench_percentile(run.rtt, run.total, 99.0), "us",
+                              "concurrency", run.concurrency);
+          }
+     }
+
+   free(run.sent_at);
+   free(run.rtt);
+   run.sent_at = NULL;
+   run.rtt = NULL;
+
+   ecore_idler_add(_bench_next_idler, NULL);
+}
+
+static void _run_send(void);
+
+static void
+_run_cb_reply(void *data, DBusMessage *msg __UNUSED__, DBusError *error)
+{
+   unsigned int id = (unsigned int)(uintptr_t)data;
+
+   run.rtt[id] = bench_time_get() - run.sent_at[id];
+   if (dbus_error_is_set(error))
+     run.errors++;
+   run.done++;
+
+   if (run.sent < run.total)
+     _run_send();
+   else if (run.done == run.total)
+     _run_finish();
+}
+
+/* a failed send is counted as done and replaced by the next message, so the
+ * run still finishes if the last or all of the sends fail */
+static void
+_run_send(void)
+{
+   DBusMessage *msg;
+   unsigned int id;
+
+   while (run.sent < run.total)
+     {
+        id = run.sent++;
+        msg = dbus_message_new_method_call(BENCH_NAME, BENCH_PATH, BENCH_IFACE,
+                                           run.method);
+        dbus_message_append_args(msg, DBUS_TYPE_STRING, &payload,
+                                 DBUS_TYPE_INVALID);
+        run.sent_at[id] = bench_time_get();
+        if (e_dbus_message_send(conn, msg, _run_cb_reply, -1,
+                                (void *)(uintptr_t)id))
+          {
+             dbus_message_unref(msg);
+             return;
+          }
+        dbus_message_unref(msg);
+
+        run.rtt[id] = 0.0;
+        run.errors++;
+        run.done++;
+     }
+
+   if (run.done == run.total)
+     _run_finish();
+}
+
+static void
+_run_start(const char *bench, const char *method, unsigned int total, unsigned int concurrency, Eina_Bool report)
+{
+   unsigned int i;
+
+   run.bench = bench;
+   run.method = method;
+   run.total = total;
+   run.concurrency = concurrency;
+   run.sent = 0;
+   run.done = 0;
+   run.errors = 0;
+   run.report = report;
+   run.sent_at = calloc(total, sizeof(double));
+   run.rtt = calloc(total, sizeof(double));
+
+   run.start = bench_time_get();
+   for (i = 0; i < concurrency && run.sent < total; i++)
+     _run_send();
+}
+
+static void
+_signals_check(void)
+{
+   double elapsed;
+
+   if (!signals_replied || signals_received < signals_expected) return;
+
+   elapsed = bench_time_get() - signals_start;
+   if (signals_expected)
+     bench_report("signals", "signals_per_sec", signals_expected / elapsed,
+                  "signals/s");
+   signals_replied = EINA_FALSE;
+   ecore_timer_del(signals_timer);
+   signals_timer = NULL;
+   ecore_idler_add(_bench_next_idler, NULL);
+}
+
+static Eina_Bool
+_signals_cb_timeout(void *data __UNUSED__)
+{
+   fprintf(stderr, "ERROR: signals run timed out, %u of %u received\n",
+           signals_received, signals_replied ? signals_expected : opt_signals);
+   exit_code = 1;
+   signals_timer = NULL;
+   /* late ticks and the Emit reply are ignored from now on */
+   signals_replied = EINA_FALSE;
+   signals_expected = (unsigned int)-1;
+   ecore_idler_add(_bench_next_idler, NULL);
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_signals_cb_tick(void *data __UNUSED__, DBusMessage *msg __UNUSED__)
+{
+   signals_received++;
+   if (signals_received == signals_expected)
+     _signals_check();
+}
+
+static void
+_signals_cb_reply(void *data __UNUSED__, DBusMessage *msg, DBusError *error)
+{
+   dbus_uint32_t sent = 0;
+
+   if (dbus_error_is_set(error))
+     {
+        fprintf(stderr, "ERROR: Emit: %s: %s\n", error->name, error->message);
+        exit_code = 1;
+        ecore_main_loop_quit();
+        return;
+     }
+   if (!signals_timer) return;
+
+   dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT32, &sent,
+                         DBUS_TYPE_INVALID);
+   if (sent < opt_signals)
+     {
+        fprintf(stderr, "ERROR: server failed to emit %u of %u signals\n",
+                opt_signals - sent, opt_signals);
+        exit_code = 1;
+     }
+   signals_expected = sent;
+   signals_replied = EINA_TRUE;
+   _signals_check();
+}
+
+static void
+_signals_start(void)
+{
+   DBusMessage *msg;
+   dbus_uint32_t count = opt_signals;
+
+   signals_received = 0;
+   /* known from the Emit reply, until then wait for all of them */
+   signals_expected = opt_signals;
+   signals_replied = EINA_FALSE;
+   signals_timer = ecore_timer_add(SIGNALS_TIMEOUT, _signals_cb_timeout, NULL);
+   msg = dbus_message_new_method_call(BENCH_NAME, BENCH_PATH, BENCH_IFACE,
+                                      "Emit");
+   dbus_message_append_args(msg, DBUS_TYPE_UINT32, &count, DBUS_TYPE_INVALID);
+   signals_start = bench_time_get();
+   e_dbus_message_send(conn, msg, _signals_cb_reply, -1, NULL);
+   dbus_message_unref(msg);
+}
+
+static void
+_quit_cb_reply(void *data __UNUSED__, DBusMessage *msg __UNUSED__, DBusError *error __UNUSED__)
+{
+   ecore_main_loop_quit();
+}
+
+static void
+_bench_next(void)
+{
+   unsigned int c, s = 0;
+   DBusMessage *msg;
+
+   if (step == s++)
+     {
+        step++;
+        _run_start("warmup", "Echo", opt_warmup, 1, EINA_FALSE);
+        return;
+     }
+   if (step == s++)
+     {
+        step++;
+        _run_start("latency", "Echo", opt_calls, 1, EINA_TRUE);
+        return;
+     }
+   /* powers of two, the last step is the requested maximum */
+   for (c = 1; c < opt_concurrency * 2; c *= 2)
+     {
+        if (step == s++)
+          {
+             step++;
+             _run_start("throughput", "Echo", opt_calls,
+                        c < opt_concurrency ? c : opt_concurrency, EINA_TRUE);
+             return;
+          }
+     }
+   if (step == s++)
+     {
+        step++;
+        _run_start("deferred", "DeferredEcho", opt_calls, opt_concurrency,
+                   EINA_TRUE);
+        return;
+     }
+   if (step == s++)
+     {
+        step++;
+        if (opt_signals)
+          {
+             _signals_start();
+             return;
+          }
+     }
+
+   msg = dbus_message_new_method_call(BENCH_NAME, BENCH_PATH, BENCH_IFACE,
+                                      "Quit");
+   e_dbus_message_send(conn, msg, _quit_cb_reply, 5000, NULL);
+   dbus_message_unref(msg);
+}
+
+static void
+_usage(const char *prog)
+{
+   fprintf(stderr,
+           "Usage: %s [options]\n"
+           "  -n <calls>        method calls per run (default %u)\n"
+           "  -c <concurrency>  maximum calls in flight (default %u)\n"
+           "  -s <signals>      signals for the signal run, 0 skips (default %u)\n"
+           "  -p <bytes>        string payload size (default %u)\n"
+           "  -w <calls>        warm up calls, not reported (default %u)\n"
+           "\n"
+           "Results are printed to stdout as one JSON object per line.\n"
+           "Set E_DBUS_BENCH_DAEMON to use another dbus-daemon binary.\n",
+           prog, opt_calls, opt_concurrency, opt_signals, opt_payload,
+           opt_warmup);
+}
+
+int
+main(int argc, char *argv[])
+{
+   Bench_Daemon daemon;
+   E_DBus_Signal_Handler *sh;
+   pid_t server;
+   int fds[2], opt;
+   ssize_t r;
+   char c = 0;
+
+   while ((opt = getopt(argc, argv, "n:c:s:p:w:h")) != -1)
+     {
+        switch (opt)
+          {
+           case 'n': opt_calls = strtoul(optarg, NULL, 10); break;
+           case 'c': opt_concurrency = strtoul(optarg, NULL, 10); break;
+           case 's': opt_signals = strtoul(optarg, NULL, 10); break;
+           case 'p': opt_payload = strtoul(optarg, NULL, 10); break;
+           case 'w': opt_warmup = strtoul(optarg, NULL, 10); break;
+           default:
+              _usage(argv[0]);
+              return opt == 'h' ? 0 : 1;
+          }
+     }
+   if (!opt_calls) opt_calls = 1;
+   if (!opt_concurrency) opt_concurrency = 1;
+
+   if (!bench_daemon_start(&daemon))
+     return 1;
+
+   if (pipe(fds) < 0)
+     {
+        fprintf(stderr, "ERROR: pipe: %s\n", strerror(errno));
+        bench_daemon_stop(&daemon);
+        return 1;
+     }
+
+   server = fork();
+   if (server < 0)
+     {
+        fprintf(stderr, "ERROR: fork: %s\n", strerror(errno));
+        bench_daemon_stop(&daemon);
+        return 1;
+     }
+   if (server == 0)
+     {
+        close(fds[0]);
+        _exit(_server_run(fds[1]));
+     }
+
+   close(fds[1]);
+   do
+     r = read(fds[0], &c, 1);
+   while (r < 0 && errno == EINTR);
+   close(fds[0]);
+   if (r != 1 || c != 'R')
+     {
+        fprintf(stderr, "ERROR: benchmark server did not start\n");
+        kill(server, SIGTERM);
+        waitpid(server, NULL, 0);
+        bench_daemon_stop(&daemon);
+        return 1;
+     }
+
+   e_dbus_init();
+   conn = e_dbus_bus_get(DBUS_BUS_SESSION);
+   if (!conn)
+     {
+        fprintf(stderr, "ERROR: could not connect to %s\n", daemon.address);
+        exit_code = 1;
+        goto end;
+     }
+
+   payload = malloc(opt_payload + 1);
+   memset(payload, 'x', opt_payload);
+   payload[opt_payload] = '\0';
+
+   sh = e_dbus_signal_handler_add(conn, NULL, BENCH_PATH, BENCH_IFACE, "Tick",
+                                  _signals_cb_tick, NULL);
+
+   ecore_idler_add(_bench_next_idler, NULL);
+   ecore_main_loop_begin();
+
+   e_dbus_signal_handler_del(conn, sh);
+   e_dbus_connection_close(conn);
+   free(payload);
+
+ end:
+   e_dbus_shutdown();
+   kill(server, SIGTERM);
+   waitpid(server, NULL, 0);
+   bench_daemon_stop(&daemon);
+   return exit_code;
+}
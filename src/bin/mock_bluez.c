@@ -0,0 +1,272 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Ecore.h>
+#include "mock_services.h"
+
+/*
+ * org.bluez 4.x: a Manager at "/" with one adapter that already knows
+ * cfg->bluez_paired devices.  While discovering, the adapter reports the
+ * next of cfg->bluez_found nearby devices with DeviceFound every
+ * bluez_found_interval ms.  CreatePairedDevice adds a Device object.
+ */
+
+#define BLUEZ_ADAPTER "/org/bluez/mock/hci0"
+
+static E_DBus_Connection *bluez_conn = NULL;
+static const Mock_Config *config = NULL;
+static Mock_Object *manager = NULL;
+static Mock_Object *adapter = NULL;
+static Mock_Iface *adapter_iface = NULL;
+static Eina_List *devices = NULL;
+static Eina_Hash *devices_by_address = NULL;
+static Ecore_Timer *found_timer = NULL;
+static unsigned int found_next = 0;
+
+static void
+_bluez_address_get(char *buf, size_t size, unsigned int index, unsigned char prefix)
+{
+   snprintf(buf, size, "00:%02X:%02X:%02X:%02X:%02X", prefix,
+            (index >> 24) & 0xff, (index >> 16) & 0xff, (index >> 8) & 0xff,
+            index & 0xff);
+}
+
+static Mock_Object *
+_bluez_device_add(const char *address, const char *name, Eina_Bool paired)
+{
+   Mock_Object *mo;
+   Mock_Iface *mi;
+   char path[128], *p;
+
+   snprintf(path, sizeof(path), "%s/dev_%s", BLUEZ_ADAPTER, address);
+   for (p = path + sizeof(BLUEZ_ADAPTER); *p; p++)
+     if (*p == ':') *p = '_';
+
+   mo = mock_object_add(bluez_conn, path, NULL);
+   if (!mo) return NULL;
+
+   mi = mock_iface_add(mo, "org.bluez.Device", MOCK_STYLE_PROPERTIES);
+   mock_property_string_set(mi, "Address", address);
+   mock_property_string_set(mi, "Name", name);
+   mock_property_string_set(mi, "Alias", name);
+   mock_property_uint32_set(mi, "Class", 0x5a020c);
+   mock_property_string_set(mi, "Icon", "phone");
+   mock_property_bool_set(mi, "Paired", paired);
+   mock_property_bool_set(mi, "Trusted", EINA_FALSE);
+   mock_property_bool_set(mi, "Connected", EINA_FALSE);
+   mock_property_array_append(mi, "UUIDs", 's', "00001101-0000-1000-8000-00805f9b34fb");
+   mock_property_path_set(mi, "Adapter", BLUEZ_ADAPTER);
+
+   devices = eina_list_append(devices, mo);
+   eina_hash_add(devices_by_address, address, mo);
+   mock_property_array_append(adapter_iface, "Devices", 'o', path);
+   return mo;
+}
+
+static void
+_bluez_device_found_emit(unsigned int index)
+{
+   DBusMessage *msg;
+   DBusMessageIter iter, array, entry, variant;
+   char address[32], name[32];
+   const char *s;
+   dbus_int16_t rssi = -40 - (index % 50);
+   dbus_uint32_t klass = 0x5a020c;
+
+   _bluez_address_get(address, sizeof(address), index, 0xF0);
+   snprintf(name, sizeof(name), "mock-found-%u", index);
+
+   msg = dbus_message_new_signal(BLUEZ_ADAPTER, "org.bluez.Adapter", "DeviceFound");
+   if (!msg) return;
+
+   dbus_message_iter_init_append(msg, &iter);
+   s = address;
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &s);
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &array);
+
+#define FOUND_PROPERTY(_key, _type, _sig, _value)                               \
+   dbus_message_iter_open_container(&array, DBUS_TYPE_DICT_ENTRY, NULL, &entry); \
+   s = _key;                                                                    \
+   dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &s);                \
+   dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, _sig, &variant); \
+   dbus_message_iter_append_basic(&variant, _type, _value);                     \
+   dbus_message_iter_close_container(&entry, &variant);                         \
+   dbus_message_iter_close_container(&array, &entry)
+
+   s = address;
+   FOUND_PROPERTY("Address", DBUS_TYPE_STRING, "s", &s);
+   s = name;
+   FOUND_PROPERTY("Name", DBUS_TYPE_STRING, "s", &s);
+   FOUND_PROPERTY("Class", DBUS_TYPE_UINT32, "u", &klass);
+   FOUND_PROPERTY("RSSI", DBUS_TYPE_INT16, "n", &rssi);
+#undef FOUND_PROPERTY
+
+   dbus_message_iter_close_container(&iter, &array);
+   e_dbus_signal_send(bluez_conn, msg);
+   dbus_message_unref(msg);
+}
+
+static Eina_Bool
+_bluez_found_update(void *data __UNUSED__)
+{
+   if (!config->bluez_found) return ECORE_CALLBACK_RENEW;
+
+   _bluez_device_found_emit(found_next);
+   found_next = (found_next + 1) % config->bluez_found;
+   return ECORE_CALLBACK_RENEW;
+}
+
+static DBusMessage *
+_bluez_cb_empty(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_bluez_cb_default_adapter(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   const char *path = BLUEZ_ADAPTER;
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &path, DBUS_TYPE_INVALID);
+   return reply;
+}
+
+static DBusMessage *
+_bluez_cb_start_discovery(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   if (!found_timer)
+     {
+        double interval = config->bluez_found_interval / 1000.0;
+
+        found_timer = ecore_timer_add(interval > 0.0 ? interval : 0.1,
+                                      _bluez_found_update, NULL);
+        mock_property_bool_set(adapter_iface, "Discovering", EINA_TRUE);
+     }
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_bluez_cb_stop_discovery(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   if (!found_timer)
+     return dbus_message_new_error(msg, "org.bluez.Error.NotAuthorized", "Not discovering");
+
+   ecore_timer_del(found_timer);
+   found_timer = NULL;
+   mock_property_bool_set(adapter_iface, "Discovering", EINA_FALSE);
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_bluez_cb_create_paired_device(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   Mock_Object *mo;
+   const char *address = NULL, *agent = NULL, *capability = NULL, *path;
+
+   if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &address,
+                              DBUS_TYPE_OBJECT_PATH, &agent,
+                              DBUS_TYPE_STRING, &capability, DBUS_TYPE_INVALID))
+     return dbus_message_new_error(msg, "org.bluez.Error.InvalidArguments", "Expected (sos)");
+
+   if (eina_hash_find(devices_by_address, address))
+     return dbus_message_new_error(msg, "org.bluez.Error.AlreadyExists", "Already paired");
+
+   mo = _bluez_device_add(address, address, EINA_TRUE);
+   if (!mo)
+     return dbus_message_new_error(msg, "org.bluez.Error.Failed", "Could not create device");
+
+   path = mock_object_path_get(mo);
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &path, DBUS_TYPE_INVALID);
+   return reply;
+}
+
+Eina_Bool
+mock_bluez_start(E_DBus_Connection *conn, const Mock_Config *cfg)
+{
+   Mock_Iface *mi;
+   char address[32], name[32];
+   unsigned int i;
+
+   bluez_conn = conn;
+   config = cfg;
+   devices_by_address = eina_hash_string_superfast_new(NULL);
+
+   manager = mock_object_add(conn, "/", NULL);
+   if (!manager) return EINA_FALSE;
+
+   mi = mock_iface_add(manager, "org.bluez.Manager", MOCK_STYLE_PROPERTIES);
+   mock_iface_method_add(mi, "DefaultAdapter", "", "o", _bluez_cb_default_adapter);
+   mock_iface_signal_add(mi, "AdapterAdded", "o");
+   mock_iface_signal_add(mi, "AdapterRemoved", "o");
+   mock_iface_signal_add(mi, "DefaultAdapterChanged", "o");
+   mock_property_array_append(mi, "Adapters", 'o', BLUEZ_ADAPTER);
+
+   adapter = mock_object_add(conn, BLUEZ_ADAPTER, NULL);
+   if (!adapter) return EINA_FALSE;
+
+   adapter_iface = mock_iface_add(adapter, "org.bluez.Adapter", MOCK_STYLE_PROPERTIES);
+   mock_iface_method_add(adapter_iface, "RegisterAgent", "os", "", _bluez_cb_empty);
+   mock_iface_method_add(adapter_iface, "UnregisterAgent", "o", "", _bluez_cb_empty);
+   mock_iface_method_add(adapter_iface, "StartDiscovery", "", "", _bluez_cb_start_discovery);
+   mock_iface_method_add(adapter_iface, "StopDiscovery", "", "", _bluez_cb_stop_discovery);
+   mock_iface_method_add(adapter_iface, "CreatePairedDevice", "sos", "o", _bluez_cb_create_paired_device);
+   mock_iface_signal_add(adapter_iface, "DeviceFound", "sa{sv}");
+   mock_iface_signal_add(adapter_iface, "DeviceDisappeared", "s");
+
+   mock_property_string_set(adapter_iface, "Address", "00:11:22:33:44:55");
+   mock_property_string_set(adapter_iface, "Name", "mock-hci0");
+   mock_property_uint32_set(adapter_iface, "Class", 0x4a010c);
+   mock_property_bool_set(adapter_iface, "Powered", EINA_TRUE);
+   mock_property_bool_set(adapter_iface, "Discoverable", EINA_FALSE);
+   mock_property_bool_set(adapter_iface, "Pairable", EINA_TRUE);
+   mock_property_uint32_set(adapter_iface, "DiscoverableTimeout", 180);
+   mock_property_uint32_set(adapter_iface, "PairableTimeout", 0);
+   mock_property_bool_set(adapter_iface, "Discovering", EINA_FALSE);
+   mock_property_array_append(adapter_iface, "UUIDs", 's', NULL);
+   mock_property_array_append(adapter_iface, "Devices", 'o', NULL);
+
+   for (i = 0; i < cfg->bluez_paired; i++)
+     {
+        _bluez_address_get(address, sizeof(address), i, 0xA0);
+        snprintf(name, sizeof(name), "mock-paired-%u", i);
+        if (!_bluez_device_add(address, name, EINA_TRUE)) break;
+     }
+   return EINA_TRUE;
+}
+
+void
+mock_bluez_stop(void)
+{
+   Mock_Object *mo;
+
+   if (found_timer)
+     {
+        ecore_timer_del(found_timer);
+        found_timer = NULL;
+     }
+   found_next = 0;
+
+   EINA_LIST_FREE(devices, mo)
+     mock_object_del(mo);
+   if (devices_by_address)
+     {
+        eina_hash_free(devices_by_address);
+        devices_by_address = NULL;
+     }
+   mock_object_del(adapter);
+   adapter = NULL;
+   adapter_iface = NULL;
+   mock_object_del(manager);
+   manager = NULL;
+   bluez_conn = NULL;
+   config = NULL;
+}
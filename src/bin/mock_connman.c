@@ -0,0 +1,287 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Ecore.h>
+#include "mock_services.h"
+
+/*
+ * net.connman 0.7x: a Manager at "/", one default profile, wifi and
+ * ethernet technologies and cfg->connman_services wifi services.  Every
+ * connman_strength_interval ms the next service (round robin) gets a new
+ * Strength, so the PropertyChanged rate is 1000 / interval per second.
+ */
+
+#define CONNMAN_PROFILE "/profile/default"
+
+typedef struct _Mock_Connman_Service Mock_Connman_Service;
+
+struct _Mock_Connman_Service
+{
+   Mock_Object *mo;
+   Mock_Iface *mi;
+   unsigned int index;
+};
+
+static Mock_Object *manager = NULL;
+static Mock_Iface *manager_iface = NULL;
+static Mock_Object *profile = NULL;
+static Eina_List *technologies = NULL;
+static Eina_List *services = NULL;
+static Eina_List *services_deleted = NULL;
+static Ecore_Timer *strength_timer = NULL;
+static Ecore_Idler *delete_idler = NULL;
+static Eina_List *strength_next = NULL;
+
+static DBusMessage *
+_connman_cb_empty(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_connman_cb_technology_toggle(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   const char *type = NULL;
+
+   if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &type, DBUS_TYPE_INVALID))
+     return dbus_message_new_error(msg, "net.connman.Error.InvalidArguments", "Expected (s)");
+
+   mock_property_array_remove(manager_iface, "EnabledTechnologies", type);
+   if (!strcmp(dbus_message_get_member(msg), "EnableTechnology"))
+     mock_property_array_append(manager_iface, "EnabledTechnologies", 's', type);
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_connman_cb_service_connect(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Connman_Service *svc = mock_object_data_get(mock_object_get(obj));
+
+   mock_property_string_set(svc->mi, "State", "ready");
+   mock_property_string_set(manager_iface, "State", "online");
+   mock_property_array_remove(manager_iface, "ConnectedTechnologies", "wifi");
+   mock_property_array_append(manager_iface, "ConnectedTechnologies", 's', "wifi");
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_connman_cb_service_disconnect(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Connman_Service *svc = mock_object_data_get(mock_object_get(obj));
+
+   mock_property_string_set(svc->mi, "State", "idle");
+   return dbus_message_new_method_return(msg);
+}
+
+static Eina_Bool
+_connman_services_delete(void *data __UNUSED__)
+{
+   Mock_Connman_Service *svc;
+
+   EINA_LIST_FREE(services_deleted, svc)
+     {
+        mock_object_del(svc->mo);
+        free(svc);
+     }
+   delete_idler = NULL;
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static DBusMessage *
+_connman_cb_service_remove(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Connman_Service *svc = mock_object_data_get(mock_object_get(obj));
+   Eina_List *l;
+
+   l = eina_list_data_find_list(services, svc);
+   if (!l)
+     return dbus_message_new_error(msg, "net.connman.Error.NotFound", "Already removed");
+
+   if (strength_next == l) strength_next = l->next;
+   services = eina_list_remove_list(services, l);
+   mock_property_array_remove(manager_iface, "Services", mock_object_path_get(svc->mo));
+
+   /* the object is still in use while this reply is being sent */
+   services_deleted = eina_list_append(services_deleted, svc);
+   if (!delete_idler)
+     delete_idler = ecore_idler_add(_connman_services_delete, NULL);
+   return dbus_message_new_method_return(msg);
+}
+
+static Eina_Bool
+_connman_strength_update(void *data __UNUSED__)
+{
+   Mock_Connman_Service *svc;
+
+   if (!services) return ECORE_CALLBACK_RENEW;
+   if (!strength_next) strength_next = services;
+
+   svc = eina_list_data_get(strength_next);
+   strength_next = eina_list_next(strength_next);
+   mock_property_byte_set(svc->mi, "Strength", 20 + (rand() % 80));
+   return ECORE_CALLBACK_RENEW;
+}
+
+static Mock_Connman_Service *
+_connman_service_add(E_DBus_Connection *conn, unsigned int index)
+{
+   Mock_Connman_Service *svc;
+   char path[128], name[64];
+
+   svc = calloc(1, sizeof(Mock_Connman_Service));
+   if (!svc) return NULL;
+
+   snprintf(path, sizeof(path), "%s/wifi_%04x_managed_psk", CONNMAN_PROFILE, index);
+   snprintf(name, sizeof(name), "mock-ap-%u", index);
+
+   svc->index = index;
+   svc->mo = mock_object_add(conn, path, svc);
+   if (!svc->mo)
+     {
+        free(svc);
+        return NULL;
+     }
+   svc->mi = mock_iface_add(svc->mo, "net.connman.Service", MOCK_STYLE_PROPERTIES);
+   mock_iface_method_add(svc->mi, "Connect", "", "", _connman_cb_service_connect);
+   mock_iface_method_add(svc->mi, "Disconnect", "", "", _connman_cb_service_disconnect);
+   mock_iface_method_add(svc->mi, "Remove", "", "", _connman_cb_service_remove);
+   mock_iface_method_add(svc->mi, "ClearProperty", "s", "", _connman_cb_empty);
+   mock_iface_method_add(svc->mi, "MoveBefore", "o", "", _connman_cb_empty);
+   mock_iface_method_add(svc->mi, "MoveAfter", "o", "", _connman_cb_empty);
+
+   mock_property_string_set(svc->mi, "Type", "wifi");
+   mock_property_string_set(svc->mi, "State", index ? "idle" : "ready");
+   mock_property_string_set(svc->mi, "Name", name);
+   mock_property_string_set(svc->mi, "Mode", "managed");
+   mock_property_array_append(svc->mi, "Security", 's', "psk");
+   mock_property_byte_set(svc->mi, "Strength", 20 + (index % 80));
+   mock_property_bool_set(svc->mi, "Favorite", index == 0);
+   mock_property_bool_set(svc->mi, "Immutable", EINA_FALSE);
+   mock_property_bool_set(svc->mi, "AutoConnect", index == 0);
+   mock_property_bool_set(svc->mi, "Roaming", EINA_FALSE);
+   mock_property_bool_set(svc->mi, "PassphraseRequired", index != 0);
+   mock_property_bool_set(svc->mi, "LoginRequired", EINA_FALSE);
+   mock_property_array_append(svc->mi, "Nameservers", 's', "192.168.0.1");
+   mock_property_array_append(svc->mi, "Domains", 's', "mock.lan");
+   mock_property_dict_string_set(svc->mi, "IPv4", "Method", "dhcp");
+   mock_property_dict_string_set(svc->mi, "IPv4", "Address", "192.168.0.100");
+   mock_property_dict_string_set(svc->mi, "IPv4", "Netmask", "255.255.255.0");
+   mock_property_dict_string_set(svc->mi, "IPv4", "Gateway", "192.168.0.1");
+   mock_property_dict_string_set(svc->mi, "IPv4.Configuration", "Method", "dhcp");
+   mock_property_dict_string_set(svc->mi, "Ethernet", "Method", "auto");
+   mock_property_dict_string_set(svc->mi, "Ethernet", "Interface", "wlan0");
+   mock_property_dict_string_set(svc->mi, "Ethernet", "Address", "00:11:22:33:44:55");
+   return svc;
+}
+
+static void
+_connman_technology_add(E_DBus_Connection *conn, const char *type, const char *name)
+{
+   Mock_Object *mo;
+   Mock_Iface *mi;
+   char path[64];
+
+   snprintf(path, sizeof(path), "/technology/%s", type);
+   mo = mock_object_add(conn, path, NULL);
+   if (!mo) return;
+
+   mi = mock_iface_add(mo, "net.connman.Technology", MOCK_STYLE_PROPERTIES);
+   mock_property_string_set(mi, "Name", name);
+   mock_property_string_set(mi, "Type", type);
+   mock_property_string_set(mi, "State", "enabled");
+   technologies = eina_list_append(technologies, mo);
+   mock_property_array_append(manager_iface, "Technologies", 'o', path);
+}
+
+Eina_Bool
+mock_connman_start(E_DBus_Connection *conn, const Mock_Config *cfg)
+{
+   Mock_Connman_Service *svc;
+   Mock_Iface *mi;
+   unsigned int i;
+
+   manager = mock_object_add(conn, "/", NULL);
+   if (!manager) return EINA_FALSE;
+
+   manager_iface = mock_iface_add(manager, "net.connman.Manager", MOCK_STYLE_PROPERTIES);
+   mock_iface_method_add(manager_iface, "RegisterAgent", "o", "", _connman_cb_empty);
+   mock_iface_method_add(manager_iface, "UnregisterAgent", "o", "", _connman_cb_empty);
+   mock_iface_method_add(manager_iface, "RequestScan", "s", "", _connman_cb_empty);
+   mock_iface_method_add(manager_iface, "EnableTechnology", "s", "", _connman_cb_technology_toggle);
+   mock_iface_method_add(manager_iface, "DisableTechnology", "s", "", _connman_cb_technology_toggle);
+   mock_iface_method_add(manager_iface, "RemoveProfile", "o", "", _connman_cb_empty);
+
+   mock_property_string_set(manager_iface, "State", "online");
+   mock_property_bool_set(manager_iface, "OfflineMode", EINA_FALSE);
+   mock_property_path_set(manager_iface, "ActiveProfile", CONNMAN_PROFILE);
+   mock_property_array_append(manager_iface, "Profiles", 'o', CONNMAN_PROFILE);
+   mock_property_string_set(manager_iface, "DefaultTechnology", "wifi");
+   mock_property_array_append(manager_iface, "AvailableTechnologies", 's', "wifi");
+   mock_property_array_append(manager_iface, "AvailableTechnologies", 's', "ethernet");
+   mock_property_array_append(manager_iface, "EnabledTechnologies", 's', "wifi");
+   mock_property_array_append(manager_iface, "EnabledTechnologies", 's', "ethernet");
+   mock_property_array_append(manager_iface, "ConnectedTechnologies", 's', "wifi");
+   mock_property_array_append(manager_iface, "Technologies", 'o', NULL);
+   mock_property_array_append(manager_iface, "Services", 'o', NULL);
+
+   profile = mock_object_add(conn, CONNMAN_PROFILE, NULL);
+   if (profile)
+     {
+        mi = mock_iface_add(profile, "net.connman.Profile", MOCK_STYLE_PROPERTIES);
+        mock_property_string_set(mi, "Name", "default");
+        mock_property_bool_set(mi, "OfflineMode", EINA_FALSE);
+     }
+
+   _connman_technology_add(conn, "wifi", "WiFi");
+   _connman_technology_add(conn, "ethernet", "Wired");
+
+   for (i = 0; i < cfg->connman_services; i++)
+     {
+        svc = _connman_service_add(conn, i);
+        if (!svc) break;
+        services = eina_list_append(services, svc);
+        mock_property_array_append(manager_iface, "Services", 'o', mock_object_path_get(svc->mo));
+     }
+
+   if (cfg->connman_strength_interval)
+     strength_timer = ecore_timer_add(cfg->connman_strength_interval / 1000.0,
+                                      _connman_strength_update, NULL);
+   return EINA_TRUE;
+}
+
+void
+mock_connman_stop(void)
+{
+   Mock_Connman_Service *svc;
+   Mock_Object *mo;
+
+   if (strength_timer)
+     {
+        ecore_timer_del(strength_timer);
+        strength_timer = NULL;
+     }
+   if (delete_idler)
+     {
+        ecore_idler_del(delete_idler);
+        _connman_services_delete(NULL);
+     }
+   strength_next = NULL;
+
+   EINA_LIST_FREE(services, svc)
+     {
+        mock_object_del(svc->mo);
+        free(svc);
+     }
+   EINA_LIST_FREE(technologies, mo)
+     mock_object_del(mo);
+   mock_object_del(profile);
+   profile = NULL;
+   mock_object_del(manager);
+   manager = NULL;
+   manager_iface = NULL;
+}
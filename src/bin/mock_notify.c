@@ -0,0 +1,216 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Ecore.h>
+#include "mock_services.h"
+
+/*
+ * org.freedesktop.Notifications: accepts every notification and closes
+ * it when it expires (reason 1), using cfg->notify_timeout when the
+ * client asks for the server default.  A notification with actions is
+ * "clicked" on expiry instead: ActionInvoked with its first action is
+ * emitted and it is closed as dismissed by the user (reason 2).
+ */
+
+#define NOTIFY_PATH  "/org/freedesktop/Notifications"
+#define NOTIFY_IFACE "org.freedesktop.Notifications"
+
+typedef struct _Mock_Notification Mock_Notification;
+
+struct _Mock_Notification
+{
+   dbus_uint32_t id;
+   const char *action;
+   Ecore_Timer *timer;
+};
+
+static const Mock_Config *config = NULL;
+static Mock_Object *notify = NULL;
+static Mock_Iface *notify_iface = NULL;
+static Eina_List *notifications = NULL;
+static dbus_uint32_t next_id = 1;
+
+static void
+_notify_close(Mock_Notification *n, dbus_uint32_t reason)
+{
+   notifications = eina_list_remove(notifications, n);
+   mock_iface_signal_emit(notify_iface, "NotificationClosed",
+                          DBUS_TYPE_UINT32, &n->id, DBUS_TYPE_UINT32, &reason,
+                          DBUS_TYPE_INVALID);
+   if (n->timer) ecore_timer_del(n->timer);
+   eina_stringshare_del(n->action);
+   free(n);
+}
+
+static Mock_Notification *
+_notify_find(dbus_uint32_t id)
+{
+   const Eina_List *l;
+   Mock_Notification *n;
+
+   EINA_LIST_FOREACH(notifications, l, n)
+     if (n->id == id)
+       return n;
+   return NULL;
+}
+
+static Eina_Bool
+_notify_expire(void *data)
+{
+   Mock_Notification *n = data;
+
+   n->timer = NULL;
+   if (n->action)
+     {
+        mock_iface_signal_emit(notify_iface, "ActionInvoked",
+                               DBUS_TYPE_UINT32, &n->id, DBUS_TYPE_STRING, &n->action,
+                               DBUS_TYPE_INVALID);
+        _notify_close(n, 2);
+     }
+   else
+     _notify_close(n, 1);
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static DBusMessage *
+_notify_cb_notify(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   DBusMessageIter iter, array;
+   Mock_Notification *n;
+   const char *s;
+   dbus_uint32_t replaces_id = 0;
+   dbus_int32_t timeout = -1;
+   int arg;
+
+   if (!dbus_message_has_signature(msg, "susssasa{sv}i"))
+     return dbus_message_new_error(msg, DBUS_ERROR_INVALID_ARGS, "Expected (susssasa{sv}i)");
+
+   /* app_name, replaces_id, app_icon, summary, body, actions, hints, timeout */
+   dbus_message_iter_init(msg, &iter);
+   for (arg = 0; arg < 8; arg++, dbus_message_iter_next(&iter))
+     {
+        if (arg == 1)
+          dbus_message_iter_get_basic(&iter, &replaces_id);
+        else if (arg == 5)
+          dbus_message_iter_recurse(&iter, &array);
+        else if (arg == 7)
+          dbus_message_iter_get_basic(&iter, &timeout);
+     }
+
+   n = replaces_id ? _notify_find(replaces_id) : NULL;
+   if (n)
+     {
+        if (n->timer) ecore_timer_del(n->timer);
+        n->timer = NULL;
+        eina_stringshare_replace(&n->action, NULL);
+     }
+   else
+     {
+        n = calloc(1, sizeof(Mock_Notification));
+        if (!n)
+          return dbus_message_new_error(msg, DBUS_ERROR_NO_MEMORY, "");
+        n->id = next_id++;
+        notifications = eina_list_append(notifications, n);
+     }
+
+   /* actions come as (key, label) pairs */
+   if (dbus_message_iter_get_arg_type(&array) == DBUS_TYPE_STRING)
+     {
+        dbus_message_iter_get_basic(&array, &s);
+        n->action = eina_stringshare_add(s);
+     }
+
+   if (timeout < 0) timeout = config->notify_timeout;
+   if (timeout > 0)
+     n->timer = ecore_timer_add(timeout / 1000.0, _notify_expire, n);
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_append_args(reply, DBUS_TYPE_UINT32, &n->id, DBUS_TYPE_INVALID);
+   return reply;
+}
+
+static DBusMessage *
+_notify_cb_close(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   Mock_Notification *n;
+   dbus_uint32_t id = 0;
+
+   if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT32, &id, DBUS_TYPE_INVALID))
+     return dbus_message_new_error(msg, DBUS_ERROR_INVALID_ARGS, "Expected (u)");
+
+   n = _notify_find(id);
+   if (n) _notify_close(n, 3);
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_notify_cb_capabilities(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   DBusMessageIter iter, array;
+   const char *caps[] = { "body", "actions", "icon-static", NULL };
+   int i;
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_iter_init_append(reply, &iter);
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "s", &array);
+   for (i = 0; caps[i]; i++)
+     dbus_message_iter_append_basic(&array, DBUS_TYPE_STRING, &caps[i]);
+   dbus_message_iter_close_container(&iter, &array);
+   return reply;
+}
+
+static DBusMessage *
+_notify_cb_server_information(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   const char *name = "e_dbus_mock_services", *vendor = "Enlightenment";
+   const char *version = PACKAGE_VERSION, *spec = "1.1";
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_append_args(reply, DBUS_TYPE_STRING, &name, DBUS_TYPE_STRING, &vendor,
+                            DBUS_TYPE_STRING, &version, DBUS_TYPE_STRING, &spec,
+                            DBUS_TYPE_INVALID);
+   return reply;
+}
+
+Eina_Bool
+mock_notify_start(E_DBus_Connection *conn, const Mock_Config *cfg)
+{
+   config = cfg;
+
+   notify = mock_object_add(conn, NOTIFY_PATH, NULL);
+   if (!notify) return EINA_FALSE;
+
+   notify_iface = mock_iface_add(notify, NOTIFY_IFACE, MOCK_STYLE_FDO);
+   mock_iface_method_add(notify_iface, "Notify", "susssasa{sv}i", "u", _notify_cb_notify);
+   mock_iface_method_add(notify_iface, "CloseNotification", "u", "", _notify_cb_close);
+   mock_iface_method_add(notify_iface, "GetCapabilities", "", "as", _notify_cb_capabilities);
+   mock_iface_method_add(notify_iface, "GetServerInformation", "", "ssss", _notify_cb_server_information);
+   mock_iface_signal_add(notify_iface, "NotificationClosed", "uu");
+   mock_iface_signal_add(notify_iface, "ActionInvoked", "us");
+   return EINA_TRUE;
+}
+
+void
+mock_notify_stop(void)
+{
+   Mock_Notification *n;
+
+   EINA_LIST_FREE(notifications, n)
+     {
+        if (n->timer) ecore_timer_del(n->timer);
+        eina_stringshare_del(n->action);
+        free(n);
+     }
+   mock_object_del(notify);
+   notify = NULL;
+   notify_iface = NULL;
+   config = NULL;
+}
@@ -0,0 +1,612 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mock_services.h"
+
+#define MOCK_ERROR_UNKNOWN_PROPERTY "org.enlightenment.edbus.Mock.Error.UnknownProperty"
+#define MOCK_ERROR_INVALID_ARGS     "org.enlightenment.edbus.Mock.Error.InvalidArguments"
+
+typedef struct _Mock_Property Mock_Property;
+
+struct _Mock_Object
+{
+   E_DBus_Object *obj;
+   E_DBus_Interface *fdo;      /* org.freedesktop.DBus.Properties, if any */
+   Eina_List *ifaces;
+   void *data;
+};
+
+struct _Mock_Iface
+{
+   Mock_Object *mo;
+   E_DBus_Interface *iface;
+   const char *name;
+   Mock_Style style;
+   Eina_List *properties;
+};
+
+struct _Mock_Property
+{
+   const char *name;
+   int type;                   /* DBUS_TYPE_ARRAY for as/ao, DICT_ENTRY for a{sv} */
+   int item_type;
+   union
+   {
+      dbus_bool_t b;
+      unsigned char y;
+      dbus_uint16_t q;
+      dbus_int32_t i;
+      dbus_uint32_t u;
+      dbus_uint64_t t;
+      double d;
+      const char *s;
+      Eina_List *list;         /* stringshared items, or Mock_Property for dicts */
+   } value;
+};
+
+static void _mock_property_free(Mock_Property *p);
+
+static Mock_Property *
+_mock_property_find(const Eina_List *properties, const char *name)
+{
+   const Eina_List *l;
+   Mock_Property *p;
+
+   EINA_LIST_FOREACH(properties, l, p)
+     if (!strcmp(p->name, name))
+       return p;
+   return NULL;
+}
+
+static void
+_mock_property_value_clear(Mock_Property *p)
+{
+   const char *s;
+   Mock_Property *entry;
+
+   switch (p->type)
+     {
+      case DBUS_TYPE_STRING:
+      case DBUS_TYPE_OBJECT_PATH:
+         eina_stringshare_del(p->value.s);
+         break;
+      case DBUS_TYPE_ARRAY:
+         EINA_LIST_FREE(p->value.list, s)
+           eina_stringshare_del(s);
+         break;
+      case DBUS_TYPE_DICT_ENTRY:
+         EINA_LIST_FREE(p->value.list, entry)
+           _mock_property_free(entry);
+         break;
+     }
+   memset(&p->value, 0, sizeof(p->value));
+}
+
+static void
+_mock_property_free(Mock_Property *p)
+{
+   _mock_property_value_clear(p);
+   eina_stringshare_del(p->name);
+   free(p);
+}
+
+static Mock_Property *
+_mock_property_get(Eina_List **properties, const char *name, int type, int item_type, Eina_Bool *created)
+{
+   Mock_Property *p;
+
+   *created = EINA_FALSE;
+   p = _mock_property_find(*properties, name);
+   if (p)
+     {
+        if ((p->type != type) || (p->item_type != item_type))
+          {
+             _mock_property_value_clear(p);
+             p->type = type;
+             p->item_type = item_type;
+          }
+        return p;
+     }
+
+   p = calloc(1, sizeof(Mock_Property));
+   if (!p) return NULL;
+   p->name = eina_stringshare_add(name);
+   p->type = type;
+   p->item_type = item_type;
+   *properties = eina_list_append(*properties, p);
+   *created = EINA_TRUE;
+   return p;
+}
+
+static void
+_mock_property_variant_append(DBusMessageIter *iter, const Mock_Property *p)
+{
+   DBusMessageIter variant, array, entry;
+   const Eina_List *l;
+   const char *s;
+   const Mock_Property *e;
+   char sig[3];
+
+   switch (p->type)
+     {
+      case DBUS_TYPE_ARRAY:
+         sig[0] = DBUS_TYPE_ARRAY;
+         sig[1] = p->item_type;
+         sig[2] = '\0';
+         dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, sig, &variant);
+         dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, sig + 1, &array);
+         EINA_LIST_FOREACH(p->value.list, l, s)
+           dbus_message_iter_append_basic(&array, p->item_type, &s);
+         dbus_message_iter_close_container(&variant, &array);
+         break;
+      case DBUS_TYPE_DICT_ENTRY:
+         dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, "a{sv}", &variant);
+         dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "{sv}", &array);
+         EINA_LIST_FOREACH(p->value.list, l, e)
+           {
+              dbus_message_iter_open_container(&array, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+              dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &e->name);
+              _mock_property_variant_append(&entry, e);
+              dbus_message_iter_close_container(&array, &entry);
+           }
+         dbus_message_iter_close_container(&variant, &array);
+         break;
+      default:
+         sig[0] = p->type;
+         sig[1] = '\0';
+         dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, sig, &variant);
+         dbus_message_iter_append_basic(&variant, p->type, &p->value);
+         break;
+     }
+   dbus_message_iter_close_container(iter, &variant);
+}
+
+static void
+_mock_properties_dict_append(DBusMessageIter *iter, const Eina_List *properties)
+{
+   DBusMessageIter array, entry;
+   const Eina_List *l;
+   const Mock_Property *p;
+
+   dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{sv}", &array);
+   EINA_LIST_FOREACH(properties, l, p)
+     {
+        dbus_message_iter_open_container(&array, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+        dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &p->name);
+        _mock_property_variant_append(&entry, p);
+        dbus_message_iter_close_container(&array, &entry);
+     }
+   dbus_message_iter_close_container(iter, &array);
+}
+
+static void
+_mock_property_changed(Mock_Iface *mi, const Mock_Property *p)
+{
+   DBusMessage *msg;
+   DBusMessageIter iter;
+
+   if (mi->style != MOCK_STYLE_PROPERTIES) return;
+
+   msg = dbus_message_new_signal(mock_object_path_get(mi->mo), mi->name, "PropertyChanged");
+   if (!msg) return;
+   dbus_message_iter_init_append(msg, &iter);
+   dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &p->name);
+   _mock_property_variant_append(&iter, p);
+   e_dbus_signal_send(e_dbus_object_conn_get(mi->mo->obj), msg);
+   dbus_message_unref(msg);
+}
+
+/* method handlers *********************************************************/
+
+static Mock_Iface *
+_mock_iface_from_message(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Object *mo = mock_object_get(obj);
+
+   if (!mo) return NULL;
+   return mock_iface_get(mo, dbus_message_get_interface(msg));
+}
+
+static Mock_Iface *
+_mock_iface_fdo_get(Mock_Object *mo, const char *name)
+{
+   const Eina_List *l;
+   Mock_Iface *mi, *first = NULL;
+
+   /* clients are sloppy about the interface argument, fall back to the
+    * only property carrying interface of the object */
+   EINA_LIST_FOREACH(mo->ifaces, l, mi)
+     {
+        if (mi->style != MOCK_STYLE_FDO) continue;
+        if ((name) && (!strcmp(mi->name, name))) return mi;
+        if (!first) first = mi;
+     }
+   return first;
+}
+
+static DBusMessage *
+_mock_cb_get_properties(E_DBus_Object *obj, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   DBusMessageIter iter;
+   Mock_Iface *mi;
+
+   mi = _mock_iface_from_message(obj, msg);
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_iter_init_append(reply, &iter);
+   _mock_properties_dict_append(&iter, mi ? mi->properties : NULL);
+   return reply;
+}
+
+static DBusMessage *
+_mock_cb_set_property(E_DBus_Object *obj, DBusMessage *msg)
+{
+   DBusMessageIter iter, variant;
+   Mock_Iface *mi;
+   Mock_Property *p;
+   const char *name;
+   int type;
+
+   mi = _mock_iface_from_message(obj, msg);
+   if ((!mi) || (!dbus_message_iter_init(msg, &iter)) ||
+       (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_STRING))
+     return dbus_message_new_error(msg, MOCK_ERROR_INVALID_ARGS, "Expected (sv)");
+
+   dbus_message_iter_get_basic(&iter, &name);
+   dbus_message_iter_next(&iter);
+   if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_VARIANT)
+     return dbus_message_new_error(msg, MOCK_ERROR_INVALID_ARGS, "Expected (sv)");
+
+   p = _mock_property_find(mi->properties, name);
+   if (!p)
+     return dbus_message_new_error_printf(msg, MOCK_ERROR_UNKNOWN_PROPERTY,
+                                          "No property '%s' on %s", name, mi->name);
+
+   dbus_message_iter_recurse(&iter, &variant);
+   type = dbus_message_iter_get_arg_type(&variant);
+   if ((type != p->type) || (!dbus_type_is_basic(type)))
+     return dbus_message_new_error_printf(msg, MOCK_ERROR_INVALID_ARGS,
+                                          "Property '%s' has type '%c'", name, p->type);
+
+   if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+     {
+        const char *s;
+
+        dbus_message_iter_get_basic(&variant, &s);
+        eina_stringshare_replace(&p->value.s, s);
+     }
+   else
+     dbus_message_iter_get_basic(&variant, &p->value);
+
+   _mock_property_changed(mi, p);
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_mock_cb_fdo_get(E_DBus_Object *obj, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   DBusMessageIter iter;
+   Mock_Object *mo = mock_object_get(obj);
+   Mock_Iface *mi;
+   Mock_Property *p;
+   const char *iface = NULL, *name = NULL;
+
+   if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &iface,
+                              DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID))
+     return dbus_message_new_error(msg, MOCK_ERROR_INVALID_ARGS, "Expected (ss)");
+
+   mi = _mock_iface_fdo_get(mo, iface);
+   p = mi ? _mock_property_find(mi->properties, name) : NULL;
+   if (!p)
+     return dbus_message_new_error_printf(msg, MOCK_ERROR_UNKNOWN_PROPERTY,
+                                          "No property '%s' on %s", name, iface);
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_iter_init_append(reply, &iter);
+   _mock_property_variant_append(&iter, p);
+   return reply;
+}
+
+static DBusMessage *
+_mock_cb_fdo_get_all(E_DBus_Object *obj, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   DBusMessageIter iter;
+   Mock_Iface *mi;
+   const char *iface = NULL;
+
+   dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &iface, DBUS_TYPE_INVALID);
+   mi = _mock_iface_fdo_get(mock_object_get(obj), iface);
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_iter_init_append(reply, &iter);
+   _mock_properties_dict_append(&iter, mi ? mi->properties : NULL);
+   return reply;
+}
+
+/* objects *****************************************************************/
+
+Mock_Object *
+mock_object_add(E_DBus_Connection *conn, const char *path, void *data)
+{
+   Mock_Object *mo;
+
+   mo = calloc(1, sizeof(Mock_Object));
+   if (!mo) return NULL;
+
+   mo->obj = e_dbus_object_add(conn, path, mo);
+   if (!mo->obj)
+     {
+        fprintf(stderr, "ERROR: mock: could not export %s\n", path);
+        free(mo);
+        return NULL;
+     }
+   mo->data = data;
+   return mo;
+}
+
+void
+mock_object_del(Mock_Object *mo)
+{
+   Mock_Iface *mi;
+   Mock_Property *p;
+
+   if (!mo) return;
+
+   EINA_LIST_FREE(mo->ifaces, mi)
+     {
+        EINA_LIST_FREE(mi->properties, p)
+          _mock_property_free(p);
+        e_dbus_object_interface_detach(mo->obj, mi->iface);
+        e_dbus_interface_unref(mi->iface);
+        eina_stringshare_del(mi->name);
+        free(mi);
+     }
+   if (mo->fdo)
+     {
+        e_dbus_object_interface_detach(mo->obj, mo->fdo);
+        e_dbus_interface_unref(mo->fdo);
+     }
+   e_dbus_object_free(mo->obj);
+   free(mo);
+}
+
+Mock_Object *
+mock_object_get(E_DBus_Object *obj)
+{
+   if (!obj) return NULL;
+   return e_dbus_object_data_get(obj);
+}
+
+const char *
+mock_object_path_get(const Mock_Object *mo)
+{
+   return e_dbus_object_path_get(mo->obj);
+}
+
+void *
+mock_object_data_get(const Mock_Object *mo)
+{
+   return mo->data;
+}
+
+/* interfaces **************************************************************/
+
+Mock_Iface *
+mock_iface_add(Mock_Object *mo, const char *name, Mock_Style style)
+{
+   Mock_Iface *mi;
+
+   mi = calloc(1, sizeof(Mock_Iface));
+   if (!mi) return NULL;
+
+   mi->iface = e_dbus_interface_new(name);
+   if (!mi->iface)
+     {
+        free(mi);
+        return NULL;
+     }
+   mi->mo = mo;
+   mi->name = eina_stringshare_add(name);
+   mi->style = style;
+
+   if (style == MOCK_STYLE_PROPERTIES)
+     {
+        e_dbus_interface_method_add(mi->iface, "GetProperties", "", "a{sv}",
+                                    _mock_cb_get_properties);
+        e_dbus_interface_method_add(mi->iface, "SetProperty", "sv", "",
+                                    _mock_cb_set_property);
+        e_dbus_interface_signal_add(mi->iface, "PropertyChanged", "sv");
+     }
+   else if (!mo->fdo)
+     {
+        mo->fdo = e_dbus_interface_new(E_DBUS_FDO_INTERFACE_PROPERTIES);
+        if (mo->fdo)
+          {
+             e_dbus_interface_method_add(mo->fdo, "Get", "ss", "v", _mock_cb_fdo_get);
+             e_dbus_interface_method_add(mo->fdo, "GetAll", "s", "a{sv}", _mock_cb_fdo_get_all);
+             e_dbus_object_interface_attach(mo->obj, mo->fdo);
+          }
+     }
+
+   e_dbus_object_interface_attach(mo->obj, mi->iface);
+   mo->ifaces = eina_list_append(mo->ifaces, mi);
+   return mi;
+}
+
+Mock_Iface *
+mock_iface_get(const Mock_Object *mo, const char *name)
+{
+   const Eina_List *l;
+   Mock_Iface *mi;
+
+   if (!name) return NULL;
+   EINA_LIST_FOREACH(mo->ifaces, l, mi)
+     if (!strcmp(mi->name, name))
+       return mi;
+   return NULL;
+}
+
+void
+mock_iface_method_add(Mock_Iface *mi, const char *member, const char *signature, const char *reply_signature, E_DBus_Method_Cb func)
+{
+   e_dbus_interface_method_add(mi->iface, member, signature, reply_signature, func);
+}
+
+void
+mock_iface_signal_add(Mock_Iface *mi, const char *name, const char *signature)
+{
+   e_dbus_interface_signal_add(mi->iface, name, signature);
+}
+
+void
+mock_iface_signal_emit(Mock_Iface *mi, const char *member, int first_type, ...)
+{
+   DBusMessage *msg;
+   va_list ap;
+
+   msg = dbus_message_new_signal(mock_object_path_get(mi->mo), mi->name, member);
+   if (!msg) return;
+
+   va_start(ap, first_type);
+   if (dbus_message_append_args_valist(msg, first_type, ap))
+     e_dbus_signal_send(e_dbus_object_conn_get(mi->mo->obj), msg);
+   va_end(ap);
+   dbus_message_unref(msg);
+}
+
+/* properties **************************************************************/
+
+#define MOCK_PROPERTY_BASIC_SET(_mi, _name, _type, _field, _value)         \
+  do                                                                      \
+    {                                                                     \
+       Mock_Property *_p;                                                 \
+       Eina_Bool _created;                                                \
+       _p = _mock_property_get(&(_mi)->properties, _name, _type, 0,      \
+                               &_created);                                \
+       if (!_p) return;                                                   \
+       if ((!_created) && (_p->value._field == (_value))) return;         \
+       _p->value._field = (_value);                                       \
+       if (!_created) _mock_property_changed(_mi, _p);                    \
+    }                                                                     \
+  while (0)
+
+void
+mock_property_bool_set(Mock_Iface *mi, const char *name, Eina_Bool value)
+{
+   MOCK_PROPERTY_BASIC_SET(mi, name, DBUS_TYPE_BOOLEAN, b, !!value);
+}
+
+void
+mock_property_byte_set(Mock_Iface *mi, const char *name, unsigned char value)
+{
+   MOCK_PROPERTY_BASIC_SET(mi, name, DBUS_TYPE_BYTE, y, value);
+}
+
+void
+mock_property_uint16_set(Mock_Iface *mi, const char *name, unsigned short value)
+{
+   MOCK_PROPERTY_BASIC_SET(mi, name, DBUS_TYPE_UINT16, q, value);
+}
+
+void
+mock_property_int32_set(Mock_Iface *mi, const char *name, int value)
+{
+   MOCK_PROPERTY_BASIC_SET(mi, name, DBUS_TYPE_INT32, i, value);
+}
+
+void
+mock_property_uint32_set(Mock_Iface *mi, const char *name, unsigned int value)
+{
+   MOCK_PROPERTY_BASIC_SET(mi, name, DBUS_TYPE_UINT32, u, value);
+}
+
+void
+mock_property_uint64_set(Mock_Iface *mi, const char *name, unsigned long long value)
+{
+   MOCK_PROPERTY_BASIC_SET(mi, name, DBUS_TYPE_UINT64, t, value);
+}
+
+void
+mock_property_double_set(Mock_Iface *mi, const char *name, double value)
+{
+   MOCK_PROPERTY_BASIC_SET(mi, name, DBUS_TYPE_DOUBLE, d, value);
+}
+
+static void
+_mock_property_str_set(Mock_Iface *mi, const char *name, int type, const char *value)
+{
+   Mock_Property *p;
+   Eina_Bool created;
+
+   p = _mock_property_get(&mi->properties, name, type, 0, &created);
+   if (!p) return;
+   if ((eina_stringshare_replace(&p->value.s, value)) && (!created))
+     _mock_property_changed(mi, p);
+}
+
+void
+mock_property_string_set(Mock_Iface *mi, const char *name, const char *value)
+{
+   _mock_property_str_set(mi, name, DBUS_TYPE_STRING, value ? value : "");
+}
+
+void
+mock_property_path_set(Mock_Iface *mi, const char *name, const char *value)
+{
+   _mock_property_str_set(mi, name, DBUS_TYPE_OBJECT_PATH, value ? value : "/");
+}
+
+void
+mock_property_array_append(Mock_Iface *mi, const char *name, int type, const char *item)
+{
+   Mock_Property *p;
+   Eina_Bool created;
+
+   p = _mock_property_get(&mi->properties, name, DBUS_TYPE_ARRAY, type, &created);
+   if (!p) return;
+   if (!item) return;
+   p->value.list = eina_list_append(p->value.list, eina_stringshare_add(item));
+   if (!created) _mock_property_changed(mi, p);
+}
+
+void
+mock_property_array_remove(Mock_Iface *mi, const char *name, const char *item)
+{
+   Mock_Property *p;
+   Eina_List *l;
+   const char *s;
+
+   p = _mock_property_find(mi->properties, name);
+   if ((!p) || (p->type != DBUS_TYPE_ARRAY)) return;
+
+   EINA_LIST_FOREACH(p->value.list, l, s)
+     if (!strcmp(s, item))
+       {
+          p->value.list = eina_list_remove_list(p->value.list, l);
+          eina_stringshare_del(s);
+          _mock_property_changed(mi, p);
+          return;
+       }
+}
+
+void
+mock_property_dict_string_set(Mock_Iface *mi, const char *name, const char *key, const char *value)
+{
+   Mock_Property *p, *e;
+   Eina_Bool created, entry_created;
+
+   p = _mock_property_get(&mi->properties, name, DBUS_TYPE_DICT_ENTRY, 0, &created);
+   if (!p) return;
+   e = _mock_property_get(&p->value.list, key, DBUS_TYPE_STRING, 0, &entry_created);
+   if (!e) return;
+   if ((eina_stringshare_replace(&e->value.s, value ? value : "")) && (!created))
+     _mock_property_changed(mi, p);
+}
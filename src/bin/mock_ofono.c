@@ -0,0 +1,149 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Ecore.h>
+#include "mock_services.h"
+
+/*
+ * org.ofono: a Manager at "/" listing cfg->ofono_modems modems, each one
+ * carrying the Modem, NetworkRegistration and SmsManager interfaces.
+ * Every ofono_strength_interval ms the next modem (round robin) reports
+ * a new network Strength.
+ */
+
+typedef struct _Mock_Ofono_Modem Mock_Ofono_Modem;
+
+struct _Mock_Ofono_Modem
+{
+   Mock_Object *mo;
+   Mock_Iface *modem;
+   Mock_Iface *netreg;
+   Mock_Iface *sms;
+   unsigned int sent;
+};
+
+static Mock_Object *manager = NULL;
+static Eina_List *modems = NULL;
+static Eina_List *strength_next = NULL;
+static Ecore_Timer *strength_timer = NULL;
+
+static DBusMessage *
+_ofono_cb_send_message(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Ofono_Modem *m = mock_object_data_get(mock_object_get(obj));
+   const char *number = NULL, *text = NULL;
+
+   if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &number,
+                              DBUS_TYPE_STRING, &text, DBUS_TYPE_INVALID))
+     return dbus_message_new_error(msg, "org.ofono.Error.InvalidArguments", "Expected (ss)");
+   if (!number[0])
+     return dbus_message_new_error(msg, "org.ofono.Error.InvalidFormat", "Empty number");
+
+   m->sent++;
+   return dbus_message_new_method_return(msg);
+}
+
+static Eina_Bool
+_ofono_strength_update(void *data __UNUSED__)
+{
+   Mock_Ofono_Modem *m;
+
+   if (!modems) return ECORE_CALLBACK_RENEW;
+   if (!strength_next) strength_next = modems;
+
+   m = eina_list_data_get(strength_next);
+   strength_next = eina_list_next(strength_next);
+   mock_property_byte_set(m->netreg, "Strength", rand() % 101);
+   return ECORE_CALLBACK_RENEW;
+}
+
+static Mock_Ofono_Modem *
+_ofono_modem_add(E_DBus_Connection *conn, unsigned int index)
+{
+   Mock_Ofono_Modem *m;
+   char path[64], name[64];
+
+   m = calloc(1, sizeof(Mock_Ofono_Modem));
+   if (!m) return NULL;
+
+   snprintf(path, sizeof(path), "/mock%u", index);
+   snprintf(name, sizeof(name), "Mock Modem %u", index);
+
+   m->mo = mock_object_add(conn, path, m);
+   if (!m->mo)
+     {
+        free(m);
+        return NULL;
+     }
+
+   m->modem = mock_iface_add(m->mo, "org.ofono.Modem", MOCK_STYLE_PROPERTIES);
+   mock_property_bool_set(m->modem, "Powered", EINA_TRUE);
+   mock_property_bool_set(m->modem, "Online", EINA_TRUE);
+   mock_property_string_set(m->modem, "Name", name);
+   mock_property_array_append(m->modem, "Interfaces", 's', "org.ofono.NetworkRegistration");
+   mock_property_array_append(m->modem, "Interfaces", 's', "org.ofono.SmsManager");
+
+   m->netreg = mock_iface_add(m->mo, "org.ofono.NetworkRegistration", MOCK_STYLE_PROPERTIES);
+   mock_property_string_set(m->netreg, "Mode", "auto");
+   mock_property_string_set(m->netreg, "Status", "registered");
+   mock_property_string_set(m->netreg, "Operator", "Mock Telecom");
+   mock_property_byte_set(m->netreg, "Strength", 50 + (index % 50));
+
+   m->sms = mock_iface_add(m->mo, "org.ofono.SmsManager", MOCK_STYLE_PROPERTIES);
+   mock_iface_method_add(m->sms, "SendMessage", "ss", "", _ofono_cb_send_message);
+   mock_property_string_set(m->sms, "ServiceCenterAddress", "+15550100");
+   return m;
+}
+
+Eina_Bool
+mock_ofono_start(E_DBus_Connection *conn, const Mock_Config *cfg)
+{
+   Mock_Ofono_Modem *m;
+   Mock_Iface *mi;
+   unsigned int i;
+
+   manager = mock_object_add(conn, "/", NULL);
+   if (!manager) return EINA_FALSE;
+
+   mi = mock_iface_add(manager, "org.ofono.Manager", MOCK_STYLE_PROPERTIES);
+   mock_property_array_append(mi, "Modems", 'o', NULL);
+
+   for (i = 0; i < cfg->ofono_modems; i++)
+     {
+        m = _ofono_modem_add(conn, i);
+        if (!m) break;
+        modems = eina_list_append(modems, m);
+        mock_property_array_append(mi, "Modems", 'o', mock_object_path_get(m->mo));
+     }
+
+   if (cfg->ofono_strength_interval)
+     strength_timer = ecore_timer_add(cfg->ofono_strength_interval / 1000.0,
+                                      _ofono_strength_update, NULL);
+   return EINA_TRUE;
+}
+
+void
+mock_ofono_stop(void)
+{
+   Mock_Ofono_Modem *m;
+
+   if (strength_timer)
+     {
+        ecore_timer_del(strength_timer);
+        strength_timer = NULL;
+     }
+   strength_next = NULL;
+
+   EINA_LIST_FREE(modems, m)
+     {
+        mock_object_del(m->mo);
+        free(m);
+     }
+   mock_object_del(manager);
+   manager = NULL;
+}
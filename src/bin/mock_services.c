@@ -0,0 +1,340 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <Ecore.h>
+#include "E_DBus.h"
+#include "bench_common.h"
+#include "mock_services.h"
+
+/*
+ * Runs mock connman, ofono, bluez, udisks, upower and notification
+ * services on a private bus so the e_dbus client libraries can be tested
+ * and benchmarked without the real daemons.
+ *
+ * One dbus-daemon is started and used as both the system and the session
+ * bus.  Each service gets its own connection, as several of them export
+ * an object at "/", and owns its well known name once all its objects
+ * are in place.  When every name is owned either the bus addresses are
+ * printed as sh assignments and the services keep running until
+ * interrupted, or the command given after "--" is run with them in its
+ * environment and the mock exits with its status:
+ *
+ *   e_dbus_mock_services --connman-services 300 -- e_dbus_connman0_7x_test
+ */
+
+typedef struct _Mock_Service Mock_Service;
+
+struct _Mock_Service
+{
+   const char *name;
+   const char *bus_name;
+   DBusBusType type;
+   Eina_Bool (*start)(E_DBus_Connection *conn, const Mock_Config *cfg);
+   void (*stop)(void);
+   Eina_Bool enabled;
+   Eina_Bool owned;
+   E_DBus_Connection *conn;
+};
+
+static Mock_Service services[] = {
+   { "connman", "net.connman", DBUS_BUS_SYSTEM, mock_connman_start, mock_connman_stop, EINA_TRUE, EINA_FALSE, NULL },
+   { "ofono", "org.ofono", DBUS_BUS_SYSTEM, mock_ofono_start, mock_ofono_stop, EINA_TRUE, EINA_FALSE, NULL },
+   { "bluez", "org.bluez", DBUS_BUS_SYSTEM, mock_bluez_start, mock_bluez_stop, EINA_TRUE, EINA_FALSE, NULL },
+   { "udisks", "org.freedesktop.UDisks", DBUS_BUS_SYSTEM, mock_udisks_start, mock_udisks_stop, EINA_TRUE, EINA_FALSE, NULL },
+   { "upower", "org.freedesktop.UPower", DBUS_BUS_SYSTEM, mock_upower_start, mock_upower_stop, EINA_TRUE, EINA_FALSE, NULL },
+   { "notify", "org.freedesktop.Notifications", DBUS_BUS_SESSION, mock_notify_start, mock_notify_stop, EINA_TRUE, EINA_FALSE, NULL },
+   { NULL, NULL, 0, NULL, NULL, EINA_FALSE, EINA_FALSE, NULL }
+};
+
+static Mock_Config config = {
+   10,     /* connman_services */
+   0,      /* connman_strength_interval */
+   1,      /* ofono_modems */
+   0,      /* ofono_strength_interval */
+   2,      /* bluez_paired */
+   10,     /* bluez_found */
+   100,    /* bluez_found_interval */
+   4,      /* udisks_devices */
+   1,      /* upower_devices */
+   0,      /* upower_interval */
+   5000    /* notify_timeout */
+};
+
+static char **command = NULL;
+static pid_t command_pid = 0;
+static int exit_code = 0;
+static unsigned int pending_names = 0;
+
+static Eina_Bool
+_mock_command_check(void *data __UNUSED__)
+{
+   int status;
+   pid_t r;
+
+   r = waitpid(command_pid, &status, WNOHANG);
+   if (r == 0) return ECORE_CALLBACK_RENEW;
+   if (r < 0)
+     exit_code = 1;
+   else if (WIFEXITED(status))
+     exit_code = WEXITSTATUS(status);
+   else
+     exit_code = 128 + WTERMSIG(status);
+
+   command_pid = 0;
+   ecore_main_loop_quit();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+_mock_ready(void)
+{
+   const char *session = getenv("DBUS_SESSION_BUS_ADDRESS");
+
+   if (!command)
+     {
+        printf("DBUS_SESSION_BUS_ADDRESS='%s'; export DBUS_SESSION_BUS_ADDRESS;\n"
+               "DBUS_SYSTEM_BUS_ADDRESS='%s'; export DBUS_SYSTEM_BUS_ADDRESS;\n",
+               session, session);
+        fflush(stdout);
+        return;
+     }
+
+   command_pid = fork();
+   if (command_pid < 0)
+     {
+        fprintf(stderr, "ERROR: fork: %s\n", strerror(errno));
+        exit_code = 1;
+        ecore_main_loop_quit();
+        return;
+     }
+   if (command_pid == 0)
+     {
+        execvp(command[0], command);
+        fprintf(stderr, "ERROR: %s: %s\n", command[0], strerror(errno));
+        _exit(127);
+     }
+   ecore_timer_add(0.1, _mock_command_check, NULL);
+}
+
+static void
+_mock_cb_request_name(void *data, DBusMessage *msg, DBusError *err)
+{
+   Mock_Service *svc = data;
+   dbus_uint32_t ret = 0;
+
+   if (dbus_error_is_set(err))
+     {
+        fprintf(stderr, "ERROR: %s: %s: %s\n", svc->name, err->name, err->message);
+        exit_code = 1;
+        ecore_main_loop_quit();
+        return;
+     }
+   dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT32, &ret, DBUS_TYPE_INVALID);
+   if (ret != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER)
+     {
+        fprintf(stderr, "ERROR: %s: could not own %s\n", svc->name, svc->bus_name);
+        exit_code = 1;
+        ecore_main_loop_quit();
+        return;
+     }
+
+   svc->owned = EINA_TRUE;
+   if (--pending_names == 0)
+     _mock_ready();
+}
+
+static E_DBus_Connection *
+_mock_connection_get(DBusBusType type)
+{
+   E_DBus_Connection *econn;
+   DBusConnection *conn;
+   DBusError err;
+
+   dbus_error_init(&err);
+   conn = dbus_bus_get_private(type, &err);
+   if (dbus_error_is_set(&err))
+     {
+        fprintf(stderr, "ERROR: could not connect to the bus: %s\n", err.message);
+        dbus_error_free(&err);
+        return NULL;
+     }
+
+   econn = e_dbus_connection_setup(conn);
+   if (!econn)
+     {
+        dbus_connection_close(conn);
+        dbus_connection_unref(conn);
+     }
+   return econn;
+}
+
+static Eina_Bool
+_mock_services_select(const char *list)
+{
+   Mock_Service *svc;
+   char *buf, *tok, *save = NULL;
+   Eina_Bool ret = EINA_TRUE;
+
+   for (svc = services; svc->name; svc++)
+     svc->enabled = EINA_FALSE;
+
+   buf = strdup(list);
+   if (!buf) return EINA_FALSE;
+   for (tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save))
+     {
+        for (svc = services; svc->name; svc++)
+          if (!strcmp(svc->name, tok))
+            break;
+        if (!svc->name)
+          {
+             fprintf(stderr, "ERROR: unknown service '%s'\n", tok);
+             ret = EINA_FALSE;
+          }
+        else
+          svc->enabled = EINA_TRUE;
+     }
+   free(buf);
+   return ret;
+}
+
+static Eina_Bool
+_mock_cb_signal_exit(void *data __UNUSED__, int type __UNUSED__, void *event __UNUSED__)
+{
+   ecore_main_loop_quit();
+   return ECORE_CALLBACK_DONE;
+}
+
+static void
+_usage(const char *prog)
+{
+   Mock_Service *svc;
+
+   printf("Usage: %s [options] [-- command [args]]\n"
+          "\n"
+          "Options:\n"
+          "  --services=LIST                   comma separated, default all of:\n"
+          "                                   ", prog);
+   for (svc = services; svc->name; svc++)
+     printf(" %s", svc->name);
+   printf("\n"
+          "  --connman-services=N              wifi services (%u)\n"
+          "  --connman-strength-interval=MS    Strength change period, 0 off (%u)\n"
+          "  --ofono-modems=N                  modems (%u)\n"
+          "  --ofono-strength-interval=MS      Strength change period, 0 off (%u)\n"
+          "  --bluez-paired=N                  paired devices (%u)\n"
+          "  --bluez-found=N                   devices seen while discovering (%u)\n"
+          "  --bluez-found-interval=MS         DeviceFound period (%u)\n"
+          "  --udisks-devices=N                removable partitions (%u)\n"
+          "  --upower-devices=N                batteries (%u)\n"
+          "  --upower-interval=MS              Percentage change period, 0 off (%u)\n"
+          "  --notify-timeout=MS               default expiry (%u)\n"
+          "  -h, --help\n",
+          config.connman_services, config.connman_strength_interval,
+          config.ofono_modems, config.ofono_strength_interval,
+          config.bluez_paired, config.bluez_found, config.bluez_found_interval,
+          config.udisks_devices, config.upower_devices, config.upower_interval,
+          config.notify_timeout);
+}
+
+int
+main(int argc, char *argv[])
+{
+   static struct option longopts[] = {
+      { "services",                  required_argument, NULL, 'S' },
+      { "connman-services",          required_argument, NULL, 'c' },
+      { "connman-strength-interval", required_argument, NULL, 'C' },
+      { "ofono-modems",              required_argument, NULL, 'o' },
+      { "ofono-strength-interval",   required_argument, NULL, 'O' },
+      { "bluez-paired",              required_argument, NULL, 'b' },
+      { "bluez-found",               required_argument, NULL, 'f' },
+      { "bluez-found-interval",      required_argument, NULL, 'F' },
+      { "udisks-devices",            required_argument, NULL, 'd' },
+      { "upower-devices",            required_argument, NULL, 'p' },
+      { "upower-interval",           required_argument, NULL, 'P' },
+      { "notify-timeout",            required_argument, NULL, 't' },
+      { "help",                      no_argument,       NULL, 'h' },
+      { NULL,                        0,                 NULL, 0 }
+   };
+   Bench_Daemon daemon;
+   Mock_Service *svc;
+   int opt;
+
+   while ((opt = getopt_long(argc, argv, "h", longopts, NULL)) != -1)
+     {
+        switch (opt)
+          {
+           case 'S':
+              if (!_mock_services_select(optarg)) return 1;
+              break;
+           case 'c': config.connman_services = strtoul(optarg, NULL, 10); break;
+           case 'C': config.connman_strength_interval = strtoul(optarg, NULL, 10); break;
+           case 'o': config.ofono_modems = strtoul(optarg, NULL, 10); break;
+           case 'O': config.ofono_strength_interval = strtoul(optarg, NULL, 10); break;
+           case 'b': config.bluez_paired = strtoul(optarg, NULL, 10); break;
+           case 'f': config.bluez_found = strtoul(optarg, NULL, 10); break;
+           case 'F': config.bluez_found_interval = strtoul(optarg, NULL, 10); break;
+           case 'd': config.udisks_devices = strtoul(optarg, NULL, 10); break;
+           case 'p': config.upower_devices = strtoul(optarg, NULL, 10); break;
+           case 'P': config.upower_interval = strtoul(optarg, NULL, 10); break;
+           case 't': config.notify_timeout = strtoul(optarg, NULL, 10); break;
+           default:
+              _usage(argv[0]);
+              return opt == 'h' ? 0 : 1;
+          }
+     }
+   if (optind < argc)
+     command = argv + optind;
+
+   if (!bench_daemon_start(&daemon))
+     return 1;
+   setenv("DBUS_SYSTEM_BUS_ADDRESS", daemon.address, 1);
+
+   e_dbus_init();
+   ecore_event_handler_add(ECORE_EVENT_SIGNAL_EXIT, _mock_cb_signal_exit, NULL);
+
+   for (svc = services; svc->name; svc++)
+     {
+        if (!svc->enabled) continue;
+
+        svc->conn = _mock_connection_get(svc->type);
+        if ((!svc->conn) || (!svc->start(svc->conn, &config)))
+          {
+             fprintf(stderr, "ERROR: %s: could not start\n", svc->name);
+             exit_code = 1;
+             goto end;
+          }
+        pending_names++;
+        e_dbus_request_name(svc->conn, svc->bus_name, DBUS_NAME_FLAG_DO_NOT_QUEUE,
+                            _mock_cb_request_name, svc);
+     }
+
+   if (!pending_names) _mock_ready();
+   ecore_main_loop_begin();
+
+ end:
+   if (command_pid > 0)
+     {
+        kill(command_pid, SIGTERM);
+        waitpid(command_pid, NULL, 0);
+     }
+   for (svc = services; svc->name; svc++)
+     {
+        if (!svc->conn) continue;
+        svc->stop();
+        e_dbus_connection_close(svc->conn);
+        svc->conn = NULL;
+     }
+   e_dbus_shutdown();
+   bench_daemon_stop(&daemon);
+   return exit_code;
+}
@@ -0,0 +1,89 @@
+#ifndef MOCK_SERVICES_H
+#define MOCK_SERVICES_H
+
+#include <Eina.h>
+#include "E_DBus.h"
+
+/*
+ * Mock system services for tests and benchmarks, exported with
+ * e_dbus_object_add() on a private bus.
+ *
+ * A Mock_Object is one object path; it carries any number of Mock_Iface
+ * holding properties.  How the properties are exposed depends on the
+ * interface style:
+ *
+ *  - MOCK_STYLE_PROPERTIES: GetProperties() -> a{sv}, SetProperty(sv) and
+ *    the PropertyChanged(sv) signal, as used by connman, ofono and bluez.
+ *  - MOCK_STYLE_FDO: org.freedesktop.DBus.Properties Get()/GetAll() on the
+ *    object, as used by udisks and upower.
+ */
+
+typedef enum _Mock_Style
+{
+   MOCK_STYLE_PROPERTIES,
+   MOCK_STYLE_FDO
+} Mock_Style;
+
+typedef struct _Mock_Object Mock_Object;
+typedef struct _Mock_Iface  Mock_Iface;
+typedef struct _Mock_Config Mock_Config;
+
+/* scriptable state, set from the command line */
+struct _Mock_Config
+{
+   unsigned int connman_services;
+   unsigned int connman_strength_interval; /* ms, 0 disables */
+   unsigned int ofono_modems;
+   unsigned int ofono_strength_interval;
+   unsigned int bluez_paired;
+   unsigned int bluez_found;               /* devices reported per discovery */
+   unsigned int bluez_found_interval;
+   unsigned int udisks_devices;
+   unsigned int upower_devices;
+   unsigned int upower_interval;
+   unsigned int notify_timeout;            /* default expiry, ms */
+};
+
+Mock_Object *mock_object_add(E_DBus_Connection *conn, const char *path, void *data);
+void         mock_object_del(Mock_Object *mo);
+Mock_Object *mock_object_get(E_DBus_Object *obj);
+const char  *mock_object_path_get(const Mock_Object *mo);
+void        *mock_object_data_get(const Mock_Object *mo);
+
+Mock_Iface  *mock_iface_add(Mock_Object *mo, const char *name, Mock_Style style);
+Mock_Iface  *mock_iface_get(const Mock_Object *mo, const char *name);
+void         mock_iface_method_add(Mock_Iface *mi, const char *member, const char *signature, const char *reply_signature, E_DBus_Method_Cb func);
+void         mock_iface_signal_add(Mock_Iface *mi, const char *name, const char *signature);
+void         mock_iface_signal_emit(Mock_Iface *mi, const char *member, int first_type, ...);
+
+/* Setting a value that differs from the current one emits PropertyChanged
+ * on MOCK_STYLE_PROPERTIES interfaces. */
+void         mock_property_bool_set(Mock_Iface *mi, const char *name, Eina_Bool value);
+void         mock_property_byte_set(Mock_Iface *mi, const char *name, unsigned char value);
+void         mock_property_uint16_set(Mock_Iface *mi, const char *name, unsigned short value);
+void         mock_property_int32_set(Mock_Iface *mi, const char *name, int value);
+void         mock_property_uint32_set(Mock_Iface *mi, const char *name, unsigned int value);
+void         mock_property_uint64_set(Mock_Iface *mi, const char *name, unsigned long long value);
+void         mock_property_double_set(Mock_Iface *mi, const char *name, double value);
+void         mock_property_string_set(Mock_Iface *mi, const char *name, const char *value);
+void         mock_property_path_set(Mock_Iface *mi, const char *name, const char *value);
+/* arrays of strings (type 's') or object paths (type 'o') */
+void         mock_property_array_append(Mock_Iface *mi, const char *name, int type, const char *item);
+void         mock_property_array_remove(Mock_Iface *mi, const char *name, const char *item);
+/* a{sv} with string values, such as connman IPv4 */
+void         mock_property_dict_string_set(Mock_Iface *mi, const char *name, const char *key, const char *value);
+
+Eina_Bool    mock_connman_start(E_DBus_Connection *conn, const Mock_Config *cfg);
+void         mock_connman_stop(void);
+Eina_Bool    mock_ofono_start(E_DBus_Connection *conn, const Mock_Config *cfg);
+void         mock_ofono_stop(void);
+Eina_Bool    mock_bluez_start(E_DBus_Connection *conn, const Mock_Config *cfg);
+void         mock_bluez_stop(void);
+Eina_Bool    mock_udisks_start(E_DBus_Connection *conn, const Mock_Config *cfg);
+void         mock_udisks_stop(void);
+Eina_Bool    mock_upower_start(E_DBus_Connection *conn, const Mock_Config *cfg);
+void         mock_upower_stop(void);
+Eina_Bool    mock_notify_start(E_DBus_Connection *conn, const Mock_Config *cfg);
+void         mock_notify_stop(void);
+
+#endif
@@ -0,0 +1,347 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Ecore.h>
+#include "mock_services.h"
+
+/*
+ * org.freedesktop.UDisks and org.freedesktop.UPower.  Both expose their
+ * device properties through org.freedesktop.DBus.Properties and announce
+ * changes with DeviceChanged(o) on the daemon object instead of a
+ * PropertyChanged signal.
+ *
+ * udisks lists cfg->udisks_devices removable vfat partitions that can be
+ * mounted, unmounted and ejected.  upower lists cfg->upower_devices
+ * batteries; every upower_interval ms the next one (round robin) changes
+ * its Percentage.
+ */
+
+#define UDISKS_PATH        "/org/freedesktop/UDisks"
+#define UDISKS_IFACE       "org.freedesktop.UDisks"
+#define UDISKS_DEVICE      "org.freedesktop.UDisks.Device"
+#define UPOWER_PATH        "/org/freedesktop/UPower"
+#define UPOWER_IFACE       "org.freedesktop.UPower"
+#define UPOWER_DEVICE      "org.freedesktop.UPower.Device"
+
+typedef struct _Mock_Ukit_Device Mock_Ukit_Device;
+
+struct _Mock_Ukit_Device
+{
+   Mock_Object *mo;
+   Mock_Iface *mi;
+   unsigned int index;
+   double percentage;
+};
+
+typedef struct _Mock_Ukit Mock_Ukit;
+
+struct _Mock_Ukit
+{
+   E_DBus_Connection *conn;
+   Mock_Object *daemon;
+   Mock_Iface *daemon_iface;
+   Eina_List *devices;
+};
+
+static Mock_Ukit udisks = { NULL, NULL, NULL, NULL };
+static Mock_Ukit upower = { NULL, NULL, NULL, NULL };
+static Eina_List *upower_next = NULL;
+static Ecore_Timer *upower_timer = NULL;
+
+static DBusMessage *
+_ukit_cb_enumerate_devices(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Ukit *ukit = mock_object_data_get(mock_object_get(obj));
+   DBusMessage *reply;
+   DBusMessageIter iter, array;
+   const Eina_List *l;
+   Mock_Ukit_Device *dev;
+   const char *path;
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_iter_init_append(reply, &iter);
+   dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "o", &array);
+   EINA_LIST_FOREACH(ukit->devices, l, dev)
+     {
+        path = mock_object_path_get(dev->mo);
+        dbus_message_iter_append_basic(&array, DBUS_TYPE_OBJECT_PATH, &path);
+     }
+   dbus_message_iter_close_container(&iter, &array);
+   return reply;
+}
+
+static void
+_ukit_device_changed(Mock_Ukit *ukit, Mock_Ukit_Device *dev)
+{
+   const char *path = mock_object_path_get(dev->mo);
+
+   mock_iface_signal_emit(ukit->daemon_iface, "DeviceChanged",
+                          DBUS_TYPE_OBJECT_PATH, &path, DBUS_TYPE_INVALID);
+}
+
+static Mock_Ukit_Device *
+_ukit_device_add(Mock_Ukit *ukit, const char *path, const char *iface, unsigned int index)
+{
+   Mock_Ukit_Device *dev;
+
+   dev = calloc(1, sizeof(Mock_Ukit_Device));
+   if (!dev) return NULL;
+
+   dev->mo = mock_object_add(ukit->conn, path, dev);
+   if (!dev->mo)
+     {
+        free(dev);
+        return NULL;
+     }
+   dev->mi = mock_iface_add(dev->mo, iface, MOCK_STYLE_FDO);
+   dev->index = index;
+   ukit->devices = eina_list_append(ukit->devices, dev);
+   return dev;
+}
+
+static Eina_Bool
+_ukit_daemon_add(Mock_Ukit *ukit, E_DBus_Connection *conn, const char *path, const char *iface)
+{
+   ukit->conn = conn;
+   ukit->daemon = mock_object_add(conn, path, ukit);
+   if (!ukit->daemon) return EINA_FALSE;
+
+   /* e_ukit calls the daemon methods with the bus name as interface */
+   ukit->daemon_iface = mock_iface_add(ukit->daemon, iface, MOCK_STYLE_FDO);
+   mock_iface_method_add(ukit->daemon_iface, "EnumerateDevices", "", "ao",
+                         _ukit_cb_enumerate_devices);
+   mock_iface_signal_add(ukit->daemon_iface, "DeviceAdded", "o");
+   mock_iface_signal_add(ukit->daemon_iface, "DeviceRemoved", "o");
+   mock_iface_signal_add(ukit->daemon_iface, "DeviceChanged", "o");
+   mock_property_string_set(ukit->daemon_iface, "DaemonVersion", "mock");
+   return EINA_TRUE;
+}
+
+static void
+_ukit_daemon_del(Mock_Ukit *ukit)
+{
+   Mock_Ukit_Device *dev;
+
+   EINA_LIST_FREE(ukit->devices, dev)
+     {
+        mock_object_del(dev->mo);
+        free(dev);
+     }
+   mock_object_del(ukit->daemon);
+   ukit->daemon = NULL;
+   ukit->daemon_iface = NULL;
+   ukit->conn = NULL;
+}
+
+/* udisks ******************************************************************/
+
+static void
+_udisks_mount_path_get(const Mock_Ukit_Device *dev, char *buf, size_t size)
+{
+   snprintf(buf, size, "/media/MOCK%u", dev->index);
+}
+
+static DBusMessage *
+_udisks_cb_mount(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Ukit_Device *dev = mock_object_data_get(mock_object_get(obj));
+   DBusMessage *reply;
+   char buf[64];
+   const char *mount_path = buf;
+
+   _udisks_mount_path_get(dev, buf, sizeof(buf));
+   mock_property_array_remove(dev->mi, "DeviceMountPaths", buf);
+   mock_property_array_append(dev->mi, "DeviceMountPaths", 's', buf);
+   mock_property_bool_set(dev->mi, "DeviceIsMounted", EINA_TRUE);
+   _ukit_device_changed(&udisks, dev);
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_append_args(reply, DBUS_TYPE_STRING, &mount_path, DBUS_TYPE_INVALID);
+   return reply;
+}
+
+static void
+_udisks_unmount(Mock_Ukit_Device *dev)
+{
+   char buf[64];
+
+   _udisks_mount_path_get(dev, buf, sizeof(buf));
+   mock_property_array_remove(dev->mi, "DeviceMountPaths", buf);
+   mock_property_bool_set(dev->mi, "DeviceIsMounted", EINA_FALSE);
+}
+
+static DBusMessage *
+_udisks_cb_unmount(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Ukit_Device *dev = mock_object_data_get(mock_object_get(obj));
+
+   _udisks_unmount(dev);
+   _ukit_device_changed(&udisks, dev);
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_udisks_cb_eject(E_DBus_Object *obj, DBusMessage *msg)
+{
+   Mock_Ukit_Device *dev = mock_object_data_get(mock_object_get(obj));
+
+   _udisks_unmount(dev);
+   mock_property_bool_set(dev->mi, "DeviceIsMediaAvailable", EINA_FALSE);
+   _ukit_device_changed(&udisks, dev);
+   return dbus_message_new_method_return(msg);
+}
+
+Eina_Bool
+mock_udisks_start(E_DBus_Connection *conn, const Mock_Config *cfg)
+{
+   Mock_Ukit_Device *dev;
+   char path[128], buf[64];
+   unsigned int i;
+
+   if (!_ukit_daemon_add(&udisks, conn, UDISKS_PATH, UDISKS_IFACE))
+     return EINA_FALSE;
+
+   for (i = 0; i < cfg->udisks_devices; i++)
+     {
+        snprintf(path, sizeof(path), UDISKS_PATH "/devices/mock%u", i);
+        dev = _ukit_device_add(&udisks, path, UDISKS_DEVICE, i);
+        if (!dev) break;
+
+        mock_iface_method_add(dev->mi, "FilesystemMount", "sas", "s", _udisks_cb_mount);
+        mock_iface_method_add(dev->mi, "FilesystemUnmount", "as", "", _udisks_cb_unmount);
+        mock_iface_method_add(dev->mi, "DriveEject", "as", "", _udisks_cb_eject);
+
+        snprintf(buf, sizeof(buf), "/dev/mock%u", i);
+        mock_property_string_set(dev->mi, "DeviceFile", buf);
+        mock_property_string_set(dev->mi, "NativePath", path);
+        mock_property_bool_set(dev->mi, "DeviceIsDrive", EINA_FALSE);
+        mock_property_bool_set(dev->mi, "DeviceIsPartition", EINA_TRUE);
+        mock_property_bool_set(dev->mi, "DeviceIsRemovable", EINA_TRUE);
+        mock_property_bool_set(dev->mi, "DeviceIsMediaAvailable", EINA_TRUE);
+        mock_property_bool_set(dev->mi, "DeviceIsMounted", EINA_FALSE);
+        mock_property_array_append(dev->mi, "DeviceMountPaths", 's', NULL);
+        mock_property_uint64_set(dev->mi, "DeviceSize", 4ULL << 30);
+        mock_property_string_set(dev->mi, "IdUsage", "filesystem");
+        mock_property_string_set(dev->mi, "IdType", "vfat");
+        snprintf(buf, sizeof(buf), "MOCK%u", i);
+        mock_property_string_set(dev->mi, "IdLabel", buf);
+        snprintf(buf, sizeof(buf), "%04X-%04X", i >> 16, i & 0xffff);
+        mock_property_string_set(dev->mi, "IdUuid", buf);
+        mock_property_path_set(dev->mi, "PartitionSlave", UDISKS_PATH "/devices/mock");
+        mock_property_string_set(dev->mi, "DriveVendor", "Mock");
+        mock_property_string_set(dev->mi, "DriveModel", "Flash Disk");
+        mock_property_bool_set(dev->mi, "DriveIsMediaEjectable", EINA_TRUE);
+     }
+   return EINA_TRUE;
+}
+
+void
+mock_udisks_stop(void)
+{
+   _ukit_daemon_del(&udisks);
+}
+
+/* upower ******************************************************************/
+
+static DBusMessage *
+_upower_cb_empty(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *
+_upower_cb_allowed(E_DBus_Object *obj __UNUSED__, DBusMessage *msg)
+{
+   DBusMessage *reply;
+   dbus_bool_t allowed = TRUE;
+
+   reply = dbus_message_new_method_return(msg);
+   dbus_message_append_args(reply, DBUS_TYPE_BOOLEAN, &allowed, DBUS_TYPE_INVALID);
+   return reply;
+}
+
+static Eina_Bool
+_upower_update(void *data __UNUSED__)
+{
+   Mock_Ukit_Device *dev;
+
+   if (!upower.devices) return ECORE_CALLBACK_RENEW;
+   if (!upower_next) upower_next = upower.devices;
+
+   dev = eina_list_data_get(upower_next);
+   upower_next = eina_list_next(upower_next);
+
+   dev->percentage -= 1.0;
+   if (dev->percentage < 0.0) dev->percentage = 100.0;
+   mock_property_double_set(dev->mi, "Percentage", dev->percentage);
+   mock_property_double_set(dev->mi, "Energy", dev->percentage * 0.5);
+   _ukit_device_changed(&upower, dev);
+   return ECORE_CALLBACK_RENEW;
+}
+
+Eina_Bool
+mock_upower_start(E_DBus_Connection *conn, const Mock_Config *cfg)
+{
+   Mock_Ukit_Device *dev;
+   Mock_Iface *mi;
+   char path[128], buf[64];
+   unsigned int i;
+
+   if (!_ukit_daemon_add(&upower, conn, UPOWER_PATH, UPOWER_IFACE))
+     return EINA_FALSE;
+
+   mi = upower.daemon_iface;
+   mock_iface_method_add(mi, "Suspend", "", "", _upower_cb_empty);
+   mock_iface_method_add(mi, "Hibernate", "", "", _upower_cb_empty);
+   mock_iface_method_add(mi, "SuspendAllowed", "", "b", _upower_cb_allowed);
+   mock_iface_method_add(mi, "HibernateAllowed", "", "b", _upower_cb_allowed);
+   mock_iface_signal_add(mi, "Changed", "");
+   mock_property_bool_set(mi, "CanSuspend", EINA_TRUE);
+   mock_property_bool_set(mi, "CanHibernate", EINA_TRUE);
+   mock_property_bool_set(mi, "OnBattery", cfg->upower_devices > 0);
+   mock_property_bool_set(mi, "LidIsClosed", EINA_FALSE);
+
+   for (i = 0; i < cfg->upower_devices; i++)
+     {
+        snprintf(path, sizeof(path), UPOWER_PATH "/devices/battery_BAT%u", i);
+        dev = _ukit_device_add(&upower, path, UPOWER_DEVICE, i);
+        if (!dev) break;
+
+        dev->percentage = 100.0 - (i % 100);
+        snprintf(buf, sizeof(buf), "/sys/class/power_supply/BAT%u", i);
+        mock_property_string_set(dev->mi, "NativePath", buf);
+        mock_property_string_set(dev->mi, "Vendor", "Mock");
+        mock_property_string_set(dev->mi, "Model", "Battery");
+        mock_property_uint32_set(dev->mi, "Type", 2);
+        mock_property_uint32_set(dev->mi, "State", 2);
+        mock_property_uint32_set(dev->mi, "Technology", 1);
+        mock_property_bool_set(dev->mi, "PowerSupply", EINA_TRUE);
+        mock_property_bool_set(dev->mi, "IsPresent", EINA_TRUE);
+        mock_property_bool_set(dev->mi, "IsRechargeable", EINA_TRUE);
+        mock_property_double_set(dev->mi, "Percentage", dev->percentage);
+        mock_property_double_set(dev->mi, "Energy", dev->percentage * 0.5);
+        mock_property_double_set(dev->mi, "EnergyFull", 50.0);
+        mock_property_uint64_set(dev->mi, "UpdateTime", 0);
+     }
+
+   if (cfg->upower_interval)
+     upower_timer = ecore_timer_add(cfg->upower_interval / 1000.0, _upower_update, NULL);
+   return EINA_TRUE;
+}
+
+void
+mock_upower_stop(void)
+{
+   if (upower_timer)
+     {
+        ecore_timer_del(upower_timer);
+        upower_timer = NULL;
+     }
+   upower_next = NULL;
+   _ukit_daemon_del(&upower);
+}
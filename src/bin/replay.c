@@ -0,0 +1,762 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <Ecore.h>
+#include "E_DBus.h"
+#include "bench_common.h"
+
+#ifdef REPLAY_BLUEZ
+#include "E_Bluez.h"
+#endif
+#ifdef REPLAY_CONNMAN
+#define E_CONNMAN_I_KNOW_THIS_API_IS_SUBJECT_TO_CHANGE 1
+#include "E_Connman.h"
+#endif
+#ifdef REPLAY_OFONO
+#include "E_Ofono.h"
+#endif
+
+/*
+ * Replays a capture made with e_dbus_connection_record_start() into this
+ * process, without a bus.
+ *
+ * The replayed E_DBus_Connection is a peer to peer connection to a unix
+ * socket served by this program, so captured messages go through the
+ * real libdbus and e_dbus filter and dispatch path.  Optionally one of
+ * the client libraries is initialised on it (-m) to process the traffic.
+ *
+ * Captured incoming messages are written at their original pace divided
+ * by the speed factor (-s, 0 for as fast as possible).  Method calls
+ * made by the replayed process are matched in order against the captured
+ * outgoing calls with the same destination, path, interface and member;
+ * the captured reply is then delivered with its reply serial rewritten,
+ * and waits (up to -w ms) for its call to be made.  Unmatched calls get
+ * an empty reply from the bus or an error from anyone else.
+ *
+ * Results are printed as JSON lines, see bench_common.h.
+ */
+
+#define REPLAY_SERIAL_BASE 0x40000000
+#define REPLAY_GUID        "0123456789abcdef0123456789abcdef"
+#define REPLAY_ERROR       "org.enlightenment.edbus.Replay.NotCaptured"
+#define REPLAY_BACKLOG     (64 * 1024)
+
+typedef struct _Replay_Message Replay_Message;
+typedef struct _Replay_Buffer  Replay_Buffer;
+
+struct _Replay_Message
+{
+   DBusMessage *msg;
+   double time;
+   unsigned char direction;
+};
+
+struct _Replay_Buffer
+{
+   unsigned char *data;
+   size_t len;
+   size_t size;
+};
+
+static double opt_speed = 1.0;
+static unsigned int opt_wait = 1000;
+static const char *opt_module = NULL;
+static Eina_Bool opt_count = EINA_FALSE;
+
+static Replay_Message *messages = NULL;
+static unsigned int message_count = 0;
+static unsigned int next_message = 0;
+
+/* captured outgoing calls by "destination path interface member" */
+static Eina_Hash *calls = NULL;
+/* captured serial -> serial used by the replayed process */
+static Eina_Hash *serials = NULL;
+/* captured serials of the outgoing calls, to tell a late call from none */
+static Eina_Hash *captured_calls = NULL;
+
+static E_DBus_Connection *conn = NULL;
+static Ecore_Fd_Handler *peer_handler = NULL;
+static int peer_fd = -1;
+static Eina_Bool peer_authenticated = EINA_FALSE;
+static Replay_Buffer peer_in = { NULL, 0, 0 };
+static Replay_Buffer peer_out = { NULL, 0, 0 };
+static dbus_uint32_t peer_serial = REPLAY_SERIAL_BASE;
+
+static Ecore_Timer *schedule_timer = NULL;
+static double replay_start = 0.0;
+static double waiting_since = 0.0;
+
+static unsigned long delivered = 0;
+static unsigned long delivered_bytes = 0;
+static unsigned long signals_seen = 0;
+static unsigned long signals_dispatched = 0;
+static unsigned long calls_matched = 0;
+static unsigned long calls_unmatched = 0;
+static unsigned long replies_skipped = 0;
+static unsigned long received = 0;
+
+static void _replay_schedule(void);
+
+/* buffers *****************************************************************/
+
+static Eina_Bool
+_replay_buffer_append(Replay_Buffer *b, const void *data, size_t len)
+{
+   if (b->len + len > b->size)
+     {
+        size_t size = b->size ? b->size : 4096;
+        unsigned char *tmp;
+
+        while (size < b->len + len) size *= 2;
+        tmp = realloc(b->data, size);
+        if (!tmp) return EINA_FALSE;
+        b->data = tmp;
+        b->size = size;
+     }
+   memcpy(b->data + b->len, data, len);
+   b->len += len;
+   return EINA_TRUE;
+}
+
+static void
+_replay_buffer_consume(Replay_Buffer *b, size_t len)
+{
+   if (len < b->len)
+     memmove(b->data, b->data + len, b->len - len);
+   b->len -= len;
+}
+
+/* capture *****************************************************************/
+
+static char *
+_replay_call_key(DBusMessage *msg)
+{
+   const char *dest = dbus_message_get_destination(msg);
+   const char *path = dbus_message_get_path(msg);
+   const char *iface = dbus_message_get_interface(msg);
+   const char *member = dbus_message_get_member(msg);
+   char *key;
+   size_t len;
+
+   len = strlen(dest ? dest : "") + strlen(path ? path : "") +
+     strlen(iface ? iface : "") + strlen(member ? member : "") + 4;
+   key = malloc(len);
+   if (key)
+     snprintf(key, len, "%s %s %s %s", dest ? dest : "", path ? path : "",
+              iface ? iface : "", member ? member : "");
+   return key;
+}
+
+static Eina_Bool
+_replay_load(const char *file)
+{
+   E_DBus_Record_Entry entry;
+   DBusError err;
+   FILE *f;
+   char magic[8], *buf = NULL;
+   unsigned int size = 0, alloc = 0;
+
+   f = fopen(file, "rb");
+   if (!f)
+     {
+        fprintf(stderr, "ERROR: %s: %s\n", file, strerror(errno));
+        return EINA_FALSE;
+     }
+   if ((fread(magic, sizeof(magic), 1, f) != 1) ||
+       (memcmp(magic, E_DBUS_RECORD_MAGIC, sizeof(magic))))
+     {
+        fprintf(stderr, "ERROR: %s: not an e_dbus capture\n", file);
+        fclose(f);
+        return EINA_FALSE;
+     }
+
+   dbus_error_init(&err);
+   while (fread(&entry, sizeof(entry), 1, f) == 1)
+     {
+        Replay_Message *m;
+
+        if (entry.length > size)
+          {
+             char *tmp = realloc(buf, entry.length);
+             if (!tmp) break;
+             buf = tmp;
+             size = entry.length;
+          }
+        if (fread(buf, entry.length, 1, f) != 1)
+          {
+             fprintf(stderr, "WARNING: %s: truncated after %u messages\n",
+                     file, message_count);
+             break;
+          }
+
+        if (message_count == alloc)
+          {
+             Replay_Message *tmp;
+
+             alloc = alloc ? alloc * 2 : 1024;
+             tmp = realloc(messages, alloc * sizeof(Replay_Message));
+             if (!tmp) break;
+             messages = tmp;
+          }
+
+        m = messages + message_count;
+        m->msg = dbus_message_demarshal(buf, entry.length, &err);
+        if (!m->msg)
+          {
+             fprintf(stderr, "WARNING: %s: message %u: %s\n", file,
+                     message_count, err.message);
+             dbus_error_free(&err);
+             continue;
+          }
+        m->time = entry.usec / 1000000.0;
+        m->direction = entry.direction;
+        message_count++;
+
+        if ((m->direction == E_DBUS_RECORD_OUT) &&
+            (dbus_message_get_type(m->msg) == DBUS_MESSAGE_TYPE_METHOD_CALL))
+          {
+             Eina_List *l;
+             char *key = _replay_call_key(m->msg);
+             int serial = dbus_message_get_serial(m->msg);
+
+             if (!key) continue;
+             l = eina_hash_find(calls, key);
+             l = eina_list_append(l, m);
+             eina_hash_set(calls, key, l);
+             eina_hash_add(captured_calls, &serial, m);
+             free(key);
+          }
+     }
+
+   free(buf);
+   fclose(f);
+   return EINA_TRUE;
+}
+
+/* peer side ***************************************************************/
+
+static void
+_replay_peer_flush(void)
+{
+   ssize_t r;
+
+   while (peer_out.len)
+     {
+        r = write(peer_fd, peer_out.data, peer_out.len);
+        if (r < 0)
+          {
+             if (errno == EINTR) continue;
+             if (errno != EAGAIN)
+               {
+                  fprintf(stderr, "ERROR: write: %s\n", strerror(errno));
+                  ecore_main_loop_quit();
+                  return;
+               }
+             break;
+          }
+        _replay_buffer_consume(&peer_out, r);
+     }
+
+   ecore_main_fd_handler_active_set(peer_handler, peer_out.len ?
+                                    ECORE_FD_READ | ECORE_FD_WRITE : ECORE_FD_READ);
+}
+
+static void
+_replay_peer_send(DBusMessage *msg)
+{
+   char *buf = NULL;
+   int len = 0;
+
+   if (!dbus_message_get_serial(msg))
+     dbus_message_set_serial(msg, peer_serial++);
+   if (!dbus_message_marshal(msg, &buf, &len))
+     {
+        fprintf(stderr, "ERROR: could not marshal message\n");
+        return;
+     }
+   _replay_buffer_append(&peer_out, buf, len);
+   free(buf);
+   delivered_bytes += len;
+   _replay_peer_flush();
+}
+
+static void
+_replay_peer_call(DBusMessage *msg)
+{
+   DBusMessage *reply = NULL;
+   Replay_Message *m;
+   Eina_List *l;
+   const char *dest;
+   char *key;
+   int serial;
+
+   key = _replay_call_key(msg);
+   l = key ? eina_hash_find(calls, key) : NULL;
+   if (l)
+     {
+        m = eina_list_data_get(l);
+        eina_hash_modify(calls, key, eina_list_remove_list(l, l));
+        serial = dbus_message_get_serial(m->msg);
+        eina_hash_add(serials, &serial, (void *)(unsigned long)dbus_message_get_serial(msg));
+        calls_matched++;
+        free(key);
+        if (waiting_since > 0.0) _replay_schedule();
+        return;
+     }
+   free(key);
+
+   calls_unmatched++;
+   if (dbus_message_get_no_reply(msg)) return;
+
+   dest = dbus_message_get_destination(msg);
+   if ((dest) && (!strcmp(dest, DBUS_SERVICE_DBUS)))
+     reply = dbus_message_new_method_return(msg);
+   else
+     reply = dbus_message_new_error(msg, REPLAY_ERROR, "This call is not in the capture");
+   if (!reply) return;
+   _replay_peer_send(reply);
+   dbus_message_unref(reply);
+}
+
+static size_t
+_replay_message_size(const unsigned char *data, size_t len)
+{
+   dbus_uint32_t body, fields;
+
+   if (len < 16) return 0;
+   if (data[0] == 'l')
+     {
+        body = data[4] | (data[5] << 8) | (data[6] << 16) | ((dbus_uint32_t)data[7] << 24);
+        fields = data[12] | (data[13] << 8) | (data[14] << 16) | ((dbus_uint32_t)data[15] << 24);
+     }
+   else
+     {
+        body = ((dbus_uint32_t)data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+        fields = ((dbus_uint32_t)data[12] << 24) | (data[13] << 16) | (data[14] << 8) | data[15];
+     }
+   return 16 + ((fields + 7) & ~7) + body;
+}
+
+static void
+_replay_peer_messages(void)
+{
+   DBusMessage *msg;
+   DBusError err;
+   size_t need;
+
+   dbus_error_init(&err);
+   while ((need = _replay_message_size(peer_in.data, peer_in.len)) &&
+          (need <= peer_in.len))
+     {
+        msg = dbus_message_demarshal((const char *)peer_in.data, need, &err);
+        _replay_buffer_consume(&peer_in, need);
+        if (!msg)
+          {
+             fprintf(stderr, "ERROR: invalid message from client: %s\n", err.message);
+             dbus_error_free(&err);
+             ecore_main_loop_quit();
+             return;
+          }
+        received++;
+        if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_METHOD_CALL)
+          _replay_peer_call(msg);
+        dbus_message_unref(msg);
+     }
+}
+
+static void
+_replay_peer_auth(void)
+{
+   unsigned char *eol;
+   const char *reply;
+   size_t len;
+
+   /* the client starts with a nul byte, then speaks line by line */
+   while ((eol = memchr(peer_in.data, '\n', peer_in.len)))
+     {
+        char *line = (char *)peer_in.data;
+
+        len = eol - peer_in.data + 1;
+        if (line[0] == '\0') line++;
+
+        if (!strncmp(line, "BEGIN", 5))
+          {
+             _replay_buffer_consume(&peer_in, len);
+             peer_authenticated = EINA_TRUE;
+             _replay_schedule();
+             return;
+          }
+        else if ((!strncmp(line, "AUTH EXTERNAL", 13)) || (!strncmp(line, "DATA", 4)))
+          reply = "OK " REPLAY_GUID "\r\n";
+        else if (!strncmp(line, "NEGOTIATE_UNIX_FD", 17))
+          reply = "ERROR\r\n";
+        else
+          reply = "REJECTED EXTERNAL\r\n";
+
+        _replay_buffer_consume(&peer_in, len);
+        _replay_buffer_append(&peer_out, reply, strlen(reply));
+        _replay_peer_flush();
+     }
+}
+
+static Eina_Bool
+_replay_cb_peer(void *data __UNUSED__, Ecore_Fd_Handler *fdh)
+{
+   unsigned char buf[65536];
+   ssize_t r;
+
+   if (ecore_main_fd_handler_active_get(fdh, ECORE_FD_WRITE))
+     {
+        _replay_peer_flush();
+        if ((peer_out.len < REPLAY_BACKLOG) && (!schedule_timer) &&
+            (peer_authenticated) && (waiting_since == 0.0))
+          _replay_schedule();
+     }
+
+   if (!ecore_main_fd_handler_active_get(fdh, ECORE_FD_READ))
+     return ECORE_CALLBACK_RENEW;
+
+   r = read(peer_fd, buf, sizeof(buf));
+   if (r == 0)
+     {
+        ecore_main_loop_quit();
+        return ECORE_CALLBACK_CANCEL;
+     }
+   if (r < 0)
+     return ECORE_CALLBACK_RENEW;
+
+   _replay_buffer_append(&peer_in, buf, r);
+   if (!peer_authenticated) _replay_peer_auth();
+   if (peer_authenticated) _replay_peer_messages();
+   return ECORE_CALLBACK_RENEW;
+}
+
+/* schedule ****************************************************************/
+
+static Eina_Bool
+_replay_cb_done(void *data __UNUSED__)
+{
+   ecore_main_loop_quit();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+static Eina_Bool
+_replay_cb_schedule(void *data __UNUSED__)
+{
+   schedule_timer = NULL;
+   _replay_schedule();
+   return ECORE_CALLBACK_CANCEL;
+}
+
+/* returns EINA_FALSE while a reply waits for its call */
+static Eina_Bool
+_replay_deliver(Replay_Message *m)
+{
+   DBusMessage *msg = m->msg, *copy;
+   int reply_serial;
+   void *serial;
+   int type = dbus_message_get_type(msg);
+
+   if ((type == DBUS_MESSAGE_TYPE_METHOD_RETURN) || (type == DBUS_MESSAGE_TYPE_ERROR))
+     {
+        reply_serial = dbus_message_get_reply_serial(msg);
+        serial = eina_hash_find(serials, &reply_serial);
+        if (!serial)
+          {
+             if (!eina_hash_find(captured_calls, &reply_serial))
+               return EINA_TRUE; /* reply to a call not in the capture */
+             if (waiting_since == 0.0)
+               waiting_since = ecore_time_get();
+             if (ecore_time_get() - waiting_since < opt_wait / 1000.0)
+               return EINA_FALSE;
+             replies_skipped++;
+             waiting_since = 0.0;
+             return EINA_TRUE;
+          }
+        waiting_since = 0.0;
+        eina_hash_del_by_key(serials, &reply_serial);
+
+        copy = dbus_message_copy(msg);
+        if (!copy) return EINA_TRUE;
+        dbus_message_set_serial(copy, dbus_message_get_serial(msg));
+        dbus_message_set_reply_serial(copy, (unsigned long)serial);
+        _replay_peer_send(copy);
+        dbus_message_unref(copy);
+     }
+   else
+     {
+        if (type == DBUS_MESSAGE_TYPE_SIGNAL) signals_seen++;
+        _replay_peer_send(msg);
+     }
+   delivered++;
+   return EINA_TRUE;
+}
+
+static void
+_replay_schedule(void)
+{
+   Replay_Message *m;
+   double now, due;
+
+   if (schedule_timer)
+     {
+        ecore_timer_del(schedule_timer);
+        schedule_timer = NULL;
+     }
+   if (!replay_start) replay_start = ecore_time_get();
+
+   while (next_message < message_count)
+     {
+        m = messages + next_message;
+        if (m->direction != E_DBUS_RECORD_IN)
+          {
+             next_message++;
+             continue;
+          }
+
+        now = ecore_time_get();
+        due = opt_speed > 0.0 ? replay_start + m->time / opt_speed : now;
+        if (due > now)
+          {
+             schedule_timer = ecore_timer_add(due - now, _replay_cb_schedule, NULL);
+             return;
+          }
+        if (!_replay_deliver(m))
+          {
+             /* retried when the call arrives or the wait expires */
+             schedule_timer = ecore_timer_add(opt_wait / 1000.0, _replay_cb_schedule, NULL);
+             return;
+          }
+        next_message++;
+
+        /* let the client catch up */
+        if (peer_out.len >= REPLAY_BACKLOG) return;
+     }
+
+   if (!peer_out.len)
+     ecore_timer_add(0.2, _replay_cb_done, NULL);
+}
+
+/* setup *******************************************************************/
+
+static void
+_replay_cb_count(void *data __UNUSED__, DBusMessage *msg __UNUSED__)
+{
+   signals_dispatched++;
+}
+
+static E_DBus_Connection *
+_replay_connect(const char *dir, int *listen_fd)
+{
+   struct sockaddr_un addr;
+   E_DBus_Connection *econn;
+   DBusConnection *dconn;
+   DBusError err;
+   char address[sizeof(addr.sun_path) + 16];
+   int fd;
+
+   fd = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (fd < 0) return NULL;
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/replay", dir);
+   if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) || (listen(fd, 1) < 0))
+     {
+        fprintf(stderr, "ERROR: %s: %s\n", addr.sun_path, strerror(errno));
+        close(fd);
+        return NULL;
+     }
+   *listen_fd = fd;
+
+   snprintf(address, sizeof(address), "unix:path=%s", addr.sun_path);
+   dbus_error_init(&err);
+   dconn = dbus_connection_open_private(address, &err);
+   if (!dconn)
+     {
+        fprintf(stderr, "ERROR: %s: %s\n", address, err.message);
+        dbus_error_free(&err);
+        return NULL;
+     }
+
+   peer_fd = accept(fd, NULL, NULL);
+   if (peer_fd < 0)
+     {
+        fprintf(stderr, "ERROR: accept: %s\n", strerror(errno));
+        dbus_connection_close(dconn);
+        dbus_connection_unref(dconn);
+        return NULL;
+     }
+   fcntl(peer_fd, F_SETFL, fcntl(peer_fd, F_GETFL) | O_NONBLOCK);
+   peer_handler = ecore_main_fd_handler_add(peer_fd, ECORE_FD_READ, _replay_cb_peer,
+                                            NULL, NULL, NULL);
+
+   econn = e_dbus_connection_setup(dconn);
+   if (!econn)
+     {
+        fprintf(stderr, "ERROR: could not set up the replay connection\n");
+        dbus_connection_close(dconn);
+        dbus_connection_unref(dconn);
+        return NULL;
+     }
+   /* as e_dbus_bus_get() does, the e_dbus_connection_close() at the end
+    * drops this reference */
+   e_dbus_connection_ref(econn);
+   return econn;
+}
+
+static Eina_Bool
+_replay_module_init(Eina_Bool init)
+{
+   if (!opt_module) return EINA_TRUE;
+#ifdef REPLAY_BLUEZ
+   if (!strcmp(opt_module, "bluez"))
+     {
+        if (init) e_bluez_system_init(conn);
+        else e_bluez_system_shutdown();
+        return EINA_TRUE;
+     }
+#endif
+#ifdef REPLAY_CONNMAN
+   if (!strcmp(opt_module, "connman"))
+     {
+        if (init) e_connman_system_init(conn);
+        else e_connman_system_shutdown();
+        return EINA_TRUE;
+     }
+#endif
+#ifdef REPLAY_OFONO
+   if (!strcmp(opt_module, "ofono"))
+     {
+        if (init) e_ofono_system_init(conn);
+        else e_ofono_system_shutdown();
+        return EINA_TRUE;
+     }
+#endif
+   fprintf(stderr, "ERROR: module '%s' is not available\n", opt_module);
+   return EINA_FALSE;
+}
+
+static void
+_usage(const char *prog)
+{
+   printf("Usage: %s [options] <capture>\n"
+          "\n"
+          "Options:\n"
+          "  -s SPEED   speed factor, 0 for as fast as possible (%g)\n"
+          "  -w MS      how long a reply waits for its call (%u)\n"
+          "  -m MODULE  client library to run on the connection:"
+#ifdef REPLAY_BLUEZ
+          " bluez"
+#endif
+#ifdef REPLAY_CONNMAN
+          " connman"
+#endif
+#ifdef REPLAY_OFONO
+          " ofono"
+#endif
+          "\n"
+          "  -c         dispatch every signal to a catch-all handler\n",
+          prog, opt_speed, opt_wait);
+}
+
+int
+main(int argc, char *argv[])
+{
+   E_DBus_Signal_Handler *sh = NULL;
+   char dir[] = "/tmp/e_dbus_replay.XXXXXX";
+   char path[sizeof(dir) + 16];
+   double t0, t1, cpu0, cpu1;
+   int opt, listen_fd = -1, ret = 0;
+
+   while ((opt = getopt(argc, argv, "s:w:m:ch")) != -1)
+     {
+        switch (opt)
+          {
+           case 's': opt_speed = strtod(optarg, NULL); break;
+           case 'w': opt_wait = strtoul(optarg, NULL, 10); break;
+           case 'm': opt_module = optarg; break;
+           case 'c': opt_count = EINA_TRUE; break;
+           default:
+              _usage(argv[0]);
+              return opt == 'h' ? 0 : 1;
+          }
+     }
+   if (optind >= argc)
+     {
+        _usage(argv[0]);
+        return 1;
+     }
+
+   e_dbus_init();
+   calls = eina_hash_string_superfast_new(NULL);
+   serials = eina_hash_int32_new(NULL);
+   captured_calls = eina_hash_int32_new(NULL);
+   if (!_replay_load(argv[optind]))
+     {
+        e_dbus_shutdown();
+        return 1;
+     }
+
+   if (!mkdtemp(dir))
+     {
+        fprintf(stderr, "ERROR: mkdtemp: %s\n", strerror(errno));
+        e_dbus_shutdown();
+        return 1;
+     }
+
+   conn = _replay_connect(dir, &listen_fd);
+   if ((!conn) || (!_replay_module_init(EINA_TRUE)))
+     {
+        ret = 1;
+        goto end;
+     }
+   if (opt_count)
+     sh = e_dbus_signal_handler_add(conn, NULL, NULL, NULL, NULL, _replay_cb_count, NULL);
+
+   t0 = bench_time_get();
+   cpu0 = bench_cpu_time_get(0);
+   ecore_main_loop_begin();
+   t1 = bench_time_get();
+   cpu1 = bench_cpu_time_get(0);
+
+   bench_report("replay", "messages", message_count, "msgs");
+   bench_report("replay", "delivered", delivered, "msgs");
+   bench_report("replay", "delivered_bytes", delivered_bytes, "bytes");
+   bench_report("replay", "signals", signals_seen, "msgs");
+   if (opt_count)
+     bench_report("replay", "signals_dispatched", signals_dispatched, "msgs");
+   bench_report("replay", "received", received, "msgs");
+   bench_report("replay", "calls_matched", calls_matched, "calls");
+   bench_report("replay", "calls_unmatched", calls_unmatched, "calls");
+   bench_report("replay", "replies_skipped", replies_skipped, "msgs");
+   bench_report("replay", "duration", t1 - t0, "s");
+   if (t1 > t0)
+     bench_report("replay", "messages_per_sec", delivered / (t1 - t0), "msgs/s");
+   if ((cpu0 >= 0.0) && (cpu1 >= 0.0))
+     bench_report("replay", "cpu", cpu1 - cpu0, "s");
+
+   if (sh) e_dbus_signal_handler_del(conn, sh);
+   _replay_module_init(EINA_FALSE);
+
+ end:
+   if (conn) e_dbus_connection_close(conn);
+   if (peer_handler) ecore_main_fd_handler_del(peer_handler);
+   if (peer_fd >= 0) close(peer_fd);
+   if (listen_fd >= 0) close(listen_fd);
+   snprintf(path, sizeof(path), "%s/replay", dir);
+   unlink(path);
+   rmdir(dir);
+   e_dbus_shutdown();
+   return ret;
+}
@@ -0,0 +1,353 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <Eina.h>
+#include "E_DBus.h"
+
+/*
+ * Joins the traces written by e_dbus_trace_start() (or E_DBUS_TRACE) in a
+ * client and a server into a breakdown of each call, in microseconds:
+ *
+ *   out      sent by the client -> first read by the server after that,
+ *            the client's outgoing queue and the bus daemon
+ *   sq       server read -> dispatched to the method handler, the
+ *            server's dispatch backlog
+ *   handler  dispatched -> reply sent
+ *   back     reply sent -> first read by the client after that
+ *   cq       client read -> reply dispatched to its callback, the
+ *            client's dispatch backlog
+ *
+ * Calls are summarised per member, or listed one per line with -c.  Calls
+ * seen by only one of the traces are counted but not broken down.
+ */
+
+typedef struct _Merge_Call  Merge_Call;
+typedef struct _Merge_Reads Merge_Reads;
+typedef struct _Merge_Stat  Merge_Stat;
+
+struct _Merge_Call
+{
+   char member[32];
+   char caller[32];
+   char server[32];
+   unsigned int serial;
+   unsigned long long send;
+   unsigned long long dispatch;
+   unsigned long long reply_send;
+   unsigned long long reply_dispatch;
+   Eina_Bool error;
+};
+
+struct _Merge_Reads
+{
+   unsigned long long *usec;
+   unsigned int count;
+   unsigned int size;
+};
+
+#define MERGE_PARTS 6
+
+struct _Merge_Stat
+{
+   unsigned long count;
+   unsigned long long sum[MERGE_PARTS];
+};
+
+static const char *part_names[MERGE_PARTS] = {
+   "total", "out", "sq", "handler", "back", "cq"
+};
+
+static Eina_Hash *calls = NULL;  /* "caller serial" -> Merge_Call */
+static Eina_Hash *reads = NULL;  /* unique name -> Merge_Reads */
+static Eina_Hash *stats = NULL;  /* member -> Merge_Stat */
+
+static void
+_merge_reads_free(void *data)
+{
+   Merge_Reads *r = data;
+
+   free(r->usec);
+   free(r);
+}
+
+static void
+_merge_read_add(const E_DBus_Trace_Entry *e)
+{
+   Merge_Reads *r;
+
+   if (!e->self[0]) return;
+   r = eina_hash_find(reads, e->self);
+   if (!r)
+     {
+        r = calloc(1, sizeof(Merge_Reads));
+        if (!r) return;
+        eina_hash_add(reads, e->self, r);
+     }
+   if (r->count == r->size)
+     {
+        unsigned long long *tmp;
+        unsigned int size = r->size ? r->size * 2 : 1024;
+
+        tmp = realloc(r->usec, size * sizeof(unsigned long long));
+        if (!tmp) return;
+        r->usec = tmp;
+        r->size = size;
+     }
+   r->usec[r->count++] = e->usec;
+}
+
+static void
+_merge_call_add(const E_DBus_Trace_Entry *e)
+{
+   Merge_Call *c;
+   char key[64];
+
+   if (!e->caller[0]) return;
+   snprintf(key, sizeof(key), "%.32s %u", e->caller, e->serial);
+   c = eina_hash_find(calls, key);
+   if (!c)
+     {
+        c = calloc(1, sizeof(Merge_Call));
+        if (!c) return;
+        memcpy(c->caller, e->caller, sizeof(c->caller));
+        c->serial = e->serial;
+        eina_hash_add(calls, key, c);
+     }
+
+   if (e->member[0] && !c->member[0])
+     memcpy(c->member, e->member, sizeof(c->member));
+
+   if (e->type == DBUS_MESSAGE_TYPE_METHOD_CALL)
+     {
+        if (e->event == E_DBUS_TRACE_SEND)
+          c->send = e->usec;
+        else
+          {
+             c->dispatch = e->usec;
+             memcpy(c->server, e->self, sizeof(c->server));
+          }
+     }
+   else
+     {
+        if (e->event == E_DBUS_TRACE_SEND)
+          c->reply_send = e->usec;
+        else
+          c->reply_dispatch = e->usec;
+        if (e->type == DBUS_MESSAGE_TYPE_ERROR)
+          c->error = EINA_TRUE;
+     }
+}
+
+static Eina_Bool
+_merge_load(const char *file)
+{
+   E_DBus_Trace_Entry e;
+   char magic[8];
+   FILE *f;
+
+   f = fopen(file, "rb");
+   if (!f)
+     {
+        fprintf(stderr, "ERROR: %s: %s\n", file, strerror(errno));
+        return EINA_FALSE;
+     }
+   if ((fread(magic, sizeof(magic), 1, f) != 1) ||
+       (memcmp(magic, E_DBUS_TRACE_MAGIC, sizeof(magic))))
+     {
+        fprintf(stderr, "ERROR: %s: not an e_dbus trace\n", file);
+        fclose(f);
+        return EINA_FALSE;
+     }
+
+   while (fread(&e, sizeof(e), 1, f) == 1)
+     {
+        e.self[sizeof(e.self) - 1] = '\0';
+        e.caller[sizeof(e.caller) - 1] = '\0';
+        e.member[sizeof(e.member) - 1] = '\0';
+
+        if (e.event == E_DBUS_TRACE_READ)
+          _merge_read_add(&e);
+        else
+          _merge_call_add(&e);
+     }
+
+   fclose(f);
+   return EINA_TRUE;
+}
+
+static int
+_merge_usec_cmp(const void *a, const void *b)
+{
+   unsigned long long x = *(const unsigned long long *)a;
+   unsigned long long y = *(const unsigned long long *)b;
+
+   return (x > y) - (x < y);
+}
+
+static Eina_Bool
+_merge_reads_sort(const Eina_Hash *hash __UNUSED__, const void *key __UNUSED__, void *data, void *fdata __UNUSED__)
+{
+   Merge_Reads *r = data;
+
+   qsort(r->usec, r->count, sizeof(unsigned long long), _merge_usec_cmp);
+   return EINA_TRUE;
+}
+
+/* first read on @p name at or after @p after, bounded by @p before */
+static unsigned long long
+_merge_read_find(const char *name, unsigned long long after, unsigned long long before)
+{
+   Merge_Reads *r = eina_hash_find(reads, name);
+   unsigned int lo = 0, hi;
+
+   if (!r) return before;
+   hi = r->count;
+   while (lo < hi)
+     {
+        unsigned int mid = (lo + hi) / 2;
+
+        if (r->usec[mid] < after) lo = mid + 1;
+        else hi = mid;
+     }
+   if ((lo == r->count) || (r->usec[lo] > before)) return before;
+   return r->usec[lo];
+}
+
+static unsigned long calls_complete = 0;
+static unsigned long calls_partial = 0;
+static Eina_Bool opt_calls = EINA_FALSE;
+
+static Eina_Bool
+_merge_call_report(const Eina_Hash *hash __UNUSED__, const void *key __UNUSED__, void *data, void *fdata __UNUSED__)
+{
+   Merge_Call *c = data;
+   unsigned long long server_read, client_read, part[MERGE_PARTS];
+   Merge_Stat *s;
+   int i;
+
+   if ((!c->send) || (!c->dispatch) || (!c->reply_send) || (!c->reply_dispatch))
+     {
+        calls_partial++;
+        return EINA_TRUE;
+     }
+   calls_complete++;
+
+   server_read = _merge_read_find(c->server, c->send, c->dispatch);
+   client_read = _merge_read_find(c->caller, c->reply_send, c->reply_dispatch);
+
+   part[0] = c->reply_dispatch - c->send;
+   part[1] = server_read - c->send;
+   part[2] = c->dispatch - server_read;
+   part[3] = c->reply_send - c->dispatch;
+   part[4] = client_read - c->reply_send;
+   part[5] = c->reply_dispatch - client_read;
+
+   if (opt_calls)
+     {
+        printf("%-24s %-12s %6u", c->member[0] ? c->member : "?", c->caller, c->serial);
+        for (i = 0; i < MERGE_PARTS; i++)
+          printf(" %9llu", part[i]);
+        printf("%s\n", c->error ? " error" : "");
+     }
+
+   s = eina_hash_find(stats, c->member);
+   if (!s)
+     {
+        s = calloc(1, sizeof(Merge_Stat));
+        if (!s) return EINA_TRUE;
+        eina_hash_add(stats, c->member, s);
+     }
+   s->count++;
+   for (i = 0; i < MERGE_PARTS; i++)
+     s->sum[i] += part[i];
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_merge_stat_report(const Eina_Hash *hash __UNUSED__, const void *key, void *data, void *fdata __UNUSED__)
+{
+   const char *member = key;
+   Merge_Stat *s = data;
+   int i;
+
+   printf("%-24s %8lu", member[0] ? member : "?", s->count);
+   for (i = 0; i < MERGE_PARTS; i++)
+     printf(" %9llu", s->sum[i] / s->count);
+   printf("\n");
+   return EINA_TRUE;
+}
+
+static void
+_usage(const char *prog)
+{
+   printf("Usage: %s [-c] <trace> [trace ...]\n"
+          "\n"
+          "Options:\n"
+          "  -c   list every call instead of the per member averages\n",
+          prog);
+}
+
+int
+main(int argc, char *argv[])
+{
+   int opt, i, ret = 0;
+
+   while ((opt = getopt(argc, argv, "ch")) != -1)
+     {
+        switch (opt)
+          {
+           case 'c': opt_calls = EINA_TRUE; break;
+           default:
+              _usage(argv[0]);
+              return opt == 'h' ? 0 : 1;
+          }
+     }
+   if (optind >= argc)
+     {
+        _usage(argv[0]);
+        return 1;
+     }
+
+   eina_init();
+   calls = eina_hash_string_superfast_new(free);
+   reads = eina_hash_string_superfast_new(_merge_reads_free);
+   stats = eina_hash_string_superfast_new(free);
+
+   for (i = optind; i < argc; i++)
+     if (!_merge_load(argv[i]))
+       {
+          ret = 1;
+          goto end;
+       }
+
+   eina_hash_foreach(reads, _merge_reads_sort, NULL);
+
+   if (opt_calls)
+     printf("%-24s %-12s %6s", "member", "caller", "serial");
+   else
+     printf("%-24s %8s", "member", "calls");
+   for (i = 0; i < MERGE_PARTS; i++)
+     printf(" %9s", part_names[i]);
+   printf("\n");
+
+   eina_hash_foreach(calls, _merge_call_report, NULL);
+   if (!opt_calls)
+     eina_hash_foreach(stats, _merge_stat_report, NULL);
+
+   printf("# %lu calls broken down, %lu seen by one side only (times in us)\n",
+          calls_complete, calls_partial);
+
+ end:
+   eina_hash_free(stats);
+   eina_hash_free(reads);
+   eina_hash_free(calls);
+   eina_shutdown();
+   return ret;
+}
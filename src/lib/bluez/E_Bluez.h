@@ -24,10 +24,18 @@ extern int E_BLUEZ_EVENT_MANAGER_OUT;
 extern int E_BLUEZ_EVENT_ELEMENT_ADD;
 extern int E_BLUEZ_EVENT_ELEMENT_DEL;
 extern int E_BLUEZ_EVENT_ELEMENT_UPDATED;
+extern int E_BLUEZ_EVENT_ELEMENT_MOVED;
+extern int E_BLUEZ_EVENT_ELEMENTS_UPDATED;
+extern int E_BLUEZ_EVENT_ELEMENTS_SYNCED;
 extern int E_BLUEZ_EVENT_DEVICE_FOUND;
 // TODO: extern int E_BLUEZ_EVENT_DEVICE_DISAPPEARED;
 
 typedef struct _E_Bluez_Element        E_Bluez_Element;
+typedef struct _E_Bluez_Event_Elements_Updated E_Bluez_Event_Elements_Updated;
+typedef struct _E_Bluez_Element_Change E_Bluez_Element_Change;
+typedef struct _E_Bluez_Element_Changes E_Bluez_Element_Changes;
+typedef struct _E_Bluez_Elements_Iter E_Bluez_Elements_Iter;
+typedef union _E_Bluez_Value E_Bluez_Value;
 typedef struct _E_Bluez_Array          E_Bluez_Array;
 typedef struct _E_Bluez_Device_Found   E_Bluez_Device_Found;
 
@@ -56,6 +64,74 @@ struct _E_Bluez_Element
    } _idler;
    Eina_Inlist *_listeners;
    int          _references;
+   struct
+   {
+      void       **slots;
+      unsigned int size;
+      unsigned int count;
+   } _props_index;
+   Eina_Bool    _dirty;
+   Eina_Bool    _sync_queued;
+   Eina_Bool    _stale;
+   Eina_Bool    _synced;
+   unsigned int _index[2];
+   struct
+   {
+      E_Bluez_Element_Change *items;
+      unsigned int            count;
+      unsigned int            size;
+   } _changes;
+};
+
+/* value of a basic type, strings and object paths are stringshared */
+union _E_Bluez_Value
+{
+   Eina_Bool      boolean;
+   unsigned char  byte;
+   unsigned short u16;
+   unsigned int   u32;
+   const char    *str;
+};
+
+/* A property that changed since the last update.  old_type is
+ * DBUS_TYPE_INVALID for a new property and type is for one that went
+ * away.  Values are only given for basic types, for arrays and dicts
+ * read the property from the element.
+ */
+struct _E_Bluez_Element_Change
+{
+   const char   *name;
+   int           type;
+   int           old_type;
+   E_Bluez_Value value;
+   E_Bluez_Value old_value;
+};
+
+struct _E_Bluez_Element_Changes
+{
+   E_Bluez_Element_Change *items;
+   unsigned int            count;
+};
+
+/* borrowed iteration over the elements, see e_bluez_elements_iter_init().
+ * Lives on the caller's stack, the fields are private.
+ */
+struct _E_Bluez_Elements_Iter
+{
+   void * const      *_items;
+   unsigned int       _count;
+   unsigned int       _pos;
+   unsigned int       _generation;
+   Eina_Bool          _paths;
+};
+
+/* event info of E_BLUEZ_EVENT_ELEMENTS_UPDATED, valid during the event,
+ * changes[i] are those of elements[i] */
+struct _E_Bluez_Event_Elements_Updated
+{
+   unsigned int             count;
+   E_Bluez_Element        **elements;
+   E_Bluez_Element_Changes *changes;
 };
 
 struct _E_Bluez_Array
@@ -75,6 +151,12 @@ struct _E_Bluez_Device_Found
 EAPI unsigned int         e_bluez_system_init(E_DBus_Connection *edbus_conn) EINA_ARG_NONNULL(1);
 EAPI unsigned int         e_bluez_system_shutdown(void);
 
+EAPI void                 e_bluez_elements_sync_window_set(unsigned int window);
+EAPI unsigned int         e_bluez_elements_sync_window_get(void);
+
+EAPI Eina_Bool            e_bluez_elements_snapshot_save(const char *file) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool            e_bluez_elements_snapshot_load(const char *file) EINA_ARG_NONNULL(1);
+
 /* Manager Methods */
 EAPI E_Bluez_Element *    e_bluez_manager_get(void) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_bluez_manager_default_adapter(E_DBus_Method_Return_Cb cb, void *data) EINA_WARN_UNUSED_RESULT;
@@ -117,10 +199,15 @@ EAPI Eina_Bool            e_bluez_manager_sync_elements(void);
 
 EAPI Eina_Bool            e_bluez_elements_get_all(unsigned int *count, E_Bluez_Element ***p_elements) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_bluez_elements_get_all_type(const char *type, unsigned int *count, E_Bluez_Element ***p_elements) EINA_ARG_NONNULL(1, 2, 3) EINA_WARN_UNUSED_RESULT;
+EAPI void                 e_bluez_elements_iter_init(E_Bluez_Elements_Iter *iter, const char *interface) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool            e_bluez_element_objects_iter_init(E_Bluez_Elements_Iter *iter, const E_Bluez_Element *element, const char *property) EINA_ARG_NONNULL(1, 2, 3);
+EAPI E_Bluez_Element *    e_bluez_elements_iter_next(E_Bluez_Elements_Iter *iter) EINA_ARG_NONNULL(1);
 EAPI E_Bluez_Element *    e_bluez_element_get(const char *path);
 
 EAPI void                 e_bluez_element_listener_add(E_Bluez_Element *element, void (*cb)(void *data, const E_Bluez_Element *element), const void *data, void (*free_data)(void *data)) EINA_ARG_NONNULL(1, 2);
 EAPI void                 e_bluez_element_listener_del(E_Bluez_Element *element, void (*cb)(void *data, const E_Bluez_Element *element), const void *data) EINA_ARG_NONNULL(1, 2);
+EAPI void                 e_bluez_element_changes_listener_add(E_Bluez_Element *element, void (*cb)(void *data, const E_Bluez_Element *element, const E_Bluez_Element_Changes *changes), const void *data, void (*free_data)(void *data), const char **names) EINA_ARG_NONNULL(1, 2);
+EAPI void                 e_bluez_element_changes_listener_del(E_Bluez_Element *element, void (*cb)(void *data, const E_Bluez_Element *element, const E_Bluez_Element_Changes *changes), const void *data) EINA_ARG_NONNULL(1, 2);
 
 EAPI int                  e_bluez_element_ref(E_Bluez_Element *element) EINA_ARG_NONNULL(1);
 EAPI int                  e_bluez_element_unref(E_Bluez_Element *element) EINA_ARG_NONNULL(1);
@@ -130,6 +217,7 @@ EAPI void                 e_bluez_element_array_print(FILE *fp, E_Bluez_Array *a
 
 EAPI Eina_Bool            e_bluez_element_properties_sync(E_Bluez_Element *element) EINA_ARG_NONNULL(1);
 EAPI Eina_Bool            e_bluez_element_properties_sync_full(E_Bluez_Element *element, E_DBus_Method_Return_Cb cb, const void *data) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool            e_bluez_element_is_stale(const E_Bluez_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
 
 EAPI Eina_Bool            e_bluez_element_property_set(E_Bluez_Element *element, const char *prop, int type, const void *value) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_bluez_element_property_set_full(E_Bluez_Element *element, const char *prop, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
@@ -142,6 +230,7 @@ EAPI Eina_Bool            e_bluez_element_property_type_get(const E_Bluez_Elemen
 EAPI Eina_Bool            e_bluez_element_property_dict_get_stringshared(const E_Bluez_Element *element, const char *dict_name, const char *key_name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_bluez_element_property_get_stringshared(const E_Bluez_Element *element, const char *name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_bluez_element_property_get(const E_Bluez_Element *element, const char *name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
+EAPI Eina_Bool            e_bluez_element_strings_array_view(const E_Bluez_Element *element, const char *property, unsigned int *count, const char ***strings) EINA_ARG_NONNULL(1, 2, 3, 4) EINA_WARN_UNUSED_RESULT;
 
 EAPI Eina_Bool            e_bluez_element_is_adapter(const E_Bluez_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_bluez_element_is_device(const E_Bluez_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
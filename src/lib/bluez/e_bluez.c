@@ -16,6 +16,9 @@ EAPI int E_BLUEZ_EVENT_MANAGER_OUT = 0;
 EAPI int E_BLUEZ_EVENT_ELEMENT_ADD = 0;
 EAPI int E_BLUEZ_EVENT_ELEMENT_DEL = 0;
 EAPI int E_BLUEZ_EVENT_ELEMENT_UPDATED = 0;
+EAPI int E_BLUEZ_EVENT_ELEMENT_MOVED = 0;
+EAPI int E_BLUEZ_EVENT_ELEMENTS_UPDATED = 0;
+EAPI int E_BLUEZ_EVENT_ELEMENTS_SYNCED = 0;
 EAPI int E_BLUEZ_EVENT_DEVICE_FOUND = 0;
 
 const char *e_bluez_iface_manager = NULL;
@@ -61,7 +64,8 @@ e_bluez_system_bus_name_get(void)
  * and some element paths and then request their properties.
  *
  * This call will add events E_BLUEZ_EVENT_ELEMENT_ADD and
- * E_BLUEZ_EVENT_ELEMENT_UPDATED to the main loop.
+ * E_BLUEZ_EVENT_ELEMENT_UPDATED to the main loop, then
+ * E_BLUEZ_EVENT_ELEMENTS_SYNCED once all their properties arrived.
  *
  * This will not remove stale elements.
  *
@@ -77,7 +81,7 @@ e_bluez_manager_sync_elements(void)
 
    manager = e_bluez_element_register(manager_path, e_bluez_iface_manager);
    if (manager)
-      e_bluez_element_properties_sync(manager);
+      e_bluez_elements_sync(manager);
    else
       return EINA_FALSE;
 
@@ -198,6 +202,15 @@ _e_bluez_get_name_owner(void *data __UNUSED__, DBusMessage *msg, DBusError *err)
  *   - E_BLUEZ_EVENT_ELEMENT_DEL: element was deleted.
  *   - E_BLUEZ_EVENT_ELEMENT_UPDATED: element was updated (properties
  *     or state changed).
+ *   - E_BLUEZ_EVENT_ELEMENT_MOVED: element changed position in the list
+ *     property of another element, get that list again for the new order.
+ *   - E_BLUEZ_EVENT_ELEMENTS_UPDATED: all the elements updated during the
+ *     last main loop iteration, as E_Bluez_Event_Elements_Updated with
+ *     the properties that changed on each.  Each one also gets its own
+ *     E_BLUEZ_EVENT_ELEMENT_UPDATED.
+ *   - E_BLUEZ_EVENT_ELEMENTS_SYNCED: the properties of all the elements
+ *     found after the manager came in have arrived, no event information.
+ *     At most e_bluez_elements_sync_window_get() of them are fetched at once.
  *   - E_BLUEZ_EVENT_DEVICE_FOUND: a device was found, raised after calling
  *     Adapter.StartDiscorvery()
  *
@@ -241,6 +254,15 @@ e_bluez_system_init(E_DBus_Connection *edbus_conn)
    if (E_BLUEZ_EVENT_ELEMENT_UPDATED == 0)
       E_BLUEZ_EVENT_ELEMENT_UPDATED = ecore_event_type_new();
 
+   if (E_BLUEZ_EVENT_ELEMENT_MOVED == 0)
+      E_BLUEZ_EVENT_ELEMENT_MOVED = ecore_event_type_new();
+
+   if (E_BLUEZ_EVENT_ELEMENTS_UPDATED == 0)
+      E_BLUEZ_EVENT_ELEMENTS_UPDATED = ecore_event_type_new();
+
+   if (E_BLUEZ_EVENT_ELEMENTS_SYNCED == 0)
+      E_BLUEZ_EVENT_ELEMENTS_SYNCED = ecore_event_type_new();
+
    if (E_BLUEZ_EVENT_DEVICE_FOUND == 0)
       E_BLUEZ_EVENT_DEVICE_FOUND = ecore_event_type_new();
 
@@ -2,8 +2,32 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "e_dbus_probes.h"
+
+E_DBUS_PROBE_DEFINE(ebluez, property_update);
 
 static Eina_Hash *elements = NULL;
+/* one PropertyChanged match for all elements, routed by path and interface */
+static E_DBus_Signal_Handler *property_changed_handler = NULL;
+/* elements with changes not yet delivered, see _elements_changed_flush() */
+static Eina_Array *changed_elements = NULL;
+static Ecore_Idle_Enterer *changed_flush = NULL;
+/* elements waiting for their GetProperties, see _elements_sync_pump() */
+static Eina_List *sync_queue = NULL;
+static unsigned int sync_in_flight = 0;
+/* calls from before the last shutdown complete late, see _sync_done() */
+static unsigned int sync_generation = 0;
+static unsigned int sync_window = 8;
+static Eina_Bool sync_initial = EINA_FALSE;
+/* manager whose GetProperties was sent outside of the queue */
+static E_Bluez_Element *sync_manager = NULL;
+/* bumped whenever an iterator would go stale, see _elements_index_add() */
+static unsigned int elements_generation = 0;
 
 typedef struct _E_Bluez_Element_Pending     E_Bluez_Element_Pending;
 typedef struct _E_Bluez_Element_Call_Data   E_Bluez_Element_Call_Data;
@@ -42,14 +66,17 @@ struct _E_Bluez_Element_Property
       void          *variant;
       E_Bluez_Array *array;
    } value;
+   Eina_Bool   stale; /* from a snapshot, not sent again yet */
 };
 
 struct _E_Bluez_Element_Listener
 {
          EINA_INLIST;
    void  (*cb)(void *data, const E_Bluez_Element *element);
+   void  (*changes_cb)(void *data, const E_Bluez_Element *element, const E_Bluez_Element_Changes *changes);
    void *data;
    void  (*free_data)(void *data);
+   const char **names; /* stringshared and NULL terminated, or NULL for all */
 };
 
 static void
@@ -105,6 +132,20 @@ e_bluez_element_pending_cancel_and_free(Eina_Inlist **pending)
      }
 }
 
+static void
+_e_bluez_element_listener_names_free(const char **names)
+{
+   const char **name;
+
+   if (!names)
+      return;
+
+   for (name = names; *name; name++)
+      eina_stringshare_del(*name);
+
+   free(names);
+}
+
 void
 e_bluez_element_listener_add(E_Bluez_Element *element, void (*cb)(void *data, const E_Bluez_Element *element), const void *data, void (*free_data)(void *data))
 {
@@ -130,8 +171,10 @@ e_bluez_element_listener_add(E_Bluez_Element *element, void (*cb)(void *data, co
      }
 
    l->cb = cb;
+   l->changes_cb = NULL;
    l->data = (void *)data;
    l->free_data = free_data;
+   l->names = NULL;
 
    element->_listeners = eina_inlist_append
          (element->_listeners, EINA_INLIST_GET(l));
@@ -159,13 +202,149 @@ e_bluez_element_listener_del(E_Bluez_Element *element, void (*cb)(void *data, co
         if (l->free_data)
            l->free_data(l->data);
 
+        _e_bluez_element_listener_names_free(l->names);
+        free(l);
+        return;
+     }
+}
+
+/**
+ * Add a listener that is told which properties changed.
+ *
+ * Like e_bluez_element_listener_add(), but @a cb also gets the changes
+ * of this update, see E_Bluez_Element_Change.  With @a names, a NULL terminated
+ * array of property names, it is only called when one of them changed.
+ *
+ * @param element element to listen to.
+ * @param cb function to call on updates.
+ * @param data data to give to cb.
+ * @param free_data function to free data when the listener is removed.
+ * @param names properties to listen to, or NULL for all of them.
+ */
+void
+e_bluez_element_changes_listener_add(E_Bluez_Element *element, void (*cb)(void *data, const E_Bluez_Element *element, const E_Bluez_Element_Changes *changes), const void *data, void (*free_data)(void *data), const char **names)
+{
+   E_Bluez_Element_Listener *l;
+   unsigned int i, count = 0;
+
+   EINA_SAFETY_ON_FALSE_GOTO(element, error);
+   EINA_SAFETY_ON_FALSE_GOTO(cb, error);
+
+   l = malloc(sizeof(*l));
+   if (!l)
+     {
+        ERR("could not allocate E_Bluez_Element_Listener");
+        goto error;
+     }
+
+   l->cb = NULL;
+   l->changes_cb = cb;
+   l->data = (void *)data;
+   l->free_data = free_data;
+   l->names = NULL;
+
+   if (names)
+     {
+        while (names[count])
+           count++;
+
+        l->names = malloc((count + 1) * sizeof(char *));
+        if (!l->names)
+          {
+             ERR("could not allocate the names of E_Bluez_Element_Listener");
+             free(l);
+             goto error;
+          }
+
+        for (i = 0; i < count; i++)
+           l->names[i] = eina_stringshare_add(names[i]);
+        l->names[count] = NULL;
+     }
+
+   element->_listeners = eina_inlist_append
+         (element->_listeners, EINA_INLIST_GET(l));
+
+   return;
+
+error:
+   if (free_data)
+      free_data((void *)data);
+}
+
+void
+e_bluez_element_changes_listener_del(E_Bluez_Element *element, void (*cb)(void *data, const E_Bluez_Element *element, const E_Bluez_Element_Changes *changes), const void *data)
+{
+   E_Bluez_Element_Listener *l;
+
+   EINA_SAFETY_ON_NULL_RETURN(element);
+   EINA_SAFETY_ON_NULL_RETURN(cb);
+
+   EINA_INLIST_FOREACH(element->_listeners, l)
+   if ((l->changes_cb == cb) && (l->data == data))
+     {
+        element->_listeners = eina_inlist_remove
+              (element->_listeners, EINA_INLIST_GET(l));
+        if (l->free_data)
+           l->free_data(l->data);
+
+        _e_bluez_element_listener_names_free(l->names);
         free(l);
         return;
      }
 }
 
 static void
-_e_bluez_element_listeners_call_do(E_Bluez_Element *element)
+_e_bluez_element_listener_call(E_Bluez_Element *element, E_Bluez_Element_Listener *l, const E_Bluez_Element_Changes *changes)
+{
+   if (l->changes_cb)
+      l->changes_cb(l->data, element, changes);
+   else
+      l->cb(l->data, element);
+}
+
+/* listeners with names only wake for changes of those properties */
+static Eina_Bool
+_e_bluez_element_listener_wants(const E_Bluez_Element_Listener *l, const E_Bluez_Element_Changes *changes)
+{
+   const char **name;
+   unsigned int i;
+
+   if (!l->names)
+      return EINA_TRUE;
+
+   for (i = 0; i < changes->count; i++)
+      for (name = l->names; *name; name++)
+         if (changes->items[i].name == *name)
+            return EINA_TRUE;
+
+   return EINA_FALSE;
+}
+
+static void
+_e_bluez_element_listener_run(E_Bluez_Element *element, E_Bluez_Element_Listener *l, const E_Bluez_Element_Changes *changes)
+{
+   E_DBus_Connection *conn = e_bluez_conn;
+   const char *interface, *path;
+   double start;
+
+   start = conn ? e_dbus_connection_handler_begin(conn) : 0.0;
+   if (start <= 0.0)
+     {
+        _e_bluez_element_listener_call(element, l, changes);
+        return;
+     }
+
+   /* the listener may free the element */
+   interface = eina_stringshare_ref(element->interface);
+   path = eina_stringshare_ref(element->path);
+   _e_bluez_element_listener_call(element, l, changes);
+   e_dbus_connection_handler_end(conn, start, "listener", interface, path);
+   eina_stringshare_del(interface);
+   eina_stringshare_del(path);
+}
+
+static void
+_e_bluez_element_listeners_call_do(E_Bluez_Element *element, const E_Bluez_Element_Changes *changes)
 {
    E_Bluez_Element_Listener *l, **shadow;
    unsigned int i, count;
@@ -187,162 +366,513 @@ _e_bluez_element_listeners_call_do(E_Bluez_Element *element)
    shadow[i++] = l;
 
    for (i = 0; i < count; i++)
-      shadow[i]->cb(shadow[i]->data, element);
+      if (_e_bluez_element_listener_wants(shadow[i], changes))
+         _e_bluez_element_listener_run(element, shadow[i], changes);
 
 end:
    e_bluez_element_event_add(E_BLUEZ_EVENT_ELEMENT_UPDATED, element);
 }
 
-static Eina_Bool
-_e_bluez_element_listeners_call_idler(void *data)
-{
-   E_Bluez_Element *element = data;
-   _e_bluez_element_listeners_call_do(element);
-   element->_idler.changed = NULL;
-   return ECORE_CALLBACK_CANCEL;
-}
-
-static void
-_e_bluez_element_listeners_call(E_Bluez_Element *element)
-{
-   if (element->_idler.changed)
-      return;
-
-   element->_idler.changed = ecore_idler_add
-         (_e_bluez_element_listeners_call_idler, element);
-}
-
-/***********************************************************************
-* Property
-***********************************************************************/
-
 static void
-_e_bluez_element_dict_entry_free(E_Bluez_Element_Dict_Entry *entry)
+_e_bluez_element_value_keep(const E_Bluez_Element_Property *p, E_Bluez_Value *v)
 {
-   switch (entry->type)
+   memset(v, 0, sizeof(*v));
+   switch (p->type)
      {
       case DBUS_TYPE_BOOLEAN:
+         v->boolean = p->value.boolean;
+         break;
+
       case DBUS_TYPE_BYTE:
-      case DBUS_TYPE_INT16:
+         v->byte = p->value.byte;
+         break;
+
       case DBUS_TYPE_UINT16:
-      case DBUS_TYPE_UINT32:
+         v->u16 = p->value.u16;
          break;
 
-      case DBUS_TYPE_OBJECT_PATH:
-         eina_stringshare_del(entry->value.path);
+      case DBUS_TYPE_UINT32:
+         v->u32 = p->value.u32;
          break;
 
       case DBUS_TYPE_STRING:
-         eina_stringshare_del(entry->value.str);
+         v->str = eina_stringshare_ref(p->value.str);
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         v->str = eina_stringshare_ref(p->value.path);
          break;
 
       default:
-         ERR("don't know how to free dict entry '%s' of type %c (%d)",
-             entry->name, entry->type, entry->type);
+         break;
      }
-
-   eina_stringshare_del(entry->name);
-   free(entry);
 }
 
-static E_Bluez_Element_Dict_Entry *
-_e_bluez_element_dict_entry_new(DBusMessageIter *itr)
+static void
+_e_bluez_element_value_release(int type, E_Bluez_Value *v)
 {
-   E_Bluez_Element_Dict_Entry *entry;
-   DBusMessageIter e_itr, v_itr;
-   int t;
-   const char *key = NULL;
-   void *value = NULL;
+   if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+      eina_stringshare_del(v->str);
+}
 
-   dbus_message_iter_recurse(itr, &e_itr);
+/* Records that p changed for the next flush.  A property changed twice
+ * before it keeps its first old value.  Takes over old.
+ */
+static void
+_e_bluez_element_change_add(E_Bluez_Element *element, const E_Bluez_Element_Property *p, int old_type, E_Bluez_Value *old)
+{
+   E_Bluez_Element_Change *c;
+   unsigned int i;
 
-   t = dbus_message_iter_get_arg_type(&e_itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+   for (i = 0; i < element->_changes.count; i++)
      {
-        ERR("invalid format for dict entry. first type not a string: %c (%d)",
-            t, t);
-        return NULL;
+        c = element->_changes.items + i;
+        if (c->name != p->name)
+           continue;
+
+        _e_bluez_element_value_release(old_type, old);
+        _e_bluez_element_value_release(c->type, &c->value);
+        c->type = p->type;
+        _e_bluez_element_value_keep(p, &c->value);
+        return;
      }
 
-   dbus_message_iter_get_basic(&e_itr, &key);
-   if (!key || !key[0])
+   if (element->_changes.count == element->_changes.size)
      {
-        ERR("invalid format for dict entry. no key.");
-        return NULL;
+        unsigned int size = element->_changes.size ? element->_changes.size * 2 : 4;
+
+        c = realloc(element->_changes.items, size * sizeof(E_Bluez_Element_Change));
+        if (!c)
+          {
+             ERR("could not record the change of %s on %s",
+                 p->name, element->path);
+             _e_bluez_element_value_release(old_type, old);
+             return;
+          }
+
+        element->_changes.items = c;
+        element->_changes.size = size;
      }
 
-   dbus_message_iter_next(&e_itr);
-   t = dbus_message_iter_get_arg_type(&e_itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+   c = element->_changes.items + element->_changes.count++;
+   c->name = eina_stringshare_ref(p->name);
+   c->type = p->type;
+   _e_bluez_element_value_keep(p, &c->value);
+   c->old_type = old_type;
+   c->old_value = *old;
+}
+
+static void
+_e_bluez_element_changes_free(E_Bluez_Element_Changes *changes)
+{
+   unsigned int i;
+
+   for (i = 0; i < changes->count; i++)
      {
-        ERR("invalid format for dict entry '%s'. "
-            "second type not a variant: %c (%d)",
-            key, t, t);
-        return NULL;
+        E_Bluez_Element_Change *c = changes->items + i;
+
+        _e_bluez_element_value_release(c->type, &c->value);
+        _e_bluez_element_value_release(c->old_type, &c->old_value);
+        eina_stringshare_del(c->name);
      }
 
-   dbus_message_iter_recurse(&e_itr, &v_itr);
+   free(changes->items);
+   changes->items = NULL;
+   changes->count = 0;
+}
 
-   t = dbus_message_iter_get_arg_type(&v_itr);
-   if ((t == DBUS_TYPE_INVALID) || (t == DBUS_TYPE_ARRAY))
+/* moves the changes recorded on element to changes */
+static void
+_e_bluez_element_changes_take(E_Bluez_Element *element, E_Bluez_Element_Changes *changes)
+{
+   changes->items = element->_changes.items;
+   changes->count = element->_changes.count;
+   element->_changes.items = NULL;
+   element->_changes.count = 0;
+   element->_changes.size = 0;
+}
+
+static void
+_e_bluez_elements_updated_free(void *data __UNUSED__, void *ev)
+{
+   E_Bluez_Event_Elements_Updated *event = ev;
+   unsigned int i;
+
+   for (i = 0; i < event->count; i++)
      {
-        ERR("invalid type for dict value for entry '%s': %c (%d)",
-            key, t, t);
-        return NULL;
+        _e_bluez_element_changes_free(event->changes + i);
+        e_bluez_element_unref(event->elements[i]);
      }
 
-   entry = calloc(1, sizeof(*entry));
-   if (!entry)
+   free(event);
+}
+
+/* Changed elements wait in a dirty set, each with a reference, until the
+ * main loop is about to go idle.  Then their listeners run and a single
+ * E_BLUEZ_EVENT_ELEMENTS_UPDATED carries them all.
+ */
+static Eina_Bool
+_e_bluez_elements_changed_flush(void *data __UNUSED__)
+{
+   E_Bluez_Event_Elements_Updated *event;
+   Eina_Array *changed = changed_elements;
+   unsigned int i, count;
+
+   /* elements changed by the listeners go to the next batch */
+   changed_elements = NULL;
+   changed_flush = NULL;
+
+   count = eina_array_count(changed);
+   event = malloc(sizeof(*event) +
+                  count * (sizeof(E_Bluez_Element_Changes) + sizeof(E_Bluez_Element *)));
+   if (event)
      {
-        ERR("could not allocate memory for dict entry.");
-        return NULL;
+        event->count = 0;
+        event->changes = (E_Bluez_Element_Changes *)(event + 1);
+        event->elements = (E_Bluez_Element **)(event->changes + count);
      }
+   else
+      ERR("could not allocate the updated elements event");
 
-   dbus_message_iter_get_basic(&v_itr, &value);
-   switch (t)
+   for (i = 0; i < count; i++)
      {
-      case DBUS_TYPE_BOOLEAN:
-         entry->value.boolean = (Eina_Bool)(long)value;
-         break;
+        E_Bluez_Element *element = eina_array_data_get(changed, i);
+        E_Bluez_Element_Changes changes;
+
+        element->_dirty = EINA_FALSE;
+        _e_bluez_element_changes_take(element, &changes);
+        /* skip those unregistered meanwhile, they got their DEL event, and
+         * all of them if a listener shut the system down */
+        if ((elements) && (eina_hash_find(elements, element->path) == element))
+          {
+             _e_bluez_element_listeners_call_do(element, &changes);
+             if (event)
+               {
+                  event->changes[event->count] = changes;
+                  event->elements[event->count++] = element;
+                  continue;
+               }
+          }
 
-      case DBUS_TYPE_BYTE:
-         entry->value.byte = (unsigned char)(long)value;
-         break;
+        _e_bluez_element_changes_free(&changes);
+        e_bluez_element_unref(element);
+     }
 
-      case DBUS_TYPE_INT16:
-         entry->value.i16 = (short)(long)value;
-         break;
+   eina_array_free(changed);
 
-      case DBUS_TYPE_UINT16:
-         entry->value.u16 = (unsigned short)(long)value;
-         break;
+   if ((event) && (event->count))
+      ecore_event_add(E_BLUEZ_EVENT_ELEMENTS_UPDATED, event,
+                      _e_bluez_elements_updated_free, NULL);
+   else
+      free(event);
 
-      case DBUS_TYPE_UINT32:
-         entry->value.u32 = (unsigned int)(long)value;
-         break;
+   return ECORE_CALLBACK_CANCEL;
+}
 
-      case DBUS_TYPE_STRING:
-         entry->value.str = eina_stringshare_add(value);
-         break;
+static void
+_e_bluez_element_listeners_call(E_Bluez_Element *element)
+{
+   if (element->_dirty)
+      return;
 
-      case DBUS_TYPE_OBJECT_PATH:
-         entry->value.path = eina_stringshare_add(value);
-         break;
+   if (!changed_elements)
+     {
+        changed_elements = eina_array_new(32);
+        if (!changed_elements)
+          {
+             ERR("could not allocate the changed elements");
+             return;
+          }
+     }
 
-      default:
-         ERR("don't know how to create dict entry '%s' for of type %c (%d)",
-             key, t, t);
-         free(entry);
-         return NULL;
+   if (!eina_array_push(changed_elements, element))
+     {
+        ERR("could not mark element %s as changed", element->path);
+        return;
      }
 
-   entry->name = eina_stringshare_add(key);
-   entry->type = t;
-   return entry;
+   element->_dirty = EINA_TRUE;
+   e_bluez_element_ref(element);
+
+   if (!changed_flush)
+      changed_flush = ecore_idle_enterer_add
+            (_e_bluez_elements_changed_flush, NULL);
 }
 
-E_Bluez_Element_Dict_Entry *
-e_bluez_element_array_dict_find_stringshared(const E_Bluez_Array *array, const char *key)
+/* GetProperties of the elements go through a queue, at most sync_window
+ * of them in flight, so the elements found in the manager's reply are
+ * fetched in parallel instead of all at once or one after the other.
+ * Once the queue started by e_bluez_elements_sync() drains, a single
+ * E_BLUEZ_EVENT_ELEMENTS_SYNCED tells everything is known.
+ */
+static void _e_bluez_elements_sync_pump(void);
+
+static void
+_e_bluez_element_sync_done(void *data, DBusMessage *msg __UNUSED__, DBusError *err __UNUSED__)
+{
+   /* canceled along with the elements of an older sync, not counted */
+   if ((unsigned long)data != sync_generation)
+      return;
+
+   if (sync_in_flight > 0)
+      sync_in_flight--;
+   _e_bluez_elements_sync_pump();
+}
+
+static void
+_e_bluez_elements_sync_pump(void)
+{
+   while ((sync_queue) && ((!sync_window) || (sync_in_flight < sync_window)))
+     {
+        E_Bluez_Element *element = eina_list_data_get(sync_queue);
+
+        sync_queue = eina_list_remove_list(sync_queue, sync_queue);
+        element->_sync_queued = EINA_FALSE;
+        /* skip those unregistered while waiting */
+        if ((elements) && (eina_hash_find(elements, element->path) == element))
+          {
+             if (e_bluez_element_properties_sync_full
+                    (element, _e_bluez_element_sync_done,
+                    (void *)(unsigned long)sync_generation))
+                sync_in_flight++;
+             else
+                WRN("could not get properties of %s", element->path);
+          }
+        e_bluez_element_unref(element);
+     }
+
+   if ((sync_initial) && (!sync_queue) && (!sync_in_flight))
+     {
+        sync_initial = EINA_FALSE;
+        DBG("all elements synced");
+        ecore_event_add(E_BLUEZ_EVENT_ELEMENTS_SYNCED, NULL, NULL, NULL);
+     }
+}
+
+static void
+_e_bluez_elements_sync_clear(void)
+{
+   E_Bluez_Element *element;
+
+   sync_initial = EINA_FALSE;
+   sync_manager = NULL;
+   EINA_LIST_FREE(sync_queue, element)
+   {
+      element->_sync_queued = EINA_FALSE;
+      e_bluez_element_unref(element);
+   }
+}
+
+/**
+ * Queue a GetProperties() of the given element.
+ *
+ * Nothing is queued if the element is already waiting or if its
+ * properties are on their way.
+ * @internal
+ */
+void
+e_bluez_element_sync_queue(E_Bluez_Element *element)
+{
+   unsigned int count;
+
+   EINA_SAFETY_ON_NULL_RETURN(element);
+
+   if ((element->_sync_queued) || (element->_pending.properties_get))
+      return;
+
+   count = eina_list_count(sync_queue);
+   sync_queue = eina_list_append(sync_queue, element);
+   if (eina_list_count(sync_queue) == count)
+     {
+        ERR("could not queue the sync of %s", element->path);
+        return;
+     }
+
+   element->_sync_queued = EINA_TRUE;
+   e_bluez_element_ref(element);
+   _e_bluez_elements_sync_pump();
+}
+
+/**
+ * Start the initial sync from the manager.
+ *
+ * E_BLUEZ_EVENT_ELEMENTS_SYNCED is posted once the properties of the manager
+ * and of all the elements found from it arrived.
+ * @internal
+ */
+void
+e_bluez_elements_sync(E_Bluez_Element *manager)
+{
+   EINA_SAFETY_ON_NULL_RETURN(manager);
+
+   sync_initial = EINA_TRUE;
+   /* already on its way outside of the queue, wait for that reply */
+   if ((manager->_pending.properties_get) && (!sync_manager))
+     {
+        sync_manager = manager;
+        sync_in_flight++;
+     }
+   else
+      e_bluez_element_sync_queue(manager);
+}
+
+/**
+ * Set how many GetProperties() may be in flight at once.
+ *
+ * The default of 8 keeps the server busy without flooding it.  Zero
+ * removes the limit.
+ *
+ * @param window maximum number of calls waiting for a reply.
+ */
+void
+e_bluez_elements_sync_window_set(unsigned int window)
+{
+   sync_window = window;
+   _e_bluez_elements_sync_pump();
+}
+
+/**
+ * Get how many GetProperties() may be in flight at once.
+ *
+ * @return the window, zero if unlimited.
+ */
+unsigned int
+e_bluez_elements_sync_window_get(void)
+{
+   return sync_window;
+}
+
+/***********************************************************************
+* Property
+***********************************************************************/
+
+static void
+_e_bluez_element_dict_entry_free(E_Bluez_Element_Dict_Entry *entry)
+{
+   switch (entry->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+      case DBUS_TYPE_BYTE:
+      case DBUS_TYPE_INT16:
+      case DBUS_TYPE_UINT16:
+      case DBUS_TYPE_UINT32:
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         eina_stringshare_del(entry->value.path);
+         break;
+
+      case DBUS_TYPE_STRING:
+         eina_stringshare_del(entry->value.str);
+         break;
+
+      default:
+         ERR("don't know how to free dict entry '%s' of type %c (%d)",
+             entry->name, entry->type, entry->type);
+     }
+
+   eina_stringshare_del(entry->name);
+   free(entry);
+}
+
+static E_Bluez_Element_Dict_Entry *
+_e_bluez_element_dict_entry_new(DBusMessageIter *itr)
+{
+   E_Bluez_Element_Dict_Entry *entry;
+   DBusMessageIter e_itr, v_itr;
+   int t;
+   const char *key = NULL;
+   void *value = NULL;
+
+   dbus_message_iter_recurse(itr, &e_itr);
+
+   t = dbus_message_iter_get_arg_type(&e_itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+     {
+        ERR("invalid format for dict entry. first type not a string: %c (%d)",
+            t, t);
+        return NULL;
+     }
+
+   dbus_message_iter_get_basic(&e_itr, &key);
+   if (!key || !key[0])
+     {
+        ERR("invalid format for dict entry. no key.");
+        return NULL;
+     }
+
+   dbus_message_iter_next(&e_itr);
+   t = dbus_message_iter_get_arg_type(&e_itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+     {
+        ERR("invalid format for dict entry '%s'. "
+            "second type not a variant: %c (%d)",
+            key, t, t);
+        return NULL;
+     }
+
+   dbus_message_iter_recurse(&e_itr, &v_itr);
+
+   t = dbus_message_iter_get_arg_type(&v_itr);
+   if ((t == DBUS_TYPE_INVALID) || (t == DBUS_TYPE_ARRAY))
+     {
+        ERR("invalid type for dict value for entry '%s': %c (%d)",
+            key, t, t);
+        return NULL;
+     }
+
+   entry = calloc(1, sizeof(*entry));
+   if (!entry)
+     {
+        ERR("could not allocate memory for dict entry.");
+        return NULL;
+     }
+
+   dbus_message_iter_get_basic(&v_itr, &value);
+   switch (t)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         entry->value.boolean = (Eina_Bool)(long)value;
+         break;
+
+      case DBUS_TYPE_BYTE:
+         entry->value.byte = (unsigned char)(long)value;
+         break;
+
+      case DBUS_TYPE_INT16:
+         entry->value.i16 = (short)(long)value;
+         break;
+
+      case DBUS_TYPE_UINT16:
+         entry->value.u16 = (unsigned short)(long)value;
+         break;
+
+      case DBUS_TYPE_UINT32:
+         entry->value.u32 = (unsigned int)(long)value;
+         break;
+
+      case DBUS_TYPE_STRING:
+         entry->value.str = eina_stringshare_add(value);
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         entry->value.path = eina_stringshare_add(value);
+         break;
+
+      default:
+         ERR("don't know how to create dict entry '%s' for of type %c (%d)",
+             key, t, t);
+         free(entry);
+         return NULL;
+     }
+
+   entry->name = eina_stringshare_add(key);
+   entry->type = t;
+   return entry;
+}
+
+E_Bluez_Element_Dict_Entry *
+e_bluez_element_array_dict_find_stringshared(const E_Bluez_Array *array, const char *key)
 {
    E_Bluez_Element_Dict_Entry *entry;
    Eina_Array_Iterator iterator;
@@ -398,6 +928,16 @@ e_bluez_element_array_free(E_Bluez_Array *array, E_Bluez_Array *new __UNUSED__)
    free(array);
 }
 
+/* iterators may borrow the object paths of a property, stop them */
+static void
+_e_bluez_element_property_array_free(E_Bluez_Array *array)
+{
+   if ((array) && (array->type == DBUS_TYPE_OBJECT_PATH))
+      elements_generation++;
+
+   e_bluez_element_array_free(array, NULL);
+}
+
 static void
 _e_bluez_element_property_value_free(E_Bluez_Element_Property *property)
 {
@@ -421,7 +961,7 @@ _e_bluez_element_property_value_free(E_Bluez_Element_Property *property)
          break;
 
       case DBUS_TYPE_ARRAY:
-         e_bluez_element_array_free(property->value.array, NULL);
+         _e_bluez_element_property_array_free(property->value.array);
          break;
 
       default:
@@ -473,24 +1013,32 @@ _e_bluez_element_item_register(const char *key, const char *item)
    if (!interface)
       return;
 
+   /* those synced already follow their PropertyChanged signals */
    element = e_bluez_element_register(item, interface);
-   if ((element) && (!e_bluez_element_properties_sync(element)))
-      WRN("could not get properties of %s", element->path);
+   if ((element) && (!element->_synced))
+      e_bluez_element_sync_queue(element);
 }
 
-/* Match 2 arrays to find which are new and which are old elements
+/* Match 2 arrays to find which are new, which are old and which moved
  * For new elements, register them under prop_name property
  * For old elements, unregister them, sending proper DEL event
+ * For elements still there but out of order, send a MOVED event
+ *
+ * Items are stringshares, so they are matched by pointer against a hash
+ * of the old positions.  The moved ones are those left out of the longest
+ * run of kept items that is still in the old order, so raising one item
+ * to the top of a long list reports just that item.
  */
+#define ARRAY_MATCH_IN_ORDER ((unsigned int)-1)
+
 static void
 _e_bluez_element_array_match(E_Bluez_Array *old, E_Bluez_Array *new, const char *prop_name)
 {
-   Eina_List *deleted = NULL;
-   Eina_Array_Iterator iter_old, iter_new;
-   unsigned int i_old = 0, i_new = 0;
-   void *item_old, *item_new;
-   Eina_List *l;
-   void *data;
+   unsigned int n_old, n_new, n_kept = 0, n_run = 0, i;
+   unsigned int *from, *to, *tails, *prev;
+   Eina_Hash *positions;
+   E_Bluez_Element *e;
+   void *item;
 
    if (!old)
       return;
@@ -498,94 +1046,180 @@ _e_bluez_element_array_match(E_Bluez_Array *old, E_Bluez_Array *new, const char
    if (old->type != DBUS_TYPE_OBJECT_PATH)
       return;
 
-   if ((!new) || (!new->array) || eina_array_count(new->array) == 0)
+   n_old = old->array ? eina_array_count(old->array) : 0;
+   n_new = ((new) && (new->array)) ? eina_array_count(new->array) : 0;
+   if ((n_old == 0) && (n_new == 0))
+      return;
+
+   positions = eina_hash_pointer_new(NULL);
+   from = malloc(4 * (n_new + 1) * sizeof(unsigned int));
+   if ((!positions) || (!from))
+     {
+        ERR("could not match the items of %s", prop_name);
+        if (positions)
+           eina_hash_free(positions);
+
+        free(from);
+        return;
+     }
+   to = from + n_new + 1;
+   tails = to + n_new + 1;
+   prev = tails + n_new + 1;
+
+   for (i = 0; i < n_old; i++)
      {
-        if ((!old) || (!old->array) || eina_array_count(old->array) == 0)
+        item = eina_array_data_get(old->array, i);
+        if (!eina_hash_find(positions, &item))
+           eina_hash_add(positions, &item, (void *)(uintptr_t)(i + 1));
+     }
+
+   /* from[] and to[] are the old and new indexes of each kept item */
+   for (i = 0; i < n_new; i++)
+     {
+        uintptr_t pos;
+
+        item = eina_array_data_get(new->array, i);
+        pos = (uintptr_t)eina_hash_find(positions, &item);
+        if (pos)
           {
-             return;
+             eina_hash_del_by_key(positions, &item);
+             from[n_kept] = pos - 1;
+             to[n_kept] = i;
+             n_kept++;
           }
         else
           {
-             iter_old = old->array->data;
-             goto out_remove_remaining;
+             _e_bluez_element_item_register(prop_name, item);
+             DBG("Add element %s\n", (const char *)item);
           }
      }
 
-   iter_new = new->array->data;
-   item_new = *iter_new;
-   EINA_ARRAY_ITER_NEXT(old->array, i_old, item_old, iter_old)
-   {
-      if (item_old == item_new)
-        {
-           i_new++;
-           if (i_new >= eina_array_count(new->array))
-             {
-                i_old++;
-                break;
-             }
-
-           iter_new++;
-           item_new = *iter_new;
-        }
-      else
-        {
-           deleted = eina_list_append(deleted, item_old);
-        }
-   }
+   /* whatever is still in positions is gone */
+   for (i = 0; i < n_old; i++)
+     {
+        item = eina_array_data_get(old->array, i);
+        if (!eina_hash_find(positions, &item))
+           continue;
+
+        eina_hash_del_by_key(positions, &item);
+        e = e_bluez_element_get(item);
+        if (e)
+           e_bluez_element_unregister(e);
 
-   for(; i_new < eina_array_count(new->array); iter_new++, i_new++)
+        DBG("Delete element %s\n", (const char *)item);
+     }
+   eina_hash_free(positions);
+
+   /* longest increasing run of from[], tails[k] ends the best of length k + 1 */
+   for (i = 0; i < n_kept; i++)
      {
-        Eina_Bool found = EINA_FALSE;
-        item_new = *iter_new;
-        if (!item_new)
-           break;
+        unsigned int lo = 0, hi = n_run;
 
-        EINA_LIST_FOREACH(deleted, l, data)
-        {
-           if (data == item_new)
-             {
-                deleted = eina_list_remove_list(deleted, l);
-                found = EINA_TRUE;
-                break;
-             }
-        }
-        if (!found)
+        while (lo < hi)
           {
-             _e_bluez_element_item_register(prop_name, item_new);
-             DBG("Add element %s\n", (const char *)item_new);
+             unsigned int mid = (lo + hi) / 2;
+
+             if (from[tails[mid]] < from[i])
+                lo = mid + 1;
+             else
+                hi = mid;
           }
-     }
 
-   /* everybody after i_old on old->array + everybody from deleted list
-      will be removed
-    */
-   EINA_LIST_FREE(deleted, data)
-   {
-      E_Bluez_Element *e = e_bluez_element_get(data);
-      if (e)
-         e_bluez_element_unregister(e);
+        prev[i] = lo ? tails[lo - 1] : ARRAY_MATCH_IN_ORDER;
+        tails[lo] = i;
+        if (lo == n_run)
+           n_run++;
+     }
 
-      DBG("Delete element %s\n", (const char *)data);
-   }
+   if (n_run)
+      for (i = tails[n_run - 1]; i != ARRAY_MATCH_IN_ORDER; i = prev[i])
+         to[i] = ARRAY_MATCH_IN_ORDER;
 
-out_remove_remaining:
-   for(; i_old < eina_array_count(old->array); iter_old++, i_old++)
+   for (i = 0; i < n_kept; i++)
      {
-        E_Bluez_Element *e;
-        item_old = *iter_old;
-        if (!item_old)
-           break;
+        if (to[i] == ARRAY_MATCH_IN_ORDER)
+           continue;
 
-        e = e_bluez_element_get(item_old);
-        if (e)
-           e_bluez_element_unregister(e);
+        item = eina_array_data_get(new->array, to[i]);
+        e = e_bluez_element_get(item);
+        if (!e)
+           continue;
 
-        DBG("Delete element %s\n", (const char *)item_old);
+        e_bluez_element_event_add(E_BLUEZ_EVENT_ELEMENT_MOVED, e);
+        DBG("Moved element %s\n", e->path);
      }
+
+   free(from);
 }
 
+#undef ARRAY_MATCH_IN_ORDER
+
 static Eina_Bool
-_e_bluez_element_property_update(E_Bluez_Element_Property *property, int type, void *data)
+_e_bluez_element_dict_entry_equal(const E_Bluez_Element_Dict_Entry *a, const E_Bluez_Element_Dict_Entry *b)
+{
+   if ((a->name != b->name) || (a->type != b->type))
+      return EINA_FALSE;
+
+   switch (a->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         return a->value.boolean == b->value.boolean;
+
+      case DBUS_TYPE_BYTE:
+         return a->value.byte == b->value.byte;
+
+      case DBUS_TYPE_INT16:
+         return a->value.i16 == b->value.i16;
+
+      case DBUS_TYPE_UINT16:
+         return a->value.u16 == b->value.u16;
+
+      case DBUS_TYPE_UINT32:
+         return a->value.u32 == b->value.u32;
+
+      case DBUS_TYPE_STRING:
+         return a->value.str == b->value.str;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         return a->value.path == b->value.path;
+
+      default:
+         return EINA_FALSE;
+     }
+}
+
+/* items are stringshares or integers, so they compare as pointers */
+static Eina_Bool
+_e_bluez_element_array_equal(const E_Bluez_Array *a, const E_Bluez_Array *b)
+{
+   unsigned int i, count;
+
+   if ((!a) || (!b))
+      return a == b;
+
+   count = eina_array_count(a->array);
+   if ((a->type != b->type) || (count != eina_array_count(b->array)))
+      return EINA_FALSE;
+
+   for (i = 0; i < count; i++)
+     {
+        void *x = eina_array_data_get(a->array, i);
+        void *y = eina_array_data_get(b->array, i);
+
+        if (a->type == DBUS_TYPE_DICT_ENTRY)
+          {
+             if (!_e_bluez_element_dict_entry_equal(x, y))
+                return EINA_FALSE;
+          }
+        else if (x != y)
+           return EINA_FALSE;
+     }
+
+   return EINA_TRUE;
+}
+
+static Eina_Bool
+_e_bluez_element_property_update(E_Bluez_Element_Property *property, int type, void *data)
 {
    Eina_Bool changed = EINA_FALSE;
 
@@ -681,13 +1315,24 @@ _e_bluez_element_property_update(E_Bluez_Element_Property *property, int type, v
          break;
 
       case DBUS_TYPE_ARRAY:
-         if (!changed)
-            if (property->value.array)
-              {
-                 _e_bluez_element_array_match(property->value.array, data, property->name);
-                 e_bluez_element_array_free(property->value.array, data);
-              }
+         if (changed)
+           {
+              property->value.array = data;
+              break;
+           }
+
+         /* an equal array keeps the old one, so its views stay valid.  A
+          * changed one is freed right away as the message is handled, not
+          * when the listeners are told later on. */
+         if (_e_bluez_element_array_equal(property->value.array, data))
+           {
+              e_bluez_element_array_free(data, NULL);
+              break;
+           }
 
+         if (property->value.array)
+            _e_bluez_element_array_match(property->value.array, data, property->name);
+         _e_bluez_element_property_array_free(property->value.array);
          property->value.array = data;
          changed = EINA_TRUE;
          break;
@@ -832,16 +1477,51 @@ e_bluez_element_objects_array_get_stringshared(const E_Bluez_Element *element, c
    return EINA_TRUE;
 }
 
-/* strings are just pointers (references), no strdup or stringshare_add/ref */
+/* the caller owns the returned array, the strings are still borrowed */
+static Eina_Bool
+_e_bluez_element_strings_array_copy(unsigned int *count, const char ***strings)
+{
+   const char **ret;
+
+   ret = malloc(*count * sizeof(char *));
+   if (!ret)
+     {
+        ERR("could not allocate return array of %d strings: %s",
+            *count, strerror(errno));
+        *count = 0;
+        *strings = NULL;
+        return EINA_FALSE;
+     }
+
+   memcpy(ret, *strings, *count * sizeof(char *));
+   *strings = ret;
+   return EINA_TRUE;
+}
+
+/**
+ * Get a view of an array of strings property.
+ *
+ * Nothing is allocated or copied, @a strings points into the array kept
+ * by the element itself, so it must not be modified or freed.  Updates
+ * with the same strings keep it, but a change frees it as soon as the
+ * message is handled, before the listeners are told, so do not keep it
+ * past a return to the main loop.  The strings are stringshared,
+ * eina_stringshare_ref() them to keep them.
+ *
+ * @param element the element with the property.
+ * @param property name of an array of strings property.
+ * @param count where to return the number of strings.
+ * @param strings where to return the strings, just set if return is
+ *        @c EINA_TRUE.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the property is not
+ *         set or not an array of strings.
+ */
 Eina_Bool
-e_bluez_element_strings_array_get_stringshared(const E_Bluez_Element *element, const char *property, unsigned int *count, const char ***strings)
+e_bluez_element_strings_array_view(const E_Bluez_Element *element, const char *property, unsigned int *count, const char ***strings)
 {
-   const char **ret, **p;
-   Eina_Array_Iterator iterator;
    E_Bluez_Array *array;
-   unsigned int i;
    int type;
-   void *item;
 
    EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
@@ -871,28 +1551,20 @@ e_bluez_element_strings_array_get_stringshared(const E_Bluez_Element *element, c
      }
 
    *count = eina_array_count(array->array);
-   ret = malloc(*count * sizeof(char *));
-   if (!ret)
-     {
-        ERR("could not allocate return array of %d strings: %s",
-            *count, strerror(errno));
-        *count = 0;
-        return EINA_FALSE;
-     }
-
-   p = ret;
+   *strings = (const char **)array->array->data;
+   return EINA_TRUE;
+}
 
-   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-   {
-      if (!item)
-         continue;
+/* the returned array is malloc()ed, strings are just pointers (references),
+ * no strdup or stringshare_add/ref
+ */
+Eina_Bool
+e_bluez_element_strings_array_get_stringshared(const E_Bluez_Element *element, const char *property, unsigned int *count, const char ***strings)
+{
+   if (!e_bluez_element_strings_array_view(element, property, count, strings))
+      return EINA_FALSE;
 
-      *p = item;
-      p++;
-   }
-   *count = p - ret;
-   *strings = ret;
-   return EINA_TRUE;
+   return _e_bluez_element_strings_array_copy(count, strings);
 }
 
 void
@@ -1079,14 +1751,24 @@ e_bluez_element_extra_properties_free(E_Bluez_Element *element)
         element->props = element->props->next;
         _e_bluez_element_property_free(prop);
      }
+
+   free(element->_props_index.slots);
+   element->_props_index.slots = NULL;
+   element->_props_index.size = 0;
+   element->_props_index.count = 0;
 }
 
 static void
 e_bluez_element_free(E_Bluez_Element *element)
 {
+   E_Bluez_Element_Changes changes;
+
    if (element->_idler.changed)
       ecore_idler_del(element->_idler.changed);
 
+   _e_bluez_element_changes_take(element, &changes);
+   _e_bluez_element_changes_free(&changes);
+
    while (element->_listeners)
      {
         E_Bluez_Element_Listener *l = (void *)element->_listeners;
@@ -1096,6 +1778,7 @@ e_bluez_element_free(E_Bluez_Element *element)
         if (l->free_data)
            l->free_data(l->data);
 
+        _e_bluez_element_listener_names_free(l->names);
         free(l);
      }
 
@@ -1220,20 +1903,194 @@ e_bluez_element_call_full(E_Bluez_Element *element, const char *method_name, E_D
              (element, method_name, cb, msg, pending, user_cb, user_data);
 }
 
+/* Properties are also indexed by their stringshared name in a small open
+ * addressing table, so lookups do not walk element->props.  They are
+ * removed all together, or a few after a snapshot was confirmed, so the
+ * table has no tombstones and is rebuilt in that case.
+ */
+#define PROPS_INDEX_MIN_SIZE 8
+
+static unsigned int
+_e_bluez_element_props_index_slot(const char *name, unsigned int size)
+{
+   uintptr_t h = (uintptr_t)name >> 3;
+
+   h ^= h >> 11;
+   return h & (size - 1);
+}
+
+static void
+_e_bluez_element_props_index_put(void **slots, unsigned int size, E_Bluez_Element_Property *p)
+{
+   unsigned int i = _e_bluez_element_props_index_slot(p->name, size);
+
+   while (slots[i])
+      i = (i + 1) & (size - 1);
+   slots[i] = p;
+}
+
 static Eina_Bool
-_e_bluez_element_property_value_add(E_Bluez_Element *element, const char *name, int type, void *value)
+_e_bluez_element_props_index_add(E_Bluez_Element *element, E_Bluez_Element_Property *p)
+{
+   /* keep the load under 3/4 so the probes stay short */
+   if (4 * (element->_props_index.count + 1) > 3 * element->_props_index.size)
+     {
+        unsigned int size, i;
+        void **slots;
+
+        size = element->_props_index.size * 2;
+        if (size < PROPS_INDEX_MIN_SIZE)
+           size = PROPS_INDEX_MIN_SIZE;
+
+        slots = calloc(size, sizeof(void *));
+        if (!slots)
+          {
+             ERR("could not grow the property index of %s", element->path);
+             return EINA_FALSE;
+          }
+
+        for (i = 0; i < element->_props_index.size; i++)
+           if (element->_props_index.slots[i])
+              _e_bluez_element_props_index_put
+                 (slots, size, element->_props_index.slots[i]);
+
+        free(element->_props_index.slots);
+        element->_props_index.slots = slots;
+        element->_props_index.size = size;
+     }
+
+   _e_bluez_element_props_index_put
+      (element->_props_index.slots, element->_props_index.size, p);
+   element->_props_index.count++;
+   return EINA_TRUE;
+}
+
+/* name must be stringshared */
+static E_Bluez_Element_Property *
+_e_bluez_element_property_find(const E_Bluez_Element *element, const char *name)
+{
+   unsigned int size = element->_props_index.size, i;
+   void **slots = element->_props_index.slots;
+
+   if (!slots)
+      return NULL;
+
+   i = _e_bluez_element_props_index_slot(name, size);
+   while (slots[i])
+     {
+        E_Bluez_Element_Property *p = slots[i];
+
+        if (p->name == name)
+           return p;
+
+        i = (i + 1) & (size - 1);
+     }
+
+   return NULL;
+}
+
+/* name may not be stringshared: try it as one, then by its contents */
+static E_Bluez_Element_Property *
+_e_bluez_element_property_find_string(const E_Bluez_Element *element, const char *name)
 {
    E_Bluez_Element_Property *p;
 
-   name = eina_stringshare_add(name);
+   p = _e_bluez_element_property_find(element, name);
+   if (p)
+      return p;
+
    EINA_INLIST_FOREACH(element->props, p)
    {
-      if (p->name == name)
-        {
-           eina_stringshare_del(name);
-           return _e_bluez_element_property_update(p, type, value);
-        }
+      if (strcmp(p->name, name) == 0)
+         return p;
+   }
+
+   return NULL;
+}
+
+/* the index has no tombstones, so it is rebuilt when properties go */
+static void
+_e_bluez_element_props_index_rebuild(E_Bluez_Element *element)
+{
+   E_Bluez_Element_Property *p;
+
+   if (!element->_props_index.slots)
+      return;
+
+   memset(element->_props_index.slots, 0,
+          element->_props_index.size * sizeof(void *));
+   element->_props_index.count = 0;
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      _e_bluez_element_props_index_put
+         (element->_props_index.slots, element->_props_index.size, p);
+      element->_props_index.count++;
    }
+}
+
+/* First reply for an element loaded from a snapshot: what the server did
+ * not send again is gone, each reported as a change to DBUS_TYPE_INVALID.
+ */
+static Eina_Bool
+_e_bluez_element_stale_props_del(E_Bluez_Element *element)
+{
+   Eina_Inlist *l = element->props;
+   Eina_Bool changed = EINA_FALSE;
+
+   element->_stale = EINA_FALSE;
+   while (l)
+     {
+        E_Bluez_Element_Property *p = (E_Bluez_Element_Property *)l;
+        E_Bluez_Value old;
+        int old_type = p->type;
+
+        l = l->next;
+        if (!p->stale)
+           continue;
+
+        _e_bluez_element_value_keep(p, &old);
+        _e_bluez_element_property_value_free(p);
+        memset(&p->value, 0, sizeof(p->value));
+        p->type = DBUS_TYPE_INVALID;
+        _e_bluez_element_change_add(element, p, old_type, &old);
+
+        element->props = eina_inlist_remove(element->props, EINA_INLIST_GET(p));
+        _e_bluez_element_property_free(p);
+        changed = EINA_TRUE;
+     }
+
+   if (changed)
+      _e_bluez_element_props_index_rebuild(element);
+
+   return changed;
+}
+
+static Eina_Bool
+_e_bluez_element_property_value_add(E_Bluez_Element *element, const char *name, int type, void *value)
+{
+   E_Bluez_Element_Property *p;
+   E_Bluez_Value none;
+
+   name = eina_stringshare_add(name);
+   p = _e_bluez_element_property_find(element, name);
+   if (p)
+     {
+        E_Bluez_Value old;
+        Eina_Bool changed;
+        int old_type = p->type;
+
+        eina_stringshare_del(name);
+        p->stale = EINA_FALSE;
+        _e_bluez_element_value_keep(p, &old);
+        changed = _e_bluez_element_property_update(p, type, value);
+        if (changed)
+           _e_bluez_element_change_add(element, p, old_type, &old);
+        else
+           _e_bluez_element_value_release(old_type, &old);
+
+        E_DBUS_PROBE4(ebluez, property_update, element->path, p->name, type, changed);
+        return changed;
+     }
 
    p = _e_bluez_element_property_new(name, type, value);
    if (!p)
@@ -1242,7 +2099,16 @@ _e_bluez_element_property_value_add(E_Bluez_Element *element, const char *name,
         return EINA_FALSE;
      }
 
+   if (!_e_bluez_element_props_index_add(element, p))
+     {
+        _e_bluez_element_property_free(p);
+        return EINA_FALSE;
+     }
+
    element->props = eina_inlist_append(element->props, EINA_INLIST_GET(p));
+   memset(&none, 0, sizeof(none));
+   _e_bluez_element_change_add(element, p, DBUS_TYPE_INVALID, &none);
+   E_DBUS_PROBE4(ebluez, property_update, element->path, p->name, type, 2);
    return EINA_TRUE;
 }
 
@@ -1332,9 +2198,8 @@ e_bluez_element_iter_get_array(DBusMessageIter *itr, const char *key)
 }
 
 static void
-_e_bluez_element_get_properties_callback(void *user_data, DBusMessage *msg, DBusError *err)
+_e_bluez_element_get_properties_parse(E_Bluez_Element *element, DBusMessage *msg, DBusError *err)
 {
-   E_Bluez_Element *element = user_data;
    DBusMessageIter itr, s_itr;
    int t, changed;
 
@@ -1347,6 +2212,7 @@ _e_bluez_element_get_properties_callback(void *user_data, DBusMessage *msg, DBus
    if (!_dbus_iter_type_check(t, DBUS_TYPE_ARRAY))
       return;
 
+   element->_synced = EINA_TRUE;
    changed = 0;
    dbus_message_iter_recurse(&itr, &s_itr);
    do
@@ -1401,10 +2267,31 @@ _e_bluez_element_get_properties_callback(void *user_data, DBusMessage *msg, DBus
      }
    while (dbus_message_iter_next(&s_itr));
 
+   if ((element->_stale) && (_e_bluez_element_stale_props_del(element)))
+      changed = 1;
+
    if (changed)
       _e_bluez_element_listeners_call(element);
 }
 
+static void
+_e_bluez_element_get_properties_callback(void *user_data, DBusMessage *msg, DBusError *err)
+{
+   E_Bluez_Element *element = user_data;
+
+   _e_bluez_element_get_properties_parse(element, msg, err);
+
+   /* the reply e_bluez_elements_sync() waited for, now that the elements
+    * it lists are queued */
+   if (element == sync_manager)
+     {
+        sync_manager = NULL;
+        if (sync_in_flight > 0)
+           sync_in_flight--;
+        _e_bluez_elements_sync_pump();
+     }
+}
+
 /**
  * Sync element properties with server.
  *
@@ -1725,14 +2612,12 @@ e_bluez_element_property_type_get_stringshared(const E_Bluez_Element *element, c
    EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(type, EINA_FALSE);
 
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      if (p->name == name)
-        {
-           *type = p->type;
-           return EINA_TRUE;
-        }
-   }
+   p = _e_bluez_element_property_find(element, name);
+   if (p)
+     {
+        *type = p->type;
+        return EINA_TRUE;
+     }
 
    WRN("element %s (%p) has no property with name \"%s\".",
        element->path, element, name);
@@ -1754,11 +2639,17 @@ e_bluez_element_property_type_get_stringshared(const E_Bluez_Element *element, c
 Eina_Bool
 e_bluez_element_property_type_get(const E_Bluez_Element *element, const char *name, int *type)
 {
-   Eina_Bool ret;
-   name = eina_stringshare_add(name);
-   ret = e_bluez_element_property_type_get_stringshared(element, name, type);
-   eina_stringshare_del(name);
-   return ret;
+   const E_Bluez_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+
+   /* use the stored stringshare instead of adding one for each call */
+   p = _e_bluez_element_property_find_string(element, name);
+   if (p)
+      name = p->name;
+
+   return e_bluez_element_property_type_get_stringshared(element, name, type);
 }
 
 void
@@ -1833,78 +2724,76 @@ e_bluez_element_property_dict_get_stringshared(const E_Bluez_Element *element, c
    EINA_SAFETY_ON_NULL_RETURN_VAL(key, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
 
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      E_Bluez_Element_Dict_Entry *entry;
-      E_Bluez_Array *array;
+   p = _e_bluez_element_property_find(element, dict_name);
+   if (p)
+     {
+        E_Bluez_Element_Dict_Entry *entry;
+        E_Bluez_Array *array;
 
-      if (p->name != dict_name)
-         continue;
+        if (p->type != DBUS_TYPE_ARRAY)
+          {
+             WRN("element %s (%p) has property \"%s\" is not an array: %c (%d)",
+                 element->path, element, dict_name, p->type, p->type);
+             return EINA_FALSE;
+          }
 
-      if (p->type != DBUS_TYPE_ARRAY)
-        {
-           WRN("element %s (%p) has property \"%s\" is not an array: %c (%d)",
-               element->path, element, dict_name, p->type, p->type);
-           return EINA_FALSE;
-        }
+        array = p->value.array;
+        if ((!array) || (array->type != DBUS_TYPE_DICT_ENTRY))
+          {
+             int t = array ? array->type : DBUS_TYPE_INVALID;
+             WRN("element %s (%p) has property \"%s\" is not a dict: %c (%d)",
+                 element->path, element, dict_name, t, t);
+             return EINA_FALSE;
+          }
 
-      array = p->value.array;
-      if ((!array) || (array->type != DBUS_TYPE_DICT_ENTRY))
-        {
-           int t = array ? array->type : DBUS_TYPE_INVALID;
-           WRN("element %s (%p) has property \"%s\" is not a dict: %c (%d)",
-               element->path, element, dict_name, t, t);
-           return EINA_FALSE;
-        }
+        entry = e_bluez_element_array_dict_find_stringshared(array, key);
+        if (!entry)
+          {
+             WRN("element %s (%p) has no dict property with name \"%s\" with "
+                 "key \"%s\".",
+                 element->path, element, dict_name, key);
+             return EINA_FALSE;
+          }
 
-      entry = e_bluez_element_array_dict_find_stringshared(array, key);
-      if (!entry)
-        {
-           WRN("element %s (%p) has no dict property with name \"%s\" with "
-               "key \"%s\".",
-               element->path, element, dict_name, key);
-           return EINA_FALSE;
-        }
+        if (type)
+           *type = entry->type;
 
-      if (type)
-         *type = entry->type;
+        switch (entry->type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+              *(Eina_Bool *)value = entry->value.boolean;
+              return EINA_TRUE;
 
-      switch (entry->type)
-        {
-         case DBUS_TYPE_BOOLEAN:
-            *(Eina_Bool *)value = entry->value.boolean;
-            return EINA_TRUE;
+           case DBUS_TYPE_BYTE:
+              *(unsigned char *)value = entry->value.byte;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_BYTE:
-            *(unsigned char *)value = entry->value.byte;
-            return EINA_TRUE;
+           case DBUS_TYPE_INT16:
+              *(short *)value = entry->value.i16;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_INT16:
-            *(short *)value = entry->value.i16;
-            return EINA_TRUE;
+           case DBUS_TYPE_UINT16:
+              *(unsigned short *)value = entry->value.u16;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_UINT16:
-            *(unsigned short *)value = entry->value.u16;
-            return EINA_TRUE;
+           case DBUS_TYPE_UINT32:
+              *(unsigned int *)value = entry->value.u32;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_UINT32:
-            *(unsigned int *)value = entry->value.u32;
-            return EINA_TRUE;
-
-         case DBUS_TYPE_STRING:
-            *(const char **)value = entry->value.str;
-            return EINA_TRUE;
+           case DBUS_TYPE_STRING:
+              *(const char **)value = entry->value.str;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_OBJECT_PATH:
-            *(const char **)value = entry->value.path;
-            return EINA_TRUE;
+           case DBUS_TYPE_OBJECT_PATH:
+              *(const char **)value = entry->value.path;
+              return EINA_TRUE;
 
-         default:
-            ERR("don't know how to get property %s, key %s type %c (%d)",
-                dict_name, key, entry->type, entry->type);
-            return EINA_FALSE;
-        }
-   }
+           default:
+              ERR("don't know how to get property %s, key %s type %c (%d)",
+                  dict_name, key, entry->type, entry->type);
+              return EINA_FALSE;
+          }
+     }
 
    WRN("element %s (%p) has no property with name \"%s\".",
        element->path, element, dict_name);
@@ -1937,50 +2826,48 @@ e_bluez_element_property_get_stringshared(const E_Bluez_Element *element, const
    EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
 
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      if (p->name != name)
-         continue;
-
-      if (type)
-         *type = p->type;
+   p = _e_bluez_element_property_find(element, name);
+   if (p)
+     {
+        if (type)
+           *type = p->type;
 
-      switch (p->type)
-        {
-         case DBUS_TYPE_BOOLEAN:
-            *(Eina_Bool *)value = p->value.boolean;
-            return EINA_TRUE;
+        switch (p->type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+              *(Eina_Bool *)value = p->value.boolean;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_BYTE:
-            *(unsigned char *)value = p->value.byte;
-            return EINA_TRUE;
+           case DBUS_TYPE_BYTE:
+              *(unsigned char *)value = p->value.byte;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_UINT16:
-            *(unsigned short *)value = p->value.u16;
-            return EINA_TRUE;
+           case DBUS_TYPE_UINT16:
+              *(unsigned short *)value = p->value.u16;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_UINT32:
-            *(unsigned int *)value = p->value.u32;
-            return EINA_TRUE;
+           case DBUS_TYPE_UINT32:
+              *(unsigned int *)value = p->value.u32;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_STRING:
-            *(const char **)value = p->value.str;
-            return EINA_TRUE;
+           case DBUS_TYPE_STRING:
+              *(const char **)value = p->value.str;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_OBJECT_PATH:
-            *(const char **)value = p->value.path;
-            return EINA_TRUE;
+           case DBUS_TYPE_OBJECT_PATH:
+              *(const char **)value = p->value.path;
+              return EINA_TRUE;
 
-         case DBUS_TYPE_ARRAY:
-            *(E_Bluez_Array **)value = p->value.array;
-            return EINA_TRUE;
+           case DBUS_TYPE_ARRAY:
+              *(E_Bluez_Array **)value = p->value.array;
+              return EINA_TRUE;
 
-         default:
-            ERR("don't know how to get property type %c (%d)",
-                p->type, p->type);
-            return EINA_FALSE;
-        }
-   }
+           default:
+              ERR("don't know how to get property type %c (%d)",
+                  p->type, p->type);
+              return EINA_FALSE;
+          }
+     }
 
    WRN("element %s (%p) has no property with name \"%s\".",
        element->path, element, name);
@@ -2007,12 +2894,18 @@ e_bluez_element_property_get_stringshared(const E_Bluez_Element *element, const
 Eina_Bool
 e_bluez_element_property_get(const E_Bluez_Element *element, const char *name, int *type, void *value)
 {
-   Eina_Bool ret;
-   name = eina_stringshare_add(name);
-   ret = e_bluez_element_property_get_stringshared
-         (element, name, type, value);
-   eina_stringshare_del(name);
-   return ret;
+   const E_Bluez_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+
+   /* use the stored stringshare instead of adding one for each call */
+   p = _e_bluez_element_property_find_string(element, name);
+   if (p)
+      name = p->name;
+
+   return e_bluez_element_property_get_stringshared
+             (element, name, type, value);
 }
 
 struct e_bluez_elements_for_each_data
@@ -2048,10 +2941,151 @@ e_bluez_elements_for_each(Eina_Hash_Foreach cb, const void *user_data)
                      &data);
 }
 
+typedef struct _E_Bluez_Elements_Index E_Bluez_Elements_Index;
+
+struct _E_Bluez_Elements_Index
+{
+   E_Bluez_Element **items;
+   unsigned int       count;
+   unsigned int       size;
+   const char        *interface;
+};
+
+static E_Bluez_Elements_Index elements_all = {NULL, 0, 0, NULL};
+/* stringshared interface -> E_Bluez_Elements_Index */
+static Eina_Hash *elements_by_interface = NULL;
+
+/* Elements are also kept in flat arrays, one for all of them and one per
+ * interface, so listing them needs no walk of the hash.  Removal swaps the
+ * last element in, element->_index[] has the position in each.  Any change
+ * to these arrays or to an array property bumps elements_generation, which
+ * stops the iterators still running over the old ones.
+ */
+enum
+{
+   ELEMENTS_INDEX_ALL,
+   ELEMENTS_INDEX_INTERFACE
+};
+
+static Eina_Bool
+_e_bluez_elements_index_add(E_Bluez_Elements_Index *index, int which, E_Bluez_Element *element)
+{
+   if (index->count == index->size)
+     {
+        unsigned int size = index->size ? index->size * 2 : 16;
+        E_Bluez_Element **items;
+
+        items = realloc(index->items, size * sizeof(E_Bluez_Element *));
+        if (!items)
+          {
+             ERR("could not grow the index of %s: %s",
+                 element->path, strerror(errno));
+             return EINA_FALSE;
+          }
+        index->items = items;
+        index->size = size;
+     }
+
+   element->_index[which] = index->count;
+   index->items[index->count++] = element;
+   elements_generation++;
+   return EINA_TRUE;
+}
+
+static void
+_e_bluez_elements_index_del(E_Bluez_Elements_Index *index, int which, E_Bluez_Element *element)
+{
+   unsigned int pos = element->_index[which];
+   E_Bluez_Element *last;
+
+   if ((pos >= index->count) || (index->items[pos] != element))
+      return;
+
+   last = index->items[--index->count];
+   index->items[pos] = last;
+   last->_index[which] = pos;
+   elements_generation++;
+}
+
+static void
+_e_bluez_elements_index_free(void *data)
+{
+   E_Bluez_Elements_Index *index = data;
+
+   eina_stringshare_del(index->interface);
+   free(index->items);
+   free(index);
+}
+
+/* interface NULL is all the elements, NULL if none was seen */
+static E_Bluez_Elements_Index *
+_e_bluez_elements_index_find(const char *interface)
+{
+   E_Bluez_Elements_Index *index;
+
+   if (!interface)
+      return &elements_all;
+
+   if (!elements_by_interface)
+      return NULL;
+
+   interface = eina_stringshare_add(interface);
+   index = eina_hash_find(elements_by_interface, &interface);
+   eina_stringshare_del(interface);
+   return index;
+}
+
+static Eina_Bool
+_e_bluez_element_index_add(E_Bluez_Element *element)
+{
+   E_Bluez_Elements_Index *index;
+
+   index = eina_hash_find(elements_by_interface, &element->interface);
+   if (!index)
+     {
+        index = calloc(1, sizeof(E_Bluez_Elements_Index));
+        if (!index)
+          {
+             ERR("could not allocate the index of %s: %s",
+                 element->interface, strerror(errno));
+             return EINA_FALSE;
+          }
+
+        index->interface = eina_stringshare_ref(element->interface);
+        if (!eina_hash_add(elements_by_interface, &index->interface, index))
+          {
+             _e_bluez_elements_index_free(index);
+             return EINA_FALSE;
+          }
+     }
+
+   if (!_e_bluez_elements_index_add(&elements_all, ELEMENTS_INDEX_ALL, element))
+      return EINA_FALSE;
+
+   if (!_e_bluez_elements_index_add(index, ELEMENTS_INDEX_INTERFACE, element))
+     {
+        _e_bluez_elements_index_del(&elements_all, ELEMENTS_INDEX_ALL, element);
+        return EINA_FALSE;
+     }
+
+   return EINA_TRUE;
+}
+
+static void
+_e_bluez_element_index_del(E_Bluez_Element *element)
+{
+   E_Bluez_Elements_Index *index;
+
+   _e_bluez_elements_index_del(&elements_all, ELEMENTS_INDEX_ALL, element);
+   index = eina_hash_find(elements_by_interface, &element->interface);
+   if (index)
+      _e_bluez_elements_index_del(index, ELEMENTS_INDEX_INTERFACE, element);
+}
+
 static Eina_Bool
-_e_bluez_elements_get_allocate(unsigned int *count, E_Bluez_Element ***p_elements)
+_e_bluez_elements_index_copy(const E_Bluez_Elements_Index *index, unsigned int *count, E_Bluez_Element ***p_elements)
 {
-   *count = eina_hash_population(elements);
+   *count = index ? index->count : 0;
    if (*count == 0)
      {
         *p_elements = NULL;
@@ -2067,17 +3101,7 @@ _e_bluez_elements_get_allocate(unsigned int *count, E_Bluez_Element ***p_element
         return EINA_FALSE;
      }
 
-   return EINA_TRUE;
-}
-
-static Eina_Bool
-_e_bluez_elements_get_all(Eina_Hash *hash __UNUSED__, const char *key __UNUSED__, void *data, void *fdata)
-{
-   E_Bluez_Element *element = data;
-   E_Bluez_Element ***p_ret = fdata;
-
-   **p_ret = element;
-   (*p_ret)++;
+   memcpy(*p_elements, index->items, *count * sizeof(E_Bluez_Element *));
    return EINA_TRUE;
 }
 
@@ -2099,39 +3123,10 @@ _e_bluez_elements_get_all(Eina_Hash *hash __UNUSED__, const char *key __UNUSED__
 Eina_Bool
 e_bluez_elements_get_all(unsigned int *count, E_Bluez_Element ***p_elements)
 {
-   E_Bluez_Element **p;
-
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
 
-   if (!_e_bluez_elements_get_allocate(count, p_elements))
-      return EINA_FALSE;
-
-   p = *p_elements;
-   eina_hash_foreach(elements, (Eina_Hash_Foreach)_e_bluez_elements_get_all,
-                     &p);
-   return EINA_TRUE;
-}
-
-struct e_bluez_elements_get_all_str_data
-{
-   E_Bluez_Element **elements;
-   int               count;
-   const char       *str;
-};
-
-static Eina_Bool
-_e_bluez_elements_get_all_type(Eina_Hash *hash __UNUSED__, const char *key __UNUSED__, void *e, void *user_data)
-{
-   struct e_bluez_elements_get_all_str_data *data = user_data;
-   E_Bluez_Element *element = e;
-
-   if ((data->str) && (element->interface != data->str))
-      return EINA_TRUE;
-
-   data->elements[data->count] = element;
-   data->count++;
-   return EINA_TRUE;
+   return _e_bluez_elements_index_copy(&elements_all, count, p_elements);
 }
 
 /**
@@ -2155,26 +3150,131 @@ _e_bluez_elements_get_all_type(Eina_Hash *hash __UNUSED__, const char *key __UNU
 Eina_Bool
 e_bluez_elements_get_all_type(const char *type, unsigned int *count, E_Bluez_Element ***p_elements)
 {
-   struct e_bluez_elements_get_all_str_data data;
-
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
 
-   if (!_e_bluez_elements_get_allocate(count, p_elements))
+   return _e_bluez_elements_index_copy
+             (_e_bluez_elements_index_find(type), count, p_elements);
+}
+
+/**
+ * Start iterating over the known elements of an interface.
+ *
+ * Nothing is allocated and no reference is added to the elements, the
+ * iterator just borrows the library's own list.  If elements are added or
+ * removed before the iteration is over, e_bluez_elements_iter_next() stops
+ * and returns NULL.
+ *
+ * @param iter the iterator to start, usually on the stack.
+ * @param interface interface to filter, or NULL to get all.
+ */
+void
+e_bluez_elements_iter_init(E_Bluez_Elements_Iter *iter, const char *interface)
+{
+   E_Bluez_Elements_Index *index;
+
+   EINA_SAFETY_ON_NULL_RETURN(iter);
+
+   memset(iter, 0, sizeof(*iter));
+   iter->_generation = elements_generation;
+
+   index = _e_bluez_elements_index_find(interface);
+   if (!index)
+      return;
+
+   iter->_items = (void * const *)index->items;
+   iter->_count = index->count;
+}
+
+/**
+ * Start iterating over the elements listed in an object path array.
+ *
+ * Like e_bluez_elements_iter_init(), this borrows the property itself and
+ * stops when it is replaced.  Paths without an element are skipped.
+ *
+ * @param iter the iterator to start, usually on the stack.
+ * @param element the element with the property.
+ * @param property name of an array of object paths, like "Devices".
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the property is not an
+ *         array of object paths.
+ */
+Eina_Bool
+e_bluez_element_objects_iter_init(E_Bluez_Elements_Iter *iter, const E_Bluez_Element *element, const char *property)
+{
+   E_Bluez_Array *array;
+   int type;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(iter, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
+
+   memset(iter, 0, sizeof(*iter));
+   iter->_generation = elements_generation;
+   iter->_paths = EINA_TRUE;
+
+   if (!e_bluez_element_property_get(element, property, &type, &array))
       return EINA_FALSE;
 
-   data.elements = *p_elements;
-   data.count = 0;
-   data.str = eina_stringshare_add(type);
-   eina_hash_foreach(elements,
-                     (Eina_Hash_Foreach)_e_bluez_elements_get_all_type,
-                     &data);
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s is not an array!", property);
+        return EINA_FALSE;
+     }
 
-   eina_stringshare_del(data.str);
-   *count = data.count;
+   /* empty arrays are kept as NULL */
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_TRUE;
+
+   if (array->type != DBUS_TYPE_OBJECT_PATH)
+     {
+        ERR("property %s is not an array of object paths!", property);
+        return EINA_FALSE;
+     }
+
+   iter->_items = (void * const *)array->array->data;
+   iter->_count = eina_array_count(array->array);
    return EINA_TRUE;
 }
 
+/**
+ * Get the next element of an iteration.
+ *
+ * @param iter an iterator started by e_bluez_elements_iter_init() or
+ *        e_bluez_element_objects_iter_init().
+ *
+ * @return the next element, no reference is added, or NULL at the end or
+ *         if the elements changed meanwhile.
+ */
+E_Bluez_Element *
+e_bluez_elements_iter_next(E_Bluez_Elements_Iter *iter)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(iter, NULL);
+
+   if (iter->_generation != elements_generation)
+     {
+        if (iter->_pos < iter->_count)
+           WRN("elements changed while iterating, stopping");
+        iter->_count = 0;
+        return NULL;
+     }
+
+   while (iter->_pos < iter->_count)
+     {
+        void *item = iter->_items[iter->_pos++];
+        E_Bluez_Element *element;
+
+        if (!iter->_paths)
+           return item;
+
+        element = e_bluez_element_get(item);
+        if (element)
+           return element;
+     }
+
+   return NULL;
+}
+
 /**
  * Get the element registered at given path.
  *
@@ -2194,14 +3294,23 @@ e_bluez_element_get(const char *path)
 }
 
 static void
-_e_bluez_element_property_changed_callback(void *data, DBusMessage *msg)
+_e_bluez_element_property_changed_callback(void *data __UNUSED__, DBusMessage *msg)
 {
-   E_Bluez_Element *element = (E_Bluez_Element *)data;
+   E_Bluez_Element *element;
    DBusMessageIter itr, v_itr;
    int t, r, changed = 0;
-   const char *name = NULL;
+   const char *name = NULL, *path, *interface;
    void *value = NULL;
 
+   path = dbus_message_get_path(msg);
+   interface = dbus_message_get_interface(msg);
+   if ((!path) || (!interface))
+      return;
+
+   element = eina_hash_find(elements, path);
+   if ((!element) || (strcmp(element->interface, interface) != 0))
+      return;
+
    DBG("Property changed in element %s", element->path);
 
    if (!_dbus_callback_check_and_init(msg, &itr, NULL))
@@ -2285,18 +3394,26 @@ e_bluez_element_register(const char *path, const char *interface)
    if (!element)
       return NULL;
 
+   if (!_e_bluez_element_index_add(element))
+     {
+        e_bluez_element_free(element);
+        return NULL;
+     }
+
    if (!eina_hash_add(elements, element->path, element))
      {
+        _e_bluez_element_index_del(element);
         ERR("could not add element %s to hash, delete it.", path);
         e_bluez_element_free(element);
         return NULL;
      }
 
-   element->signal_handler =
-      e_dbus_signal_handler_add
-         (e_bluez_conn, e_bluez_system_bus_name_get(),
-         element->path, element->interface, "PropertyChanged",
-         _e_bluez_element_property_changed_callback, element);
+   if (!property_changed_handler)
+      property_changed_handler =
+         e_dbus_signal_handler_add
+            (e_bluez_conn, e_bluez_system_bus_name_get(),
+            NULL, NULL, "PropertyChanged",
+            _e_bluez_element_property_changed_callback, NULL);
 
    e_bluez_element_event_add(E_BLUEZ_EVENT_ELEMENT_ADD, element);
 
@@ -2313,12 +3430,7 @@ _e_bluez_element_event_unregister_and_free(void *data __UNUSED__, void *ev)
 static void
 _e_bluez_element_unregister_internal(E_Bluez_Element *element)
 {
-   if (element->signal_handler)
-     {
-        e_dbus_signal_handler_del(e_bluez_conn, element->signal_handler);
-        element->signal_handler = NULL;
-     }
-
+   _e_bluez_element_index_del(element);
    ecore_event_add(E_BLUEZ_EVENT_ELEMENT_DEL, element,
                    _e_bluez_element_event_unregister_and_free, NULL);
 }
@@ -2372,14 +3484,54 @@ e_bluez_elements_init(void)
    elements =
       eina_hash_string_superfast_new(EINA_FREE_CB
                                         (_e_bluez_element_unregister_internal));
+   elements_by_interface =
+      eina_hash_pointer_new(_e_bluez_elements_index_free);
 }
 
 void
 e_bluez_elements_shutdown(void)
 {
    EINA_SAFETY_ON_FALSE_RETURN(!!elements);
+   if (changed_flush)
+     {
+        ecore_idle_enterer_del(changed_flush);
+        changed_flush = NULL;
+     }
+   if (changed_elements)
+     {
+        E_Bluez_Element *element;
+        Eina_Array_Iterator iterator;
+        unsigned int i;
+
+        EINA_ARRAY_ITER_NEXT(changed_elements, i, element, iterator)
+        {
+           E_Bluez_Element_Changes changes;
+
+           element->_dirty = EINA_FALSE;
+           _e_bluez_element_changes_take(element, &changes);
+           _e_bluez_element_changes_free(&changes);
+           e_bluez_element_unref(element);
+        }
+        eina_array_free(changed_elements);
+        changed_elements = NULL;
+     }
+   _e_bluez_elements_sync_clear();
+   if (property_changed_handler)
+     {
+        e_dbus_signal_handler_del(e_bluez_conn, property_changed_handler);
+        property_changed_handler = NULL;
+     }
    eina_hash_free(elements);
    elements = NULL;
+   eina_hash_free(elements_by_interface);
+   elements_by_interface = NULL;
+   free(elements_all.items);
+   memset(&elements_all, 0, sizeof(elements_all));
+   elements_generation++;
+   /* the calls in flight were canceled with their elements, their
+    * completions still come and must not count against the next sync */
+   sync_in_flight = 0;
+   sync_generation++;
 }
 
 static inline Eina_Bool
@@ -2402,3 +3554,711 @@ e_bluez_element_is_device(const E_Bluez_Element *element)
    return _e_bluez_element_is(element, e_bluez_iface_device);
 }
 
+/***********************************************************************
+* Snapshot
+***********************************************************************/
+
+/* A snapshot is the elements hash written to a file, so the next start
+ * shows the last known state before the server answers.  It is a cache
+ * in native byte order: the header, then all the strings NUL terminated
+ * and padded to 4 bytes as a whole, then 32 bit words:
+ *
+ *   element:  path interface n_props prop...
+ *   prop:     name type value
+ *   value:    the integer types as is, strings and paths as the offset
+ *             of the string, arrays as type count item...
+ *   item:     a value, or name type value for dict entries
+ *
+ * Each string is stored once, so the file is small and read in place
+ * through mmap().
+ */
+#define SNAPSHOT_MAGIC "EDBSNAP1"
+
+typedef struct _E_Bluez_Snapshot_Header E_Bluez_Snapshot_Header;
+typedef struct _E_Bluez_Snapshot_Writer E_Bluez_Snapshot_Writer;
+typedef struct _E_Bluez_Snapshot_Reader E_Bluez_Snapshot_Reader;
+
+struct _E_Bluez_Snapshot_Header
+{
+   char     magic[8];
+   char     system[8];
+   uint32_t strings_size;
+   uint32_t n_elements;
+   uint32_t n_words;
+   uint32_t reserved;
+};
+
+struct _E_Bluez_Snapshot_Writer
+{
+   Eina_Hash *offsets; /* stringshare -> offset + 1 */
+   char      *strings;
+   uint32_t   strings_size;
+   uint32_t   strings_alloc;
+   uint32_t  *words;
+   uint32_t   n_words;
+   uint32_t   words_alloc;
+   uint32_t   n_elements;
+   Eina_Bool  failed;
+};
+
+struct _E_Bluez_Snapshot_Reader
+{
+   const char     *strings;
+   uint32_t        strings_size;
+   const uint32_t *words;
+   uint32_t        n_words;
+   uint32_t        pos;
+   Eina_Bool       failed;
+};
+
+static void
+_e_bluez_snapshot_word_add(E_Bluez_Snapshot_Writer *w, uint32_t word)
+{
+   if (w->n_words == w->words_alloc)
+     {
+        uint32_t size = w->words_alloc ? w->words_alloc * 2 : 1024;
+        uint32_t *tmp;
+
+        tmp = realloc(w->words, size * sizeof(uint32_t));
+        if (!tmp)
+          {
+             w->failed = EINA_TRUE;
+             return;
+          }
+        w->words = tmp;
+        w->words_alloc = size;
+     }
+
+   w->words[w->n_words++] = word;
+}
+
+/* s is a stringshare, so the same string is found by its pointer */
+static void
+_e_bluez_snapshot_string_add(E_Bluez_Snapshot_Writer *w, const char *s)
+{
+   uintptr_t offset;
+
+   if (!s)
+      s = "";
+
+   offset = (uintptr_t)eina_hash_find(w->offsets, &s);
+   if (!offset)
+     {
+        uint32_t len = strlen(s) + 1;
+
+        if (w->strings_size + len > w->strings_alloc)
+          {
+             uint32_t size = w->strings_alloc ? w->strings_alloc * 2 : 4096;
+             char *tmp;
+
+             while (size < w->strings_size + len)
+                size *= 2;
+
+             tmp = realloc(w->strings, size);
+             if (!tmp)
+               {
+                  w->failed = EINA_TRUE;
+                  return;
+               }
+             w->strings = tmp;
+             w->strings_alloc = size;
+          }
+
+        memcpy(w->strings + w->strings_size, s, len);
+        offset = w->strings_size + 1;
+        w->strings_size += len;
+        if (!eina_hash_add(w->offsets, &s, (void *)offset))
+           w->failed = EINA_TRUE;
+     }
+
+   _e_bluez_snapshot_word_add(w, offset - 1);
+}
+
+static void
+_e_bluez_snapshot_dict_entry_add(E_Bluez_Snapshot_Writer *w, const E_Bluez_Element_Dict_Entry *entry)
+{
+   _e_bluez_snapshot_string_add(w, entry->name);
+   _e_bluez_snapshot_word_add(w, entry->type);
+   switch (entry->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         _e_bluez_snapshot_word_add(w, entry->value.boolean);
+         break;
+
+      case DBUS_TYPE_BYTE:
+         _e_bluez_snapshot_word_add(w, entry->value.byte);
+         break;
+
+      case DBUS_TYPE_INT16:
+         _e_bluez_snapshot_word_add(w, (unsigned short)entry->value.i16);
+         break;
+
+      case DBUS_TYPE_UINT16:
+         _e_bluez_snapshot_word_add(w, entry->value.u16);
+         break;
+
+      case DBUS_TYPE_UINT32:
+         _e_bluez_snapshot_word_add(w, entry->value.u32);
+         break;
+
+      case DBUS_TYPE_STRING:
+         _e_bluez_snapshot_string_add(w, entry->value.str);
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         _e_bluez_snapshot_string_add(w, entry->value.path);
+         break;
+
+      default:
+         ERR("don't know how to save dict entry '%s' of type %c (%d)",
+             entry->name, entry->type, entry->type);
+         w->failed = EINA_TRUE;
+     }
+}
+
+static void
+_e_bluez_snapshot_array_add(E_Bluez_Snapshot_Writer *w, const E_Bluez_Array *array)
+{
+   Eina_Array_Iterator iterator;
+   unsigned int i;
+   void *item;
+
+   /* empty arrays are kept as NULL */
+   if (!array)
+     {
+        _e_bluez_snapshot_word_add(w, DBUS_TYPE_INVALID);
+        _e_bluez_snapshot_word_add(w, 0);
+        return;
+     }
+
+   _e_bluez_snapshot_word_add(w, array->type);
+   _e_bluez_snapshot_word_add(w, eina_array_count(array->array));
+   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+   {
+      switch (array->type)
+        {
+         case DBUS_TYPE_STRING:
+         case DBUS_TYPE_OBJECT_PATH:
+            _e_bluez_snapshot_string_add(w, item);
+            break;
+
+         case DBUS_TYPE_DICT_ENTRY:
+            _e_bluez_snapshot_dict_entry_add(w, item);
+            break;
+
+         default:
+            _e_bluez_snapshot_word_add(w, (uint32_t)(uintptr_t)item);
+        }
+   }
+}
+
+static void
+_e_bluez_snapshot_element_add(E_Bluez_Snapshot_Writer *w, const E_Bluez_Element *element)
+{
+   const E_Bluez_Element_Property *p;
+   uint32_t n_props = 0, at;
+
+   _e_bluez_snapshot_string_add(w, element->path);
+   _e_bluez_snapshot_string_add(w, element->interface);
+   at = w->n_words;
+   _e_bluez_snapshot_word_add(w, 0);
+
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      switch (p->type)
+        {
+         case DBUS_TYPE_BOOLEAN:
+         case DBUS_TYPE_BYTE:
+         case DBUS_TYPE_UINT16:
+         case DBUS_TYPE_UINT32:
+         case DBUS_TYPE_STRING:
+         case DBUS_TYPE_OBJECT_PATH:
+         case DBUS_TYPE_ARRAY:
+            break;
+
+         default:
+            continue;
+        }
+
+      _e_bluez_snapshot_string_add(w, p->name);
+      _e_bluez_snapshot_word_add(w, p->type);
+      switch (p->type)
+        {
+         case DBUS_TYPE_BOOLEAN:
+            _e_bluez_snapshot_word_add(w, p->value.boolean);
+            break;
+
+         case DBUS_TYPE_BYTE:
+            _e_bluez_snapshot_word_add(w, p->value.byte);
+            break;
+
+         case DBUS_TYPE_UINT16:
+            _e_bluez_snapshot_word_add(w, p->value.u16);
+            break;
+
+         case DBUS_TYPE_UINT32:
+            _e_bluez_snapshot_word_add(w, p->value.u32);
+            break;
+
+         case DBUS_TYPE_STRING:
+            _e_bluez_snapshot_string_add(w, p->value.str);
+            break;
+
+         case DBUS_TYPE_OBJECT_PATH:
+            _e_bluez_snapshot_string_add(w, p->value.path);
+            break;
+
+         case DBUS_TYPE_ARRAY:
+            _e_bluez_snapshot_array_add(w, p->value.array);
+            break;
+        }
+      n_props++;
+   }
+
+   if (!w->failed)
+      w->words[at] = n_props;
+}
+
+static Eina_Bool
+_e_bluez_snapshot_element_add_cb(const Eina_Hash *hash __UNUSED__, const void *key __UNUSED__, void *data, void *fdata)
+{
+   E_Bluez_Snapshot_Writer *w = fdata;
+
+   _e_bluez_snapshot_element_add(w, data);
+   w->n_elements++;
+   return !w->failed;
+}
+
+static uint32_t
+_e_bluez_snapshot_word_get(E_Bluez_Snapshot_Reader *r)
+{
+   if (r->pos >= r->n_words)
+     {
+        r->failed = EINA_TRUE;
+        return 0;
+     }
+
+   return r->words[r->pos++];
+}
+
+static const char *
+_e_bluez_snapshot_string_get(E_Bluez_Snapshot_Reader *r)
+{
+   uint32_t offset = _e_bluez_snapshot_word_get(r);
+
+   if (offset >= r->strings_size)
+     {
+        r->failed = EINA_TRUE;
+        return "";
+     }
+
+   return r->strings + offset;
+}
+
+static E_Bluez_Element_Dict_Entry *
+_e_bluez_snapshot_dict_entry_get(E_Bluez_Snapshot_Reader *r)
+{
+   E_Bluez_Element_Dict_Entry *entry;
+   const char *name;
+   int type;
+
+   name = _e_bluez_snapshot_string_get(r);
+   type = _e_bluez_snapshot_word_get(r);
+   if (r->failed)
+      return NULL;
+
+   entry = calloc(1, sizeof(*entry));
+   if (!entry)
+     {
+        ERR("could not allocate memory for dict entry.");
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
+
+   switch (type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         entry->value.boolean = !!_e_bluez_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_BYTE:
+         entry->value.byte = _e_bluez_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_INT16:
+         entry->value.i16 = (short)_e_bluez_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_UINT16:
+         entry->value.u16 = _e_bluez_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_UINT32:
+         entry->value.u32 = _e_bluez_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_STRING:
+         entry->value.str =
+            eina_stringshare_add(_e_bluez_snapshot_string_get(r));
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         entry->value.path =
+            eina_stringshare_add(_e_bluez_snapshot_string_get(r));
+         break;
+
+      default:
+         r->failed = EINA_TRUE;
+         free(entry);
+         return NULL;
+     }
+
+   entry->name = eina_stringshare_add(name);
+   entry->type = type;
+   return entry;
+}
+
+static E_Bluez_Array *
+_e_bluez_snapshot_array_get(E_Bluez_Snapshot_Reader *r)
+{
+   E_Bluez_Array *array;
+   uint32_t count, i;
+   int type;
+
+   type = _e_bluez_snapshot_word_get(r);
+   count = _e_bluez_snapshot_word_get(r);
+   if ((r->failed) || (type == DBUS_TYPE_INVALID))
+      return NULL;
+
+   if (count > r->n_words - r->pos)
+     {
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
+
+   array = malloc(sizeof(E_Bluez_Array));
+   if (!array)
+     {
+        ERR("could not create new e_bluez array.");
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
+
+   array->type = type;
+   array->array = eina_array_new(16);
+   if (!(array->array))
+     {
+        ERR("could not create new eina array.");
+        free(array);
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
+
+   for (i = 0; (i < count) && (!r->failed); i++)
+     {
+        void *item;
+
+        switch (type)
+          {
+           case DBUS_TYPE_STRING:
+           case DBUS_TYPE_OBJECT_PATH:
+              item = (void *)eina_stringshare_add(_e_bluez_snapshot_string_get(r));
+              break;
+
+           case DBUS_TYPE_DICT_ENTRY:
+              item = _e_bluez_snapshot_dict_entry_get(r);
+              break;
+
+           case DBUS_TYPE_BOOLEAN:
+           case DBUS_TYPE_BYTE:
+           case DBUS_TYPE_UINT16:
+           case DBUS_TYPE_UINT32:
+              item = (void *)(long)_e_bluez_snapshot_word_get(r);
+              break;
+
+           default:
+              r->failed = EINA_TRUE;
+              continue;
+          }
+
+        if (item)
+           eina_array_push(array->array, item);
+     }
+
+   if (r->failed)
+     {
+        e_bluez_element_array_free(array, NULL);
+        return NULL;
+     }
+
+   return array;
+}
+
+static void
+_e_bluez_snapshot_element_get(E_Bluez_Snapshot_Reader *r)
+{
+   E_Bluez_Element_Property *p;
+   E_Bluez_Element *element;
+   const char *path, *interface;
+   uint32_t n_props, i;
+
+   path = _e_bluez_snapshot_string_get(r);
+   interface = eina_stringshare_add(_e_bluez_snapshot_string_get(r));
+   n_props = _e_bluez_snapshot_word_get(r);
+   element = r->failed ? NULL : e_bluez_element_register(path, interface);
+   eina_stringshare_del(interface);
+   if (!element)
+     {
+        r->failed = EINA_TRUE;
+        return;
+     }
+
+   for (i = 0; (i < n_props) && (!r->failed); i++)
+     {
+        const char *name;
+        void *value;
+        int type;
+
+        name = _e_bluez_snapshot_string_get(r);
+        type = _e_bluez_snapshot_word_get(r);
+        switch (type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+           case DBUS_TYPE_BYTE:
+           case DBUS_TYPE_UINT16:
+           case DBUS_TYPE_UINT32:
+              value = (void *)(long)_e_bluez_snapshot_word_get(r);
+              break;
+
+           case DBUS_TYPE_STRING:
+           case DBUS_TYPE_OBJECT_PATH:
+              value = (void *)_e_bluez_snapshot_string_get(r);
+              break;
+
+           case DBUS_TYPE_ARRAY:
+              value = _e_bluez_snapshot_array_get(r);
+              break;
+
+           default:
+              r->failed = EINA_TRUE;
+              continue;
+          }
+
+        if (!r->failed)
+           _e_bluez_element_property_value_add(element, name, type, value);
+     }
+
+   element->_stale = EINA_TRUE;
+   EINA_INLIST_FOREACH(element->props, p)
+      p->stale = EINA_TRUE;
+
+   if (element->props)
+      _e_bluez_element_listeners_call(element);
+}
+
+/**
+ * Write all the elements and their properties to a snapshot file.
+ *
+ * Give it to e_bluez_elements_snapshot_load() on the next start.  The file
+ * is replaced atomically.
+ *
+ * @param file where to write the snapshot.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_bluez_elements_snapshot_save(const char *file)
+{
+   static const char pad[4] = { 0, 0, 0, 0 };
+   E_Bluez_Snapshot_Header header;
+   E_Bluez_Snapshot_Writer w;
+   Eina_Bool ret = EINA_FALSE;
+   uint32_t n_pad;
+   size_t len;
+   char *tmp;
+   FILE *fp;
+   int fd;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(elements, EINA_FALSE);
+
+   memset(&w, 0, sizeof(w));
+   w.offsets = eina_hash_pointer_new(NULL);
+   if (!w.offsets)
+      return EINA_FALSE;
+
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+   eina_strlcpy(header.system, "bluez", sizeof(header.system));
+
+   eina_hash_foreach(elements, _e_bluez_snapshot_element_add_cb, &w);
+
+   if (w.failed)
+     {
+        ERR("could not build the snapshot for %s", file);
+        goto end;
+     }
+
+   n_pad = ((w.strings_size + 3) & ~3U) - w.strings_size;
+   header.strings_size = w.strings_size + n_pad;
+   header.n_elements = w.n_elements;
+   header.n_words = w.n_words;
+
+   len = strlen(file) + sizeof(".XXXXXX");
+   tmp = alloca(len);
+   snprintf(tmp, len, "%s.XXXXXX", file);
+   fd = mkstemp(tmp);
+   if (fd < 0)
+     {
+        ERR("could not create %s: %s", tmp, strerror(errno));
+        goto end;
+     }
+
+   fp = fdopen(fd, "wb");
+   if (!fp)
+     {
+        ERR("could not open %s: %s", tmp, strerror(errno));
+        close(fd);
+        unlink(tmp);
+        goto end;
+     }
+
+   if ((fwrite(&header, sizeof(header), 1, fp) != 1) ||
+       (fwrite(w.strings, 1, w.strings_size, fp) != w.strings_size) ||
+       (fwrite(pad, 1, n_pad, fp) != n_pad) ||
+       (fwrite(w.words, sizeof(uint32_t), w.n_words, fp) != w.n_words))
+     {
+        ERR("could not write %s: %s", tmp, strerror(errno));
+        fclose(fp);
+        unlink(tmp);
+        goto end;
+     }
+
+   if ((fclose(fp) != 0) || (rename(tmp, file) < 0))
+     {
+        ERR("could not save %s: %s", file, strerror(errno));
+        unlink(tmp);
+        goto end;
+     }
+
+   DBG("saved %u elements to %s", header.n_elements, file);
+   ret = EINA_TRUE;
+
+end:
+   eina_hash_free(w.offsets);
+   free(w.strings);
+   free(w.words);
+   return ret;
+}
+
+/**
+ * Add the elements saved by e_bluez_elements_snapshot_save().
+ *
+ * Call it right after e_bluez_system_init(), before the manager comes in.
+ * The elements are added at once with their last known properties and
+ * are stale, see e_bluez_element_is_stale(), until their GetProperties()
+ * reply arrives.  Listeners then only hear about the properties that
+ * differ, and those the server did not send are removed.  Elements gone
+ * meanwhile are removed when the lists holding them are synced.
+ *
+ * @param file the snapshot to load.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the file is missing or
+ *         invalid, or if there are elements already.
+ */
+Eina_Bool
+e_bluez_elements_snapshot_load(const char *file)
+{
+   const E_Bluez_Snapshot_Header *header;
+   E_Bluez_Snapshot_Reader r;
+   uint32_t n_elements, i;
+   struct stat st;
+   void *map;
+   int fd;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(elements, EINA_FALSE);
+
+   if (eina_hash_population(elements) > 0)
+     {
+        ERR("elements already known, not loading snapshot %s", file);
+        return EINA_FALSE;
+     }
+
+   fd = open(file, O_RDONLY);
+   if (fd < 0)
+     {
+        DBG("no snapshot %s: %s", file, strerror(errno));
+        return EINA_FALSE;
+     }
+
+   if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(*header)))
+     {
+        ERR("invalid snapshot %s", file);
+        close(fd);
+        return EINA_FALSE;
+     }
+
+   map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED)
+     {
+        ERR("could not map %s: %s", file, strerror(errno));
+        return EINA_FALSE;
+     }
+
+   header = map;
+   if ((memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) ||
+       (strncmp(header->system, "bluez", sizeof(header->system)) != 0) ||
+       (header->strings_size % 4) ||
+       /* only subtract and divide, the sizes in the file could overflow */
+       (header->strings_size > (size_t)st.st_size - sizeof(*header)) ||
+       (((size_t)st.st_size - sizeof(*header)) % sizeof(uint32_t)) ||
+       (header->n_words != ((size_t)st.st_size - sizeof(*header) -
+                            header->strings_size) / sizeof(uint32_t)))
+     {
+        ERR("invalid snapshot %s", file);
+        munmap(map, st.st_size);
+        return EINA_FALSE;
+     }
+
+   memset(&r, 0, sizeof(r));
+   r.strings = (const char *)(header + 1);
+   r.strings_size = header->strings_size;
+   r.words = (const uint32_t *)(r.strings + r.strings_size);
+   r.n_words = header->n_words;
+   n_elements = header->n_elements;
+
+   /* the last string is terminated, so all of them are */
+   if ((r.strings_size) && (r.strings[r.strings_size - 1] != '\0'))
+      r.failed = EINA_TRUE;
+
+   for (i = 0; (i < n_elements) && (!r.failed); i++)
+      _e_bluez_snapshot_element_get(&r);
+
+   munmap(map, st.st_size);
+
+   if (r.failed)
+     {
+        ERR("snapshot %s is corrupt, dropping it", file);
+        e_bluez_manager_clear_elements();
+        return EINA_FALSE;
+     }
+
+   DBG("loaded %u elements from %s", n_elements, file);
+   return EINA_TRUE;
+}
+
+/**
+ * Tell if the element still has the properties of a snapshot.
+ *
+ * @param element which element to query.
+ *
+ * @return @c EINA_TRUE until the server answered for the element.
+ */
+Eina_Bool
+e_bluez_element_is_stale(const E_Bluez_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return element->_stale;
+}
@@ -1,3 +1,6 @@
+#ifndef E_BLUEZ_PRIVATE_H
+#define E_BLUEZ_PRIVATE_H
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -127,6 +130,8 @@ void                            e_bluez_manager_clear_elements(void);
 
 void                            e_bluez_elements_init(void);
 void                            e_bluez_elements_shutdown(void);
+void                            e_bluez_elements_sync(E_Bluez_Element *manager);
+void                            e_bluez_element_sync_queue(E_Bluez_Element *element);
 
 E_Bluez_Element *               e_bluez_element_register(const char *path, const char *interface);
 void                            e_bluez_element_unregister(E_Bluez_Element *element);
@@ -141,3 +146,5 @@ Eina_Bool                       e_bluez_element_call_full(E_Bluez_Element *eleme
 Eina_Bool                       e_bluez_element_call_with_path(E_Bluez_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data);
 Eina_Bool                       e_bluez_element_call_with_string(E_Bluez_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data);
 Eina_Bool                       e_bluez_element_call_with_path_and_string(E_Bluez_Element *element, const char *method_name, const char *path, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data);
+
+#endif
@@ -35,8 +35,16 @@ extern int E_CONNMAN_EVENT_MANAGER_OUT;
 extern int E_CONNMAN_EVENT_ELEMENT_ADD;
 extern int E_CONNMAN_EVENT_ELEMENT_DEL;
 extern int E_CONNMAN_EVENT_ELEMENT_UPDATED;
+extern int E_CONNMAN_EVENT_ELEMENT_MOVED;
+extern int E_CONNMAN_EVENT_ELEMENTS_UPDATED;
+extern int E_CONNMAN_EVENT_ELEMENTS_SYNCED;
 
 typedef struct _E_Connman_Element   E_Connman_Element;
+typedef struct _E_Connman_Event_Elements_Updated E_Connman_Event_Elements_Updated;
+typedef struct _E_Connman_Element_Change E_Connman_Element_Change;
+typedef struct _E_Connman_Element_Changes E_Connman_Element_Changes;
+typedef struct _E_Connman_Elements_Iter E_Connman_Elements_Iter;
+typedef union _E_Connman_Value E_Connman_Value;
 
 struct _E_Connman_Element
 {
@@ -69,12 +77,87 @@ struct _E_Connman_Element
    } _idler;
    Eina_Inlist *_listeners;
    int          _references;
+   struct
+   {
+      void       **slots;
+      unsigned int size;
+      unsigned int count;
+   } _props_index;
+   void        *_service_record;
+   Eina_Bool    _dirty;
+   Eina_Bool    _sync_queued;
+   Eina_Bool    _stale;
+   Eina_Bool    _synced;
+   unsigned int _index[2];
+   struct
+   {
+      E_Connman_Element_Change *items;
+      unsigned int              count;
+      unsigned int              size;
+   } _changes;
+};
+
+/* value of a basic type, strings and object paths are stringshared */
+union _E_Connman_Value
+{
+   Eina_Bool      boolean;
+   unsigned char  byte;
+   unsigned short u16;
+   unsigned int   u32;
+   const char    *str;
+};
+
+/* A property that changed since the last update.  old_type is
+ * DBUS_TYPE_INVALID for a new property and type is for one that went
+ * away.  Values are only given for basic types, for arrays and dicts
+ * read the property from the element.
+ */
+struct _E_Connman_Element_Change
+{
+   const char     *name;
+   int             type;
+   int             old_type;
+   E_Connman_Value value;
+   E_Connman_Value old_value;
+};
+
+struct _E_Connman_Element_Changes
+{
+   E_Connman_Element_Change *items;
+   unsigned int              count;
+};
+
+/* borrowed iteration over the elements, see e_connman_elements_iter_init().
+ * Lives on the caller's stack, the fields are private.
+ */
+struct _E_Connman_Elements_Iter
+{
+   void * const      *_items;
+   unsigned int       _count;
+   unsigned int       _pos;
+   unsigned int       _generation;
+   Eina_Bool          _paths;
+};
+
+/* event info of E_CONNMAN_EVENT_ELEMENTS_UPDATED, valid during the event,
+ * changes[i] are those of elements[i] */
+struct _E_Connman_Event_Elements_Updated
+{
+   unsigned int               count;
+   E_Connman_Element        **elements;
+   E_Connman_Element_Changes *changes;
 };
 
 /* General Public API */
 EAPI unsigned int           e_connman_system_init(E_DBus_Connection *edbus_conn) EINA_ARG_NONNULL(1);
 EAPI unsigned int           e_connman_system_shutdown(void);
 
+EAPI void                   e_connman_elements_sync_window_set(unsigned int window);
+EAPI unsigned int           e_connman_elements_sync_window_get(void);
+
+EAPI Eina_Bool              e_connman_elements_snapshot_save(const char *file) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool              e_connman_elements_snapshot_load(const char *file) EINA_ARG_NONNULL(1);
+
 /* Manager Methods */
 EAPI E_Connman_Element *    e_connman_manager_get(void) EINA_WARN_UNUSED_RESULT;
 
@@ -88,6 +171,7 @@ EAPI Eina_Bool              e_connman_manager_offline_mode_set(Eina_Bool offline
 
 EAPI Eina_Bool              e_connman_manager_profiles_get(unsigned int *count, E_Connman_Element ***p_elements) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool              e_connman_manager_services_get(unsigned int *count, E_Connman_Element ***p_elements) EINA_ARG_NONNULL(1, 2)  EINA_WARN_UNUSED_RESULT;
+EAPI Eina_Bool              e_connman_manager_services_iter_init(E_Connman_Elements_Iter *iter) EINA_ARG_NONNULL(1);
 EAPI Eina_Bool              e_connman_manager_technologies_get(unsigned int *count, E_Connman_Element ***p_elements) EINA_ARG_NONNULL(1, 2)  EINA_WARN_UNUSED_RESULT;
 
 EAPI Eina_Bool              e_connman_manager_request_scan(const char *type, E_DBus_Method_Return_Cb cb, const void *data) EINA_WARN_UNUSED_RESULT;
@@ -207,10 +291,15 @@ EAPI Eina_Bool              e_connman_manager_sync_elements(void);
 
 EAPI Eina_Bool              e_connman_elements_get_all(unsigned int *count, E_Connman_Element ***p_elements) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool              e_connman_elements_get_all_type(const char *type, unsigned int *count, E_Connman_Element ***p_elements) EINA_ARG_NONNULL(1, 2, 3) EINA_WARN_UNUSED_RESULT;
+EAPI void                   e_connman_elements_iter_init(E_Connman_Elements_Iter *iter, const char *interface) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool              e_connman_element_objects_iter_init(E_Connman_Elements_Iter *iter, const E_Connman_Element *element, const char *property) EINA_ARG_NONNULL(1, 2, 3);
+EAPI E_Connman_Element *    e_connman_elements_iter_next(E_Connman_Elements_Iter *iter) EINA_ARG_NONNULL(1);
 EAPI E_Connman_Element *    e_connman_element_get(const char *path);
 
 EAPI void                   e_connman_element_listener_add(E_Connman_Element *element, void (*cb)(void *data, const E_Connman_Element *element), const void *data, void (*free_data)(void *data)) EINA_ARG_NONNULL(1, 2);
 EAPI void                   e_connman_element_listener_del(E_Connman_Element *element, void (*cb)(void *data, const E_Connman_Element *element), const void *data) EINA_ARG_NONNULL(1, 2);
+EAPI void                   e_connman_element_changes_listener_add(E_Connman_Element *element, void (*cb)(void *data, const E_Connman_Element *element, const E_Connman_Element_Changes *changes), const void *data, void (*free_data)(void *data), const char **names) EINA_ARG_NONNULL(1, 2);
+EAPI void                   e_connman_element_changes_listener_del(E_Connman_Element *element, void (*cb)(void *data, const E_Connman_Element *element, const E_Connman_Element_Changes *changes), const void *data) EINA_ARG_NONNULL(1, 2);
 
 EAPI int                    e_connman_element_ref(E_Connman_Element *element) EINA_ARG_NONNULL(1);
 EAPI int                    e_connman_element_unref(E_Connman_Element *element) EINA_ARG_NONNULL(1);
@@ -219,6 +308,7 @@ EAPI void                   e_connman_element_print(FILE *fp, const E_Connman_El
 
 EAPI Eina_Bool              e_connman_element_properties_sync(E_Connman_Element *element) EINA_ARG_NONNULL(1);
 EAPI Eina_Bool              e_connman_element_properties_sync_full(E_Connman_Element *element, E_DBus_Method_Return_Cb cb, const void *data) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool              e_connman_element_is_stale(const E_Connman_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
 EAPI void                   e_connman_element_properties_list(const E_Connman_Element *element, Eina_Bool (*cb)(void *data, const E_Connman_Element *element, const char *name, int type, const void *value), const void *data) EINA_ARG_NONNULL(1, 2);
 
 EAPI Eina_Bool              e_connman_element_property_set(E_Connman_Element *element, const char *prop, int type, const void *value) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
@@ -231,9 +321,11 @@ EAPI Eina_Bool              e_connman_element_property_type_get_stringshared(con
 EAPI Eina_Bool              e_connman_element_property_type_get(const E_Connman_Element *element, const char *name, int *type) EINA_ARG_NONNULL(1, 2, 3) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool              e_connman_element_property_dict_get_stringshared(const E_Connman_Element *element, const char *dict_name, const char *key_name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool              e_connman_element_property_dict_strings_array_get_stringshared(const E_Connman_Element *element, const char *dict_name, const char *key, unsigned int *count, const char ***strings) EINA_ARG_NONNULL(1, 2, 3, 4) EINA_WARN_UNUSED_RESULT;
+EAPI Eina_Bool              e_connman_element_property_dict_strings_array_view(const E_Connman_Element *element, const char *dict_name, const char *key, unsigned int *count, const char ***strings) EINA_ARG_NONNULL(1, 2, 3, 4, 5) EINA_WARN_UNUSED_RESULT;
 
 EAPI Eina_Bool              e_connman_element_property_get_stringshared(const E_Connman_Element *element, const char *name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool              e_connman_element_property_get(const E_Connman_Element *element, const char *name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
+EAPI Eina_Bool              e_connman_element_strings_array_view(const E_Connman_Element *element, const char *property, unsigned int *count, const char ***strings) EINA_ARG_NONNULL(1, 2, 3, 4) EINA_WARN_UNUSED_RESULT;
 
 EAPI Eina_Bool              e_connman_element_is_manager(const E_Connman_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool              e_connman_element_is_profile(const E_Connman_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
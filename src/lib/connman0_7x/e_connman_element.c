@@ -2,14 +2,39 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "e_dbus_probes.h"
+
+E_DBUS_PROBE_DEFINE(econnman, property_update);
 
 static Eina_Hash *elements = NULL;
+/* one PropertyChanged match for all elements, routed by path and interface */
+static E_DBus_Signal_Handler *property_changed_handler = NULL;
+/* elements with changes not yet delivered, see _elements_changed_flush() */
+static Eina_Array *changed_elements = NULL;
+static Ecore_Idle_Enterer *changed_flush = NULL;
+/* elements waiting for their GetProperties, see _elements_sync_pump() */
+static Eina_List *sync_queue = NULL;
+static unsigned int sync_in_flight = 0;
+/* calls from before the last shutdown complete late, see _sync_done() */
+static unsigned int sync_generation = 0;
+static unsigned int sync_window = 8;
+static Eina_Bool sync_initial = EINA_FALSE;
+/* manager whose GetProperties was sent outside of the queue */
+static E_Connman_Element *sync_manager = NULL;
+/* bumped whenever an iterator would go stale, see _elements_index_add() */
+static unsigned int elements_generation = 0;
 
 typedef struct _E_Connman_Element_Pending      E_Connman_Element_Pending;
 typedef struct _E_Connman_Element_Call_Data    E_Connman_Element_Call_Data;
 typedef struct _E_Connman_Element_Property     E_Connman_Element_Property;
 typedef struct _E_Connman_Element_Listener     E_Connman_Element_Listener;
 typedef struct _E_Connman_Element_Dict_Entry   E_Connman_Element_Dict_Entry;
+typedef struct _E_Connman_Service_Record       E_Connman_Service_Record;
 
 struct _E_Connman_Element_Pending
 {
@@ -43,6 +68,7 @@ struct _E_Connman_Element_Property
       void            *variant;
       E_Connman_Array *array;
    } value;
+   Eina_Bool   stale; /* from a snapshot, not sent again yet */
 };
 
 struct _E_Connman_Element_Dict_Entry
@@ -60,12 +86,54 @@ struct _E_Connman_Element_Dict_Entry
    } value;
 };
 
+/* the known properties of a service, they still live in element->props */
+struct _E_Connman_Service_Record
+{
+   E_Connman_Element_Property   *props[E_CONNMAN_SERVICE_SLOT_LAST];
+   E_Connman_Element_Dict_Entry *entries[E_CONNMAN_SERVICE_SLOT_DICTS][E_CONNMAN_SERVICE_KEY_LAST];
+};
+
+/* names of the slots in E_Connman_Service_Slot and E_Connman_Service_Key */
+static const char **service_slot_names[E_CONNMAN_SERVICE_SLOT_LAST] = {
+   &e_connman_prop_state,
+   &e_connman_prop_error,
+   &e_connman_prop_name,
+   &e_connman_prop_type,
+   &e_connman_prop_passphrase,
+   &e_connman_prop_passphrase_required,
+   &e_connman_prop_login_required,
+   &e_connman_prop_strength,
+   &e_connman_prop_favorite,
+   &e_connman_prop_immutable,
+   &e_connman_prop_auto_connect,
+   &e_connman_prop_roaming,
+   &e_connman_prop_ipv4,
+   &e_connman_prop_ipv4_configuration,
+   &e_connman_prop_proxy,
+   &e_connman_prop_proxy_configuration,
+   &e_connman_prop_ethernet
+};
+
+static const char **service_key_names[E_CONNMAN_SERVICE_KEY_LAST] = {
+   &e_connman_prop_method,
+   &e_connman_prop_address,
+   &e_connman_prop_gateway,
+   &e_connman_prop_netmask,
+   &e_connman_prop_url,
+   &e_connman_prop_interface,
+   &e_connman_prop_speed,
+   &e_connman_prop_duplex,
+   &e_connman_prop_mtu
+};
+
 struct _E_Connman_Element_Listener
 {
          EINA_INLIST;
    void  (*cb)(void *data, const E_Connman_Element *element);
+   void  (*changes_cb)(void *data, const E_Connman_Element *element, const E_Connman_Element_Changes *changes);
    void *data;
    void  (*free_data)(void *data);
+   const char **names; /* stringshared and NULL terminated, or NULL for all */
 };
 
 static void
@@ -121,6 +189,20 @@ e_connman_element_pending_cancel_and_free(Eina_Inlist **pending)
      }
 }
 
+static void
+_e_connman_element_listener_names_free(const char **names)
+{
+   const char **name;
+
+   if (!names)
+      return;
+
+   for (name = names; *name; name++)
+      eina_stringshare_del(*name);
+
+   free(names);
+}
+
 void
 e_connman_element_listener_add(E_Connman_Element *element, void (*cb)(void *data, const E_Connman_Element *element), const void *data, void (*free_data)(void *data))
 {
@@ -136,8 +218,10 @@ e_connman_element_listener_add(E_Connman_Element *element, void (*cb)(void *data
      }
 
    l->cb = cb;
+   l->changes_cb = NULL;
    l->data = (void *)data;
    l->free_data = free_data;
+   l->names = NULL;
 
    element->_listeners = eina_inlist_append
          (element->_listeners, EINA_INLIST_GET(l));
@@ -165,907 +249,1569 @@ e_connman_element_listener_del(E_Connman_Element *element, void (*cb)(void *data
         if (l->free_data)
            l->free_data(l->data);
 
+        _e_connman_element_listener_names_free(l->names);
         free(l);
         return;
      }
 }
 
-static void
-_e_connman_element_listeners_call_do(E_Connman_Element *element)
+/**
+ * Add a listener that is told which properties changed.
+ *
+ * Like e_connman_element_listener_add(), but @a cb also gets the changes
+ * of this update, see E_Connman_Element_Change.  With @a names, a NULL terminated
+ * array of property names, it is only called when one of them changed.
+ *
+ * @param element element to listen to.
+ * @param cb function to call on updates.
+ * @param data data to give to cb.
+ * @param free_data function to free data when the listener is removed.
+ * @param names properties to listen to, or NULL for all of them.
+ */
+void
+e_connman_element_changes_listener_add(E_Connman_Element *element, void (*cb)(void *data, const E_Connman_Element *element, const E_Connman_Element_Changes *changes), const void *data, void (*free_data)(void *data), const char **names)
 {
    E_Connman_Element_Listener *l;
-   Eina_Inlist *x;
+   unsigned int i, count = 0;
 
-   /* NB: iterate on a copy in order to allow listeners to be deleted
-    * from callbacks.  number of listeners should be small, so the
-    * following should do fine.
-    */
-   if (eina_inlist_count(element->_listeners) < 1) goto end;
+   EINA_SAFETY_ON_FALSE_GOTO(element, error);
+   EINA_SAFETY_ON_FALSE_GOTO(cb, error);
 
-   EINA_INLIST_FOREACH_SAFE(element->_listeners, x, l)
-     l->cb(l->data, element);
+   l = malloc(sizeof(*l));
+   if (!l)
+     {
+        ERR("could not allocate E_Connman_Element_Listener");
+        goto error;
+     }
 
-end:
-   e_connman_element_event_add(E_CONNMAN_EVENT_ELEMENT_UPDATED, element);
-}
+   l->cb = NULL;
+   l->changes_cb = cb;
+   l->data = (void *)data;
+   l->free_data = free_data;
+   l->names = NULL;
 
-static Eina_Bool
-_e_connman_element_listeners_call_idler(void *data)
-{
-   E_Connman_Element *element = data;
-   _e_connman_element_listeners_call_do(element);
-   element->_idler.changed = NULL;
-   return ECORE_CALLBACK_CANCEL;
+   if (names)
+     {
+        while (names[count])
+           count++;
+
+        l->names = malloc((count + 1) * sizeof(char *));
+        if (!l->names)
+          {
+             ERR("could not allocate the names of E_Connman_Element_Listener");
+             free(l);
+             goto error;
+          }
+
+        for (i = 0; i < count; i++)
+           l->names[i] = eina_stringshare_add(names[i]);
+        l->names[count] = NULL;
+     }
+
+   element->_listeners = eina_inlist_append
+         (element->_listeners, EINA_INLIST_GET(l));
+
+   return;
+
+error:
+   if (free_data)
+      free_data((void *)data);
 }
 
-static void
-_e_connman_element_listeners_call(E_Connman_Element *element)
+void
+e_connman_element_changes_listener_del(E_Connman_Element *element, void (*cb)(void *data, const E_Connman_Element *element, const E_Connman_Element_Changes *changes), const void *data)
 {
-   if (element->_idler.changed)
-      return;
+   E_Connman_Element_Listener *l;
 
-   element->_idler.changed = ecore_idler_add
-         (_e_connman_element_listeners_call_idler, element);
-}
+   EINA_SAFETY_ON_NULL_RETURN(element);
+   EINA_SAFETY_ON_NULL_RETURN(cb);
 
-/***********************************************************************
-* Property
-***********************************************************************/
+   EINA_INLIST_FOREACH(element->_listeners, l)
+   if ((l->changes_cb == cb) && (l->data == data))
+     {
+        element->_listeners = eina_inlist_remove
+              (element->_listeners, EINA_INLIST_GET(l));
+        if (l->free_data)
+           l->free_data(l->data);
+
+        _e_connman_element_listener_names_free(l->names);
+        free(l);
+        return;
+     }
+}
 
 static void
-_e_connman_element_dict_entry_free(E_Connman_Element_Dict_Entry *entry)
+_e_connman_element_listener_call(E_Connman_Element *element, E_Connman_Element_Listener *l, const E_Connman_Element_Changes *changes)
 {
-   switch (entry->type)
-     {
-      case DBUS_TYPE_BOOLEAN:
-      case DBUS_TYPE_BYTE:
-      case DBUS_TYPE_UINT16:
-      case DBUS_TYPE_UINT32:
-         break;
+   if (l->changes_cb)
+      l->changes_cb(l->data, element, changes);
+   else
+      l->cb(l->data, element);
+}
 
-      case DBUS_TYPE_OBJECT_PATH:
-         eina_stringshare_del(entry->value.path);
-         break;
+/* listeners with names only wake for changes of those properties */
+static Eina_Bool
+_e_connman_element_listener_wants(const E_Connman_Element_Listener *l, const E_Connman_Element_Changes *changes)
+{
+   const char **name;
+   unsigned int i;
 
-      case DBUS_TYPE_STRING:
-         eina_stringshare_del(entry->value.str);
-         break;
+   if (!l->names)
+      return EINA_TRUE;
 
-      default:
-         ERR("don't know how to free dict entry '%s' of type %c (%d)",
-             entry->name, entry->type, entry->type);
-     }
+   for (i = 0; i < changes->count; i++)
+      for (name = l->names; *name; name++)
+         if (changes->items[i].name == *name)
+            return EINA_TRUE;
 
-   eina_stringshare_del(entry->name);
-   free(entry);
+   return EINA_FALSE;
 }
 
-static E_Connman_Element_Dict_Entry *
-_e_connman_element_dict_entry_new(DBusMessageIter *itr)
+static void
+_e_connman_element_listener_run(E_Connman_Element *element, E_Connman_Element_Listener *l, const E_Connman_Element_Changes *changes)
 {
-   E_Connman_Element_Dict_Entry *entry;
-   DBusMessageIter e_itr, v_itr;
-   int t;
-   const char *key = NULL;
-   void *value = NULL;
+   E_DBus_Connection *conn = e_connman_conn;
+   const char *interface, *path;
+   double start;
 
-   dbus_message_iter_recurse(itr, &e_itr);
-
-   t = dbus_message_iter_get_arg_type(&e_itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+   start = conn ? e_dbus_connection_handler_begin(conn) : 0.0;
+   if (start <= 0.0)
      {
-        ERR("invalid format for dict entry. first type not a string: %c (%d)",
-            t, t);
-        return NULL;
+        _e_connman_element_listener_call(element, l, changes);
+        return;
      }
 
-   dbus_message_iter_get_basic(&e_itr, &key);
-   if (!key || !key[0])
-     {
-        ERR("invalid format for dict entry. no key.");
-        return NULL;
-     }
+   /* the listener may free the element */
+   interface = eina_stringshare_ref(element->interface);
+   path = eina_stringshare_ref(element->path);
+   _e_connman_element_listener_call(element, l, changes);
+   e_dbus_connection_handler_end(conn, start, "listener", interface, path);
+   eina_stringshare_del(interface);
+   eina_stringshare_del(path);
+}
 
-   dbus_message_iter_next(&e_itr);
-   t = dbus_message_iter_get_arg_type(&e_itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
-     {
-        ERR("invalid format for dict entry '%s'. "
-            "second type not a variant: %c (%d)",
-            key, t, t);
-        return NULL;
-     }
+static void
+_e_connman_element_listeners_call_do(E_Connman_Element *element, const E_Connman_Element_Changes *changes)
+{
+   E_Connman_Element_Listener *l;
+   Eina_Inlist *x;
 
-   dbus_message_iter_recurse(&e_itr, &v_itr);
+   /* NB: iterate on a copy in order to allow listeners to be deleted
+    * from callbacks.  number of listeners should be small, so the
+    * following should do fine.
+    */
+   if (eina_inlist_count(element->_listeners) < 1) goto end;
 
-   t = dbus_message_iter_get_arg_type(&v_itr);
-   if ((t == DBUS_TYPE_INVALID) || (t == DBUS_TYPE_ARRAY))
-     {
-        ERR("invalid type for dict value for entry '%s': %c (%d)",
-            key, t, t);
-        return NULL;
-     }
+   EINA_INLIST_FOREACH_SAFE(element->_listeners, x, l)
+     if (_e_connman_element_listener_wants(l, changes))
+       _e_connman_element_listener_run(element, l, changes);
 
-   entry = calloc(1, sizeof(*entry));
-   if (!entry)
-     {
-        ERR("could not allocate memory for dict entry.");
-        return NULL;
-     }
+end:
+   e_connman_element_event_add(E_CONNMAN_EVENT_ELEMENT_UPDATED, element);
+}
 
-   dbus_message_iter_get_basic(&v_itr, &value);
-   switch (t)
+static void
+_e_connman_element_value_keep(const E_Connman_Element_Property *p, E_Connman_Value *v)
+{
+   memset(v, 0, sizeof(*v));
+   switch (p->type)
      {
       case DBUS_TYPE_BOOLEAN:
-         entry->value.boolean = (Eina_Bool)(long)value;
+         v->boolean = p->value.boolean;
          break;
 
       case DBUS_TYPE_BYTE:
-         entry->value.byte = (unsigned char)(long)value;
+         v->byte = p->value.byte;
          break;
 
       case DBUS_TYPE_UINT16:
-         entry->value.u16 = (unsigned short)(long)value;
+         v->u16 = p->value.u16;
          break;
 
       case DBUS_TYPE_UINT32:
-         entry->value.u32 = (unsigned int)(long)value;
+         v->u32 = p->value.u32;
          break;
 
       case DBUS_TYPE_STRING:
-         entry->value.str = eina_stringshare_add(value);
+         v->str = eina_stringshare_ref(p->value.str);
          break;
 
       case DBUS_TYPE_OBJECT_PATH:
-         entry->value.path = eina_stringshare_add(value);
+         v->str = eina_stringshare_ref(p->value.path);
          break;
 
       default:
-         ERR("don't know how to create dict entry '%s' for of type %c (%d)",
-             key, t, t);
-         free(entry);
-         return NULL;
+         break;
      }
+}
 
-   entry->name = eina_stringshare_add(key);
-   entry->type = t;
-   return entry;
+static void
+_e_connman_element_value_release(int type, E_Connman_Value *v)
+{
+   if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+      eina_stringshare_del(v->str);
 }
 
-static E_Connman_Element_Dict_Entry *
-_e_connman_element_array_dict_find_stringshared(const E_Connman_Array *array, const char *key)
+/* Records that p changed for the next flush.  A property changed twice
+ * before it keeps its first old value.  Takes over old.
+ */
+static void
+_e_connman_element_change_add(E_Connman_Element *element, const E_Connman_Element_Property *p, int old_type, E_Connman_Value *old)
 {
-   E_Connman_Element_Dict_Entry *entry;
-   Eina_Array_Iterator iterator;
+   E_Connman_Element_Change *c;
    unsigned int i;
 
-   EINA_ARRAY_ITER_NEXT(array->array, i, entry, iterator)
-   if (entry->name == key)
-      return entry;
+   for (i = 0; i < element->_changes.count; i++)
+     {
+        c = element->_changes.items + i;
+        if (c->name != p->name)
+           continue;
 
-   return NULL;
+        _e_connman_element_value_release(old_type, old);
+        _e_connman_element_value_release(c->type, &c->value);
+        c->type = p->type;
+        _e_connman_element_value_keep(p, &c->value);
+        return;
+     }
+
+   if (element->_changes.count == element->_changes.size)
+     {
+        unsigned int size = element->_changes.size ? element->_changes.size * 2 : 4;
+
+        c = realloc(element->_changes.items, size * sizeof(E_Connman_Element_Change));
+        if (!c)
+          {
+             ERR("could not record the change of %s on %s",
+                 p->name, element->path);
+             _e_connman_element_value_release(old_type, old);
+             return;
+          }
+
+        element->_changes.items = c;
+        element->_changes.size = size;
+     }
+
+   c = element->_changes.items + element->_changes.count++;
+   c->name = eina_stringshare_ref(p->name);
+   c->type = p->type;
+   _e_connman_element_value_keep(p, &c->value);
+   c->old_type = old_type;
+   c->old_value = *old;
 }
 
 static void
-_e_connman_element_array_free(E_Connman_Array *array, E_Connman_Array *new __UNUSED__)
+_e_connman_element_changes_free(E_Connman_Element_Changes *changes)
 {
-   Eina_Array_Iterator iterator;
    unsigned int i;
-   void *item;
-
-   if (!array)
-      return;
 
-   switch (array->type)
+   for (i = 0; i < changes->count; i++)
      {
-      case DBUS_TYPE_BOOLEAN:
-      case DBUS_TYPE_BYTE:
-      case DBUS_TYPE_UINT16:
-      case DBUS_TYPE_UINT32:
-         break;
+        E_Connman_Element_Change *c = changes->items + i;
 
-      case DBUS_TYPE_STRING:
-      case DBUS_TYPE_OBJECT_PATH:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-            eina_stringshare_del(item);
-         break;
+        _e_connman_element_value_release(c->type, &c->value);
+        _e_connman_element_value_release(c->old_type, &c->old_value);
+        eina_stringshare_del(c->name);
+     }
 
-      case DBUS_TYPE_DICT_ENTRY:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         _e_connman_element_dict_entry_free(item);
-         break;
+   free(changes->items);
+   changes->items = NULL;
+   changes->count = 0;
+}
 
-      default:
-         ERR("don't know how to free array of values of type %c (%d)",
-             array->type, array->type);
-         break;
-     }
-   eina_array_free(array->array);
-   free(array);
+/* moves the changes recorded on element to changes */
+static void
+_e_connman_element_changes_take(E_Connman_Element *element, E_Connman_Element_Changes *changes)
+{
+   changes->items = element->_changes.items;
+   changes->count = element->_changes.count;
+   element->_changes.items = NULL;
+   element->_changes.count = 0;
+   element->_changes.size = 0;
 }
 
 static void
-_e_connman_element_property_value_free(E_Connman_Element_Property *property)
+_e_connman_elements_updated_free(void *data __UNUSED__, void *ev)
 {
-   switch (property->type)
+   E_Connman_Event_Elements_Updated *event = ev;
+   unsigned int i;
+
+   for (i = 0; i < event->count; i++)
      {
-      case 0:
-         return;
+        _e_connman_element_changes_free(event->changes + i);
+        e_connman_element_unref(event->elements[i]);
+     }
 
-      case DBUS_TYPE_BOOLEAN:
-      case DBUS_TYPE_BYTE:
-      case DBUS_TYPE_UINT16:
-      case DBUS_TYPE_UINT32:
-         break;
-
-      case DBUS_TYPE_STRING:
-         eina_stringshare_del(property->value.str);
-         break;
+   free(event);
+}
 
-      case DBUS_TYPE_OBJECT_PATH:
-         eina_stringshare_del(property->value.path);
-         break;
+/* Changed elements wait in a dirty set, each with a reference, until the
+ * main loop is about to go idle.  Then their listeners run and a single
+ * E_CONNMAN_EVENT_ELEMENTS_UPDATED carries them all.
+ */
+static Eina_Bool
+_e_connman_elements_changed_flush(void *data __UNUSED__)
+{
+   E_Connman_Event_Elements_Updated *event;
+   Eina_Array *changed = changed_elements;
+   unsigned int i, count;
+
+   /* elements changed by the listeners go to the next batch */
+   changed_elements = NULL;
+   changed_flush = NULL;
+
+   count = eina_array_count(changed);
+   event = malloc(sizeof(*event) +
+                  count * (sizeof(E_Connman_Element_Changes) + sizeof(E_Connman_Element *)));
+   if (event)
+     {
+        event->count = 0;
+        event->changes = (E_Connman_Element_Changes *)(event + 1);
+        event->elements = (E_Connman_Element **)(event->changes + count);
+     }
+   else
+      ERR("could not allocate the updated elements event");
 
-      case DBUS_TYPE_ARRAY:
-         _e_connman_element_array_free(property->value.array, NULL);
-         break;
+   for (i = 0; i < count; i++)
+     {
+        E_Connman_Element *element = eina_array_data_get(changed, i);
+        E_Connman_Element_Changes changes;
+
+        element->_dirty = EINA_FALSE;
+        _e_connman_element_changes_take(element, &changes);
+        /* skip those unregistered meanwhile, they got their DEL event, and
+         * all of them if a listener shut the system down */
+        if ((elements) && (eina_hash_find(elements, element->path) == element))
+          {
+             _e_connman_element_listeners_call_do(element, &changes);
+             if (event)
+               {
+                  event->changes[event->count] = changes;
+                  event->elements[event->count++] = element;
+                  continue;
+               }
+          }
 
-      default:
-         ERR("don't know how to free value of property type %c (%d)",
-             property->type, property->type);
+        _e_connman_element_changes_free(&changes);
+        e_connman_element_unref(element);
      }
+
+   eina_array_free(changed);
+
+   if ((event) && (event->count))
+      ecore_event_add(E_CONNMAN_EVENT_ELEMENTS_UPDATED, event,
+                      _e_connman_elements_updated_free, NULL);
+   else
+      free(event);
+
+   return ECORE_CALLBACK_CANCEL;
 }
 
-static const char *
-_e_connman_element_get_interface(const char *key)
+static void
+_e_connman_element_listeners_call(E_Connman_Element *element)
 {
-   const char *interface = NULL, *tail;
-   char head;
+   if (element->_dirty)
+      return;
 
-   head = key[0];
-   tail = key + 1;
+   if (!changed_elements)
+     {
+        changed_elements = eina_array_new(32);
+        if (!changed_elements)
+          {
+             ERR("could not allocate the changed elements");
+             return;
+          }
+     }
 
-   switch (head)
+   if (!eina_array_push(changed_elements, element))
      {
-      case 'P':
-         if (strcmp(tail, "rofiles") == 0)
-            interface = e_connman_iface_profile;
+        ERR("could not mark element %s as changed", element->path);
+        return;
+     }
 
-         break;
+   element->_dirty = EINA_TRUE;
+   e_connman_element_ref(element);
 
-      case 'S':
-         if (strcmp(tail, "ervices") == 0)
-            interface = e_connman_iface_service;
+   if (!changed_flush)
+      changed_flush = ecore_idle_enterer_add
+            (_e_connman_elements_changed_flush, NULL);
+}
 
-         break;
+/* GetProperties of the elements go through a queue, at most sync_window
+ * of them in flight, so the elements found in the manager's reply are
+ * fetched in parallel instead of all at once or one after the other.
+ * Once the queue started by e_connman_elements_sync() drains, a single
+ * E_CONNMAN_EVENT_ELEMENTS_SYNCED tells everything is known.
+ */
+static void _e_connman_elements_sync_pump(void);
 
-      case 'T':
-         if (strcmp(tail, "echnologies") == 0)
-            interface = e_connman_iface_technology;
+static void
+_e_connman_element_sync_done(void *data, DBusMessage *msg __UNUSED__, DBusError *err __UNUSED__)
+{
+   /* canceled along with the elements of an older sync, not counted */
+   if ((unsigned long)data != sync_generation)
+      return;
 
-         break;
+   if (sync_in_flight > 0)
+      sync_in_flight--;
+   _e_connman_elements_sync_pump();
+}
 
-      default:
-         break;
-     }
+static void
+_e_connman_elements_sync_pump(void)
+{
+   while ((sync_queue) && ((!sync_window) || (sync_in_flight < sync_window)))
+     {
+        E_Connman_Element *element = eina_list_data_get(sync_queue);
 
-   if (!interface)
-      ERR("failed to find interface for property \"%s\"", key);
+        sync_queue = eina_list_remove_list(sync_queue, sync_queue);
+        element->_sync_queued = EINA_FALSE;
+        /* skip those unregistered while waiting */
+        if ((elements) && (eina_hash_find(elements, element->path) == element))
+          {
+             if (e_connman_element_properties_sync_full
+                    (element, _e_connman_element_sync_done,
+                    (void *)(unsigned long)sync_generation))
+                sync_in_flight++;
+             else
+                WRN("could not get properties of %s", element->path);
+          }
+        e_connman_element_unref(element);
+     }
 
-   return interface;
+   if ((sync_initial) && (!sync_queue) && (!sync_in_flight))
+     {
+        sync_initial = EINA_FALSE;
+        DBG("all elements synced");
+        ecore_event_add(E_CONNMAN_EVENT_ELEMENTS_SYNCED, NULL, NULL, NULL);
+     }
 }
 
 static void
-_e_connman_element_item_register(const char *key, const char *item)
+_e_connman_elements_sync_clear(void)
 {
    E_Connman_Element *element;
-   const char *interface;
-
-   interface = _e_connman_element_get_interface(key);
-   if (!interface)
-      return;
 
-   element = e_connman_element_register(item, interface);
-   if ((element) && (!e_connman_element_properties_sync(element)))
-      WRN("could not get properties of %s", element->path);
+   sync_initial = EINA_FALSE;
+   sync_manager = NULL;
+   EINA_LIST_FREE(sync_queue, element)
+   {
+      element->_sync_queued = EINA_FALSE;
+      e_connman_element_unref(element);
+   }
 }
 
-/* Match 2 arrays to find which are new and which are old elements
- * For new elements, register them under prop_name property
- * For old elements, unregister them, sending proper DEL event
+/**
+ * Queue a GetProperties() of the given element.
+ *
+ * Nothing is queued if the element is already waiting or if its
+ * properties are on their way.
+ * @internal
  */
-static void
-_e_connman_element_array_match(E_Connman_Array *old, E_Connman_Array *new, const char *prop_name)
+void
+e_connman_element_sync_queue(E_Connman_Element *element)
 {
-   Eina_List *deleted = NULL;
-   Eina_Array_Iterator iter_old, iter_new;
-   unsigned int i_old = 0, i_new = 0;
-   void *item_old, *item_new;
-   Eina_List *l;
-   void *data;
+   unsigned int count;
 
-   if (!old)
-      return;
+   EINA_SAFETY_ON_NULL_RETURN(element);
 
-   if (old->type != DBUS_TYPE_OBJECT_PATH)
+   if ((element->_sync_queued) || (element->_pending.properties_get))
       return;
 
-   if ((!new) || (!new->array) || eina_array_count(new->array) == 0)
+   count = eina_list_count(sync_queue);
+   sync_queue = eina_list_append(sync_queue, element);
+   if (eina_list_count(sync_queue) == count)
      {
-        if ((!old) || (!old->array) || eina_array_count(old->array) == 0)
-          {
-             return;
-          }
-        else
-          {
-             iter_old = old->array->data;
-             goto out_remove_remaining;
-          }
+        ERR("could not queue the sync of %s", element->path);
+        return;
      }
 
-   iter_new = new->array->data;
-   item_new = *iter_new;
-   EINA_ARRAY_ITER_NEXT(old->array, i_old, item_old, iter_old)
-   {
-      if (item_old == item_new)
-        {
-           i_new++;
-           if (i_new >= eina_array_count(new->array))
-             {
-                i_old++;
-                break;
-             }
-
-           iter_new++;
-           item_new = *iter_new;
-        }
-      else
-        {
-           deleted = eina_list_append(deleted, item_old);
-        }
-   }
+   element->_sync_queued = EINA_TRUE;
+   e_connman_element_ref(element);
+   _e_connman_elements_sync_pump();
+}
 
-   for(; i_new < eina_array_count(new->array); iter_new++, i_new++)
-     {
-        Eina_Bool found = EINA_FALSE;
-        item_new = *iter_new;
-        if (!item_new)
-           break;
+/**
+ * Start the initial sync from the manager.
+ *
+ * E_CONNMAN_EVENT_ELEMENTS_SYNCED is posted once the properties of the manager
+ * and of all the elements found from it arrived.
+ * @internal
+ */
+void
+e_connman_elements_sync(E_Connman_Element *manager)
+{
+   EINA_SAFETY_ON_NULL_RETURN(manager);
 
-        EINA_LIST_FOREACH(deleted, l, data)
-        {
-           if (data == item_new)
-             {
-                deleted = eina_list_remove_list(deleted, l);
-                found = EINA_TRUE;
-                break;
-             }
-        }
-        if (!found)
-          {
-             _e_connman_element_item_register(prop_name, item_new);
-             DBG("Add element %s\n", (const char *)item_new);
-          }
+   sync_initial = EINA_TRUE;
+   /* already on its way outside of the queue, wait for that reply */
+   if ((manager->_pending.properties_get) && (!sync_manager))
+     {
+        sync_manager = manager;
+        sync_in_flight++;
      }
+   else
+      e_connman_element_sync_queue(manager);
+}
 
-   /* everybody after i_old on old->array + everybody from deleted list
-      will be removed
-    */
-   EINA_LIST_FREE(deleted, data)
-   {
-      E_Connman_Element *e = e_connman_element_get(data);
-      if (e)
-         e_connman_element_unregister(e);
+/**
+ * Set how many GetProperties() may be in flight at once.
+ *
+ * The default of 8 keeps the server busy without flooding it.  Zero
+ * removes the limit.
+ *
+ * @param window maximum number of calls waiting for a reply.
+ */
+void
+e_connman_elements_sync_window_set(unsigned int window)
+{
+   sync_window = window;
+   _e_connman_elements_sync_pump();
+}
 
-      DBG("Delete element %s\n", (const char *)data);
-   }
+/**
+ * Get how many GetProperties() may be in flight at once.
+ *
+ * @return the window, zero if unlimited.
+ */
+unsigned int
+e_connman_elements_sync_window_get(void)
+{
+   return sync_window;
+}
+
+/***********************************************************************
+* Property
+***********************************************************************/
 
-out_remove_remaining:
-   for(; i_old < eina_array_count(old->array); iter_old++, i_old++)
+static void
+_e_connman_element_dict_entry_free(E_Connman_Element_Dict_Entry *entry)
+{
+   switch (entry->type)
      {
-        E_Connman_Element *e;
-        item_old = *iter_old;
-        if (!item_old)
-           break;
+      case DBUS_TYPE_BOOLEAN:
+      case DBUS_TYPE_BYTE:
+      case DBUS_TYPE_UINT16:
+      case DBUS_TYPE_UINT32:
+         break;
 
-        e = e_connman_element_get(item_old);
-        if (e)
-           e_connman_element_unregister(e);
+      case DBUS_TYPE_OBJECT_PATH:
+         eina_stringshare_del(entry->value.path);
+         break;
+
+      case DBUS_TYPE_STRING:
+         eina_stringshare_del(entry->value.str);
+         break;
 
-        DBG("Delete element %s\n", (const char *)item_old);
+      default:
+         ERR("don't know how to free dict entry '%s' of type %c (%d)",
+             entry->name, entry->type, entry->type);
      }
+
+   eina_stringshare_del(entry->name);
+   free(entry);
 }
 
-static Eina_Bool
-_e_connman_element_property_update(E_Connman_Element_Property *property, int type, void *data)
+static E_Connman_Element_Dict_Entry *
+_e_connman_element_dict_entry_new(DBusMessageIter *itr)
 {
-   Eina_Bool changed = EINA_FALSE;
+   E_Connman_Element_Dict_Entry *entry;
+   DBusMessageIter e_itr, v_itr;
+   int t;
+   const char *key = NULL;
+   void *value = NULL;
 
-   if ((type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH) && data)
-      data = (char *)eina_stringshare_add(data);
+   dbus_message_iter_recurse(itr, &e_itr);
 
-   if (property->type != type)
+   t = dbus_message_iter_get_arg_type(&e_itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
      {
-        if (property->type)
-           DBG("property type changed from '%c' to '%c'",
-               property->type, type);
+        ERR("invalid format for dict entry. first type not a string: %c (%d)",
+            t, t);
+        return NULL;
+     }
 
-        _e_connman_element_property_value_free(property);
-        memset(&property->value, 0, sizeof(property->value));
-        property->type = type;
-        changed = EINA_TRUE;
+   dbus_message_iter_get_basic(&e_itr, &key);
+   if (!key || !key[0])
+     {
+        ERR("invalid format for dict entry. no key.");
+        return NULL;
      }
 
-   switch (type)
+   dbus_message_iter_next(&e_itr);
+   t = dbus_message_iter_get_arg_type(&e_itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
      {
-      case DBUS_TYPE_BOOLEAN:
-         if (changed || property->value.boolean != (Eina_Bool)(long)data)
-           {
-              property->value.boolean = (Eina_Bool)(long)data;
-              changed = EINA_TRUE;
-           }
+        ERR("invalid format for dict entry '%s'. "
+            "second type not a variant: %c (%d)",
+            key, t, t);
+        return NULL;
+     }
+
+   dbus_message_iter_recurse(&e_itr, &v_itr);
+
+   t = dbus_message_iter_get_arg_type(&v_itr);
+   if ((t == DBUS_TYPE_INVALID) || (t == DBUS_TYPE_ARRAY))
+     {
+        ERR("invalid type for dict value for entry '%s': %c (%d)",
+            key, t, t);
+        return NULL;
+     }
+
+   entry = calloc(1, sizeof(*entry));
+   if (!entry)
+     {
+        ERR("could not allocate memory for dict entry.");
+        return NULL;
+     }
 
+   dbus_message_iter_get_basic(&v_itr, &value);
+   switch (t)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         entry->value.boolean = (Eina_Bool)(long)value;
          break;
 
       case DBUS_TYPE_BYTE:
-         if (changed || property->value.byte != (unsigned char)(long)data)
-           {
-              property->value.byte = (unsigned char)(long)data;
-              changed = EINA_TRUE;
-           }
-
+         entry->value.byte = (unsigned char)(long)value;
          break;
 
       case DBUS_TYPE_UINT16:
-         if (changed || property->value.u16 != (unsigned short)(long)data)
-           {
-              property->value.u16 = (unsigned short)(long)data;
-              changed = EINA_TRUE;
-           }
-
+         entry->value.u16 = (unsigned short)(long)value;
          break;
 
       case DBUS_TYPE_UINT32:
-         if (changed || property->value.u32 != (unsigned int)(long)data)
-           {
-              property->value.u32 = (unsigned int)(long)data;
-              changed = EINA_TRUE;
-           }
-
+         entry->value.u32 = (unsigned int)(long)value;
          break;
 
       case DBUS_TYPE_STRING:
-         if (changed)
-           {
-              property->value.str = data;
-           }
-         else
-           {
-              if (property->value.str)
-                 eina_stringshare_del(property->value.str);
-
-              if (property->value.str != data)
-                {
-                   property->value.str = data;
-                   changed = EINA_TRUE;
-                }
-           }
-
+         entry->value.str = eina_stringshare_add(value);
          break;
 
       case DBUS_TYPE_OBJECT_PATH:
-         if (changed)
-           {
-              property->value.path = data;
-           }
-         else
-           {
-              if (property->value.path)
-                 eina_stringshare_del(property->value.path);
-
-              if (property->value.path != data)
-                {
-                   property->value.path = data;
-                   changed = EINA_TRUE;
-                }
-           }
-
-         break;
-
-      case DBUS_TYPE_ARRAY:
-         if (!changed)
-            if (property->value.array)
-              {
-                 _e_connman_element_array_match(property->value.array, data, property->name);
-                 _e_connman_element_array_free(property->value.array, data);
-              }
-
-         property->value.array = data;
-         changed = EINA_TRUE;
+         entry->value.path = eina_stringshare_add(value);
          break;
 
       default:
-         ERR("don't know how to update property type %c (%d)", type, type);
+         ERR("don't know how to create dict entry '%s' for of type %c (%d)",
+             key, t, t);
+         free(entry);
+         return NULL;
      }
 
-   return changed;
+   entry->name = eina_stringshare_add(key);
+   entry->type = t;
+   return entry;
 }
 
-static E_Connman_Element_Property *
-_e_connman_element_property_new(const char *name, int type, void *data)
+static E_Connman_Element_Dict_Entry *
+_e_connman_element_array_dict_find_stringshared(const E_Connman_Array *array, const char *key)
 {
-   E_Connman_Element_Property *property;
+   E_Connman_Element_Dict_Entry *entry;
+   Eina_Array_Iterator iterator;
+   unsigned int i;
 
-   property = calloc(1, sizeof(*property));
-   if (!property)
-     {
-        eina_stringshare_del(name);
-        ERR("could not allocate property: %s", strerror(errno));
-        return NULL;
-     }
+   EINA_ARRAY_ITER_NEXT(array->array, i, entry, iterator)
+   if (entry->name == key)
+      return entry;
 
-   property->name = name;
-   _e_connman_element_property_update(property, type, data);
-   return property;
+   return NULL;
 }
 
 static void
-_e_connman_element_property_free(E_Connman_Element_Property *property)
-{
-   _e_connman_element_property_value_free(property);
-   eina_stringshare_del(property->name);
-   free(property);
-}
-
-/***********************************************************************
-* Element
-***********************************************************************/
-unsigned char *
-e_connman_element_bytes_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count)
+_e_connman_element_array_free(E_Connman_Array *array, E_Connman_Array *new __UNUSED__)
 {
    Eina_Array_Iterator iterator;
-   E_Connman_Array *array;
-   unsigned char *ret, *p;
    unsigned int i;
    void *item;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, NULL);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(property, NULL);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, NULL);
+   if (!array)
+      return;
 
-   *count = 0;
+   switch (array->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+      case DBUS_TYPE_BYTE:
+      case DBUS_TYPE_UINT16:
+      case DBUS_TYPE_UINT32:
+         break;
 
-   if (!e_connman_element_property_get_stringshared
-          (element, property, NULL, &array))
-      return NULL;
+      case DBUS_TYPE_STRING:
+      case DBUS_TYPE_OBJECT_PATH:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+            eina_stringshare_del(item);
+         break;
 
-   if ((!array) || (!(array->array)))
-      return NULL;
+      case DBUS_TYPE_DICT_ENTRY:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         _e_connman_element_dict_entry_free(item);
+         break;
 
-   *count = eina_array_count(array->array);
-   ret = malloc(*count * sizeof(unsigned char));
-   if (!ret)
-     {
-        ERR("could not allocate return array of %d bytes: %s",
-            *count, strerror(errno));
-        return NULL;
+      default:
+         ERR("don't know how to free array of values of type %c (%d)",
+             array->type, array->type);
+         break;
      }
+   eina_array_free(array->array);
+   free(array);
+}
 
-   p = ret;
+/* iterators may borrow the object paths of a property, stop them */
+static void
+_e_connman_element_property_array_free(E_Connman_Array *array)
+{
+   if ((array) && (array->type == DBUS_TYPE_OBJECT_PATH))
+      elements_generation++;
 
-   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-   {
-      *p = (unsigned char)(long)item;
-      p++;
-   }
-   return ret;
+   _e_connman_element_array_free(array, NULL);
 }
 
-Eina_Bool
-e_connman_element_objects_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count, E_Connman_Element ***p_elements)
+static void
+_e_connman_element_property_value_free(E_Connman_Element_Property *property)
 {
-   E_Connman_Element **ret, **p;
-   Eina_Array_Iterator iterator;
-   E_Connman_Array *array;
-   unsigned int i;
-   int type;
-   void *item;
+   switch (property->type)
+     {
+      case 0:
+         return;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+      case DBUS_TYPE_BOOLEAN:
+      case DBUS_TYPE_BYTE:
+      case DBUS_TYPE_UINT16:
+      case DBUS_TYPE_UINT32:
+         break;
 
-   *count = 0;
-   *p_elements = NULL;
+      case DBUS_TYPE_STRING:
+         eina_stringshare_del(property->value.str);
+         break;
 
-   if (!e_connman_element_property_get_stringshared
-          (element, property, &type, &array))
-      return EINA_FALSE;
+      case DBUS_TYPE_OBJECT_PATH:
+         eina_stringshare_del(property->value.path);
+         break;
 
-   if (type != DBUS_TYPE_ARRAY)
-     {
-        ERR("property %s is not an array!", property);
-        return EINA_FALSE;
+      case DBUS_TYPE_ARRAY:
+         _e_connman_element_property_array_free(property->value.array);
+         break;
+
+      default:
+         ERR("don't know how to free value of property type %c (%d)",
+             property->type, property->type);
      }
+}
 
-   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
-      return EINA_FALSE;
+static const char *
+_e_connman_element_get_interface(const char *key)
+{
+   const char *interface = NULL, *tail;
+   char head;
 
-   if (array->type != DBUS_TYPE_OBJECT_PATH)
-     {
-        ERR("property %s is not an array of object paths!", property);
-        return EINA_FALSE;
-     }
+   head = key[0];
+   tail = key + 1;
 
-   *count = eina_array_count(array->array);
-   ret = malloc(*count * sizeof(E_Connman_Element *));
-   if (!ret)
+   switch (head)
      {
-        ERR("could not allocate return array of %d elements: %s",
-            *count, strerror(errno));
-        *count = 0;
-        return EINA_FALSE;
-     }
+      case 'P':
+         if (strcmp(tail, "rofiles") == 0)
+            interface = e_connman_iface_profile;
 
-   p = ret;
+         break;
 
-   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-   {
-      E_Connman_Element *e = e_connman_element_get(item);
-      if (!e)
-         continue;
+      case 'S':
+         if (strcmp(tail, "ervices") == 0)
+            interface = e_connman_iface_service;
 
-      *p = e;
-      p++;
-   }
-   *count = p - ret;
-   *p_elements = ret;
-   return EINA_TRUE;
-}
+         break;
 
-/* array and strings are just pointers (references),
- * no malloc, strdup or stringshare_add/ref
- */
-Eina_Bool
-e_connman_element_strings_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count, const char ***strings)
-{
-   E_Connman_Array *array;
-   int type;
+      case 'T':
+         if (strcmp(tail, "echnologies") == 0)
+            interface = e_connman_iface_technology;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(strings, EINA_FALSE);
+         break;
 
-   *count = 0;
-   *strings = NULL;
+      default:
+         break;
+     }
 
-   if (!e_connman_element_property_get_stringshared
-          (element, property, &type, &array))
-      return EINA_FALSE;
+   if (!interface)
+      ERR("failed to find interface for property \"%s\"", key);
 
-   if (type != DBUS_TYPE_ARRAY)
-     {
-        ERR("property %s is not an array!", property);
-        return EINA_FALSE;
-     }
+   return interface;
+}
 
-   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
-      return EINA_FALSE;
+static void
+_e_connman_element_item_register(const char *key, const char *item)
+{
+   E_Connman_Element *element;
+   const char *interface;
 
-   if (array->type != DBUS_TYPE_STRING)
-     {
-        ERR("property %s is not an array of strings!", property);
-        return EINA_FALSE;
-     }
+   interface = _e_connman_element_get_interface(key);
+   if (!interface)
+      return;
 
-   *count = array->array->count;
-   *strings = (const char **)array->array->data;
-   return EINA_TRUE;
+   /* those synced already follow their PropertyChanged signals */
+   element = e_connman_element_register(item, interface);
+   if ((element) && (!element->_synced))
+      e_connman_element_sync_queue(element);
 }
 
+/* Match 2 arrays to find which are new, which are old and which moved
+ * For new elements, register them under prop_name property
+ * For old elements, unregister them, sending proper DEL event
+ * For elements still there but out of order, send a MOVED event
+ *
+ * Items are stringshares, so they are matched by pointer against a hash
+ * of the old positions.  The moved ones are those left out of the longest
+ * run of kept items that is still in the old order, so raising one item
+ * to the top of a long list reports just that item.
+ */
+#define ARRAY_MATCH_IN_ORDER ((unsigned int)-1)
+
 static void
-_e_connman_element_array_print(FILE *fp, E_Connman_Array *array)
+_e_connman_element_array_match(E_Connman_Array *old, E_Connman_Array *new, const char *prop_name)
 {
-   Eina_Array_Iterator iterator;
-   unsigned int i;
+   unsigned int n_old, n_new, n_kept = 0, n_run = 0, i;
+   unsigned int *from, *to, *tails, *prev;
+   Eina_Hash *positions;
+   E_Connman_Element *e;
    void *item;
 
-   if (!array)
+   if (!old)
       return;
 
-   switch (array->type)
+   if (old->type != DBUS_TYPE_OBJECT_PATH)
+      return;
+
+   n_old = old->array ? eina_array_count(old->array) : 0;
+   n_new = ((new) && (new->array)) ? eina_array_count(new->array) : 0;
+   if ((n_old == 0) && (n_new == 0))
+      return;
+
+   positions = eina_hash_pointer_new(NULL);
+   from = malloc(4 * (n_new + 1) * sizeof(unsigned int));
+   if ((!positions) || (!from))
      {
-      case DBUS_TYPE_OBJECT_PATH:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "\"%s\", ", (const char *)item);
-         break;
+        ERR("could not match the items of %s", prop_name);
+        if (positions)
+           eina_hash_free(positions);
 
-      case DBUS_TYPE_STRING:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "\"%s\", ", (const char *)item);
-         break;
+        free(from);
+        return;
+     }
+   to = from + n_new + 1;
+   tails = to + n_new + 1;
+   prev = tails + n_new + 1;
 
-      case DBUS_TYPE_BYTE:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "%#02hhx (\"%c\"), ", (unsigned char)(long)item,
-                 (unsigned char)(long)item);
-         break;
+   for (i = 0; i < n_old; i++)
+     {
+        item = eina_array_data_get(old->array, i);
+        if (!eina_hash_find(positions, &item))
+           eina_hash_add(positions, &item, (void *)(uintptr_t)(i + 1));
+     }
 
-      case DBUS_TYPE_UINT16:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "%#04hx (%hu), ", (unsigned short)(long)item,
-                 (unsigned short)(long)item);
-         break;
+   /* from[] and to[] are the old and new indexes of each kept item */
+   for (i = 0; i < n_new; i++)
+     {
+        uintptr_t pos;
 
-      case DBUS_TYPE_UINT32:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "%#08x (%u), ", (unsigned int)(long)item,
-                 (unsigned int)(long)item);
-         break;
+        item = eina_array_data_get(new->array, i);
+        pos = (uintptr_t)eina_hash_find(positions, &item);
+        if (pos)
+          {
+             eina_hash_del_by_key(positions, &item);
+             from[n_kept] = pos - 1;
+             to[n_kept] = i;
+             n_kept++;
+          }
+        else
+          {
+             _e_connman_element_item_register(prop_name, item);
+             DBG("Add element %s\n", (const char *)item);
+          }
+     }
 
-      case DBUS_TYPE_DICT_ENTRY:
-         fputs("{ ", fp);
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         {
-            E_Connman_Element_Dict_Entry *entry = item;
-            fprintf(fp, "%s: ", entry->name);
-            switch (entry->type)
-              {
-               case DBUS_TYPE_OBJECT_PATH:
-                  fprintf(fp, "\"%s\", ", entry->value.path);
-                  break;
+   /* whatever is still in positions is gone */
+   for (i = 0; i < n_old; i++)
+     {
+        item = eina_array_data_get(old->array, i);
+        if (!eina_hash_find(positions, &item))
+           continue;
 
-               case DBUS_TYPE_STRING:
-                  fprintf(fp, "\"%s\", ", entry->value.str);
-                  break;
+        eina_hash_del_by_key(positions, &item);
+        e = e_connman_element_get(item);
+        if (e)
+           e_connman_element_unregister(e);
 
-               case DBUS_TYPE_BYTE:
-                  fprintf(fp, "%#02hhx (\"%c\"), ",
-                          entry->value.byte, entry->value.byte);
-                  break;
+        DBG("Delete element %s\n", (const char *)item);
+     }
+   eina_hash_free(positions);
 
-               case DBUS_TYPE_UINT16:
-                  fprintf(fp, "%#04hx (%hu), ",
-                          entry->value.u16, entry->value.u16);
-                  break;
+   /* longest increasing run of from[], tails[k] ends the best of length k + 1 */
+   for (i = 0; i < n_kept; i++)
+     {
+        unsigned int lo = 0, hi = n_run;
 
-               case DBUS_TYPE_UINT32:
-                  fprintf(fp, "%#08x (%u), ",
-                          entry->value.u32, entry->value.u32);
-                  break;
+        while (lo < hi)
+          {
+             unsigned int mid = (lo + hi) / 2;
 
-               default:
-                  fprintf(fp, "<UNKNOWN TYPE '%c'>", entry->type);
-              }
-         }
-         fputs("}", fp);
-         break;
+             if (from[tails[mid]] < from[i])
+                lo = mid + 1;
+             else
+                hi = mid;
+          }
 
-      default:
-         fprintf(fp, "<UNKNOWN ARRAY TYPE '%c'>", array->type);
+        prev[i] = lo ? tails[lo - 1] : ARRAY_MATCH_IN_ORDER;
+        tails[lo] = i;
+        if (lo == n_run)
+           n_run++;
      }
-}
 
-/**
- * Print element to file descriptor.
- */
-void
-e_connman_element_print(FILE *fp, const E_Connman_Element *element)
-{
-   const E_Connman_Element_Property *p;
+   if (n_run)
+      for (i = tails[n_run - 1]; i != ARRAY_MATCH_IN_ORDER; i = prev[i])
+         to[i] = ARRAY_MATCH_IN_ORDER;
 
-   EINA_SAFETY_ON_NULL_RETURN(fp);
-   if (!element)
+   for (i = 0; i < n_kept; i++)
      {
-        fputs("Error: no element to print\n", fp);
-        return;
-     }
+        if (to[i] == ARRAY_MATCH_IN_ORDER)
+           continue;
 
-   fprintf(fp,
-           "Element %p: %s [%s]\n"
-           "\tProperties:\n",
-           element, element->path, element->interface);
+        item = eina_array_data_get(new->array, to[i]);
+        e = e_connman_element_get(item);
+        if (!e)
+           continue;
 
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      fprintf(fp, "\t\t%s (%c) = ", p->name, p->type);
+        e_connman_element_event_add(E_CONNMAN_EVENT_ELEMENT_MOVED, e);
+        DBG("Moved element %s\n", e->path);
+     }
 
-      switch (p->type)
-        {
-         case DBUS_TYPE_STRING:
-            fprintf(fp, "\"%s\"", p->value.str);
-            break;
+   free(from);
+}
 
-         case DBUS_TYPE_OBJECT_PATH:
-            fprintf(fp, "\"%s\"", p->value.path);
-            break;
+#undef ARRAY_MATCH_IN_ORDER
 
-         case DBUS_TYPE_BOOLEAN:
-            fprintf(fp, "%hhu", p->value.boolean);
-            break;
+static Eina_Bool
+_e_connman_element_dict_entry_equal(const E_Connman_Element_Dict_Entry *a, const E_Connman_Element_Dict_Entry *b)
+{
+   if ((a->name != b->name) || (a->type != b->type))
+      return EINA_FALSE;
 
-         case DBUS_TYPE_BYTE:
-            fprintf(fp, "%#02hhx (%d), ", p->value.byte, p->value.byte);
-            break;
+   switch (a->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         return a->value.boolean == b->value.boolean;
 
-         case DBUS_TYPE_UINT16:
-            fprintf(fp, "%hu", p->value.u16);
-            break;
+      case DBUS_TYPE_BYTE:
+         return a->value.byte == b->value.byte;
 
-         case DBUS_TYPE_UINT32:
-            fprintf(fp, "%u", p->value.u32);
-            break;
+      case DBUS_TYPE_UINT16:
+         return a->value.u16 == b->value.u16;
 
-         case DBUS_TYPE_ARRAY:
-            _e_connman_element_array_print(fp, p->value.array);
-            break;
+      case DBUS_TYPE_UINT32:
+         return a->value.u32 == b->value.u32;
 
-         default:
-            fputs("don't know how to print type", fp);
-        }
+      case DBUS_TYPE_STRING:
+         return a->value.str == b->value.str;
 
-      fputc('\n', fp);
-   }
+      case DBUS_TYPE_OBJECT_PATH:
+         return a->value.path == b->value.path;
+
+      default:
+         return EINA_FALSE;
+     }
 }
 
-static E_Connman_Element *
-e_connman_element_new(const char *path, const char *interface)
+/* items are stringshares or integers, so they compare as pointers */
+static Eina_Bool
+_e_connman_element_array_equal(const E_Connman_Array *a, const E_Connman_Array *b)
 {
-   E_Connman_Element *element;
-
-   element = calloc(1, sizeof(*element));
-   if (!element)
-     {
-        ERR("could not allocate element: %s",   strerror(errno));
-        return NULL;
-     }
+   unsigned int i, count;
 
-   element->path = eina_stringshare_add(path);
-   element->interface = eina_stringshare_ref(interface);
-   element->_references = 1;
+   if ((!a) || (!b))
+      return a == b;
 
-   return element;
-}
+   count = eina_array_count(a->array);
+   if ((a->type != b->type) || (count != eina_array_count(b->array)))
+      return EINA_FALSE;
 
-static void
-e_connman_element_extra_properties_free(E_Connman_Element *element)
-{
-   while (element->props)
+   for (i = 0; i < count; i++)
      {
-        E_Connman_Element_Property *prop;
-        prop = (E_Connman_Element_Property *)element->props;
-        element->props = element->props->next;
-        _e_connman_element_property_free(prop);
+        void *x = eina_array_data_get(a->array, i);
+        void *y = eina_array_data_get(b->array, i);
+
+        if (a->type == DBUS_TYPE_DICT_ENTRY)
+          {
+             if (!_e_connman_element_dict_entry_equal(x, y))
+                return EINA_FALSE;
+          }
+        else if (x != y)
+           return EINA_FALSE;
      }
+
+   return EINA_TRUE;
 }
 
-static void
-e_connman_element_free(E_Connman_Element *element)
+static Eina_Bool
+_e_connman_element_property_update(E_Connman_Element_Property *property, int type, void *data)
 {
-   if (element->_idler.changed)
-      ecore_idler_del(element->_idler.changed);
+   Eina_Bool changed = EINA_FALSE;
 
-   while (element->_listeners)
-     {
-        E_Connman_Element_Listener *l = (void *)element->_listeners;
-        element->_listeners = eina_inlist_remove
-              (element->_listeners, element->_listeners);
+   if ((type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH) && data)
+      data = (char *)eina_stringshare_add(data);
 
-        if (l->free_data)
-           l->free_data(l->data);
+   if (property->type != type)
+     {
+        if (property->type)
+           DBG("property type changed from '%c' to '%c'",
+               property->type, type);
 
-        free(l);
+        _e_connman_element_property_value_free(property);
+        memset(&property->value, 0, sizeof(property->value));
+        property->type = type;
+        changed = EINA_TRUE;
      }
 
-   e_connman_element_pending_cancel_and_free(&element->_pending.properties_get);
-   e_connman_element_pending_cancel_and_free(&element->_pending.property_set);
-   e_connman_element_pending_cancel_and_free(&element->_pending.agent_register);
-   e_connman_element_pending_cancel_and_free(&element->_pending.agent_unregister);
-   e_connman_element_pending_cancel_and_free(&element->_pending.request_scan);
-   e_connman_element_pending_cancel_and_free(&element->_pending.technology_enable);
-   e_connman_element_pending_cancel_and_free(&element->_pending.technology_disable);
+   switch (type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         if (changed || property->value.boolean != (Eina_Bool)(long)data)
+           {
+              property->value.boolean = (Eina_Bool)(long)data;
+              changed = EINA_TRUE;
+           }
+
+         break;
+
+      case DBUS_TYPE_BYTE:
+         if (changed || property->value.byte != (unsigned char)(long)data)
+           {
+              property->value.byte = (unsigned char)(long)data;
+              changed = EINA_TRUE;
+           }
+
+         break;
+
+      case DBUS_TYPE_UINT16:
+         if (changed || property->value.u16 != (unsigned short)(long)data)
+           {
+              property->value.u16 = (unsigned short)(long)data;
+              changed = EINA_TRUE;
+           }
+
+         break;
+
+      case DBUS_TYPE_UINT32:
+         if (changed || property->value.u32 != (unsigned int)(long)data)
+           {
+              property->value.u32 = (unsigned int)(long)data;
+              changed = EINA_TRUE;
+           }
+
+         break;
+
+      case DBUS_TYPE_STRING:
+         if (changed)
+           {
+              property->value.str = data;
+           }
+         else
+           {
+              if (property->value.str)
+                 eina_stringshare_del(property->value.str);
+
+              if (property->value.str != data)
+                {
+                   property->value.str = data;
+                   changed = EINA_TRUE;
+                }
+           }
+
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         if (changed)
+           {
+              property->value.path = data;
+           }
+         else
+           {
+              if (property->value.path)
+                 eina_stringshare_del(property->value.path);
+
+              if (property->value.path != data)
+                {
+                   property->value.path = data;
+                   changed = EINA_TRUE;
+                }
+           }
+
+         break;
+
+      case DBUS_TYPE_ARRAY:
+         if (changed)
+           {
+              property->value.array = data;
+              break;
+           }
+
+         /* an equal array keeps the old one, so its views stay valid.  A
+          * changed one is freed right away as the message is handled, not
+          * when the listeners are told later on. */
+         if (_e_connman_element_array_equal(property->value.array, data))
+           {
+              _e_connman_element_array_free(data, NULL);
+              break;
+           }
+
+         if (property->value.array)
+            _e_connman_element_array_match(property->value.array, data, property->name);
+         _e_connman_element_property_array_free(property->value.array);
+         property->value.array = data;
+         changed = EINA_TRUE;
+         break;
+
+      default:
+         ERR("don't know how to update property type %c (%d)", type, type);
+     }
+
+   return changed;
+}
+
+static E_Connman_Element_Property *
+_e_connman_element_property_new(const char *name, int type, void *data)
+{
+   E_Connman_Element_Property *property;
+
+   property = calloc(1, sizeof(*property));
+   if (!property)
+     {
+        eina_stringshare_del(name);
+        ERR("could not allocate property: %s", strerror(errno));
+        return NULL;
+     }
+
+   property->name = name;
+   _e_connman_element_property_update(property, type, data);
+   return property;
+}
+
+static void
+_e_connman_element_property_free(E_Connman_Element_Property *property)
+{
+   _e_connman_element_property_value_free(property);
+   eina_stringshare_del(property->name);
+   free(property);
+}
+
+/***********************************************************************
+* Element
+***********************************************************************/
+unsigned char *
+e_connman_element_bytes_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count)
+{
+   Eina_Array_Iterator iterator;
+   E_Connman_Array *array;
+   unsigned char *ret, *p;
+   unsigned int i;
+   void *item;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, NULL);
+
+   *count = 0;
+
+   if (!e_connman_element_property_get_stringshared
+          (element, property, NULL, &array))
+      return NULL;
+
+   if ((!array) || (!(array->array)))
+      return NULL;
+
+   *count = eina_array_count(array->array);
+   ret = malloc(*count * sizeof(unsigned char));
+   if (!ret)
+     {
+        ERR("could not allocate return array of %d bytes: %s",
+            *count, strerror(errno));
+        return NULL;
+     }
+
+   p = ret;
+
+   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+   {
+      *p = (unsigned char)(long)item;
+      p++;
+   }
+   return ret;
+}
+
+Eina_Bool
+e_connman_element_objects_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count, E_Connman_Element ***p_elements)
+{
+   E_Connman_Element **ret, **p;
+   Eina_Array_Iterator iterator;
+   E_Connman_Array *array;
+   unsigned int i;
+   int type;
+   void *item;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+
+   *count = 0;
+   *p_elements = NULL;
+
+   if (!e_connman_element_property_get_stringshared
+          (element, property, &type, &array))
+      return EINA_FALSE;
+
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s is not an array!", property);
+        return EINA_FALSE;
+     }
+
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_FALSE;
+
+   if (array->type != DBUS_TYPE_OBJECT_PATH)
+     {
+        ERR("property %s is not an array of object paths!", property);
+        return EINA_FALSE;
+     }
+
+   *count = eina_array_count(array->array);
+   ret = malloc(*count * sizeof(E_Connman_Element *));
+   if (!ret)
+     {
+        ERR("could not allocate return array of %d elements: %s",
+            *count, strerror(errno));
+        *count = 0;
+        return EINA_FALSE;
+     }
+
+   p = ret;
+
+   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+   {
+      E_Connman_Element *e = e_connman_element_get(item);
+      if (!e)
+         continue;
+
+      *p = e;
+      p++;
+   }
+   *count = p - ret;
+   *p_elements = ret;
+   return EINA_TRUE;
+}
+
+/* the caller owns the returned array, the strings are still borrowed */
+static Eina_Bool
+_e_connman_element_strings_array_copy(unsigned int *count, const char ***strings)
+{
+   const char **ret;
+
+   ret = malloc(*count * sizeof(char *));
+   if (!ret)
+     {
+        ERR("could not allocate return array of %d strings: %s",
+            *count, strerror(errno));
+        *count = 0;
+        *strings = NULL;
+        return EINA_FALSE;
+     }
+
+   memcpy(ret, *strings, *count * sizeof(char *));
+   *strings = ret;
+   return EINA_TRUE;
+}
+
+/**
+ * Get a view of an array of strings property.
+ *
+ * Nothing is allocated or copied, @a strings points into the array kept
+ * by the element itself, so it must not be modified or freed.  Updates
+ * with the same strings keep it, but a change frees it as soon as the
+ * message is handled, before the listeners are told, so do not keep it
+ * past a return to the main loop.  The strings are stringshared,
+ * eina_stringshare_ref() them to keep them.
+ *
+ * @param element the element with the property.
+ * @param property name of an array of strings property.
+ * @param count where to return the number of strings.
+ * @param strings where to return the strings, just set if return is
+ *        @c EINA_TRUE.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the property is not
+ *         set or not an array of strings.
+ */
+Eina_Bool
+e_connman_element_strings_array_view(const E_Connman_Element *element, const char *property, unsigned int *count, const char ***strings)
+{
+   E_Connman_Array *array;
+   int type;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(strings, EINA_FALSE);
+
+   *count = 0;
+   *strings = NULL;
+
+   if (!e_connman_element_property_get_stringshared
+          (element, property, &type, &array))
+      return EINA_FALSE;
+
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s is not an array!", property);
+        return EINA_FALSE;
+     }
+
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_FALSE;
+
+   if (array->type != DBUS_TYPE_STRING)
+     {
+        ERR("property %s is not an array of strings!", property);
+        return EINA_FALSE;
+     }
+
+   *count = eina_array_count(array->array);
+   *strings = (const char **)array->array->data;
+   return EINA_TRUE;
+}
+
+/* the returned array is malloc()ed, strings are just pointers (references),
+ * no strdup or stringshare_add/ref
+ */
+Eina_Bool
+e_connman_element_strings_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count, const char ***strings)
+{
+   if (!e_connman_element_strings_array_view(element, property, count, strings))
+      return EINA_FALSE;
+
+   return _e_connman_element_strings_array_copy(count, strings);
+}
+
+static void
+_e_connman_element_array_print(FILE *fp, E_Connman_Array *array)
+{
+   Eina_Array_Iterator iterator;
+   unsigned int i;
+   void *item;
+
+   if (!array)
+      return;
+
+   switch (array->type)
+     {
+      case DBUS_TYPE_OBJECT_PATH:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "\"%s\", ", (const char *)item);
+         break;
+
+      case DBUS_TYPE_STRING:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "\"%s\", ", (const char *)item);
+         break;
+
+      case DBUS_TYPE_BYTE:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "%#02hhx (\"%c\"), ", (unsigned char)(long)item,
+                 (unsigned char)(long)item);
+         break;
+
+      case DBUS_TYPE_UINT16:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "%#04hx (%hu), ", (unsigned short)(long)item,
+                 (unsigned short)(long)item);
+         break;
+
+      case DBUS_TYPE_UINT32:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "%#08x (%u), ", (unsigned int)(long)item,
+                 (unsigned int)(long)item);
+         break;
+
+      case DBUS_TYPE_DICT_ENTRY:
+         fputs("{ ", fp);
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         {
+            E_Connman_Element_Dict_Entry *entry = item;
+            fprintf(fp, "%s: ", entry->name);
+            switch (entry->type)
+              {
+               case DBUS_TYPE_OBJECT_PATH:
+                  fprintf(fp, "\"%s\", ", entry->value.path);
+                  break;
+
+               case DBUS_TYPE_STRING:
+                  fprintf(fp, "\"%s\", ", entry->value.str);
+                  break;
+
+               case DBUS_TYPE_BYTE:
+                  fprintf(fp, "%#02hhx (\"%c\"), ",
+                          entry->value.byte, entry->value.byte);
+                  break;
+
+               case DBUS_TYPE_UINT16:
+                  fprintf(fp, "%#04hx (%hu), ",
+                          entry->value.u16, entry->value.u16);
+                  break;
+
+               case DBUS_TYPE_UINT32:
+                  fprintf(fp, "%#08x (%u), ",
+                          entry->value.u32, entry->value.u32);
+                  break;
+
+               default:
+                  fprintf(fp, "<UNKNOWN TYPE '%c'>", entry->type);
+              }
+         }
+         fputs("}", fp);
+         break;
+
+      default:
+         fprintf(fp, "<UNKNOWN ARRAY TYPE '%c'>", array->type);
+     }
+}
+
+/**
+ * Print element to file descriptor.
+ */
+void
+e_connman_element_print(FILE *fp, const E_Connman_Element *element)
+{
+   const E_Connman_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN(fp);
+   if (!element)
+     {
+        fputs("Error: no element to print\n", fp);
+        return;
+     }
+
+   fprintf(fp,
+           "Element %p: %s [%s]\n"
+           "\tProperties:\n",
+           element, element->path, element->interface);
+
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      fprintf(fp, "\t\t%s (%c) = ", p->name, p->type);
+
+      switch (p->type)
+        {
+         case DBUS_TYPE_STRING:
+            fprintf(fp, "\"%s\"", p->value.str);
+            break;
+
+         case DBUS_TYPE_OBJECT_PATH:
+            fprintf(fp, "\"%s\"", p->value.path);
+            break;
+
+         case DBUS_TYPE_BOOLEAN:
+            fprintf(fp, "%hhu", p->value.boolean);
+            break;
+
+         case DBUS_TYPE_BYTE:
+            fprintf(fp, "%#02hhx (%d), ", p->value.byte, p->value.byte);
+            break;
+
+         case DBUS_TYPE_UINT16:
+            fprintf(fp, "%hu", p->value.u16);
+            break;
+
+         case DBUS_TYPE_UINT32:
+            fprintf(fp, "%u", p->value.u32);
+            break;
+
+         case DBUS_TYPE_ARRAY:
+            _e_connman_element_array_print(fp, p->value.array);
+            break;
+
+         default:
+            fputs("don't know how to print type", fp);
+        }
+
+      fputc('\n', fp);
+   }
+}
+
+static E_Connman_Element *
+e_connman_element_new(const char *path, const char *interface)
+{
+   E_Connman_Element *element;
+
+   element = calloc(1, sizeof(*element));
+   if (!element)
+     {
+        ERR("could not allocate element: %s",   strerror(errno));
+        return NULL;
+     }
+
+   element->path = eina_stringshare_add(path);
+   element->interface = eina_stringshare_ref(interface);
+   element->_references = 1;
+
+   return element;
+}
+
+static void
+e_connman_element_extra_properties_free(E_Connman_Element *element)
+{
+   while (element->props)
+     {
+        E_Connman_Element_Property *prop;
+        prop = (E_Connman_Element_Property *)element->props;
+        element->props = element->props->next;
+        _e_connman_element_property_free(prop);
+     }
+
+   free(element->_props_index.slots);
+   element->_props_index.slots = NULL;
+   element->_props_index.size = 0;
+   element->_props_index.count = 0;
+
+   free(element->_service_record);
+   element->_service_record = NULL;
+}
+
+static void
+e_connman_element_free(E_Connman_Element *element)
+{
+   E_Connman_Element_Changes changes;
+
+   if (element->_idler.changed)
+      ecore_idler_del(element->_idler.changed);
+
+   _e_connman_element_changes_take(element, &changes);
+   _e_connman_element_changes_free(&changes);
+
+   while (element->_listeners)
+     {
+        E_Connman_Element_Listener *l = (void *)element->_listeners;
+        element->_listeners = eina_inlist_remove
+              (element->_listeners, element->_listeners);
+
+        if (l->free_data)
+           l->free_data(l->data);
+
+        _e_connman_element_listener_names_free(l->names);
+        free(l);
+     }
+
+   e_connman_element_pending_cancel_and_free(&element->_pending.properties_get);
+   e_connman_element_pending_cancel_and_free(&element->_pending.property_set);
+   e_connman_element_pending_cancel_and_free(&element->_pending.agent_register);
+   e_connman_element_pending_cancel_and_free(&element->_pending.agent_unregister);
+   e_connman_element_pending_cancel_and_free(&element->_pending.request_scan);
+   e_connman_element_pending_cancel_and_free(&element->_pending.technology_enable);
+   e_connman_element_pending_cancel_and_free(&element->_pending.technology_disable);
    e_connman_element_pending_cancel_and_free(&element->_pending.profile_remove);
    e_connman_element_pending_cancel_and_free(&element->_pending.service_connect);
    e_connman_element_pending_cancel_and_free(&element->_pending.service_disconnect);
@@ -1074,1431 +1820,2816 @@ e_connman_element_free(E_Connman_Element *element)
    e_connman_element_pending_cancel_and_free(&element->_pending.service_move_after);
    e_connman_element_pending_cancel_and_free(&element->_pending.service_clear_property);
 
-   e_connman_element_extra_properties_free(element);
-   eina_stringshare_del(element->interface);
-   eina_stringshare_del(element->path);
-   free(element);
+   e_connman_element_extra_properties_free(element);
+   eina_stringshare_del(element->interface);
+   eina_stringshare_del(element->path);
+   free(element);
+}
+
+/**
+ * Add reference to element.
+ */
+int
+e_connman_element_ref(E_Connman_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
+   return ++element->_references;
+}
+
+/**
+ * Remove reference from element.
+ *
+ * If reference count drops to 0 element will be freed.
+ */
+int
+e_connman_element_unref(E_Connman_Element *element)
+{
+   int i;
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
+
+   i = --element->_references;
+   if (i == 0)
+      e_connman_element_free(element);
+   else if (i < 0)
+      ERR("element %p references %d < 0", element, i);
+
+   return i;
+}
+
+/**
+ * Send message with callbacks set to work with connman elements.
+ *
+ * If this call fails (returns @c EINA_FALSE), pending callbacks will not be called,
+ * not even with error messages.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE on failure.
+ */
+Eina_Bool
+e_connman_element_message_send(E_Connman_Element *element, const char *method_name, E_DBus_Method_Return_Cb cb, DBusMessage *msg, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   E_Connman_Element_Call_Data *data;
+   E_Connman_Element_Pending *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(msg, EINA_FALSE);
+
+   data = malloc(sizeof(*data));
+   if (!data)
+     {
+        ERR("could not alloc e_connman_element_call_data: %s",
+            strerror(errno));
+        dbus_message_unref(msg);
+        return EINA_FALSE;
+     }
+
+   p = malloc(sizeof(*p));
+   if (!p)
+     {
+        ERR("could not alloc E_Connman_Element_Pending: %s",
+            strerror(errno));
+        free(data);
+        dbus_message_unref(msg);
+        return EINA_FALSE;
+     }
+
+   data->element = element;
+   data->cb = cb;
+   data->pending = p;
+   data->p_list = pending;
+   p->user_cb = user_cb;
+   p->user_data = (void *)user_data;
+   p->data = data;
+   p->pending = e_dbus_message_send
+         (e_connman_conn, msg, e_connman_element_call_dispatch_and_free, -1, data);
+   dbus_message_unref(msg);
+
+   if (p->pending)
+     {
+        *pending = eina_inlist_append(*pending, EINA_INLIST_GET(p));
+        return EINA_TRUE;
+     }
+
+   ERR("failed to call %s (obj=%s, path=%s, iface=%s)",
+       method_name, e_connman_system_bus_name_get(),
+       element->path, element->interface);
+   free(data);
+   free(p);
+   return EINA_FALSE;
+}
+
+Eina_Bool
+e_connman_element_call_full(E_Connman_Element *element, const char *method_name, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_connman_system_bus_name_get(), element->path, element->interface,
+         method_name);
+
+   return e_connman_element_message_send
+             (element, method_name, cb, msg, pending, user_cb, user_data);
+}
+
+/* Properties are also indexed by their stringshared name in a small open
+ * addressing table, so lookups do not walk element->props.  They are
+ * removed all together, or a few after a snapshot was confirmed, so the
+ * table has no tombstones and is rebuilt in that case.
+ */
+#define PROPS_INDEX_MIN_SIZE 8
+
+static unsigned int
+_e_connman_element_props_index_slot(const char *name, unsigned int size)
+{
+   uintptr_t h = (uintptr_t)name >> 3;
+
+   h ^= h >> 11;
+   return h & (size - 1);
+}
+
+static void
+_e_connman_element_props_index_put(void **slots, unsigned int size, E_Connman_Element_Property *p)
+{
+   unsigned int i = _e_connman_element_props_index_slot(p->name, size);
+
+   while (slots[i])
+      i = (i + 1) & (size - 1);
+   slots[i] = p;
+}
+
+static Eina_Bool
+_e_connman_element_props_index_add(E_Connman_Element *element, E_Connman_Element_Property *p)
+{
+   /* keep the load under 3/4 so the probes stay short */
+   if (4 * (element->_props_index.count + 1) > 3 * element->_props_index.size)
+     {
+        unsigned int size, i;
+        void **slots;
+
+        size = element->_props_index.size * 2;
+        if (size < PROPS_INDEX_MIN_SIZE)
+           size = PROPS_INDEX_MIN_SIZE;
+
+        slots = calloc(size, sizeof(void *));
+        if (!slots)
+          {
+             ERR("could not grow the property index of %s", element->path);
+             return EINA_FALSE;
+          }
+
+        for (i = 0; i < element->_props_index.size; i++)
+           if (element->_props_index.slots[i])
+              _e_connman_element_props_index_put
+                 (slots, size, element->_props_index.slots[i]);
+
+        free(element->_props_index.slots);
+        element->_props_index.slots = slots;
+        element->_props_index.size = size;
+     }
+
+   _e_connman_element_props_index_put
+      (element->_props_index.slots, element->_props_index.size, p);
+   element->_props_index.count++;
+   return EINA_TRUE;
+}
+
+/* name must be stringshared */
+static E_Connman_Element_Property *
+_e_connman_element_property_find(const E_Connman_Element *element, const char *name)
+{
+   unsigned int size = element->_props_index.size, i;
+   void **slots = element->_props_index.slots;
+
+   if (!slots)
+      return NULL;
+
+   i = _e_connman_element_props_index_slot(name, size);
+   while (slots[i])
+     {
+        E_Connman_Element_Property *p = slots[i];
+
+        if (p->name == name)
+           return p;
+
+        i = (i + 1) & (size - 1);
+     }
+
+   return NULL;
+}
+
+/* name may not be stringshared: try it as one, then by its contents */
+static E_Connman_Element_Property *
+_e_connman_element_property_find_string(const E_Connman_Element *element, const char *name)
+{
+   E_Connman_Element_Property *p;
+
+   p = _e_connman_element_property_find(element, name);
+   if (p)
+      return p;
+
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      if (strcmp(p->name, name) == 0)
+         return p;
+   }
+
+   return NULL;
+}
+
+/* refill the key slots of a dict after its value was replaced */
+static void
+_e_connman_element_service_dict_fill(E_Connman_Service_Record *record, unsigned int dict)
+{
+   E_Connman_Element_Dict_Entry **entries, *entry;
+   E_Connman_Element_Property *p = record->props[dict];
+   Eina_Array_Iterator iterator;
+   unsigned int i, key;
+
+   entries = record->entries[dict - E_CONNMAN_SERVICE_SLOT_DICT_FIRST];
+   memset(entries, 0, E_CONNMAN_SERVICE_KEY_LAST * sizeof(*entries));
+
+   if ((!p) || (p->type != DBUS_TYPE_ARRAY) || (!p->value.array) ||
+       (p->value.array->type != DBUS_TYPE_DICT_ENTRY))
+      return;
+
+   EINA_ARRAY_ITER_NEXT(p->value.array->array, i, entry, iterator)
+   {
+      for (key = 0; key < E_CONNMAN_SERVICE_KEY_LAST; key++)
+         if (entry->name == *service_key_names[key])
+           {
+              entries[key] = entry;
+              break;
+           }
+   }
+}
+
+/* give a new property of a service its slot, if it has one */
+static void
+_e_connman_element_service_slot_set(E_Connman_Element *element, E_Connman_Element_Property *p)
+{
+   E_Connman_Service_Record *record = element->_service_record;
+   unsigned int slot;
+
+   if (element->interface != e_connman_iface_service)
+      return;
+
+   if (!record)
+     {
+        record = calloc(1, sizeof(E_Connman_Service_Record));
+        if (!record)
+          {
+             ERR("could not allocate the record of service %s", element->path);
+             return;
+          }
+        element->_service_record = record;
+     }
+
+   for (slot = 0; slot < E_CONNMAN_SERVICE_SLOT_LAST; slot++)
+      if (p->name == *service_slot_names[slot])
+        {
+           record->props[slot] = p;
+           if (slot >= E_CONNMAN_SERVICE_SLOT_DICT_FIRST)
+              _e_connman_element_service_dict_fill(record, slot);
+           return;
+        }
+}
+
+/* dict values are replaced on update, so their key slots are refilled */
+static void
+_e_connman_element_service_slot_update(E_Connman_Element *element, E_Connman_Element_Property *p)
+{
+   E_Connman_Service_Record *record = element->_service_record;
+   unsigned int slot;
+
+   if (!record)
+      return;
+
+   for (slot = E_CONNMAN_SERVICE_SLOT_DICT_FIRST;
+        slot < E_CONNMAN_SERVICE_SLOT_LAST; slot++)
+      if (record->props[slot] == p)
+        {
+           _e_connman_element_service_dict_fill(record, slot);
+           return;
+        }
+}
+
+/* a property of a service went away, so does its slot */
+static void
+_e_connman_element_service_slot_del(E_Connman_Element *element, E_Connman_Element_Property *p)
+{
+   E_Connman_Service_Record *record = element->_service_record;
+   unsigned int slot;
+
+   if (!record)
+      return;
+
+   for (slot = 0; slot < E_CONNMAN_SERVICE_SLOT_LAST; slot++)
+      if (record->props[slot] == p)
+        {
+           record->props[slot] = NULL;
+           if (slot >= E_CONNMAN_SERVICE_SLOT_DICT_FIRST)
+              _e_connman_element_service_dict_fill(record, slot);
+           return;
+        }
+}
+
+/* the index has no tombstones, so it is rebuilt when properties go */
+static void
+_e_connman_element_props_index_rebuild(E_Connman_Element *element)
+{
+   E_Connman_Element_Property *p;
+
+   if (!element->_props_index.slots)
+      return;
+
+   memset(element->_props_index.slots, 0,
+          element->_props_index.size * sizeof(void *));
+   element->_props_index.count = 0;
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      _e_connman_element_props_index_put
+         (element->_props_index.slots, element->_props_index.size, p);
+      element->_props_index.count++;
+   }
+}
+
+/* First reply for an element loaded from a snapshot: what the server did
+ * not send again is gone, each reported as a change to DBUS_TYPE_INVALID.
+ */
+static Eina_Bool
+_e_connman_element_stale_props_del(E_Connman_Element *element)
+{
+   Eina_Inlist *l = element->props;
+   Eina_Bool changed = EINA_FALSE;
+
+   element->_stale = EINA_FALSE;
+   while (l)
+     {
+        E_Connman_Element_Property *p = (E_Connman_Element_Property *)l;
+        E_Connman_Value old;
+        int old_type = p->type;
+
+        l = l->next;
+        if (!p->stale)
+           continue;
+
+        _e_connman_element_value_keep(p, &old);
+        _e_connman_element_property_value_free(p);
+        memset(&p->value, 0, sizeof(p->value));
+        p->type = DBUS_TYPE_INVALID;
+        _e_connman_element_service_slot_del(element, p);
+        _e_connman_element_change_add(element, p, old_type, &old);
+
+        element->props = eina_inlist_remove(element->props, EINA_INLIST_GET(p));
+        _e_connman_element_property_free(p);
+        changed = EINA_TRUE;
+     }
+
+   if (changed)
+      _e_connman_element_props_index_rebuild(element);
+
+   return changed;
+}
+
+static Eina_Bool
+_e_connman_element_property_value_add(E_Connman_Element *element, const char *name, int type, void *value)
+{
+   E_Connman_Element_Property *p;
+   E_Connman_Value none;
+
+   name = eina_stringshare_add(name);
+   p = _e_connman_element_property_find(element, name);
+   if (p)
+     {
+        E_Connman_Value old;
+        Eina_Bool changed;
+        int old_type = p->type;
+
+        eina_stringshare_del(name);
+        p->stale = EINA_FALSE;
+        _e_connman_element_value_keep(p, &old);
+        changed = _e_connman_element_property_update(p, type, value);
+        _e_connman_element_service_slot_update(element, p);
+        if (changed)
+           _e_connman_element_change_add(element, p, old_type, &old);
+        else
+           _e_connman_element_value_release(old_type, &old);
+
+        E_DBUS_PROBE4(econnman, property_update, element->path, p->name, type, changed);
+        return changed;
+     }
+
+   p = _e_connman_element_property_new(name, type, value);
+   if (!p)
+     {
+        ERR("could not create property %s (%c)", name, type);
+        return EINA_FALSE;
+     }
+
+   if (!_e_connman_element_props_index_add(element, p))
+     {
+        _e_connman_element_property_free(p);
+        return EINA_FALSE;
+     }
+
+   element->props = eina_inlist_append(element->props, EINA_INLIST_GET(p));
+   _e_connman_element_service_slot_set(element, p);
+   memset(&none, 0, sizeof(none));
+   _e_connman_element_change_add(element, p, DBUS_TYPE_INVALID, &none);
+   E_DBUS_PROBE4(econnman, property_update, element->path, p->name, type, 2);
+   return EINA_TRUE;
+}
+
+static E_Connman_Array *
+_e_connman_element_iter_get_array(DBusMessageIter *itr, const char *key)
+{
+   E_Connman_Array *array;
+   DBusMessageIter e_itr;
+
+   array = malloc(sizeof(E_Connman_Array));
+   if (!array)
+     {
+        ERR("could not create new e_connman array.");
+        return NULL;
+     }
+
+   array->array = eina_array_new(16);
+   if (!(array->array))
+     {
+        ERR("could not create new eina array.");
+        free(array);
+        return NULL;
+     }
+
+   dbus_message_iter_recurse(itr, &e_itr);
+   array->type = dbus_message_iter_get_arg_type(&e_itr);
+   if (array->type == DBUS_TYPE_INVALID)
+     {
+        DBG("array %s is of type 'invalid' (empty?)", key);
+        eina_array_free(array->array);
+        free(array);
+        return NULL;
+     }
+
+   do
+     {
+        switch (array->type)
+          {
+           case DBUS_TYPE_OBJECT_PATH:
+           {
+              const char *path;
+
+              dbus_message_iter_get_basic(&e_itr, &path);
+              path = eina_stringshare_add(path);
+              eina_array_push(array->array, path);
+              _e_connman_element_item_register(key, path);
+           }
+           break;
+
+           case DBUS_TYPE_STRING:
+           {
+              const char *str;
+
+              dbus_message_iter_get_basic(&e_itr, &str);
+              str = eina_stringshare_add(str);
+              eina_array_push(array->array, str);
+           }
+           break;
+
+           case DBUS_TYPE_BYTE:
+           {
+              unsigned char byte;
+              dbus_message_iter_get_basic(&e_itr, &byte);
+              eina_array_push(array->array, (void *)(long)byte);
+           }
+           break;
+
+           case DBUS_TYPE_DICT_ENTRY:
+           {
+              E_Connman_Element_Dict_Entry *entry;
+              entry = _e_connman_element_dict_entry_new(&e_itr);
+              if (entry)
+                 eina_array_push(array->array, entry);
+           }
+           break;
+
+           default:
+              ERR("don't know how to build array '%s' of type %c (%d)",
+                  key, array->type, array->type);
+              eina_array_free(array->array);
+              free(array);
+              return NULL;
+          }
+     }
+   while (dbus_message_iter_next(&e_itr));
+   return array;
+}
+
+static void
+_e_connman_element_get_properties_parse(E_Connman_Element *element, DBusMessage *msg, DBusError *err)
+{
+   DBusMessageIter itr, s_itr;
+   int t, changed;
+
+   DBG("get_properties msg=%p", msg);
+
+   if (!_dbus_callback_check_and_init(msg, &itr, err))
+      return;
+
+   t = dbus_message_iter_get_arg_type(&itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_ARRAY))
+      return;
+
+   element->_synced = EINA_TRUE;
+   changed = 0;
+   dbus_message_iter_recurse(&itr, &s_itr);
+   do
+     {
+        DBusMessageIter e_itr, v_itr;
+        const char *key;
+        void *value = NULL;
+        int r;
+
+        t = dbus_message_iter_get_arg_type(&s_itr);
+        if (!_dbus_iter_type_check(t, DBUS_TYPE_DICT_ENTRY))
+           continue;
+
+        dbus_message_iter_recurse(&s_itr, &e_itr);
+
+        t = dbus_message_iter_get_arg_type(&e_itr);
+        if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+           continue;
+
+        dbus_message_iter_get_basic(&e_itr, &key);
+        dbus_message_iter_next(&e_itr);
+        t = dbus_message_iter_get_arg_type(&e_itr);
+        if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+           continue;
+
+        dbus_message_iter_recurse(&e_itr, &v_itr);
+        t = dbus_message_iter_get_arg_type(&v_itr);
+        if (t == DBUS_TYPE_ARRAY)
+          {
+             value = _e_connman_element_iter_get_array(&v_itr, key);
+          }
+        else if (t != DBUS_TYPE_INVALID)
+          {
+             dbus_message_iter_get_basic(&v_itr, &value);
+          }
+        else
+          {
+             ERR("property has invalid type %s", key);
+             continue;
+          }
+
+        r = _e_connman_element_property_value_add(element, key, t, value);
+        if (r < 0)
+          {
+             ERR("failed to add property value %s (%c)", key, t);
+          }
+        else if (r == 1)
+          {
+             INF("property value changed %s (%c)", key, t);
+             changed = 1;
+          }
+     }
+   while (dbus_message_iter_next(&s_itr));
+
+   if ((element->_stale) && (_e_connman_element_stale_props_del(element)))
+      changed = 1;
+
+   if (changed)
+      _e_connman_element_listeners_call(element);
+}
+
+static void
+_e_connman_element_get_properties_callback(void *user_data, DBusMessage *msg, DBusError *err)
+{
+   E_Connman_Element *element = user_data;
+
+   _e_connman_element_get_properties_parse(element, msg, err);
+
+   /* the reply e_connman_elements_sync() waited for, now that the elements
+    * it lists are queued */
+   if (element == sync_manager)
+     {
+        sync_manager = NULL;
+        if (sync_in_flight > 0)
+           sync_in_flight--;
+        _e_connman_elements_sync_pump();
+     }
+}
+
+/**
+ * Sync element properties with server.
+ *
+ * Call method GetProperties() at the given element on server in order to sync
+ * them.
+ *
+ * @param element to call method on server.
+ * @param cb function to call when server replies or some error happens.
+ * @param data data to give to cb when it is called.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_properties_sync_full(E_Connman_Element *element, E_DBus_Method_Return_Cb cb, const void *data)
+{
+   const char name[] = "GetProperties";
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return e_connman_element_call_full
+             (element, name, _e_connman_element_get_properties_callback,
+             &element->_pending.properties_get, cb, data);
+}
+
+/**
+ * Sync element properties with server, simple version.
+ *
+ * Call method GetProperties() at the given element on server in order to sync
+ * them. This is the simple version and there is no check of server reply
+ * for errors.
+ *
+ * @param element to call method on server.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_properties_sync(E_Connman_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return e_connman_element_properties_sync_full(element, NULL, NULL);
+}
+
+/**
+ * Call method SetProperty(prop, {key: value}) at the given element on server.
+ *
+ * This is a server call, not local, so it may fail and in that case
+ * no property is updated locally. If the value was set the event
+ * E_CONNMAN_EVENT_ELEMENT_UPDATED will be added to main loop.
+ *
+ * @param element to call method on server.
+ * @param prop property name.
+ * @param key dict key name.
+ * @param type DBus type to use for value.
+ * @param value pointer to value, just like regular DBus, see
+ *        dbus_message_iter_append_basic().
+ * @param cb function to call when server replies or some error happens.
+ * @param data data to give to cb when it is called.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_dict_set_full(E_Connman_Element *element, const char *prop, const char *key, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+{
+   const char name[] = "SetProperty";
+   DBusMessage *msg;
+   DBusMessageIter itr, variant, dict, entry;
+   char typestr[32];
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_connman_system_bus_name_get(), element->path, element->interface, name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+
+   if ((size_t)snprintf(typestr, sizeof(typestr),
+                        (DBUS_TYPE_ARRAY_AS_STRING
+                         DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                         DBUS_TYPE_STRING_AS_STRING
+                         "%c"
+                         DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
+                        type) >= sizeof(typestr))
+     {
+        ERR("sizeof(typestr) is too small!");
+        return EINA_FALSE;
+     }
+
+   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &variant))
+     {
+        snprintf(typestr, sizeof(typestr),
+                 (DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                     DBUS_TYPE_STRING_AS_STRING
+                     "%c"
+                     DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
+                 type);
+        if (dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, typestr, &dict))
+          {
+             if (dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry))
+               {
+                  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+
+                  if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+                    dbus_message_iter_append_basic(&entry, type, &value);
+                  else
+                    dbus_message_iter_append_basic(&entry, type, value);
+                  
+                  dbus_message_iter_close_container(&dict, &entry);
+               }
+             else
+               {
+                  ERR("dbus_message_iter_open_container() failed");
+               }
+             dbus_message_iter_close_container(&variant, &dict);
+          }
+        else
+          {
+             ERR("dbus_message_iter_open_container() failed");
+          }
+        dbus_message_iter_close_container(&itr, &variant);
+     }
+   else
+     {
+        ERR("dbus_message_iter_open_container() failed");
+     }
+
+   return e_connman_element_message_send
+             (element, name, NULL, msg, &element->_pending.property_set, cb, data);
+}
+
+/**
+ * Call method SetProperty(prop, value) at the given element on server.
+ *
+ * This is a server call, not local, so it may fail and in that case
+ * no property is updated locally. If the value was set the event
+ * E_CONNMAN_EVENT_ELEMENT_UPDATED will be added to main loop.
+ *
+ * @param element to call method on server.
+ * @param prop property name.
+ * @param type DBus type to use for value.
+ * @param value pointer to value, just like regular DBus, see
+ *        dbus_message_iter_append_basic().
+ * @param cb function to call when server replies or some error happens.
+ * @param data data to give to cb when it is called.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_set_full(E_Connman_Element *element, const char *prop, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+{
+   const char name[] = "SetProperty";
+   char typestr[2];
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_connman_system_bus_name_get(), element->path, element->interface, name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   DBusMessageIter itr, v;
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+
+   typestr[0] = type;
+   typestr[1] = '\0';
+   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &v))
+     {
+        if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+          {
+             dbus_message_iter_append_basic(&v, type, &value);
+          }
+        else if (type == DBUS_TYPE_BOOLEAN)
+          {
+             unsigned int b = *(char *)value;
+             dbus_message_iter_append_basic(&v, type, &b);
+          }
+        else
+          {
+             dbus_message_iter_append_basic(&v, type, value);
+          }
+        
+        dbus_message_iter_close_container(&itr, &v);
+     }
+   else
+     {
+        ERR("dbus_message_iter_open_container() failed");
+     }
+
+   return e_connman_element_message_send
+             (element, name, NULL, msg, &element->_pending.property_set, cb, data);
+}
+
+/**
+ * Call method SetProperty(prop, value) at the given element on server, when
+ * value is an array.
+ *
+ * This is a server call, not local, so it may fail and in that case
+ * no property is updated locally. If the value was set the event
+ * E_CONNMAN_EVENT_ELEMENT_UPDATED will be added to main loop.
+ *
+ * @param element to call method on server.
+ * @param prop property name.
+ * @param type DBus type to use for value.
+ * @param value pointer to value, just like regular DBus, see
+ *        dbus_message_iter_append_basic().
+ * @param cb function to call when server replies or some error happens.
+ * @param data data to give to cb when it is called.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_array_set_full(E_Connman_Element *element, const char *prop, int type, unsigned int count, const void * const *values, E_DBus_Method_Return_Cb cb, const void *data)
+{
+   const char name[] = "SetProperty";
+   char type_sig[2] = { type, '\0'};
+   char array_sig[3] = { DBUS_TYPE_ARRAY, type, '\0' };
+   DBusMessage *msg;
+   DBusMessageIter itr, variant, array;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_connman_system_bus_name_get(), element->path, element->interface, name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+
+   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, array_sig, &variant))
+     {
+        if (dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, type_sig, &array))
+          {
+             if (type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH)
+               {
+                  unsigned int i;
+                  for (i = 0; i < count; i++)
+                    {
+                       const void *entry = values[i];
+                       dbus_message_iter_append_basic(&array, type, &entry);
+                    }
+               }
+             else
+               {
+                  unsigned int i;
+                  for (i = 0; i < count; i++)
+                    {
+                       const void *entry = values[i];
+                       dbus_message_iter_append_basic(&array, type, entry);
+                    }
+               }
+             
+             dbus_message_iter_close_container(&variant, &array);
+          }
+        else
+          {
+             ERR("dbus_message_iter_open_container() failed");
+          }
+        dbus_message_iter_close_container(&itr, &variant);
+     }
+   else
+     {
+        ERR("dbus_message_iter_open_container() failed");
+     }
+   
+   return e_connman_element_message_send(element, name, NULL, msg,
+                                         &element->_pending.property_set,
+                                         cb, data);
+}
+
+/**
+ * Call method SetProperty(prop, value) at the given element on server.
+ *
+ * This is the simple version and there is no check of server reply
+ * for errors.
+ *
+ * @param element to call method on server.
+ * @param prop property name.
+ * @param type DBus type to use for value.
+ * @param value pointer to value, just like regular DBus, see
+ *        dbus_message_iter_append_basic().
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_set(E_Connman_Element *element, const char *prop, int type, const void *value)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+   return e_connman_element_property_set_full
+             (element, prop, type, value, NULL, NULL);
+}
+
+Eina_Bool
+e_connman_element_call_with_path(E_Connman_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   DBusMessageIter itr;
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_connman_system_bus_name_get(), element->path, element->interface,
+         method_name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_OBJECT_PATH, &string);
+
+   return e_connman_element_message_send
+             (element, method_name, cb, msg, pending, user_cb, user_data);
+}
+
+Eina_Bool
+e_connman_element_call_with_string(E_Connman_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   DBusMessageIter itr;
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_connman_system_bus_name_get(), element->path, element->interface,
+         method_name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &string);
+
+   return e_connman_element_message_send
+             (element, method_name, cb, msg, pending, user_cb, user_data);
+}
+
+/**
+ * Get property type.
+ *
+ * If @c EINA_FALSE is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name, must be previously stringshared
+ * @param type will contain the value type.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_type_get_stringshared(const E_Connman_Element *element, const char *name, int *type)
+{
+   const E_Connman_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(type, EINA_FALSE);
+
+   p = _e_connman_element_property_find(element, name);
+   if (p)
+     {
+        *type = p->type;
+        return EINA_TRUE;
+     }
+
+   WRN("element %s (%p) has no property with name \"%s\".",
+       element->path, element, name);
+   return EINA_FALSE;
 }
 
 /**
- * Add reference to element.
+ * Get property type.
+ *
+ * If @c EINA_FALSE is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name
+ * @param type will contain the value type.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
  */
-int
-e_connman_element_ref(E_Connman_Element *element)
+Eina_Bool
+e_connman_element_property_type_get(const E_Connman_Element *element, const char *name, int *type)
 {
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
-   return ++element->_references;
+   const E_Connman_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+
+   /* use the stored stringshare instead of adding one for each call */
+   p = _e_connman_element_property_find_string(element, name);
+   if (p)
+      name = p->name;
+
+   return e_connman_element_property_type_get_stringshared(element, name, type);
+}
+
+void
+e_connman_element_list_properties(const E_Connman_Element *element, Eina_Bool (*cb)(void *data, const E_Connman_Element *element, const char *name, int type, const void *value), const void *data)
+{
+   const E_Connman_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN(element);
+   EINA_SAFETY_ON_NULL_RETURN(cb);
+
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      const void *value = NULL;
+
+      switch (p->type)
+        {
+         case DBUS_TYPE_STRING:
+            value = &p->value.str;
+            break;
+
+         case DBUS_TYPE_OBJECT_PATH:
+            value = &p->value.path;
+            break;
+
+         case DBUS_TYPE_BOOLEAN:
+            value = (void *)&p->value.boolean;
+            break;
+
+         case DBUS_TYPE_UINT16:
+            value = &p->value.u16;
+            break;
+
+         case DBUS_TYPE_UINT32:
+            value = &p->value.u32;
+            break;
+
+         default:
+            ERR("unsupported type %c", p->type);
+        }
+
+      if (!cb((void *)data, element, p->name, p->type, value))
+         return;
+   }
+}
+
+/**
+ * Get dict value given its key inside a dict property.
+ *
+ * This will look into properties for one of type dict that contains
+ * the given key, to find the property.  If no property is found then
+ * @c EINA_FALSE is returned.
+ *
+ * If @c EINA_FALSE is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param dict_name property name, must be previously stringshared
+ * @param key key inside dict, must be previously stringshared
+ * @param type if provided it will contain the value type.
+ * @param value where to store the property value, must be a pointer to the
+ *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_dict_get_stringshared(const E_Connman_Element *element, const char *dict_name, const char *key, int *type, void *value)
+{
+   const E_Connman_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(dict_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(key, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+
+   p = _e_connman_element_property_find(element, dict_name);
+   if (p)
+     {
+        E_Connman_Element_Dict_Entry *entry;
+        E_Connman_Array *array;
+
+        if (p->type != DBUS_TYPE_ARRAY)
+          {
+             WRN("element %s (%p) has property \"%s\" is not an array: %c (%d)",
+                 element->path, element, dict_name, p->type, p->type);
+             return EINA_FALSE;
+          }
+
+        array = p->value.array;
+        if ((!array) || (array->type != DBUS_TYPE_DICT_ENTRY))
+          {
+             int t = array ? array->type : DBUS_TYPE_INVALID;
+             WRN("element %s (%p) has property \"%s\" is not a dict: %c (%d)",
+                 element->path, element, dict_name, t, t);
+             return EINA_FALSE;
+          }
+
+        entry = _e_connman_element_array_dict_find_stringshared(array, key);
+        if (!entry)
+          {
+             WRN("element %s (%p) has no dict property with name \"%s\" with "
+                 "key \"%s\".",
+                 element->path, element, dict_name, key);
+             return EINA_FALSE;
+          }
+
+        if (type)
+           *type = entry->type;
+
+        switch (entry->type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+              *(Eina_Bool *)value = entry->value.boolean;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_BYTE:
+              *(unsigned char *)value = entry->value.byte;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT16:
+              *(unsigned short *)value = entry->value.u16;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT32:
+              *(unsigned int *)value = entry->value.u32;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_STRING:
+              *(const char **)value = entry->value.str;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_OBJECT_PATH:
+              *(const char **)value = entry->value.path;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_ARRAY:
+              *(E_Connman_Array **)value = entry->value.array;
+              return EINA_TRUE;
+
+           default:
+              ERR("don't know how to get property %s, key %s type %c (%d)",
+                  dict_name, key, entry->type, entry->type);
+              return EINA_FALSE;
+          }
+     }
+
+   DBG("element %s (%p) has no property with name \"%s\".",
+       element->path, element, dict_name);
+   return EINA_FALSE;
+}
+
+/**
+ * Get a view of an array of strings inside a dict property.
+ *
+ * Like e_connman_element_strings_array_view(), nothing is copied and the
+ * strings are freed as soon as a change of the dict is handled, do not
+ * keep them past a return to the main loop.
+ *
+ * @param element the element with the property.
+ * @param dict_name name of the dict property.
+ * @param key key of the array of strings in the dict.
+ * @param count where to return the number of strings.
+ * @param strings where to return the strings, just set if return is
+ *        @c EINA_TRUE.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_dict_strings_array_view(const E_Connman_Element *element, const char *dict_name, const char *key, unsigned int *count, const char ***strings)
+{
+   E_Connman_Array *array;
+   int type;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(dict_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(key, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(strings, EINA_FALSE);
+
+   *count = 0;
+   *strings = NULL;
+
+   if (!e_connman_element_property_dict_get_stringshared(element, dict_name,
+                                                         key, &type, &array))
+      return EINA_FALSE;
+
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s.%s is not an array!", dict_name, key);
+        return EINA_FALSE;
+     }
+
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_FALSE;
+
+   if (array->type != DBUS_TYPE_STRING)
+     {
+        ERR("property %s.%s is not an array of strings!", dict_name, key);
+        return EINA_FALSE;
+     }
+
+   *count = eina_array_count(array->array);
+   *strings = (const char **)array->array->data;
+   return EINA_TRUE;
+}
+
+/* the returned array is malloc()ed, the strings are stringshared references */
+Eina_Bool
+e_connman_element_property_dict_strings_array_get_stringshared(const E_Connman_Element *element, const char *dict_name, const char *key, unsigned int *count, const char ***strings)
+{
+   if (!e_connman_element_property_dict_strings_array_view
+          (element, dict_name, key, count, strings))
+      return EINA_FALSE;
+
+   return _e_connman_element_strings_array_copy(count, strings);
+}
+
+/**
+ * Get property value given its name.
+ *
+ * This will look into properties, to find the property.
+ * If no property is found then @c EINA_FALSE is returned.
+ *
+ * If @c EINA_FALSE is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name, must be previously stringshared
+ * @param type if provided it will contain the value type.
+ * @param value where to store the property value, must be a pointer to the
+ *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_element_property_get_stringshared(const E_Connman_Element *element, const char *name, int *type, void *value)
+{
+   const E_Connman_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+
+   p = _e_connman_element_property_find(element, name);
+   if (p)
+     {
+        if (type)
+           *type = p->type;
+
+        switch (p->type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+              *(Eina_Bool *)value = p->value.boolean;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_BYTE:
+              *(unsigned char *)value = p->value.byte;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT16:
+              *(unsigned short *)value = p->value.u16;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT32:
+              *(unsigned int *)value = p->value.u32;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_STRING:
+              *(const char **)value = p->value.str;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_OBJECT_PATH:
+              *(const char **)value = p->value.path;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_ARRAY:
+              *(E_Connman_Array **)value = p->value.array;
+              return EINA_TRUE;
+
+           default:
+              ERR("don't know how to get property type %c (%d)",
+                  p->type, p->type);
+              return EINA_FALSE;
+          }
+     }
+
+   WRN("element %s (%p) has no property with name \"%s\".",
+       element->path, element, name);
+   return EINA_FALSE;
 }
 
 /**
- * Remove reference from element.
+ * Get property value given its name.
  *
- * If reference count drops to 0 element will be freed.
+ * This will look into properties, to find the property.
+ * If no property is found then @c EINA_FALSE is returned.
+ *
+ * If @c EINA_FALSE is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name
+ * @param type if provided it will contain the value type.
+ * @param value where to store the property value, must be a pointer to the
+ *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
  */
-int
-e_connman_element_unref(E_Connman_Element *element)
+Eina_Bool
+e_connman_element_property_get(const E_Connman_Element *element, const char *name, int *type, void *value)
 {
-   int i;
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
+   const E_Connman_Element_Property *p;
 
-   i = --element->_references;
-   if (i == 0)
-      e_connman_element_free(element);
-   else if (i < 0)
-      ERR("element %p references %d < 0", element, i);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
 
-   return i;
+   /* use the stored stringshare instead of adding one for each call */
+   p = _e_connman_element_property_find_string(element, name);
+   if (p)
+      name = p->name;
+
+   return e_connman_element_property_get_stringshared
+             (element, name, type, value);
 }
 
+/* stores a slot value of the given type, as the _stringshared getters do */
+#define SERVICE_SLOT_VALUE_STORE(v, type, value)              \
+   switch (type)                                              \
+     {                                                        \
+      case DBUS_TYPE_BOOLEAN:                                 \
+         *(Eina_Bool *)value = (v).boolean;                   \
+         return EINA_TRUE;                                    \
+      case DBUS_TYPE_BYTE:                                    \
+         *(unsigned char *)value = (v).byte;                  \
+         return EINA_TRUE;                                    \
+      case DBUS_TYPE_UINT16:                                  \
+         *(unsigned short *)value = (v).u16;                  \
+         return EINA_TRUE;                                    \
+      case DBUS_TYPE_UINT32:                                  \
+         *(unsigned int *)value = (v).u32;                    \
+         return EINA_TRUE;                                    \
+      case DBUS_TYPE_STRING:                                  \
+         *(const char **)value = (v).str;                     \
+         return EINA_TRUE;                                    \
+      case DBUS_TYPE_OBJECT_PATH:                             \
+         *(const char **)value = (v).path;                    \
+         return EINA_TRUE;                                    \
+      default:                                                \
+         ERR("don't know how to get slot type %c (%d)",       \
+             type, type);                                     \
+         return EINA_FALSE;                                   \
+     }
+
 /**
- * Send message with callbacks set to work with connman elements.
+ * Get the value of a known service property from its slot.
  *
- * If this call fails (returns @c EINA_FALSE), pending callbacks will not be called,
- * not even with error messages.
+ * Same as e_connman_element_property_get_stringshared() with the name of
+ * @a slot, but without a lookup.  The value must be of @a type.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE on failure.
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
  */
 Eina_Bool
-e_connman_element_message_send(E_Connman_Element *element, const char *method_name, E_DBus_Method_Return_Cb cb, DBusMessage *msg, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+e_connman_element_service_slot_get(const E_Connman_Element *service, E_Connman_Service_Slot slot, int type, void *value)
 {
-   E_Connman_Element_Call_Data *data;
-   E_Connman_Element_Pending *p;
+   const E_Connman_Service_Record *record;
+   const E_Connman_Element_Property *p = NULL;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(msg, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+   EINA_SAFETY_ON_FALSE_RETURN_VAL(slot < E_CONNMAN_SERVICE_SLOT_LAST, EINA_FALSE);
 
-   data = malloc(sizeof(*data));
-   if (!data)
-     {
-        ERR("could not alloc e_connman_element_call_data: %s",
-            strerror(errno));
-        dbus_message_unref(msg);
-        return EINA_FALSE;
-     }
+   record = service->_service_record;
+   if (record)
+      p = record->props[slot];
 
-   p = malloc(sizeof(*p));
    if (!p)
      {
-        ERR("could not alloc E_Connman_Element_Pending: %s",
-            strerror(errno));
-        free(data);
-        dbus_message_unref(msg);
+        WRN("element %s (%p) has no property with name \"%s\".",
+            service->path, service, *service_slot_names[slot]);
         return EINA_FALSE;
      }
 
-   data->element = element;
-   data->cb = cb;
-   data->pending = p;
-   data->p_list = pending;
-   p->user_cb = user_cb;
-   p->user_data = (void *)user_data;
-   p->data = data;
-   p->pending = e_dbus_message_send
-         (e_connman_conn, msg, e_connman_element_call_dispatch_and_free, -1, data);
-   dbus_message_unref(msg);
-
-   if (p->pending)
+   if (p->type != type)
      {
-        *pending = eina_inlist_append(*pending, EINA_INLIST_GET(p));
-        return EINA_TRUE;
+        WRN("element %s (%p) property \"%s\" is %c, not %c.",
+            service->path, service, p->name, p->type, type);
+        return EINA_FALSE;
      }
 
-   ERR("failed to call %s (obj=%s, path=%s, iface=%s)",
-       method_name, e_connman_system_bus_name_get(),
-       element->path, element->interface);
-   free(data);
-   free(p);
-   return EINA_FALSE;
+   SERVICE_SLOT_VALUE_STORE(p->value, type, value);
 }
 
+/**
+ * Get the value of a known key inside a service dict from its slot.
+ *
+ * Same as e_connman_element_property_dict_get_stringshared() with the
+ * names of @a dict and @a key, but without a lookup.  The value must be
+ * of @a type.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
 Eina_Bool
-e_connman_element_call_full(E_Connman_Element *element, const char *method_name, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+e_connman_element_service_dict_slot_get(const E_Connman_Element *service, E_Connman_Service_Slot dict, E_Connman_Service_Key key, int type, void *value)
 {
-   DBusMessage *msg;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
-
-   msg = dbus_message_new_method_call
-         (e_connman_system_bus_name_get(), element->path, element->interface,
-         method_name);
+   const E_Connman_Service_Record *record;
+   const E_Connman_Element_Dict_Entry *entry = NULL;
 
-   return e_connman_element_message_send
-             (element, method_name, cb, msg, pending, user_cb, user_data);
-}
+   EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+   EINA_SAFETY_ON_FALSE_RETURN_VAL(dict >= E_CONNMAN_SERVICE_SLOT_DICT_FIRST, EINA_FALSE);
+   EINA_SAFETY_ON_FALSE_RETURN_VAL(dict < E_CONNMAN_SERVICE_SLOT_LAST, EINA_FALSE);
+   EINA_SAFETY_ON_FALSE_RETURN_VAL(key < E_CONNMAN_SERVICE_KEY_LAST, EINA_FALSE);
 
-static Eina_Bool
-_e_connman_element_property_value_add(E_Connman_Element *element, const char *name, int type, void *value)
-{
-   E_Connman_Element_Property *p;
+   record = service->_service_record;
+   if (record)
+      entry = record->entries[dict - E_CONNMAN_SERVICE_SLOT_DICT_FIRST][key];
 
-   name = eina_stringshare_add(name);
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      if (p->name == name)
-        {
-           eina_stringshare_del(name);
-           return _e_connman_element_property_update(p, type, value);
-        }
-   }
+   if (!entry)
+     {
+        WRN("element %s (%p) has no dict property with name \"%s\" with "
+            "key \"%s\".", service->path, service,
+            *service_slot_names[dict], *service_key_names[key]);
+        return EINA_FALSE;
+     }
 
-   p = _e_connman_element_property_new(name, type, value);
-   if (!p)
+   if (entry->type != type)
      {
-        ERR("could not create property %s (%c)", name, type);
+        WRN("element %s (%p) dict \"%s\" key \"%s\" is %c, not %c.",
+            service->path, service, *service_slot_names[dict], entry->name,
+            entry->type, type);
         return EINA_FALSE;
      }
 
-   element->props = eina_inlist_append(element->props, EINA_INLIST_GET(p));
-   return EINA_TRUE;
+   SERVICE_SLOT_VALUE_STORE(entry->value, type, value);
 }
 
-static E_Connman_Array *
-_e_connman_element_iter_get_array(DBusMessageIter *itr, const char *key)
+#undef SERVICE_SLOT_VALUE_STORE
+
+struct e_connman_elements_for_each_data
 {
-   E_Connman_Array *array;
-   DBusMessageIter e_itr;
+   Eina_Hash_Foreach cb;
+   void             *data;
+};
 
-   array = malloc(sizeof(E_Connman_Array));
-   if (!array)
-     {
-        ERR("could not create new e_connman array.");
-        return NULL;
-     }
+static Eina_Bool
+_e_connman_elements_for_each(Eina_Hash *hash __UNUSED__, const char *key, void *data, void *fdata)
+{
+   struct e_connman_elements_for_each_data *each_data = fdata;
 
-   array->array = eina_array_new(16);
-   if (!(array->array))
-     {
-        ERR("could not create new eina array.");
-        free(array);
-        return NULL;
-     }
+   each_data->cb(elements, key, data, each_data->data);
+   return EINA_TRUE;
+}
 
-   dbus_message_iter_recurse(itr, &e_itr);
-   array->type = dbus_message_iter_get_arg_type(&e_itr);
-   if (array->type == DBUS_TYPE_INVALID)
-     {
-        DBG("array %s is of type 'invalid' (empty?)", key);
-        eina_array_free(array->array);
-        free(array);
-        return NULL;
-     }
+/**
+ * Call the given function for each existing element.
+ *
+ * @param cb function to call for each element. It will get as parameters,
+ *        in order: the element pointer and the given @a user_data.
+ * @param user_data data to give to @a cb for each element.
+ */
+void
+e_connman_elements_for_each(Eina_Hash_Foreach cb, const void *user_data)
+{
+   struct e_connman_elements_for_each_data data = {cb, (void *)user_data};
 
-   do
-     {
-        switch (array->type)
-          {
-           case DBUS_TYPE_OBJECT_PATH:
-           {
-              const char *path;
+   EINA_SAFETY_ON_NULL_RETURN(cb);
 
-              dbus_message_iter_get_basic(&e_itr, &path);
-              path = eina_stringshare_add(path);
-              eina_array_push(array->array, path);
-              _e_connman_element_item_register(key, path);
-           }
-           break;
+   eina_hash_foreach(elements, (Eina_Hash_Foreach)_e_connman_elements_for_each,
+                     &data);
+}
 
-           case DBUS_TYPE_STRING:
-           {
-              const char *str;
+typedef struct _E_Connman_Elements_Index E_Connman_Elements_Index;
 
-              dbus_message_iter_get_basic(&e_itr, &str);
-              str = eina_stringshare_add(str);
-              eina_array_push(array->array, str);
-           }
-           break;
+struct _E_Connman_Elements_Index
+{
+   E_Connman_Element **items;
+   unsigned int         count;
+   unsigned int         size;
+   const char          *interface;
+};
 
-           case DBUS_TYPE_BYTE:
-           {
-              unsigned char byte;
-              dbus_message_iter_get_basic(&e_itr, &byte);
-              eina_array_push(array->array, (void *)(long)byte);
-           }
-           break;
+static E_Connman_Elements_Index elements_all = {NULL, 0, 0, NULL};
+/* stringshared interface -> E_Connman_Elements_Index */
+static Eina_Hash *elements_by_interface = NULL;
 
-           case DBUS_TYPE_DICT_ENTRY:
-           {
-              E_Connman_Element_Dict_Entry *entry;
-              entry = _e_connman_element_dict_entry_new(&e_itr);
-              if (entry)
-                 eina_array_push(array->array, entry);
-           }
-           break;
+/* Elements are also kept in flat arrays, one for all of them and one per
+ * interface, so listing them needs no walk of the hash.  Removal swaps the
+ * last element in, element->_index[] has the position in each.  Any change
+ * to these arrays or to an array property bumps elements_generation, which
+ * stops the iterators still running over the old ones.
+ */
+enum
+{
+   ELEMENTS_INDEX_ALL,
+   ELEMENTS_INDEX_INTERFACE
+};
 
-           default:
-              ERR("don't know how to build array '%s' of type %c (%d)",
-                  key, array->type, array->type);
-              eina_array_free(array->array);
-              free(array);
-              return NULL;
+static Eina_Bool
+_e_connman_elements_index_add(E_Connman_Elements_Index *index, int which, E_Connman_Element *element)
+{
+   if (index->count == index->size)
+     {
+        unsigned int size = index->size ? index->size * 2 : 16;
+        E_Connman_Element **items;
+
+        items = realloc(index->items, size * sizeof(E_Connman_Element *));
+        if (!items)
+          {
+             ERR("could not grow the index of %s: %s",
+                 element->path, strerror(errno));
+             return EINA_FALSE;
           }
+        index->items = items;
+        index->size = size;
      }
-   while (dbus_message_iter_next(&e_itr));
-   return array;
+
+   element->_index[which] = index->count;
+   index->items[index->count++] = element;
+   elements_generation++;
+   return EINA_TRUE;
 }
 
 static void
-_e_connman_element_get_properties_callback(void *user_data, DBusMessage *msg, DBusError *err)
+_e_connman_elements_index_del(E_Connman_Elements_Index *index, int which, E_Connman_Element *element)
 {
-   E_Connman_Element *element = user_data;
-   DBusMessageIter itr, s_itr;
-   int t, changed;
-
-   DBG("get_properties msg=%p", msg);
+   unsigned int pos = element->_index[which];
+   E_Connman_Element *last;
 
-   if (!_dbus_callback_check_and_init(msg, &itr, err))
+   if ((pos >= index->count) || (index->items[pos] != element))
       return;
 
-   t = dbus_message_iter_get_arg_type(&itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_ARRAY))
-      return;
+   last = index->items[--index->count];
+   index->items[pos] = last;
+   last->_index[which] = pos;
+   elements_generation++;
+}
 
-   changed = 0;
-   dbus_message_iter_recurse(&itr, &s_itr);
-   do
-     {
-        DBusMessageIter e_itr, v_itr;
-        const char *key;
-        void *value = NULL;
-        int r;
+static void
+_e_connman_elements_index_free(void *data)
+{
+   E_Connman_Elements_Index *index = data;
 
-        t = dbus_message_iter_get_arg_type(&s_itr);
-        if (!_dbus_iter_type_check(t, DBUS_TYPE_DICT_ENTRY))
-           continue;
+   eina_stringshare_del(index->interface);
+   free(index->items);
+   free(index);
+}
+
+/* interface NULL is all the elements, NULL if none was seen */
+static E_Connman_Elements_Index *
+_e_connman_elements_index_find(const char *interface)
+{
+   E_Connman_Elements_Index *index;
 
-        dbus_message_iter_recurse(&s_itr, &e_itr);
+   if (!interface)
+      return &elements_all;
 
-        t = dbus_message_iter_get_arg_type(&e_itr);
-        if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
-           continue;
+   if (!elements_by_interface)
+      return NULL;
 
-        dbus_message_iter_get_basic(&e_itr, &key);
-        dbus_message_iter_next(&e_itr);
-        t = dbus_message_iter_get_arg_type(&e_itr);
-        if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
-           continue;
+   interface = eina_stringshare_add(interface);
+   index = eina_hash_find(elements_by_interface, &interface);
+   eina_stringshare_del(interface);
+   return index;
+}
 
-        dbus_message_iter_recurse(&e_itr, &v_itr);
-        t = dbus_message_iter_get_arg_type(&v_itr);
-        if (t == DBUS_TYPE_ARRAY)
-          {
-             value = _e_connman_element_iter_get_array(&v_itr, key);
-          }
-        else if (t != DBUS_TYPE_INVALID)
-          {
-             dbus_message_iter_get_basic(&v_itr, &value);
-          }
-        else
-          {
-             ERR("property has invalid type %s", key);
-             continue;
-          }
+static Eina_Bool
+_e_connman_element_index_add(E_Connman_Element *element)
+{
+   E_Connman_Elements_Index *index;
 
-        r = _e_connman_element_property_value_add(element, key, t, value);
-        if (r < 0)
+   index = eina_hash_find(elements_by_interface, &element->interface);
+   if (!index)
+     {
+        index = calloc(1, sizeof(E_Connman_Elements_Index));
+        if (!index)
           {
-             ERR("failed to add property value %s (%c)", key, t);
+             ERR("could not allocate the index of %s: %s",
+                 element->interface, strerror(errno));
+             return EINA_FALSE;
           }
-        else if (r == 1)
+
+        index->interface = eina_stringshare_ref(element->interface);
+        if (!eina_hash_add(elements_by_interface, &index->interface, index))
           {
-             INF("property value changed %s (%c)", key, t);
-             changed = 1;
+             _e_connman_elements_index_free(index);
+             return EINA_FALSE;
           }
      }
-   while (dbus_message_iter_next(&s_itr));
 
-   if (changed)
-      _e_connman_element_listeners_call(element);
+   if (!_e_connman_elements_index_add(&elements_all, ELEMENTS_INDEX_ALL, element))
+      return EINA_FALSE;
+
+   if (!_e_connman_elements_index_add(index, ELEMENTS_INDEX_INTERFACE, element))
+     {
+        _e_connman_elements_index_del(&elements_all, ELEMENTS_INDEX_ALL, element);
+        return EINA_FALSE;
+     }
+
+   return EINA_TRUE;
+}
+
+static void
+_e_connman_element_index_del(E_Connman_Element *element)
+{
+   E_Connman_Elements_Index *index;
+
+   _e_connman_elements_index_del(&elements_all, ELEMENTS_INDEX_ALL, element);
+   index = eina_hash_find(elements_by_interface, &element->interface);
+   if (index)
+      _e_connman_elements_index_del(index, ELEMENTS_INDEX_INTERFACE, element);
+}
+
+static Eina_Bool
+_e_connman_elements_index_copy(const E_Connman_Elements_Index *index, unsigned int *count, E_Connman_Element ***p_elements)
+{
+   *count = index ? index->count : 0;
+   if (*count == 0)
+     {
+        *p_elements = NULL;
+        return EINA_TRUE;
+     }
+
+   *p_elements = malloc(*count * sizeof(E_Connman_Element *));
+   if (!*p_elements)
+     {
+        ERR("could not allocate return array of %d elements: %s",
+            *count, strerror(errno));
+        *count = 0;
+        return EINA_FALSE;
+     }
+
+   memcpy(*p_elements, index->items, *count * sizeof(E_Connman_Element *));
+   return EINA_TRUE;
 }
 
 /**
- * Sync element properties with server.
+ * Get all known elements.
  *
- * Call method GetProperties() at the given element on server in order to sync
- * them.
+ * No reference is added to these elements, since there are no threads
+ * in the system, you are free to add references yourself right after
+ * the return of this call without race condition, elements by the
+ * system (ie: elementRemoved signal)could only be touched on the next
+ * main loop iteration.
  *
- * @param element to call method on server.
- * @param cb function to call when server replies or some error happens.
- * @param data data to give to cb when it is called.
+ * @param count return the number of elements in array.
+ * @param p_elements array with all elements, these are not referenced
+ *        and in no particular order, just set if return is @c EINA_TRUE.
  *
  * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
  */
 Eina_Bool
-e_connman_element_sync_properties_full(E_Connman_Element *element, E_DBus_Method_Return_Cb cb, const void *data)
+e_connman_elements_get_all(unsigned int *count, E_Connman_Element ***p_elements)
 {
-   const char name[] = "GetProperties";
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return e_connman_element_call_full
-             (element, name, _e_connman_element_get_properties_callback,
-             &element->_pending.properties_get, cb, data);
+   return _e_connman_elements_index_copy(&elements_all, count, p_elements);
 }
 
 /**
- * Sync element properties with server, simple version.
+ * Get all known elements of type.
  *
- * Call method GetProperties() at the given element on server in order to sync
- * them. This is the simple version and there is no check of server reply
- * for errors.
+ * No reference is added to these elements, since there are no threads
+ * in the system, you are free to add references yourself right after
+ * the return of this call without race condition, elements by the
+ * system (ie: ElementRemoved signal) could only be touched on the next
+ * main loop iteration.
  *
- * @param element to call method on server.
+ * @param type type to filter, or NULL to get all.
+ * @param count return the number of elements in array.
+ * @param p_elements array with all elements, these are not referenced
+ *        and in no particular order, just set if return is @c EINA_TRUE.
  *
  * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ *
+ * @see e_connman_elements_get_all()
  */
 Eina_Bool
-e_connman_element_properties_sync(E_Connman_Element *element)
+e_connman_elements_get_all_type(const char *type, unsigned int *count, E_Connman_Element ***p_elements)
 {
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return e_connman_element_sync_properties_full(element, NULL, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+
+   return _e_connman_elements_index_copy
+             (_e_connman_elements_index_find(type), count, p_elements);
 }
 
 /**
- * Call method SetProperty(prop, {key: value}) at the given element on server.
- *
- * This is a server call, not local, so it may fail and in that case
- * no property is updated locally. If the value was set the event
- * E_CONNMAN_EVENT_ELEMENT_UPDATED will be added to main loop.
+ * Start iterating over the known elements of an interface.
  *
- * @param element to call method on server.
- * @param prop property name.
- * @param key dict key name.
- * @param type DBus type to use for value.
- * @param value pointer to value, just like regular DBus, see
- *        dbus_message_iter_append_basic().
- * @param cb function to call when server replies or some error happens.
- * @param data data to give to cb when it is called.
+ * Nothing is allocated and no reference is added to the elements, the
+ * iterator just borrows the library's own list.  If elements are added or
+ * removed before the iteration is over, e_connman_elements_iter_next() stops
+ * and returns NULL.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * @param iter the iterator to start, usually on the stack.
+ * @param interface interface to filter, or NULL to get all.
  */
-Eina_Bool
-e_connman_element_property_dict_set_full(E_Connman_Element *element, const char *prop, const char *key, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+void
+e_connman_elements_iter_init(E_Connman_Elements_Iter *iter, const char *interface)
 {
-   const char name[] = "SetProperty";
-   DBusMessage *msg;
-   DBusMessageIter itr, variant, dict, entry;
-   char typestr[32];
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
-
-   msg = dbus_message_new_method_call
-         (e_connman_system_bus_name_get(), element->path, element->interface, name);
-
-   if (!msg)
-      return EINA_FALSE;
+   E_Connman_Elements_Index *index;
 
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
-
-   if ((size_t)snprintf(typestr, sizeof(typestr),
-                        (DBUS_TYPE_ARRAY_AS_STRING
-                         DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
-                         DBUS_TYPE_STRING_AS_STRING
-                         "%c"
-                         DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
-                        type) >= sizeof(typestr))
-     {
-        ERR("sizeof(typestr) is too small!");
-        return EINA_FALSE;
-     }
+   EINA_SAFETY_ON_NULL_RETURN(iter);
 
-   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &variant))
-     {
-        snprintf(typestr, sizeof(typestr),
-                 (DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
-                     DBUS_TYPE_STRING_AS_STRING
-                     "%c"
-                     DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
-                 type);
-        if (dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, typestr, &dict))
-          {
-             if (dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry))
-               {
-                  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+   memset(iter, 0, sizeof(*iter));
+   iter->_generation = elements_generation;
 
-                  if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
-                    dbus_message_iter_append_basic(&entry, type, &value);
-                  else
-                    dbus_message_iter_append_basic(&entry, type, value);
-                  
-                  dbus_message_iter_close_container(&dict, &entry);
-               }
-             else
-               {
-                  ERR("dbus_message_iter_open_container() failed");
-               }
-             dbus_message_iter_close_container(&variant, &dict);
-          }
-        else
-          {
-             ERR("dbus_message_iter_open_container() failed");
-          }
-        dbus_message_iter_close_container(&itr, &variant);
-     }
-   else
-     {
-        ERR("dbus_message_iter_open_container() failed");
-     }
+   index = _e_connman_elements_index_find(interface);
+   if (!index)
+      return;
 
-   return e_connman_element_message_send
-             (element, name, NULL, msg, &element->_pending.property_set, cb, data);
+   iter->_items = (void * const *)index->items;
+   iter->_count = index->count;
 }
 
 /**
- * Call method SetProperty(prop, value) at the given element on server.
+ * Start iterating over the elements listed in an object path array.
  *
- * This is a server call, not local, so it may fail and in that case
- * no property is updated locally. If the value was set the event
- * E_CONNMAN_EVENT_ELEMENT_UPDATED will be added to main loop.
+ * Like e_connman_elements_iter_init(), this borrows the property itself and
+ * stops when it is replaced.  Paths without an element are skipped.
  *
- * @param element to call method on server.
- * @param prop property name.
- * @param type DBus type to use for value.
- * @param value pointer to value, just like regular DBus, see
- *        dbus_message_iter_append_basic().
- * @param cb function to call when server replies or some error happens.
- * @param data data to give to cb when it is called.
+ * @param iter the iterator to start, usually on the stack.
+ * @param element the element with the property.
+ * @param property name of an array of object paths, like "Services".
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the property is not an
+ *         array of object paths.
  */
 Eina_Bool
-e_connman_element_property_set_full(E_Connman_Element *element, const char *prop, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+e_connman_element_objects_iter_init(E_Connman_Elements_Iter *iter, const E_Connman_Element *element, const char *property)
 {
-   const char name[] = "SetProperty";
-   char typestr[2];
-   DBusMessage *msg;
+   E_Connman_Array *array;
+   int type;
 
+   EINA_SAFETY_ON_NULL_RETURN_VAL(iter, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
 
-   msg = dbus_message_new_method_call
-         (e_connman_system_bus_name_get(), element->path, element->interface, name);
+   memset(iter, 0, sizeof(*iter));
+   iter->_generation = elements_generation;
+   iter->_paths = EINA_TRUE;
 
-   if (!msg)
+   if (!e_connman_element_property_get(element, property, &type, &array))
       return EINA_FALSE;
 
-   DBusMessageIter itr, v;
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s is not an array!", property);
+        return EINA_FALSE;
+     }
 
-   typestr[0] = type;
-   typestr[1] = '\0';
-   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &v))
+   /* empty arrays are kept as NULL */
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_TRUE;
+
+   if (array->type != DBUS_TYPE_OBJECT_PATH)
      {
-        if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
-          {
-             dbus_message_iter_append_basic(&v, type, &value);
-          }
-        else if (type == DBUS_TYPE_BOOLEAN)
-          {
-             unsigned int b = *(char *)value;
-             dbus_message_iter_append_basic(&v, type, &b);
-          }
-        else
-          {
-             dbus_message_iter_append_basic(&v, type, value);
-          }
-        
-        dbus_message_iter_close_container(&itr, &v);
+        ERR("property %s is not an array of object paths!", property);
+        return EINA_FALSE;
      }
-   else
+
+   iter->_items = (void * const *)array->array->data;
+   iter->_count = eina_array_count(array->array);
+   return EINA_TRUE;
+}
+
+/**
+ * Get the next element of an iteration.
+ *
+ * @param iter an iterator started by e_connman_elements_iter_init() or
+ *        e_connman_element_objects_iter_init().
+ *
+ * @return the next element, no reference is added, or NULL at the end or
+ *         if the elements changed meanwhile.
+ */
+E_Connman_Element *
+e_connman_elements_iter_next(E_Connman_Elements_Iter *iter)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(iter, NULL);
+
+   if (iter->_generation != elements_generation)
      {
-        ERR("dbus_message_iter_open_container() failed");
+        if (iter->_pos < iter->_count)
+           WRN("elements changed while iterating, stopping");
+        iter->_count = 0;
+        return NULL;
      }
 
-   return e_connman_element_message_send
-             (element, name, NULL, msg, &element->_pending.property_set, cb, data);
+   while (iter->_pos < iter->_count)
+     {
+        void *item = iter->_items[iter->_pos++];
+        E_Connman_Element *element;
+
+        if (!iter->_paths)
+           return item;
+
+        element = e_connman_element_get(item);
+        if (element)
+           return element;
+     }
+
+   return NULL;
 }
 
 /**
- * Call method SetProperty(prop, value) at the given element on server, when
- * value is an array.
- *
- * This is a server call, not local, so it may fail and in that case
- * no property is updated locally. If the value was set the event
- * E_CONNMAN_EVENT_ELEMENT_UPDATED will be added to main loop.
+ * Get the element registered at given path.
  *
- * @param element to call method on server.
- * @param prop property name.
- * @param type DBus type to use for value.
- * @param value pointer to value, just like regular DBus, see
- *        dbus_message_iter_append_basic().
- * @param cb function to call when server replies or some error happens.
- * @param data data to give to cb when it is called.
+ * @param path the path to query for registered object.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * @return element pointer if found, NULL otherwise. No references are added.
  */
-Eina_Bool
-e_connman_element_property_array_set_full(E_Connman_Element *element, const char *prop, int type, unsigned int count, const void * const *values, E_DBus_Method_Return_Cb cb, const void *data)
+E_Connman_Element *
+e_connman_element_get(const char *path)
 {
-   const char name[] = "SetProperty";
-   char type_sig[2] = { type, '\0'};
-   char array_sig[3] = { DBUS_TYPE_ARRAY, type, '\0' };
-   DBusMessage *msg;
-   DBusMessageIter itr, variant, array;
+   E_Connman_Element *element;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
+   element = eina_hash_find(elements, path);
 
-   msg = dbus_message_new_method_call
-         (e_connman_system_bus_name_get(), element->path, element->interface, name);
+   return element;
+}
 
-   if (!msg)
-      return EINA_FALSE;
+static void
+_e_connman_element_property_changed_callback(void *data __UNUSED__, DBusMessage *msg)
+{
+   E_Connman_Element *element;
+   DBusMessageIter itr, v_itr;
+   int t, r, changed = 0;
+   const char *name = NULL, *path, *interface;
+   void *value = NULL;
 
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+   path = dbus_message_get_path(msg);
+   interface = dbus_message_get_interface(msg);
+   if ((!path) || (!interface))
+      return;
 
-   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, array_sig, &variant))
+   element = eina_hash_find(elements, path);
+   if ((!element) || (strcmp(element->interface, interface) != 0))
+      return;
+
+   DBG("Property changed in element %s", element->path);
+
+   if (!_dbus_callback_check_and_init(msg, &itr, NULL))
+      return;
+
+   t = dbus_message_iter_get_arg_type(&itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
      {
-        if (dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, type_sig, &array))
-          {
-             if (type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH)
-               {
-                  unsigned int i;
-                  for (i = 0; i < count; i++)
-                    {
-                       const void *entry = values[i];
-                       dbus_message_iter_append_basic(&array, type, &entry);
-                    }
-               }
-             else
-               {
-                  unsigned int i;
-                  for (i = 0; i < count; i++)
-                    {
-                       const void *entry = values[i];
-                       dbus_message_iter_append_basic(&array, type, entry);
-                    }
-               }
-             
-             dbus_message_iter_close_container(&variant, &array);
-          }
-        else
-          {
-             ERR("dbus_message_iter_open_container() failed");
-          }
-        dbus_message_iter_close_container(&itr, &variant);
+        ERR("missing name in property changed signal");
+        return;
+     }
+
+   dbus_message_iter_get_basic(&itr, &name);
+
+   dbus_message_iter_next(&itr);
+   t = dbus_message_iter_get_arg_type(&itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+     {
+        ERR("missing value in property changed signal");
+        return;
+     }
+
+   dbus_message_iter_recurse(&itr, &v_itr);
+   t = dbus_message_iter_get_arg_type(&v_itr);
+
+   if (t == DBUS_TYPE_ARRAY)
+     {
+        value = _e_connman_element_iter_get_array(&v_itr, name);
+     }
+   else if (t != DBUS_TYPE_INVALID)
+     {
+        dbus_message_iter_get_basic(&v_itr, &value);
      }
    else
      {
-        ERR("dbus_message_iter_open_container() failed");
+        ERR("property has invalid type %s", name);
+        return;
      }
-   
-   return e_connman_element_message_send(element, name, NULL, msg,
-                                         &element->_pending.property_set,
-                                         cb, data);
+
+   r = _e_connman_element_property_value_add(element, name, t, value);
+   if (r < 0)
+     {
+        ERR("failed to add property value %s (%c)", name, t);
+     }
+   else if (r == 1)
+     {
+        INF("property value changed %s (%c)", name, t);
+        changed = 1;
+     }
+
+   if (changed)
+      _e_connman_element_listeners_call(element);
 }
 
 /**
- * Call method SetProperty(prop, value) at the given element on server.
+ * Register the given path, possible creating and element and return it.
  *
- * This is the simple version and there is no check of server reply
- * for errors.
+ * This will check if path is already registered, in that case the
+ * exiting element is returned. If it was not registered yet, a new
+ * element is created, registered and returned.
  *
- * @param element to call method on server.
- * @param prop property name.
- * @param type DBus type to use for value.
- * @param value pointer to value, just like regular DBus, see
- *        dbus_message_iter_append_basic().
+ * This call will not add extra references to the object.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * @param path the path to register the element
+ *
+ * @return the registered object, no references are added.
  */
-Eina_Bool
-e_connman_element_property_set(E_Connman_Element *element, const char *prop, int type, const void *value)
+E_Connman_Element *
+e_connman_element_register(const char *path, const char *interface)
 {
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
-   return e_connman_element_property_set_full
-             (element, prop, type, value, NULL, NULL);
-}
+   E_Connman_Element *element;
 
-Eina_Bool
-e_connman_element_call_with_path(E_Connman_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
-{
-   DBusMessageIter itr;
-   DBusMessage *msg;
+   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(interface, NULL);
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+   element = eina_hash_find(elements, path);
+   if (element)
+      return element;
 
-   msg = dbus_message_new_method_call
-         (e_connman_system_bus_name_get(), element->path, element->interface,
-         method_name);
+   element = e_connman_element_new(path, interface);
+   if (!element)
+      return NULL;
 
-   if (!msg)
-      return EINA_FALSE;
+   if (!_e_connman_element_index_add(element))
+     {
+        e_connman_element_free(element);
+        return NULL;
+     }
 
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_OBJECT_PATH, &string);
+   if (!eina_hash_add(elements, element->path, element))
+     {
+        _e_connman_element_index_del(element);
+        ERR("could not add element %s to hash, delete it.", path);
+        e_connman_element_free(element);
+        return NULL;
+     }
 
-   return e_connman_element_message_send
-             (element, method_name, cb, msg, pending, user_cb, user_data);
-}
+   if (!property_changed_handler)
+      property_changed_handler =
+         e_dbus_signal_handler_add
+            (e_connman_conn, e_connman_system_bus_name_get(),
+            NULL, NULL, "PropertyChanged",
+            _e_connman_element_property_changed_callback, NULL);
 
-Eina_Bool
-e_connman_element_call_with_string(E_Connman_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
-{
-   DBusMessageIter itr;
-   DBusMessage *msg;
+   e_connman_element_event_add(E_CONNMAN_EVENT_ELEMENT_ADD, element);
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+   return element;
+}
 
-   msg = dbus_message_new_method_call
-         (e_connman_system_bus_name_get(), element->path, element->interface,
-         method_name);
+static void
+_e_connman_element_event_unregister_and_free(void *data __UNUSED__, void *ev)
+{
+   E_Connman_Element *element = ev;
+   e_connman_element_unref(element);
+}
 
-   if (!msg)
-      return EINA_FALSE;
+static void
+_e_connman_element_unregister_internal(E_Connman_Element *element)
+{
+   _e_connman_element_index_del(element);
+   ecore_event_add(E_CONNMAN_EVENT_ELEMENT_DEL, element,
+                   _e_connman_element_event_unregister_and_free, NULL);
+}
 
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &string);
+/**
+ * Forget about the given element.
+ *
+ * This will remove the element from the pool of known objects, then
+ * add an E_CONNMAN_EVENT_ELEMENT_DEL and after that will unreference it,
+ * possible freeing it.
+ *
+ * @param element element to forget about. Its reference will be removed.
+ */
+void
+e_connman_element_unregister(E_Connman_Element *element)
+{
+   if (!element)
+      return;
 
-   return e_connman_element_message_send
-             (element, method_name, cb, msg, pending, user_cb, user_data);
+   if (elements)
+      eina_hash_del_by_key(elements, element->path);
 }
 
 /**
- * Get property type.
- *
- * If @c EINA_FALSE is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
+ * Remove all known elements.
  *
- * @param element which element to get the property
- * @param name property name, must be previously stringshared
- * @param type will contain the value type.
+ * This will remove all known elements but will NOT add any
+ * E_CONNMAN_EVENT_ELEMENT_DEL to main loop.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * This is just useful to make sure next e_connman_manager_sync_elements()
+ * will not leave any stale elements. This is unlikely to happen, as
+ * E_Connman is supposed to catch all required events to avoid stale elements.
  */
-Eina_Bool
-e_connman_element_property_type_get_stringshared(const E_Connman_Element *element, const char *name, int *type)
+void
+e_connman_manager_clear_elements(void)
 {
-   const E_Connman_Element_Property *p;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(type, EINA_FALSE);
-
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      if (p->name == name)
-        {
-           *type = p->type;
-           return EINA_TRUE;
-        }
-   }
-
-   WRN("element %s (%p) has no property with name \"%s\".",
-       element->path, element, name);
-   return EINA_FALSE;
+   e_connman_elements_shutdown();
+   e_connman_elements_init();
 }
 
 /**
- * Get property type.
- *
- * If @c EINA_FALSE is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
- *
- * @param element which element to get the property
- * @param name property name
- * @param type will contain the value type.
+ * Creates elements hash.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * This has no init counter since its already guarded by other code.
+ * @internal
  */
-Eina_Bool
-e_connman_element_property_type_get(const E_Connman_Element *element, const char *name, int *type)
+void
+e_connman_elements_init(void)
 {
-   Eina_Bool ret;
-   name = eina_stringshare_add(name);
-   ret = e_connman_element_property_type_get_stringshared(element, name, type);
-   eina_stringshare_del(name);
-   return ret;
+   EINA_SAFETY_ON_FALSE_RETURN(!elements);
+   elements =
+      eina_hash_string_superfast_new(EINA_FREE_CB
+                                        (_e_connman_element_unregister_internal));
+   elements_by_interface =
+      eina_hash_pointer_new(_e_connman_elements_index_free);
 }
 
 void
-e_connman_element_list_properties(const E_Connman_Element *element, Eina_Bool (*cb)(void *data, const E_Connman_Element *element, const char *name, int type, const void *value), const void *data)
+e_connman_elements_shutdown(void)
 {
-   const E_Connman_Element_Property *p;
-
-   EINA_SAFETY_ON_NULL_RETURN(element);
-   EINA_SAFETY_ON_NULL_RETURN(cb);
-
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      const void *value = NULL;
+   EINA_SAFETY_ON_FALSE_RETURN(!!elements);
+   if (changed_flush)
+     {
+        ecore_idle_enterer_del(changed_flush);
+        changed_flush = NULL;
+     }
+   if (changed_elements)
+     {
+        E_Connman_Element *element;
+        Eina_Array_Iterator iterator;
+        unsigned int i;
 
-      switch (p->type)
+        EINA_ARRAY_ITER_NEXT(changed_elements, i, element, iterator)
         {
-         case DBUS_TYPE_STRING:
-            value = &p->value.str;
-            break;
+           E_Connman_Element_Changes changes;
 
-         case DBUS_TYPE_OBJECT_PATH:
-            value = &p->value.path;
-            break;
+           element->_dirty = EINA_FALSE;
+           _e_connman_element_changes_take(element, &changes);
+           _e_connman_element_changes_free(&changes);
+           e_connman_element_unref(element);
+        }
+        eina_array_free(changed_elements);
+        changed_elements = NULL;
+     }
+   _e_connman_elements_sync_clear();
+   if (property_changed_handler)
+     {
+        e_dbus_signal_handler_del(e_connman_conn, property_changed_handler);
+        property_changed_handler = NULL;
+     }
+   eina_hash_free(elements);
+   elements = NULL;
+   eina_hash_free(elements_by_interface);
+   elements_by_interface = NULL;
+   free(elements_all.items);
+   memset(&elements_all, 0, sizeof(elements_all));
+   elements_generation++;
+   /* the calls in flight were canceled with their elements, their
+    * completions still come and must not count against the next sync */
+   sync_in_flight = 0;
+   sync_generation++;
+}
 
-         case DBUS_TYPE_BOOLEAN:
-            value = (void *)&p->value.boolean;
-            break;
+static inline Eina_Bool
+_e_connman_element_is(const E_Connman_Element *element, const char *interface)
+{
+   return element->interface == interface;
+}
 
-         case DBUS_TYPE_UINT16:
-            value = &p->value.u16;
-            break;
+Eina_Bool
+e_connman_element_is_manager(const E_Connman_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return _e_connman_element_is(element, e_connman_iface_manager);
+}
 
-         case DBUS_TYPE_UINT32:
-            value = &p->value.u32;
-            break;
+Eina_Bool
+e_connman_element_is_profile(const E_Connman_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return _e_connman_element_is(element, e_connman_iface_profile);
+}
 
-         default:
-            ERR("unsupported type %c", p->type);
-        }
+Eina_Bool
+e_connman_element_is_service(const E_Connman_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return _e_connman_element_is(element, e_connman_iface_service);
+}
 
-      if (!cb((void *)data, element, p->name, p->type, value))
-         return;
-   }
+Eina_Bool
+e_connman_element_is_technology(const E_Connman_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return _e_connman_element_is(element, e_connman_iface_technology);
 }
 
-/**
- * Get dict value given its key inside a dict property.
- *
- * This will look into properties for one of type dict that contains
- * the given key, to find the property.  If no property is found then
- * @c EINA_FALSE is returned.
- *
- * If @c EINA_FALSE is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
+/***********************************************************************
+* Snapshot
+***********************************************************************/
+
+/* A snapshot is the elements hash written to a file, so the next start
+ * shows the last known state before the server answers.  It is a cache
+ * in native byte order: the header, then all the strings NUL terminated
+ * and padded to 4 bytes as a whole, then 32 bit words:
  *
- * @param element which element to get the property
- * @param dict_name property name, must be previously stringshared
- * @param key key inside dict, must be previously stringshared
- * @param type if provided it will contain the value type.
- * @param value where to store the property value, must be a pointer to the
- *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
+ *   element:  path interface n_props prop...
+ *   prop:     name type value
+ *   value:    the integer types as is, strings and paths as the offset
+ *             of the string, arrays as type count item...
+ *   item:     a value, or name type value for dict entries
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * Each string is stored once, so the file is small and read in place
+ * through mmap().
  */
-Eina_Bool
-e_connman_element_property_dict_get_stringshared(const E_Connman_Element *element, const char *dict_name, const char *key, int *type, void *value)
-{
-   const E_Connman_Element_Property *p;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(dict_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(key, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+#define SNAPSHOT_MAGIC "EDBSNAP1"
 
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      E_Connman_Element_Dict_Entry *entry;
-      E_Connman_Array *array;
+typedef struct _E_Connman_Snapshot_Header E_Connman_Snapshot_Header;
+typedef struct _E_Connman_Snapshot_Writer E_Connman_Snapshot_Writer;
+typedef struct _E_Connman_Snapshot_Reader E_Connman_Snapshot_Reader;
 
-      if (p->name != dict_name)
-         continue;
+struct _E_Connman_Snapshot_Header
+{
+   char     magic[8];
+   char     system[8];
+   uint32_t strings_size;
+   uint32_t n_elements;
+   uint32_t n_words;
+   uint32_t reserved;
+};
 
-      if (p->type != DBUS_TYPE_ARRAY)
-        {
-           WRN("element %s (%p) has property \"%s\" is not an array: %c (%d)",
-               element->path, element, dict_name, p->type, p->type);
-           return EINA_FALSE;
-        }
+struct _E_Connman_Snapshot_Writer
+{
+   Eina_Hash *offsets; /* stringshare -> offset + 1 */
+   char      *strings;
+   uint32_t   strings_size;
+   uint32_t   strings_alloc;
+   uint32_t  *words;
+   uint32_t   n_words;
+   uint32_t   words_alloc;
+   uint32_t   n_elements;
+   Eina_Bool  failed;
+};
 
-      array = p->value.array;
-      if ((!array) || (array->type != DBUS_TYPE_DICT_ENTRY))
-        {
-           int t = array ? array->type : DBUS_TYPE_INVALID;
-           WRN("element %s (%p) has property \"%s\" is not a dict: %c (%d)",
-               element->path, element, dict_name, t, t);
-           return EINA_FALSE;
-        }
+struct _E_Connman_Snapshot_Reader
+{
+   const char     *strings;
+   uint32_t        strings_size;
+   const uint32_t *words;
+   uint32_t        n_words;
+   uint32_t        pos;
+   Eina_Bool       failed;
+};
 
-      entry = _e_connman_element_array_dict_find_stringshared(array, key);
-      if (!entry)
-        {
-           WRN("element %s (%p) has no dict property with name \"%s\" with "
-               "key \"%s\".",
-               element->path, element, dict_name, key);
-           return EINA_FALSE;
-        }
+static void
+_e_connman_snapshot_word_add(E_Connman_Snapshot_Writer *w, uint32_t word)
+{
+   if (w->n_words == w->words_alloc)
+     {
+        uint32_t size = w->words_alloc ? w->words_alloc * 2 : 1024;
+        uint32_t *tmp;
 
-      if (type)
-         *type = entry->type;
+        tmp = realloc(w->words, size * sizeof(uint32_t));
+        if (!tmp)
+          {
+             w->failed = EINA_TRUE;
+             return;
+          }
+        w->words = tmp;
+        w->words_alloc = size;
+     }
 
-      switch (entry->type)
-        {
-         case DBUS_TYPE_BOOLEAN:
-            *(Eina_Bool *)value = entry->value.boolean;
-            return EINA_TRUE;
+   w->words[w->n_words++] = word;
+}
 
-         case DBUS_TYPE_BYTE:
-            *(unsigned char *)value = entry->value.byte;
-            return EINA_TRUE;
+/* s is a stringshare, so the same string is found by its pointer */
+static void
+_e_connman_snapshot_string_add(E_Connman_Snapshot_Writer *w, const char *s)
+{
+   uintptr_t offset;
 
-         case DBUS_TYPE_UINT16:
-            *(unsigned short *)value = entry->value.u16;
-            return EINA_TRUE;
+   if (!s)
+      s = "";
 
-         case DBUS_TYPE_UINT32:
-            *(unsigned int *)value = entry->value.u32;
-            return EINA_TRUE;
+   offset = (uintptr_t)eina_hash_find(w->offsets, &s);
+   if (!offset)
+     {
+        uint32_t len = strlen(s) + 1;
 
-         case DBUS_TYPE_STRING:
-            *(const char **)value = entry->value.str;
-            return EINA_TRUE;
+        if (w->strings_size + len > w->strings_alloc)
+          {
+             uint32_t size = w->strings_alloc ? w->strings_alloc * 2 : 4096;
+             char *tmp;
 
-         case DBUS_TYPE_OBJECT_PATH:
-            *(const char **)value = entry->value.path;
-            return EINA_TRUE;
+             while (size < w->strings_size + len)
+                size *= 2;
 
-         case DBUS_TYPE_ARRAY:
-            *(E_Connman_Array **)value = entry->value.array;
-            return EINA_TRUE;
+             tmp = realloc(w->strings, size);
+             if (!tmp)
+               {
+                  w->failed = EINA_TRUE;
+                  return;
+               }
+             w->strings = tmp;
+             w->strings_alloc = size;
+          }
 
-         default:
-            ERR("don't know how to get property %s, key %s type %c (%d)",
-                dict_name, key, entry->type, entry->type);
-            return EINA_FALSE;
-        }
-   }
+        memcpy(w->strings + w->strings_size, s, len);
+        offset = w->strings_size + 1;
+        w->strings_size += len;
+        if (!eina_hash_add(w->offsets, &s, (void *)offset))
+           w->failed = EINA_TRUE;
+     }
 
-   DBG("element %s (%p) has no property with name \"%s\".",
-       element->path, element, dict_name);
-   return EINA_FALSE;
+   _e_connman_snapshot_word_add(w, offset - 1);
 }
 
-Eina_Bool
-e_connman_element_property_dict_strings_array_get_stringshared(const E_Connman_Element *element, const char *dict_name, const char *key, unsigned int *count, const char ***strings)
+static void
+_e_connman_snapshot_dict_entry_add(E_Connman_Snapshot_Writer *w, const E_Connman_Element_Dict_Entry *entry)
 {
-   const char **ret, **p;
-   Eina_Array_Iterator iterator;
-   E_Connman_Array *array;
-   unsigned int i;
-   int type;
-   void *item;
+   _e_connman_snapshot_string_add(w, entry->name);
+   _e_connman_snapshot_word_add(w, entry->type);
+   switch (entry->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         _e_connman_snapshot_word_add(w, entry->value.boolean);
+         break;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(dict_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(key, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(strings, EINA_FALSE);
+      case DBUS_TYPE_BYTE:
+         _e_connman_snapshot_word_add(w, entry->value.byte);
+         break;
 
-   *count = 0;
-   *strings = NULL;
+      case DBUS_TYPE_UINT16:
+         _e_connman_snapshot_word_add(w, entry->value.u16);
+         break;
 
-   if (!e_connman_element_property_dict_get_stringshared(element, dict_name,
-                                                         key, &type, &array))
-      return EINA_FALSE;
+      case DBUS_TYPE_UINT32:
+         _e_connman_snapshot_word_add(w, entry->value.u32);
+         break;
 
-   if (type != DBUS_TYPE_ARRAY)
-     {
-        ERR("property %s.%s is not an array!", dict_name, key);
-        return EINA_FALSE;
-     }
+      case DBUS_TYPE_STRING:
+         _e_connman_snapshot_string_add(w, entry->value.str);
+         break;
 
-   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
-      return EINA_FALSE;
+      case DBUS_TYPE_OBJECT_PATH:
+         _e_connman_snapshot_string_add(w, entry->value.path);
+         break;
 
-   if (array->type != DBUS_TYPE_STRING)
-     {
-        ERR("property %s.%s is not an array of strings!", dict_name, key);
-        return EINA_FALSE;
+      default:
+         ERR("don't know how to save dict entry '%s' of type %c (%d)",
+             entry->name, entry->type, entry->type);
+         w->failed = EINA_TRUE;
      }
+}
 
-   *count = eina_array_count(array->array);
-   ret = malloc(*count * sizeof(char *));
-   if (!ret)
+static void
+_e_connman_snapshot_array_add(E_Connman_Snapshot_Writer *w, const E_Connman_Array *array)
+{
+   Eina_Array_Iterator iterator;
+   unsigned int i;
+   void *item;
+
+   /* empty arrays are kept as NULL */
+   if (!array)
      {
-        ERR("could not allocate return array of %d strings: %s",
-            *count, strerror(errno));
-        *count = 0;
-        return EINA_FALSE;
+        _e_connman_snapshot_word_add(w, DBUS_TYPE_INVALID);
+        _e_connman_snapshot_word_add(w, 0);
+        return;
      }
 
-   p = ret;
-
+   _e_connman_snapshot_word_add(w, array->type);
+   _e_connman_snapshot_word_add(w, eina_array_count(array->array));
    EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-     {
-        if (!item)
-           continue;
+   {
+      switch (array->type)
+        {
+         case DBUS_TYPE_STRING:
+         case DBUS_TYPE_OBJECT_PATH:
+            _e_connman_snapshot_string_add(w, item);
+            break;
 
-        *p = item;
-        p++;
-     }
-   *count = p - ret;
-   *strings = ret;
-   return EINA_TRUE;
+         case DBUS_TYPE_DICT_ENTRY:
+            _e_connman_snapshot_dict_entry_add(w, item);
+            break;
+
+         default:
+            _e_connman_snapshot_word_add(w, (uint32_t)(uintptr_t)item);
+        }
+   }
 }
 
-/**
- * Get property value given its name.
- *
- * This will look into properties, to find the property.
- * If no property is found then @c EINA_FALSE is returned.
- *
- * If @c EINA_FALSE is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
- *
- * @param element which element to get the property
- * @param name property name, must be previously stringshared
- * @param type if provided it will contain the value type.
- * @param value where to store the property value, must be a pointer to the
- *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_connman_element_property_get_stringshared(const E_Connman_Element *element, const char *name, int *type, void *value)
+static void
+_e_connman_snapshot_element_add(E_Connman_Snapshot_Writer *w, const E_Connman_Element *element)
 {
    const E_Connman_Element_Property *p;
+   uint32_t n_props = 0, at;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+   _e_connman_snapshot_string_add(w, element->path);
+   _e_connman_snapshot_string_add(w, element->interface);
+   at = w->n_words;
+   _e_connman_snapshot_word_add(w, 0);
 
    EINA_INLIST_FOREACH(element->props, p)
    {
-      if (p->name != name)
-         continue;
+      switch (p->type)
+        {
+         case DBUS_TYPE_BOOLEAN:
+         case DBUS_TYPE_BYTE:
+         case DBUS_TYPE_UINT16:
+         case DBUS_TYPE_UINT32:
+         case DBUS_TYPE_STRING:
+         case DBUS_TYPE_OBJECT_PATH:
+         case DBUS_TYPE_ARRAY:
+            break;
 
-      if (type)
-         *type = p->type;
+         default:
+            continue;
+        }
 
+      _e_connman_snapshot_string_add(w, p->name);
+      _e_connman_snapshot_word_add(w, p->type);
       switch (p->type)
         {
          case DBUS_TYPE_BOOLEAN:
-            *(Eina_Bool *)value = p->value.boolean;
-            return EINA_TRUE;
+            _e_connman_snapshot_word_add(w, p->value.boolean);
+            break;
 
          case DBUS_TYPE_BYTE:
-            *(unsigned char *)value = p->value.byte;
-            return EINA_TRUE;
+            _e_connman_snapshot_word_add(w, p->value.byte);
+            break;
 
          case DBUS_TYPE_UINT16:
-            *(unsigned short *)value = p->value.u16;
-            return EINA_TRUE;
+            _e_connman_snapshot_word_add(w, p->value.u16);
+            break;
 
          case DBUS_TYPE_UINT32:
-            *(unsigned int *)value = p->value.u32;
-            return EINA_TRUE;
+            _e_connman_snapshot_word_add(w, p->value.u32);
+            break;
 
          case DBUS_TYPE_STRING:
-            *(const char **)value = p->value.str;
-            return EINA_TRUE;
+            _e_connman_snapshot_string_add(w, p->value.str);
+            break;
 
          case DBUS_TYPE_OBJECT_PATH:
-            *(const char **)value = p->value.path;
-            return EINA_TRUE;
+            _e_connman_snapshot_string_add(w, p->value.path);
+            break;
 
          case DBUS_TYPE_ARRAY:
-            *(E_Connman_Array **)value = p->value.array;
-            return EINA_TRUE;
-
-         default:
-            ERR("don't know how to get property type %c (%d)",
-                p->type, p->type);
-            return EINA_FALSE;
+            _e_connman_snapshot_array_add(w, p->value.array);
+            break;
         }
+      n_props++;
    }
 
-   WRN("element %s (%p) has no property with name \"%s\".",
-       element->path, element, name);
-   return EINA_FALSE;
+   if (!w->failed)
+      w->words[at] = n_props;
 }
 
-/**
- * Get property value given its name.
- *
- * This will look into properties, to find the property.
- * If no property is found then @c EINA_FALSE is returned.
- *
- * If @c EINA_FALSE is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
- *
- * @param element which element to get the property
- * @param name property name
- * @param type if provided it will contain the value type.
- * @param value where to store the property value, must be a pointer to the
- *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_connman_element_property_get(const E_Connman_Element *element, const char *name, int *type, void *value)
+static Eina_Bool
+_e_connman_snapshot_element_add_cb(const Eina_Hash *hash __UNUSED__, const void *key __UNUSED__, void *data, void *fdata)
 {
-   Eina_Bool ret;
-   name = eina_stringshare_add(name);
-   ret = e_connman_element_property_get_stringshared
-         (element, name, type, value);
-   eina_stringshare_del(name);
-   return ret;
-}
+   E_Connman_Snapshot_Writer *w = fdata;
 
-struct e_connman_elements_for_each_data
-{
-   Eina_Hash_Foreach cb;
-   void             *data;
-};
+   _e_connman_snapshot_element_add(w, data);
+   w->n_elements++;
+   return !w->failed;
+}
 
-static Eina_Bool
-_e_connman_elements_for_each(Eina_Hash *hash __UNUSED__, const char *key, void *data, void *fdata)
+static uint32_t
+_e_connman_snapshot_word_get(E_Connman_Snapshot_Reader *r)
 {
-   struct e_connman_elements_for_each_data *each_data = fdata;
+   if (r->pos >= r->n_words)
+     {
+        r->failed = EINA_TRUE;
+        return 0;
+     }
 
-   each_data->cb(elements, key, data, each_data->data);
-   return EINA_TRUE;
+   return r->words[r->pos++];
 }
 
-/**
- * Call the given function for each existing element.
- *
- * @param cb function to call for each element. It will get as parameters,
- *        in order: the element pointer and the given @a user_data.
- * @param user_data data to give to @a cb for each element.
- */
-void
-e_connman_elements_for_each(Eina_Hash_Foreach cb, const void *user_data)
+static const char *
+_e_connman_snapshot_string_get(E_Connman_Snapshot_Reader *r)
 {
-   struct e_connman_elements_for_each_data data = {cb, (void *)user_data};
+   uint32_t offset = _e_connman_snapshot_word_get(r);
 
-   EINA_SAFETY_ON_NULL_RETURN(cb);
+   if (offset >= r->strings_size)
+     {
+        r->failed = EINA_TRUE;
+        return "";
+     }
 
-   eina_hash_foreach(elements, (Eina_Hash_Foreach)_e_connman_elements_for_each,
-                     &data);
+   return r->strings + offset;
 }
 
-static Eina_Bool
-_e_connman_elements_get_allocate(unsigned int *count, E_Connman_Element ***p_elements)
+static E_Connman_Element_Dict_Entry *
+_e_connman_snapshot_dict_entry_get(E_Connman_Snapshot_Reader *r)
 {
-   *count = eina_hash_population(elements);
-   if (*count == 0)
+   E_Connman_Element_Dict_Entry *entry;
+   const char *name;
+   int type;
+
+   name = _e_connman_snapshot_string_get(r);
+   type = _e_connman_snapshot_word_get(r);
+   if (r->failed)
+      return NULL;
+
+   entry = calloc(1, sizeof(*entry));
+   if (!entry)
      {
-        *p_elements = NULL;
-        return EINA_TRUE;
+        ERR("could not allocate memory for dict entry.");
+        r->failed = EINA_TRUE;
+        return NULL;
      }
 
-   *p_elements = malloc(*count * sizeof(E_Connman_Element *));
-   if (!*p_elements)
+   switch (type)
      {
-        ERR("could not allocate return array of %d elements: %s",
-            *count, strerror(errno));
-        *count = 0;
-        return EINA_FALSE;
+      case DBUS_TYPE_BOOLEAN:
+         entry->value.boolean = !!_e_connman_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_BYTE:
+         entry->value.byte = _e_connman_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_UINT16:
+         entry->value.u16 = _e_connman_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_UINT32:
+         entry->value.u32 = _e_connman_snapshot_word_get(r);
+         break;
+
+      case DBUS_TYPE_STRING:
+         entry->value.str =
+            eina_stringshare_add(_e_connman_snapshot_string_get(r));
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         entry->value.path =
+            eina_stringshare_add(_e_connman_snapshot_string_get(r));
+         break;
+
+      default:
+         r->failed = EINA_TRUE;
+         free(entry);
+         return NULL;
      }
 
-   return EINA_TRUE;
+   entry->name = eina_stringshare_add(name);
+   entry->type = type;
+   return entry;
 }
 
-static Eina_Bool
-_e_connman_elements_get_all(Eina_Hash *hash __UNUSED__, const char *key __UNUSED__, void *data, void *fdata)
+static E_Connman_Array *
+_e_connman_snapshot_array_get(E_Connman_Snapshot_Reader *r)
 {
-   E_Connman_Element *element = data;
-   E_Connman_Element ***p_ret = fdata;
+   E_Connman_Array *array;
+   uint32_t count, i;
+   int type;
 
-   **p_ret = element;
-   (*p_ret)++;
-   return EINA_TRUE;
-}
+   type = _e_connman_snapshot_word_get(r);
+   count = _e_connman_snapshot_word_get(r);
+   if ((r->failed) || (type == DBUS_TYPE_INVALID))
+      return NULL;
 
-/**
- * Get all known elements.
- *
- * No reference is added to these elements, since there are no threads
- * in the system, you are free to add references yourself right after
- * the return of this call without race condition, elements by the
- * system (ie: elementRemoved signal)could only be touched on the next
- * main loop iteration.
- *
- * @param count return the number of elements in array.
- * @param p_elements array with all elements, these are not referenced
- *        and in no particular order, just set if return is @c EINA_TRUE.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_connman_elements_get_all(unsigned int *count, E_Connman_Element ***p_elements)
-{
-   E_Connman_Element **p;
+   if (count > r->n_words - r->pos)
+     {
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+   array = malloc(sizeof(E_Connman_Array));
+   if (!array)
+     {
+        ERR("could not create new e_connman array.");
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
+
+   array->type = type;
+   array->array = eina_array_new(16);
+   if (!(array->array))
+     {
+        ERR("could not create new eina array.");
+        free(array);
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
+
+   for (i = 0; (i < count) && (!r->failed); i++)
+     {
+        void *item;
+
+        switch (type)
+          {
+           case DBUS_TYPE_STRING:
+           case DBUS_TYPE_OBJECT_PATH:
+              item = (void *)eina_stringshare_add(_e_connman_snapshot_string_get(r));
+              break;
+
+           case DBUS_TYPE_DICT_ENTRY:
+              item = _e_connman_snapshot_dict_entry_get(r);
+              break;
+
+           case DBUS_TYPE_BOOLEAN:
+           case DBUS_TYPE_BYTE:
+           case DBUS_TYPE_UINT16:
+           case DBUS_TYPE_UINT32:
+              item = (void *)(long)_e_connman_snapshot_word_get(r);
+              break;
+
+           default:
+              r->failed = EINA_TRUE;
+              continue;
+          }
+
+        if (item)
+           eina_array_push(array->array, item);
+     }
 
-   if (!_e_connman_elements_get_allocate(count, p_elements))
-      return EINA_FALSE;
+   if (r->failed)
+     {
+        _e_connman_element_array_free(array, NULL);
+        return NULL;
+     }
 
-   p = *p_elements;
-   eina_hash_foreach(elements, (Eina_Hash_Foreach)_e_connman_elements_get_all,
-                     &p);
-   return EINA_TRUE;
+   return array;
 }
 
-struct e_connman_elements_get_all_str_data
+static void
+_e_connman_snapshot_element_get(E_Connman_Snapshot_Reader *r)
 {
-   E_Connman_Element **elements;
-   int                 count;
-   const char         *str;
-};
+   E_Connman_Element_Property *p;
+   E_Connman_Element *element;
+   const char *path, *interface;
+   uint32_t n_props, i;
+
+   path = _e_connman_snapshot_string_get(r);
+   interface = eina_stringshare_add(_e_connman_snapshot_string_get(r));
+   n_props = _e_connman_snapshot_word_get(r);
+   element = r->failed ? NULL : e_connman_element_register(path, interface);
+   eina_stringshare_del(interface);
+   if (!element)
+     {
+        r->failed = EINA_TRUE;
+        return;
+     }
 
-static Eina_Bool
-_e_connman_elements_get_all_type(Eina_Hash *hash __UNUSED__, const char *key __UNUSED__, void *e, void *user_data)
-{
-   struct e_connman_elements_get_all_str_data *data = user_data;
-   E_Connman_Element *element = e;
+   for (i = 0; (i < n_props) && (!r->failed); i++)
+     {
+        const char *name;
+        void *value;
+        int type;
 
-   if ((data->str) && (element->interface != data->str))
-      return EINA_TRUE;
+        name = _e_connman_snapshot_string_get(r);
+        type = _e_connman_snapshot_word_get(r);
+        switch (type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+           case DBUS_TYPE_BYTE:
+           case DBUS_TYPE_UINT16:
+           case DBUS_TYPE_UINT32:
+              value = (void *)(long)_e_connman_snapshot_word_get(r);
+              break;
 
-   data->elements[data->count] = element;
-   data->count++;
-   return EINA_TRUE;
-}
+           case DBUS_TYPE_STRING:
+           case DBUS_TYPE_OBJECT_PATH:
+              value = (void *)_e_connman_snapshot_string_get(r);
+              break;
 
-/**
- * Get all known elements of type.
- *
- * No reference is added to these elements, since there are no threads
- * in the system, you are free to add references yourself right after
- * the return of this call without race condition, elements by the
- * system (ie: ElementRemoved signal) could only be touched on the next
- * main loop iteration.
- *
- * @param type type to filter, or NULL to get all.
- * @param count return the number of elements in array.
- * @param p_elements array with all elements, these are not referenced
- *        and in no particular order, just set if return is @c EINA_TRUE.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- *
- * @see e_connman_elements_get_all()
- */
-Eina_Bool
-e_connman_elements_get_all_type(const char *type, unsigned int *count, E_Connman_Element ***p_elements)
-{
-   struct e_connman_elements_get_all_str_data data;
+           case DBUS_TYPE_ARRAY:
+              value = _e_connman_snapshot_array_get(r);
+              break;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+           default:
+              r->failed = EINA_TRUE;
+              continue;
+          }
 
-   if (!_e_connman_elements_get_allocate(count, p_elements))
-      return EINA_FALSE;
+        if (!r->failed)
+           _e_connman_element_property_value_add(element, name, type, value);
+     }
 
-   data.elements = *p_elements;
-   data.count = 0;
-   data.str = eina_stringshare_add(type);
-   eina_hash_foreach(elements,
-                     (Eina_Hash_Foreach)_e_connman_elements_get_all_type,
-                     &data);
+   element->_stale = EINA_TRUE;
+   EINA_INLIST_FOREACH(element->props, p)
+      p->stale = EINA_TRUE;
 
-   eina_stringshare_del(data.str);
-   *count = data.count;
-   return EINA_TRUE;
+   if (element->props)
+      _e_connman_element_listeners_call(element);
 }
 
 /**
- * Get the element registered at given path.
+ * Write all the elements and their properties to a snapshot file.
  *
- * @param path the path to query for registered object.
+ * Give it to e_connman_elements_snapshot_load() on the next start.  The file
+ * is replaced atomically.
  *
- * @return element pointer if found, NULL otherwise. No references are added.
+ * @param file where to write the snapshot.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
  */
-E_Connman_Element *
-e_connman_element_get(const char *path)
-{
-   E_Connman_Element *element;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
-   element = eina_hash_find(elements, path);
-
-   return element;
-}
-
-static void
-_e_connman_element_property_changed_callback(void *data, DBusMessage *msg)
+Eina_Bool
+e_connman_elements_snapshot_save(const char *file)
 {
-   E_Connman_Element *element = (E_Connman_Element *)data;
-   DBusMessageIter itr, v_itr;
-   int t, r, changed = 0;
-   const char *name = NULL;
-   void *value = NULL;
+   static const char pad[4] = { 0, 0, 0, 0 };
+   E_Connman_Snapshot_Header header;
+   E_Connman_Snapshot_Writer w;
+   Eina_Bool ret = EINA_FALSE;
+   uint32_t n_pad;
+   size_t len;
+   char *tmp;
+   FILE *fp;
+   int fd;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(elements, EINA_FALSE);
+
+   memset(&w, 0, sizeof(w));
+   w.offsets = eina_hash_pointer_new(NULL);
+   if (!w.offsets)
+      return EINA_FALSE;
 
-   DBG("Property changed in element %s", element->path);
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+   eina_strlcpy(header.system, "connman", sizeof(header.system));
 
-   if (!_dbus_callback_check_and_init(msg, &itr, NULL))
-      return;
+   eina_hash_foreach(elements, _e_connman_snapshot_element_add_cb, &w);
 
-   t = dbus_message_iter_get_arg_type(&itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+   if (w.failed)
      {
-        ERR("missing name in property changed signal");
-        return;
+        ERR("could not build the snapshot for %s", file);
+        goto end;
      }
 
-   dbus_message_iter_get_basic(&itr, &name);
+   n_pad = ((w.strings_size + 3) & ~3U) - w.strings_size;
+   header.strings_size = w.strings_size + n_pad;
+   header.n_elements = w.n_elements;
+   header.n_words = w.n_words;
 
-   dbus_message_iter_next(&itr);
-   t = dbus_message_iter_get_arg_type(&itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+   len = strlen(file) + sizeof(".XXXXXX");
+   tmp = alloca(len);
+   snprintf(tmp, len, "%s.XXXXXX", file);
+   fd = mkstemp(tmp);
+   if (fd < 0)
      {
-        ERR("missing value in property changed signal");
-        return;
+        ERR("could not create %s: %s", tmp, strerror(errno));
+        goto end;
      }
 
-   dbus_message_iter_recurse(&itr, &v_itr);
-   t = dbus_message_iter_get_arg_type(&v_itr);
-
-   if (t == DBUS_TYPE_ARRAY)
-     {
-        value = _e_connman_element_iter_get_array(&v_itr, name);
-     }
-   else if (t != DBUS_TYPE_INVALID)
-     {
-        dbus_message_iter_get_basic(&v_itr, &value);
-     }
-   else
+   fp = fdopen(fd, "wb");
+   if (!fp)
      {
-        ERR("property has invalid type %s", name);
-        return;
+        ERR("could not open %s: %s", tmp, strerror(errno));
+        close(fd);
+        unlink(tmp);
+        goto end;
      }
 
-   r = _e_connman_element_property_value_add(element, name, t, value);
-   if (r < 0)
+   if ((fwrite(&header, sizeof(header), 1, fp) != 1) ||
+       (fwrite(w.strings, 1, w.strings_size, fp) != w.strings_size) ||
+       (fwrite(pad, 1, n_pad, fp) != n_pad) ||
+       (fwrite(w.words, sizeof(uint32_t), w.n_words, fp) != w.n_words))
      {
-        ERR("failed to add property value %s (%c)", name, t);
+        ERR("could not write %s: %s", tmp, strerror(errno));
+        fclose(fp);
+        unlink(tmp);
+        goto end;
      }
-   else if (r == 1)
+
+   if ((fclose(fp) != 0) || (rename(tmp, file) < 0))
      {
-        INF("property value changed %s (%c)", name, t);
-        changed = 1;
+        ERR("could not save %s: %s", file, strerror(errno));
+        unlink(tmp);
+        goto end;
      }
 
-   if (changed)
-      _e_connman_element_listeners_call(element);
+   DBG("saved %u elements to %s", header.n_elements, file);
+   ret = EINA_TRUE;
+
+end:
+   eina_hash_free(w.offsets);
+   free(w.strings);
+   free(w.words);
+   return ret;
 }
 
 /**
- * Register the given path, possible creating and element and return it.
- *
- * This will check if path is already registered, in that case the
- * exiting element is returned. If it was not registered yet, a new
- * element is created, registered and returned.
+ * Add the elements saved by e_connman_elements_snapshot_save().
  *
- * This call will not add extra references to the object.
+ * Call it right after e_connman_system_init(), before the manager comes in.
+ * The elements are added at once with their last known properties and
+ * are stale, see e_connman_element_is_stale(), until their GetProperties()
+ * reply arrives.  Listeners then only hear about the properties that
+ * differ, and those the server did not send are removed.  Elements gone
+ * meanwhile are removed when the lists holding them are synced.
  *
- * @param path the path to register the element
+ * @param file the snapshot to load.
  *
- * @return the registered object, no references are added.
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the file is missing or
+ *         invalid, or if there are elements already.
  */
-E_Connman_Element *
-e_connman_element_register(const char *path, const char *interface)
+Eina_Bool
+e_connman_elements_snapshot_load(const char *file)
 {
-   E_Connman_Element *element;
+   const E_Connman_Snapshot_Header *header;
+   E_Connman_Snapshot_Reader r;
+   uint32_t n_elements, i;
+   struct stat st;
+   void *map;
+   int fd;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(interface, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(elements, EINA_FALSE);
 
-   element = eina_hash_find(elements, path);
-   if (element)
-      return element;
+   if (eina_hash_population(elements) > 0)
+     {
+        ERR("elements already known, not loading snapshot %s", file);
+        return EINA_FALSE;
+     }
 
-   element = e_connman_element_new(path, interface);
-   if (!element)
-      return NULL;
+   fd = open(file, O_RDONLY);
+   if (fd < 0)
+     {
+        DBG("no snapshot %s: %s", file, strerror(errno));
+        return EINA_FALSE;
+     }
 
-   if (!eina_hash_add(elements, element->path, element))
+   if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(*header)))
      {
-        ERR("could not add element %s to hash, delete it.", path);
-        e_connman_element_free(element);
-        return NULL;
+        ERR("invalid snapshot %s", file);
+        close(fd);
+        return EINA_FALSE;
      }
 
-   element->signal_handler =
-      e_dbus_signal_handler_add
-         (e_connman_conn, e_connman_system_bus_name_get(),
-         element->path, element->interface, "PropertyChanged",
-         _e_connman_element_property_changed_callback, element);
+   map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED)
+     {
+        ERR("could not map %s: %s", file, strerror(errno));
+        return EINA_FALSE;
+     }
 
-   e_connman_element_event_add(E_CONNMAN_EVENT_ELEMENT_ADD, element);
+   header = map;
+   if ((memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) ||
+       (strncmp(header->system, "connman", sizeof(header->system)) != 0) ||
+       (header->strings_size % 4) ||
+       /* only subtract and divide, the sizes in the file could overflow */
+       (header->strings_size > (size_t)st.st_size - sizeof(*header)) ||
+       (((size_t)st.st_size - sizeof(*header)) % sizeof(uint32_t)) ||
+       (header->n_words != ((size_t)st.st_size - sizeof(*header) -
+                            header->strings_size) / sizeof(uint32_t)))
+     {
+        ERR("invalid snapshot %s", file);
+        munmap(map, st.st_size);
+        return EINA_FALSE;
+     }
 
-   return element;
-}
+   memset(&r, 0, sizeof(r));
+   r.strings = (const char *)(header + 1);
+   r.strings_size = header->strings_size;
+   r.words = (const uint32_t *)(r.strings + r.strings_size);
+   r.n_words = header->n_words;
+   n_elements = header->n_elements;
 
-static void
-_e_connman_element_event_unregister_and_free(void *data __UNUSED__, void *ev)
-{
-   E_Connman_Element *element = ev;
-   e_connman_element_unref(element);
-}
+   /* the last string is terminated, so all of them are */
+   if ((r.strings_size) && (r.strings[r.strings_size - 1] != '\0'))
+      r.failed = EINA_TRUE;
 
-static void
-_e_connman_element_unregister_internal(E_Connman_Element *element)
-{
-   if (element->signal_handler)
-     {
-        e_dbus_signal_handler_del(e_connman_conn, element->signal_handler);
-        element->signal_handler = NULL;
-     }
+   for (i = 0; (i < n_elements) && (!r.failed); i++)
+      _e_connman_snapshot_element_get(&r);
 
-   ecore_event_add(E_CONNMAN_EVENT_ELEMENT_DEL, element,
-                   _e_connman_element_event_unregister_and_free, NULL);
-}
+   munmap(map, st.st_size);
 
-/**
- * Forget about the given element.
- *
- * This will remove the element from the pool of known objects, then
- * add an E_CONNMAN_EVENT_ELEMENT_DEL and after that will unreference it,
- * possible freeing it.
- *
- * @param element element to forget about. Its reference will be removed.
- */
-void
-e_connman_element_unregister(E_Connman_Element *element)
-{
-   if (!element)
-      return;
+   if (r.failed)
+     {
+        ERR("snapshot %s is corrupt, dropping it", file);
+        e_connman_manager_clear_elements();
+        return EINA_FALSE;
+     }
 
-   if (elements)
-      eina_hash_del_by_key(elements, element->path);
+   DBG("loaded %u elements from %s", n_elements, file);
+   return EINA_TRUE;
 }
 
 /**
- * Remove all known elements.
- *
- * This will remove all known elements but will NOT add any
- * E_CONNMAN_EVENT_ELEMENT_DEL to main loop.
+ * Tell if the element still has the properties of a snapshot.
  *
- * This is just useful to make sure next e_connman_manager_sync_elements()
- * will not leave any stale elements. This is unlikely to happen, as
- * E_Connman is supposed to catch all required events to avoid stale elements.
- */
-void
-e_connman_manager_clear_elements(void)
-{
-   e_connman_elements_shutdown();
-   e_connman_elements_init();
-}
-
-/**
- * Creates elements hash.
+ * @param element which element to query.
  *
- * This has no init counter since its already guarded by other code.
- * @internal
+ * @return @c EINA_TRUE until the server answered for the element.
  */
-void
-e_connman_elements_init(void)
-{
-   EINA_SAFETY_ON_FALSE_RETURN(!elements);
-   elements =
-      eina_hash_string_superfast_new(EINA_FREE_CB
-                                        (_e_connman_element_unregister_internal));
-}
-
-void
-e_connman_elements_shutdown(void)
-{
-   EINA_SAFETY_ON_FALSE_RETURN(!!elements);
-   eina_hash_free(elements);
-   elements = NULL;
-}
-
-static inline Eina_Bool
-_e_connman_element_is(const E_Connman_Element *element, const char *interface)
-{
-   return element->interface == interface;
-}
-
-Eina_Bool
-e_connman_element_is_manager(const E_Connman_Element *element)
-{
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return _e_connman_element_is(element, e_connman_iface_manager);
-}
-
-Eina_Bool
-e_connman_element_is_profile(const E_Connman_Element *element)
-{
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return _e_connman_element_is(element, e_connman_iface_profile);
-}
-
-Eina_Bool
-e_connman_element_is_service(const E_Connman_Element *element)
-{
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return _e_connman_element_is(element, e_connman_iface_service);
-}
-
 Eina_Bool
-e_connman_element_is_technology(const E_Connman_Element *element)
+e_connman_element_is_stale(const E_Connman_Element *element)
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return _e_connman_element_is(element, e_connman_iface_technology);
+   return element->_stale;
 }
-
@@ -246,6 +246,32 @@ e_connman_manager_services_get(unsigned int *count, E_Connman_Element ***p_eleme
              (element, e_connman_prop_services, count, p_elements);
 }
 
+/**
+ * Iterate over the service elements without allocating.
+ *
+ * Services are listed in the order of the manager's Services property.
+ * Get them with e_connman_elements_iter_next(), the iteration stops early
+ * if the services change meanwhile.
+ *
+ * @param iter the iterator to start, usually on the stack.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_connman_manager_services_iter_init(E_Connman_Elements_Iter *iter)
+{
+   E_Connman_Element *element;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(iter, EINA_FALSE);
+
+   element = e_connman_manager_get();
+   if (!element)
+      return EINA_FALSE;
+
+   return e_connman_element_objects_iter_init
+             (iter, element, e_connman_prop_services);
+}
+
 /**
  * Get array of technology elements.
  *
@@ -1,3 +1,6 @@
+#ifndef E_CONNMAN_PRIVATE_H
+#define E_CONNMAN_PRIVATE_H
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -159,6 +162,8 @@ void                   e_connman_manager_clear_elements(void);
 
 void                   e_connman_elements_init(void);
 void                   e_connman_elements_shutdown(void);
+void                   e_connman_elements_sync(E_Connman_Element *manager);
+void                   e_connman_element_sync_queue(E_Connman_Element *element);
 
 E_Connman_Element *    e_connman_element_register(const char *path, const char *interface);
 void                   e_connman_element_unregister(E_Connman_Element *element);
@@ -167,8 +172,59 @@ Eina_Bool              e_connman_element_objects_array_get_stringshared(const E_
 Eina_Bool              e_connman_element_strings_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count, const char ***strings);
 unsigned char *        e_connman_element_bytes_array_get_stringshared(const E_Connman_Element *element, const char *property, unsigned int *count);
 
+/* Known properties of net.connman.Service and the keys of its dicts.  Each
+ * service keeps them in fixed slots, filled as properties arrive, so its
+ * accessors are a load instead of a lookup by name.  The order matches the
+ * name tables in e_connman_element.c.
+ */
+typedef enum _E_Connman_Service_Slot
+{
+   E_CONNMAN_SERVICE_SLOT_STATE,
+   E_CONNMAN_SERVICE_SLOT_ERROR,
+   E_CONNMAN_SERVICE_SLOT_NAME,
+   E_CONNMAN_SERVICE_SLOT_TYPE,
+   E_CONNMAN_SERVICE_SLOT_PASSPHRASE,
+   E_CONNMAN_SERVICE_SLOT_PASSPHRASE_REQUIRED,
+   E_CONNMAN_SERVICE_SLOT_LOGIN_REQUIRED,
+   E_CONNMAN_SERVICE_SLOT_STRENGTH,
+   E_CONNMAN_SERVICE_SLOT_FAVORITE,
+   E_CONNMAN_SERVICE_SLOT_IMMUTABLE,
+   E_CONNMAN_SERVICE_SLOT_AUTO_CONNECT,
+   E_CONNMAN_SERVICE_SLOT_ROAMING,
+   /* dicts from here on */
+   E_CONNMAN_SERVICE_SLOT_IPV4,
+   E_CONNMAN_SERVICE_SLOT_IPV4_CONFIGURATION,
+   E_CONNMAN_SERVICE_SLOT_PROXY,
+   E_CONNMAN_SERVICE_SLOT_PROXY_CONFIGURATION,
+   E_CONNMAN_SERVICE_SLOT_ETHERNET,
+   E_CONNMAN_SERVICE_SLOT_LAST
+} E_Connman_Service_Slot;
+
+#define E_CONNMAN_SERVICE_SLOT_DICT_FIRST E_CONNMAN_SERVICE_SLOT_IPV4
+#define E_CONNMAN_SERVICE_SLOT_DICTS \
+   (E_CONNMAN_SERVICE_SLOT_LAST - E_CONNMAN_SERVICE_SLOT_DICT_FIRST)
+
+typedef enum _E_Connman_Service_Key
+{
+   E_CONNMAN_SERVICE_KEY_METHOD,
+   E_CONNMAN_SERVICE_KEY_ADDRESS,
+   E_CONNMAN_SERVICE_KEY_GATEWAY,
+   E_CONNMAN_SERVICE_KEY_NETMASK,
+   E_CONNMAN_SERVICE_KEY_URL,
+   E_CONNMAN_SERVICE_KEY_INTERFACE,
+   E_CONNMAN_SERVICE_KEY_SPEED,
+   E_CONNMAN_SERVICE_KEY_DUPLEX,
+   E_CONNMAN_SERVICE_KEY_MTU,
+   E_CONNMAN_SERVICE_KEY_LAST
+} E_Connman_Service_Key;
+
+Eina_Bool              e_connman_element_service_slot_get(const E_Connman_Element *service, E_Connman_Service_Slot slot, int type, void *value);
+Eina_Bool              e_connman_element_service_dict_slot_get(const E_Connman_Element *service, E_Connman_Service_Slot dict, E_Connman_Service_Key key, int type, void *value);
+
 Eina_Bool              e_connman_element_message_send(E_Connman_Element *element, const char *method_name, E_DBus_Method_Return_Cb cb, DBusMessage *msg, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data);
 
 Eina_Bool              e_connman_element_call_full(E_Connman_Element *element, const char *method_name, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data);
 Eina_Bool              e_connman_element_call_with_path(E_Connman_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data);
 Eina_Bool              e_connman_element_call_with_string(E_Connman_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data);
+
+#endif
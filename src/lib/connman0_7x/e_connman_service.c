@@ -222,8 +222,8 @@ e_connman_service_state_get(const E_Connman_Element *service, const char **state
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(state, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_state, NULL, state);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_STATE, DBUS_TYPE_STRING, state);
 }
 
 /**
@@ -259,8 +259,8 @@ e_connman_service_error_get(const E_Connman_Element *service, const char **error
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(error, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_error, NULL, error);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ERROR, DBUS_TYPE_STRING, error);
 }
 
 /**
@@ -291,8 +291,8 @@ e_connman_service_name_get(const E_Connman_Element *service, const char **name)
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_name, NULL, name);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_NAME, DBUS_TYPE_STRING, name);
 }
 
 /**
@@ -321,8 +321,8 @@ e_connman_service_type_get(const E_Connman_Element *service, const char **type)
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(type, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_type, NULL, type);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_TYPE, DBUS_TYPE_STRING, type);
 }
 
 /**
@@ -357,7 +357,7 @@ e_connman_service_security_get(const E_Connman_Element *service, unsigned int *c
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(security, EINA_FALSE);
 
-   return e_connman_element_strings_array_get_stringshared
+   return e_connman_element_strings_array_view
      (service, e_connman_prop_security, count, security);
 }
 
@@ -392,8 +392,8 @@ e_connman_service_passphrase_get(const E_Connman_Element *service, const char **
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(passphrase, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_passphrase, NULL, passphrase);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_PASSPHRASE, DBUS_TYPE_STRING, passphrase);
 }
 
 /**
@@ -455,8 +455,8 @@ e_connman_service_passphrase_required_get(const E_Connman_Element *service, Eina
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(passphrase_required, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_passphrase_required, NULL, passphrase_required);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_PASSPHRASE_REQUIRED, DBUS_TYPE_BOOLEAN, passphrase_required);
 }
 
 /**
@@ -486,8 +486,8 @@ e_connman_service_login_required_get(const E_Connman_Element *service, Eina_Bool
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(login_required, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_login_required, NULL, login_required);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_LOGIN_REQUIRED, DBUS_TYPE_BOOLEAN, login_required);
 }
 
 /**
@@ -514,8 +514,8 @@ e_connman_service_strength_get(const E_Connman_Element *service, unsigned char *
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(strength, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_strength, NULL, strength);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_STRENGTH, DBUS_TYPE_BYTE, strength);
 }
 
 /**
@@ -543,8 +543,8 @@ e_connman_service_favorite_get(const E_Connman_Element *service, Eina_Bool *favo
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(favorite, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_favorite, NULL, favorite);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_FAVORITE, DBUS_TYPE_BOOLEAN, favorite);
 }
 
 /**
@@ -568,8 +568,8 @@ e_connman_service_immutable_get(const E_Connman_Element *service, Eina_Bool *imm
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(immutable, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_immutable, NULL, immutable);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IMMUTABLE, DBUS_TYPE_BOOLEAN, immutable);
 }
 
 /**
@@ -598,8 +598,8 @@ e_connman_service_auto_connect_get(const E_Connman_Element *service, Eina_Bool *
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(auto_connect, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_auto_connect, NULL, auto_connect);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_AUTO_CONNECT, DBUS_TYPE_BOOLEAN, auto_connect);
 }
 
 /**
@@ -655,8 +655,8 @@ e_connman_service_roaming_get(const E_Connman_Element *service, Eina_Bool *roami
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(roaming, EINA_FALSE);
-   return e_connman_element_property_get_stringshared
-             (service, e_connman_prop_roaming, NULL, roaming);
+   return e_connman_element_service_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ROAMING, DBUS_TYPE_BOOLEAN, roaming);
 }
 
 /**
@@ -695,7 +695,7 @@ e_connman_service_nameservers_get(const E_Connman_Element *service, unsigned int
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(nameservers, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_strings_array_get_stringshared
+   return e_connman_element_strings_array_view
              (service, e_connman_prop_nameservers, count, nameservers);
 }
 
@@ -729,7 +729,7 @@ e_connman_service_nameservers_configuration_get(const E_Connman_Element *service
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(nameservers, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_strings_array_get_stringshared
+   return e_connman_element_strings_array_view
              (service, e_connman_prop_nameservers_configuration,
               count, nameservers);
 }
@@ -802,7 +802,7 @@ e_connman_service_domains_get(const E_Connman_Element *service, unsigned int *co
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(domains, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_strings_array_get_stringshared
+   return e_connman_element_strings_array_view
              (service, e_connman_prop_domains, count, domains);
 }
 
@@ -836,7 +836,7 @@ e_connman_service_domains_configuration_get(const E_Connman_Element *service, un
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(domains, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_strings_array_get_stringshared
+   return e_connman_element_strings_array_view
              (service, e_connman_prop_domains_configuration, count, domains);
 }
 
@@ -903,8 +903,9 @@ e_connman_service_ipv4_method_get(const E_Connman_Element *service, const char *
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(method, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4, e_connman_prop_method, NULL, method);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4, E_CONNMAN_SERVICE_KEY_METHOD,
+             DBUS_TYPE_STRING, method);
 }
 
 /**
@@ -929,8 +930,9 @@ e_connman_service_ipv4_address_get(const E_Connman_Element *service, const char
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(address, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4, e_connman_prop_address, NULL, address);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4, E_CONNMAN_SERVICE_KEY_ADDRESS,
+             DBUS_TYPE_STRING, address);
 }
 
 /**
@@ -955,8 +957,9 @@ e_connman_service_ipv4_gateway_get(const E_Connman_Element *service, const char
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(gateway, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4, e_connman_prop_gateway, NULL, gateway);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4, E_CONNMAN_SERVICE_KEY_GATEWAY,
+             DBUS_TYPE_STRING, gateway);
 }
 
 /**
@@ -981,8 +984,9 @@ e_connman_service_ipv4_netmask_get(const E_Connman_Element *service, const char
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(netmask, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4, e_connman_prop_netmask, NULL, netmask);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4, E_CONNMAN_SERVICE_KEY_NETMASK,
+             DBUS_TYPE_STRING, netmask);
 }
 
 /**
@@ -1011,9 +1015,9 @@ e_connman_service_ipv4_configuration_method_get(const E_Connman_Element *service
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(method, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4_configuration, e_connman_prop_method,
-             NULL, method);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4_CONFIGURATION, E_CONNMAN_SERVICE_KEY_METHOD,
+             DBUS_TYPE_STRING, method);
 }
 
 /**
@@ -1041,9 +1045,9 @@ e_connman_service_ipv4_configuration_address_get(const E_Connman_Element *servic
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(address, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4_configuration, e_connman_prop_address,
-             NULL, address);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4_CONFIGURATION, E_CONNMAN_SERVICE_KEY_ADDRESS,
+             DBUS_TYPE_STRING, address);
 }
 
 /**
@@ -1071,9 +1075,9 @@ e_connman_service_ipv4_configuration_gateway_get(const E_Connman_Element *servic
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(gateway, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4_configuration, e_connman_prop_gateway,
-             NULL, gateway);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4_CONFIGURATION, E_CONNMAN_SERVICE_KEY_GATEWAY,
+             DBUS_TYPE_STRING, gateway);
 }
 
 /**
@@ -1101,9 +1105,9 @@ e_connman_service_ipv4_configuration_netmask_get(const E_Connman_Element *servic
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(netmask, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ipv4_configuration, e_connman_prop_netmask,
-             NULL, netmask);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_IPV4_CONFIGURATION, E_CONNMAN_SERVICE_KEY_NETMASK,
+             DBUS_TYPE_STRING, netmask);
 }
 
 /**
@@ -1259,8 +1263,9 @@ e_connman_service_proxy_method_get(const E_Connman_Element *service, const char
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(method, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_proxy, e_connman_prop_method, NULL, method);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_PROXY, E_CONNMAN_SERVICE_KEY_METHOD,
+             DBUS_TYPE_STRING, method);
 }
 
 /**
@@ -1285,8 +1290,9 @@ e_connman_service_proxy_url_get(const E_Connman_Element *service, const char **u
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(url, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_proxy, e_connman_prop_url, NULL, url);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_PROXY, E_CONNMAN_SERVICE_KEY_URL,
+             DBUS_TYPE_STRING, url);
 }
 
 /**
@@ -1321,7 +1327,7 @@ e_connman_service_proxy_servers_get(const E_Connman_Element *service, unsigned i
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(servers, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_property_dict_strings_array_get_stringshared
+   return e_connman_element_property_dict_strings_array_view
              (service, e_connman_prop_proxy, e_connman_prop_servers, count, servers);
 }
 
@@ -1354,7 +1360,7 @@ e_connman_service_proxy_excludes_get(const E_Connman_Element *service, unsigned
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(excludes, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_property_dict_strings_array_get_stringshared
+   return e_connman_element_property_dict_strings_array_view
              (service, e_connman_prop_proxy, e_connman_prop_excludes, count, excludes);
 }
 
@@ -1383,8 +1389,9 @@ e_connman_service_proxy_configuration_method_get(const E_Connman_Element *servic
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(method, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_proxy_configuration, e_connman_prop_method, NULL, method);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_PROXY_CONFIGURATION, E_CONNMAN_SERVICE_KEY_METHOD,
+             DBUS_TYPE_STRING, method);
 }
 
 /**
@@ -1412,8 +1419,9 @@ e_connman_service_proxy_configuration_url_get(const E_Connman_Element *service,
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(url, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_proxy_configuration, e_connman_prop_url, NULL, url);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_PROXY_CONFIGURATION, E_CONNMAN_SERVICE_KEY_URL,
+             DBUS_TYPE_STRING, url);
 }
 
 /**
@@ -1451,7 +1459,7 @@ e_connman_service_proxy_configuration_servers_get(const E_Connman_Element *servi
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(servers, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_property_dict_strings_array_get_stringshared
+   return e_connman_element_property_dict_strings_array_view
              (service, e_connman_prop_proxy_configuration, e_connman_prop_servers, count, servers);
 }
 
@@ -1487,7 +1495,7 @@ e_connman_service_proxy_configuration_excludes_get(const E_Connman_Element *serv
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(excludes, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   return e_connman_element_property_dict_strings_array_get_stringshared
+   return e_connman_element_property_dict_strings_array_view
              (service, e_connman_prop_proxy_configuration, e_connman_prop_excludes, count, excludes);
 }
 
@@ -1513,8 +1521,9 @@ e_connman_service_ethernet_interface_get(const E_Connman_Element *service, const
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(iface, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ethernet, e_connman_prop_interface, NULL, iface);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ETHERNET, E_CONNMAN_SERVICE_KEY_INTERFACE,
+             DBUS_TYPE_STRING, iface);
 }
 
 /**
@@ -1539,8 +1548,9 @@ e_connman_service_ethernet_method_get(const E_Connman_Element *service, const ch
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(method, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ethernet, e_connman_prop_method, NULL, method);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ETHERNET, E_CONNMAN_SERVICE_KEY_METHOD,
+             DBUS_TYPE_STRING, method);
 }
 
 /**
@@ -1562,8 +1572,9 @@ e_connman_service_ethernet_speed_get(const E_Connman_Element *service, unsigned
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(speed, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ethernet, e_connman_prop_speed, NULL, speed);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ETHERNET, E_CONNMAN_SERVICE_KEY_SPEED,
+             DBUS_TYPE_UINT16, speed);
 }
 
 /**
@@ -1588,8 +1599,9 @@ e_connman_service_ethernet_address_get(const E_Connman_Element *service, const c
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(address, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ethernet, e_connman_prop_address, NULL, address);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ETHERNET, E_CONNMAN_SERVICE_KEY_ADDRESS,
+             DBUS_TYPE_STRING, address);
 }
 
 /**
@@ -1615,8 +1627,9 @@ e_connman_service_ethernet_duplex_get(const E_Connman_Element *service, const ch
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(duplex, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ethernet, e_connman_prop_duplex, NULL, duplex);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ETHERNET, E_CONNMAN_SERVICE_KEY_DUPLEX,
+             DBUS_TYPE_STRING, duplex);
 }
 
 /**
@@ -1641,6 +1654,7 @@ e_connman_service_ethernet_mtu_get(const E_Connman_Element *service, unsigned sh
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(service, EINA_FALSE);
    EINA_SAFETY_ON_NULL_RETURN_VAL(mtu, EINA_FALSE);
-   return e_connman_element_property_dict_get_stringshared
-             (service, e_connman_prop_ethernet, e_connman_prop_mtu, NULL, mtu);
+   return e_connman_element_service_dict_slot_get
+             (service, E_CONNMAN_SERVICE_SLOT_ETHERNET, E_CONNMAN_SERVICE_KEY_MTU,
+             DBUS_TYPE_UINT16, mtu);
 }
@@ -120,11 +120,23 @@ extern "C" {
    typedef struct E_DBus_Object E_DBus_Object;
    typedef struct E_DBus_Interface E_DBus_Interface;
    typedef struct E_DBus_Signal_Handler E_DBus_Signal_Handler;
+   typedef struct E_DBus_Connection_Pool E_DBus_Connection_Pool;
 
    typedef DBusMessage *(* E_DBus_Method_Cb)(E_DBus_Object *obj, DBusMessage *message);
    typedef void (*E_DBus_Method_Return_Cb) (void *data, DBusMessage *msg, DBusError *error);
    typedef void (*E_DBus_Signal_Cb) (void *data, DBusMessage *msg);
 
+   typedef void (*E_DBus_Outgoing_Cb) (void *data, E_DBus_Connection *conn, Eina_Bool congested);
+   typedef void (*E_DBus_Connection_Ready_Cb) (void *data, E_DBus_Connection *conn, DBusError *error);
+   typedef enum
+     {
+        E_DBUS_PRIORITY_NORMAL = 0,
+        E_DBUS_PRIORITY_HIGH,
+        E_DBUS_PRIORITY_BULK
+     } E_DBus_Priority;
+
+   typedef void (*E_DBus_Slow_Handler_Cb) (void *data, E_DBus_Connection *conn, const char *kind, const char *interface, const char *member, double duration);
+
    typedef void (*E_DBus_Object_Property_Get_Cb) (E_DBus_Object *obj, const char *property, int *type, void **value);
    typedef int  (*E_DBus_Object_Property_Set_Cb) (E_DBus_Object *obj, const char *property, int type, void *value);
 
@@ -156,10 +168,39 @@ EAPI int e_dbus_shutdown(void);
    
 /**
  * Retrieve a connection to the bus and integrate it with the ecore main loop.
+ *
+ * If the shared connection was opened by e_dbus_bus_get_async() and is still
+ * waiting for its Hello reply, this blocks until it is ready, and opens a new
+ * connection if that Hello failed.
+ *
  * @param type the type of bus to connect to, e.g. DBUS_BUS_SYSTEM or DBUS_BUS_SESSION
  */
 EAPI E_DBus_Connection *e_dbus_bus_get(DBusBusType type);
 
+/**
+ * Retrieve a connection to the bus without blocking.
+ *
+ * The connection is returned right away, while authentication and the
+ * Hello round-trip happen in the ecore main loop. Messages sent and signal
+ * handlers added before the connection is ready are queued behind the Hello
+ * call and go out once the bus accepts the connection. @a cb is called
+ * when the connection is ready, or with @a error set if it failed.
+ *
+ * If a shared connection to the bus already exists it is returned, and
+ * @a cb is called from an idler once it is ready.
+ *
+ * @param type the type of bus to connect to, e.g. DBUS_BUS_SYSTEM or DBUS_BUS_SESSION
+ * @param cb a callback to call when the connection is ready, may be NULL
+ * @param data custom data to pass in to the callback
+ */
+EAPI E_DBus_Connection *e_dbus_bus_get_async(DBusBusType type, E_DBus_Connection_Ready_Cb cb, const void *data);
+
+/**
+ * @brief Get whether the bus accepted the connection and assigned it a name
+ * @param conn the connection
+ */
+EAPI Eina_Bool e_dbus_connection_ready_get(E_DBus_Connection *conn);
+
    EAPI void e_dbus_connection_ref(E_DBus_Connection *conn);
 
    
@@ -176,6 +217,282 @@ EAPI E_DBus_Connection *e_dbus_connection_setup(DBusConnection *conn);
  */
 EAPI void e_dbus_connection_close(E_DBus_Connection *conn);
 
+/**
+ * Set the outgoing queue watermarks of a connection
+ *
+ * Once @a high bytes or more are waiting to be written the connection is
+ * considered congested and @a cb is called with @c EINA_TRUE. When the
+ * queue drains to @a low bytes or less, @a cb is called with @c EINA_FALSE.
+ *
+ * @param conn the connection
+ * @param high the high water mark in bytes, 0 disables the limits
+ * @param low the low water mark in bytes, must be lower than @a high
+ * @param cb callback to call when a mark is crossed, may be NULL
+ * @param data custom data to pass in to the callback
+ */
+EAPI void e_dbus_connection_outgoing_limits_set(E_DBus_Connection *conn, long high, long low, E_DBus_Outgoing_Cb cb, const void *data);
+
+/**
+ * @brief Get whether the outgoing queue is over its high water mark
+ * @param conn the connection
+ */
+EAPI Eina_Bool e_dbus_connection_congested_get(E_DBus_Connection *conn);
+
+/**
+ * @brief Get the number of bytes waiting to be written on a connection
+ * @param conn the connection
+ */
+EAPI long e_dbus_connection_outgoing_size_get(E_DBus_Connection *conn);
+
+/**
+ * @brief Get the number of signals dropped by e_dbus_signal_send()
+ * @param conn the connection
+ */
+EAPI unsigned int e_dbus_connection_outgoing_dropped_get(E_DBus_Connection *conn);
+
+/**
+ * Set the dispatch priority class of the signals of an interface or member
+ *
+ * Signals in the E_DBUS_PRIORITY_BULK class are set aside as they come
+ * off the connection and handed to the signal handlers and the
+ * E_DBUS_EVENT_SIGNAL event later, in their arrival order, once no other
+ * message is waiting (plus one every few messages so they are not
+ * starved). Method calls, replies and the other signals are dispatched
+ * ahead of them.
+ *
+ * When several rules match a signal the one with both @a interface and
+ * @a member wins over the one with only @a interface, which wins over the
+ * one with only @a member; E_DBUS_PRIORITY_HIGH exempts a member from the
+ * rule of its interface. E_DBUS_PRIORITY_NORMAL removes the rule.
+ *
+ * @param conn the connection
+ * @param interface the interface, or NULL for any
+ * @param member the member, or NULL for any
+ * @param priority the class
+ * @return EINA_TRUE if the rule was set
+ */
+EAPI Eina_Bool e_dbus_connection_priority_set(E_DBus_Connection *conn, const char *interface, const char *member, E_DBus_Priority priority);
+
+/**
+ * Set the time budget of the handlers run for a connection
+ *
+ * Dispatch is serialized, so a slow handler delays every message queued
+ * behind it. Signal handlers, method handlers, reply callbacks and the
+ * element listeners of the libraries built on e_dbus that run for longer
+ * than @a budget seconds are counted, see
+ * e_dbus_connection_slow_handlers_get(), and reported to @a cb with
+ * @a kind one of "signal", "method", "reply" or "listener", the interface
+ * and member they ran for (the element path for listeners) and how long
+ * they took.
+ *
+ * @param conn the connection
+ * @param budget the budget in seconds, 0 disables the checks
+ * @param cb callback to call for each slow handler, may be NULL
+ * @param data custom data to pass in to the callback
+ */
+EAPI void e_dbus_connection_handler_budget_set(E_DBus_Connection *conn, double budget, E_DBus_Slow_Handler_Cb cb, const void *data);
+
+/**
+ * @brief Get the handler time budget of a connection, 0 if disabled
+ * @param conn the connection
+ */
+EAPI double e_dbus_connection_handler_budget_get(E_DBus_Connection *conn);
+
+/**
+ * Get how many handlers went over the budget of a connection
+ * @param conn the connection
+ * @param worst where to store the longest duration seen in seconds, may be NULL
+ * @return the number of handlers that went over the budget
+ */
+EAPI unsigned int e_dbus_connection_slow_handlers_get(E_DBus_Connection *conn, double *worst);
+
+/**
+ * Start timing a handler against the budget of a connection
+ *
+ * For libraries that run their own callbacks from e_dbus ones.
+ *
+ * @param conn the connection
+ * @return the value to pass to e_dbus_connection_handler_end()
+ */
+EAPI double e_dbus_connection_handler_begin(E_DBus_Connection *conn);
+
+/**
+ * Check a handler timed with e_dbus_connection_handler_begin() against the budget
+ * @param conn the connection
+ * @param start the value returned by e_dbus_connection_handler_begin()
+ * @param kind what ran, e.g. "listener"
+ * @param interface the interface it ran for, may be NULL
+ * @param member the member it ran for, may be NULL
+ */
+EAPI void e_dbus_connection_handler_end(E_DBus_Connection *conn, double start, const char *kind, const char *interface, const char *member);
+
+/**
+ * Hold back outgoing messages that do not expect a reply
+ *
+ * While a connection is corked, signals, method returns and errors are
+ * queued instead of being handed to libdbus one at a time. They are sent
+ * back to back when the connection is uncorked, at the end of the current
+ * main loop iteration, or before the next method call is sent, so the
+ * order of messages on the connection is preserved. Calls nest.
+ *
+ * @param conn the connection
+ */
+EAPI void e_dbus_connection_cork(E_DBus_Connection *conn);
+
+/**
+ * Release a cork taken with e_dbus_connection_cork()
+ *
+ * When the last cork is released the queued messages are sent.
+ *
+ * @param conn the connection
+ */
+EAPI void e_dbus_connection_uncork(E_DBus_Connection *conn);
+
+/* traffic capture */
+
+/*
+ * A capture file starts with the 8 bytes of E_DBUS_RECORD_MAGIC, followed
+ * for every message by an E_DBus_Record_Entry and then entry.length bytes
+ * of dbus_message_marshal() output. Entries are in host byte order.
+ */
+#define E_DBUS_RECORD_MAGIC "EDBUSRC1"
+#define E_DBUS_RECORD_IN  '<'
+#define E_DBUS_RECORD_OUT '>'
+
+   typedef struct E_DBus_Record_Entry E_DBus_Record_Entry;
+
+   struct E_DBus_Record_Entry
+   {
+      unsigned long long usec;   /* since the capture was started */
+      unsigned int length;
+      unsigned char direction;   /* E_DBUS_RECORD_IN or E_DBUS_RECORD_OUT */
+      unsigned char pad[3];
+   };
+
+/**
+ * Record every message received or sent on a connection to a file
+ *
+ * Incoming messages are recorded as they are dispatched, including the
+ * replies to calls made with e_dbus_message_send(), outgoing ones once
+ * libdbus has given them a serial. Any previous capture on the connection
+ * is stopped. Connections set up while the E_DBUS_RECORD environment
+ * variable is set are recorded to "$E_DBUS_RECORD.<pid>.<n>".
+ *
+ * Requires libdbus 1.1.1 or newer.
+ *
+ * @param conn the connection
+ * @param file the capture file to create
+ * @return EINA_TRUE if the capture was started
+ */
+EAPI Eina_Bool e_dbus_connection_record_start(E_DBus_Connection *conn, const char *file);
+
+/**
+ * Stop a capture started with e_dbus_connection_record_start() and close its file
+ * @param conn the connection
+ */
+EAPI void e_dbus_connection_record_stop(E_DBus_Connection *conn);
+
+/* call tracing */
+
+/*
+ * A trace file starts with the 8 bytes of E_DBUS_TRACE_MAGIC followed by
+ * E_DBus_Trace_Entry records in host byte order.  Calls are identified on
+ * both sides by the caller's unique name and the call serial, so the
+ * traces of a client and a server can be joined; timestamps come from
+ * the monotonic clock and are only comparable between processes of the
+ * same host.
+ */
+#define E_DBUS_TRACE_MAGIC "EDBUSTR1"
+#define E_DBUS_TRACE_SEND     'S' /* a call or reply was sent */
+#define E_DBUS_TRACE_DISPATCH 'D' /* a call or reply reached its handler */
+#define E_DBUS_TRACE_READ     'R' /* data was read from the connection */
+
+   typedef struct E_DBus_Trace_Entry E_DBus_Trace_Entry;
+
+   struct E_DBus_Trace_Entry
+   {
+      unsigned long long usec;
+      unsigned int serial;       /* of the call, also for its reply */
+      unsigned char event;       /* E_DBUS_TRACE_* */
+      unsigned char type;        /* DBUS_MESSAGE_TYPE_*, 0 for reads */
+      unsigned char pad[2];
+      char self[32];             /* unique name of the connection */
+      char caller[32];           /* unique name of the caller */
+      char member[32];           /* of the call, empty for replies */
+   };
+
+/**
+ * Trace method calls and replies of every connection of the process
+ *
+ * Records when calls and replies are sent and dispatched, and when data
+ * is read from a connection, in a buffer that is written to @p file when
+ * full and when tracing stops.  Any previous trace is stopped.  When the
+ * E_DBUS_TRACE environment variable is set the process is traced from
+ * e_dbus_init() to "$E_DBUS_TRACE.<pid>".  e_dbus_trace_merge joins the
+ * traces of several processes into a per call latency breakdown.
+ *
+ * @param file the trace file to create
+ * @return EINA_TRUE if tracing was started
+ */
+EAPI Eina_Bool e_dbus_trace_start(const char *file);
+
+/**
+ * Stop tracing, writing out the buffer and closing the trace file
+ */
+EAPI void e_dbus_trace_stop(void);
+
+/* connection pools */
+
+/**
+ * Create a pool of connections to a bus for high outbound call volume
+ *
+ * The first connection of the pool is the shared connection returned by
+ * e_dbus_bus_get(), the others are private connections to the same bus.
+ * Signal handlers and objects should stay on the primary connection.
+ *
+ * @param type the type of bus to connect to, e.g. DBUS_BUS_SYSTEM or DBUS_BUS_SESSION
+ * @param size the number of connections in the pool, at least 1
+ * @return the pool, or NULL on failure
+ */
+EAPI E_DBus_Connection_Pool *e_dbus_connection_pool_new(DBusBusType type, unsigned int size);
+
+/**
+ * Close all the connections of a pool and free it
+ * @param pool the pool to free
+ */
+EAPI void e_dbus_connection_pool_free(E_DBus_Connection_Pool *pool);
+
+/**
+ * @brief Get the primary (shared) connection of a pool
+ * @param pool the pool
+ */
+EAPI E_DBus_Connection *e_dbus_connection_pool_primary_get(E_DBus_Connection_Pool *pool);
+
+/**
+ * Get the connection of a pool to use for a destination
+ *
+ * A destination is bound to the same connection for the lifetime of the
+ * pool, so messages to it keep their order. Well-known names are spread
+ * over the connections in round-robin order as they are first seen, unique
+ * names are hashed onto one so they need not be remembered. Calls to
+ * the bus itself always go through the primary connection. A NULL
+ * destination picks the next connection in round-robin order.
+ *
+ * @param pool the pool
+ * @param destination the bus name the message is sent to, may be NULL
+ */
+EAPI E_DBus_Connection *e_dbus_connection_pool_get(E_DBus_Connection_Pool *pool, const char *destination);
+
+/**
+ * @brief Send a DBus message through the pool connection for its destination
+ *
+ * Only method calls are spread, signals and replies are always sent through
+ * the primary connection.
+ *
+ * @see e_dbus_message_send(), e_dbus_connection_pool_get()
+ */
+EAPI DBusPendingCall *e_dbus_connection_pool_message_send(E_DBus_Connection_Pool *pool, DBusMessage *msg, E_DBus_Method_Return_Cb cb_return, int timeout, void *data);
+
 /* receiving method calls */
    EAPI E_DBus_Interface *e_dbus_interface_new(const char *interface);
    EAPI void e_dbus_interface_ref(E_DBus_Interface *iface);
@@ -278,10 +595,31 @@ EAPI void e_dbus_object_property_set_cb_set(E_DBus_Object *obj, E_DBus_Object_Pr
  * @param cb_return A callback function for returns (only used if @a msg is a method-call)
  * @param timeout   A timeout in milliseconds, after which a synthetic error will be generated
  * @param data custom data to pass in to the callback
- * @return a DBusPendingCall that can be used to cancel the current call
+ * @return a DBusPendingCall that can be used to cancel the current call.
+ *         Messages other than method calls queued on a corked connection
+ *         return NULL.
  */
 EAPI DBusPendingCall *e_dbus_message_send(E_DBus_Connection *conn, DBusMessage *msg, E_DBus_Method_Return_Cb cb_return, int timeout, void *data);
 
+/**
+ * @brief Send a DBus message unless the connection is congested
+ *
+ * Same as e_dbus_message_send(), but fails right away instead of queueing
+ * while the outgoing queue is over the high water mark set with
+ * e_dbus_connection_outgoing_limits_set().
+ *
+ * @return a DBusPendingCall, or NULL on failure or congestion
+ */
+EAPI DBusPendingCall *e_dbus_message_send_try(E_DBus_Connection *conn, DBusMessage *msg, E_DBus_Method_Return_Cb cb_return, int timeout, void *data);
+
+/**
+ * @brief Send a signal, dropping it if the connection is congested
+ * @param conn The DBus connection
+ * @param msg  The signal to send
+ * @return EINA_TRUE if the signal was queued, EINA_FALSE if it was dropped
+ */
+EAPI Eina_Bool e_dbus_signal_send(E_DBus_Connection *conn, DBusMessage *msg);
+
    EAPI DBusPendingCall *e_dbus_method_call_send(E_DBus_Connection *conn, DBusMessage *msg, E_DBus_Unmarshal_Func unmarshal_func, E_DBus_Callback_Func cb_func, E_DBus_Free_Func free_func, int timeout, void *data);
 
 
@@ -309,6 +647,24 @@ EAPI E_DBus_Signal_Handler *e_dbus_signal_handler_add(E_DBus_Connection *conn, c
  */
 EAPI void e_dbus_signal_handler_del(E_DBus_Connection *conn, E_DBus_Signal_Handler *sh);
 
+/**
+ * Coalesce the signals delivered to a handler
+ *
+ * The first matching signal opens a window of @a window seconds; signals
+ * with the same sender, path, member and, if @a arg is not negative,
+ * string argument number @a arg that arrive before it closes replace the
+ * one held back, which is released unread. When the window closes the
+ * latest signal of each key is delivered, in the order the keys were
+ * first seen. Useful for services sending storms of PropertyChanged for
+ * the same property.
+ *
+ * @param sh the handler
+ * @param window the window in seconds, 0 delivers every signal right away
+ * @param arg the argument that is part of the key, e.g. 0 for the
+ *        property name of PropertyChanged, or -1 for none
+ */
+EAPI void e_dbus_signal_handler_coalesce_set(E_DBus_Signal_Handler *sh, double window, int arg);
+
 /* standard dbus method calls */
 
    EAPI DBusPendingCall *e_dbus_request_name(E_DBus_Connection *conn, const char *name,
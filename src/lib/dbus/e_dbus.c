@@ -25,10 +25,23 @@ static int _edbus_init_count = 0;
 static int close_connection = 0;
 EAPI int E_DBUS_EVENT_SIGNAL = 0;
 
+E_DBUS_PROBE_DEFINE(edbus, message_receive);
+E_DBUS_PROBE_DEFINE(edbus, dispatch_start);
+E_DBUS_PROBE_DEFINE(edbus, dispatch_end);
+
 static E_DBus_Connection *shared_connections[2] = {NULL, NULL};
 
+#define E_DBUS_SYSTEM_BUS_DEFAULT_ADDRESS "unix:path=/var/run/dbus/system_bus_socket"
+
+/* bulk signals are delivered for at most this long per idler run once
+ * nothing else is queued, and one every E_DBUS_BULK_INTERLEAVE messages
+ * otherwise so a steady stream of other traffic cannot starve them */
+#define E_DBUS_BULK_SLICE 0.005
+#define E_DBUS_BULK_INTERLEAVE 16
+
 typedef struct E_DBus_Handler_Data E_DBus_Handler_Data;
 typedef struct E_DBus_Timeout_Data E_DBus_Timeout_Data;
+typedef struct E_DBus_Ready_Waiter E_DBus_Ready_Waiter;
 
 
 struct E_DBus_Handler_Data
@@ -48,6 +61,12 @@ struct E_DBus_Timeout_Data
   int interval;
 };
 
+struct E_DBus_Ready_Waiter
+{
+  E_DBus_Connection_Ready_Cb cb;
+  void *data;
+};
+
 static Eina_Bool e_dbus_idler(void *data);
 
 static void
@@ -65,6 +84,7 @@ static Eina_Bool
 e_dbus_fd_handler(void *data, Ecore_Fd_Handler *fd_handler)
 {
   E_DBus_Handler_Data *hd;
+  E_DBus_Connection *cd;
   unsigned int condition = 0;
 
   DBG("fd handler (%p)!", fd_handler);
@@ -84,7 +104,11 @@ e_dbus_fd_handler(void *data, Ecore_Fd_Handler *fd_handler)
       (condition & DBUS_WATCH_WRITABLE) == DBUS_WATCH_WRITABLE);
 
   if (condition & DBUS_WATCH_ERROR) DBG("DBUS watch error");
+  if ((condition & DBUS_WATCH_READABLE) && e_dbus_trace_active) e_dbus_trace_read(hd->cd);
+  /* the watch, and hd with it, may be gone once handled */
+  cd = hd->cd;
   dbus_watch_handle(hd->watch, condition);
+  if (condition & DBUS_WATCH_WRITABLE) e_dbus_connection_outgoing_check(cd);
   hd = NULL;
 
   return ECORE_CALLBACK_RENEW;
@@ -173,6 +197,7 @@ e_dbus_connection_new(DBusConnection *conn)
   }
   else
     DBG("Not connected");
+  cd->ready = 1;
 
   cd->shared_type = (unsigned int)-1;
   cd->fd_handlers = NULL;
@@ -187,8 +212,24 @@ e_dbus_connection_free(void *data)
   E_DBus_Connection *cd = data;
   Ecore_Fd_Handler *fd_handler;
   Ecore_Timer *timer;
+  DBusMessage *msg;
+  E_DBus_Ready_Waiter *w;
   DBG("e_dbus_connection free!");
 
+  EINA_LIST_FREE(cd->ready_waiters, w)
+    free(w);
+
+  if (cd->ready_idler) ecore_idler_del(cd->ready_idler);
+
+  EINA_LIST_FREE(cd->corked_messages, msg)
+    dbus_message_unref(msg);
+
+  EINA_LIST_FREE(cd->bulk_signals, msg)
+    dbus_message_unref(msg);
+  if (cd->priorities) eina_hash_free(cd->priorities);
+
+  if (cd->uncorker) ecore_idle_enterer_del(cd->uncorker);
+
   EINA_LIST_FREE(cd->fd_handlers, fd_handler)
     ecore_main_fd_handler_del(fd_handler);
 
@@ -199,6 +240,7 @@ e_dbus_connection_free(void *data)
     shared_connections[cd->shared_type] = NULL;
 
   e_dbus_signal_handlers_free_all(cd);
+  e_dbus_connection_record_stop(cd);
 
   if (cd->conn_name) free(cd->conn_name);
 
@@ -217,7 +259,7 @@ cb_dispatch_status(DBusConnection *conn __UNUSED__, DBusDispatchStatus new_statu
 
   if (new_status == DBUS_DISPATCH_DATA_REMAINS && !cd->idler)
      cd->idler = ecore_idler_add(e_dbus_idler, cd);
-  else if (new_status != DBUS_DISPATCH_DATA_REMAINS && cd->idler) 
+  else if (new_status != DBUS_DISPATCH_DATA_REMAINS && cd->idler && !cd->bulk_signals)
     {
        ecore_idler_del(cd->idler);
        cd->idler = NULL;
@@ -358,6 +400,52 @@ e_dbus_message_free(void *data __UNUSED__, void *message)
   dbus_message_unref(message);
 }
 
+static E_DBus_Priority
+e_dbus_priority_get(E_DBus_Connection *cd, DBusMessage *message)
+{
+  const char *interface, *member;
+  char key[512];
+  void *p;
+
+  interface = dbus_message_get_interface(message);
+  member = dbus_message_get_member(message);
+  if (!interface) interface = "";
+  if (!member) member = "";
+
+  /* the most specific rule wins */
+  snprintf(key, sizeof(key), "%s %s", interface, member);
+  if ((p = eina_hash_find(cd->priorities, key))) return (long)p - 1;
+  snprintf(key, sizeof(key), "%s ", interface);
+  if ((p = eina_hash_find(cd->priorities, key))) return (long)p - 1;
+  snprintf(key, sizeof(key), " %s", member);
+  if ((p = eina_hash_find(cd->priorities, key))) return (long)p - 1;
+  return E_DBUS_PRIORITY_NORMAL;
+}
+
+/* takes the reference on message */
+static void
+e_dbus_signal_deliver(E_DBus_Connection *cd, DBusMessage *message)
+{
+  if (cd->signal_dispatcher) cd->signal_dispatcher(cd, message);
+  ecore_event_add(E_DBUS_EVENT_SIGNAL, message, e_dbus_message_free, NULL);
+}
+
+static void
+e_dbus_bulk_signals_deliver(E_DBus_Connection *cd, double slice)
+{
+  DBusMessage *message;
+  double start = ecore_time_get();
+
+  cd->bulk_interleave = 0;
+  while (cd->bulk_signals)
+  {
+    message = eina_list_data_get(cd->bulk_signals);
+    cd->bulk_signals = eina_list_remove_list(cd->bulk_signals, cd->bulk_signals);
+    e_dbus_signal_deliver(cd, message);
+    if (ecore_time_get() - start >= slice) break;
+  }
+}
+
 static DBusHandlerResult
 e_dbus_filter(DBusConnection *conn __UNUSED__, DBusMessage *message, void *user_data)
 {
@@ -371,6 +459,14 @@ e_dbus_filter(DBusConnection *conn __UNUSED__, DBusMessage *message, void *user_
   DBG("member: %s", dbus_message_get_member(message));
   DBG("sender: %s", dbus_message_get_sender(message));
 
+  if (cd->record) e_dbus_connection_record(cd, message, E_DBUS_RECORD_IN);
+  E_DBUS_TRACE(cd, message, E_DBUS_TRACE_DISPATCH);
+  if (E_DBUS_PROBE_ENABLED(edbus, message_receive))
+    E_DBUS_PROBE4(edbus, message_receive, dbus_message_get_type(message),
+                  dbus_message_get_serial(message),
+                  dbus_message_get_interface(message),
+                  dbus_message_get_member(message));
+
   switch (dbus_message_get_type(message))
   {
     case DBUS_MESSAGE_TYPE_METHOD_CALL:
@@ -384,8 +480,13 @@ e_dbus_filter(DBusConnection *conn __UNUSED__, DBusMessage *message, void *user_
       break;
     case DBUS_MESSAGE_TYPE_SIGNAL:
       dbus_message_ref(message);
-      if (cd->signal_dispatcher) cd->signal_dispatcher(cd, message);
-      ecore_event_add(E_DBUS_EVENT_SIGNAL, message, e_dbus_message_free, NULL);
+      if (cd->priorities && e_dbus_priority_get(cd, message) == E_DBUS_PRIORITY_BULK)
+      {
+        DBG("deferring bulk signal");
+        cd->bulk_signals = eina_list_append(cd->bulk_signals, message);
+        break;
+      }
+      e_dbus_signal_deliver(cd, message);
       break;
     default:
       break;
@@ -401,9 +502,12 @@ static Eina_Bool
 e_dbus_idler(void *data)
 {
   E_DBus_Connection *cd;
+  unsigned long long t0 = 0;
+  Eina_Bool complete;
   cd = data;
 
-  if (DBUS_DISPATCH_COMPLETE == dbus_connection_get_dispatch_status(cd->conn))
+  complete = DBUS_DISPATCH_COMPLETE == dbus_connection_get_dispatch_status(cd->conn);
+  if (complete && !cd->bulk_signals)
   {
     DBG("done dispatching!");
     cd->idler = NULL;
@@ -411,10 +515,28 @@ e_dbus_idler(void *data)
   }
   e_dbus_idler_active++;
   dbus_connection_ref(cd->conn);
-  DBG("dispatch()");
-  dbus_connection_dispatch(cd->conn);
+  if (complete)
+    e_dbus_bulk_signals_deliver(cd, E_DBUS_BULK_SLICE);
+  else
+  {
+    DBG("dispatch()");
+    E_DBUS_PROBE1(edbus, dispatch_start, cd);
+    if (E_DBUS_PROBE_ENABLED(edbus, dispatch_end)) t0 = E_DBUS_PROBE_TIME();
+    dbus_connection_dispatch(cd->conn);
+    E_DBUS_PROBE2(edbus, dispatch_end, cd, t0 ? E_DBUS_PROBE_TIME() - t0 : 0);
+    if (cd->bulk_signals && ++cd->bulk_interleave >= E_DBUS_BULK_INTERLEAVE)
+      e_dbus_bulk_signals_deliver(cd, 0.0);
+  }
   dbus_connection_unref(cd->conn);
   e_dbus_idler_active--;
+  e_dbus_deferred_run(cd);
+  return ECORE_CALLBACK_RENEW;
+}
+
+/* run the handler deletions and closes deferred while callbacks ran */
+void
+e_dbus_deferred_run(E_DBus_Connection *cd)
+{
   e_dbus_signal_handlers_clean(cd);
   if (!e_dbus_idler_active && close_connection)
   {
@@ -423,26 +545,58 @@ e_dbus_idler(void *data)
       e_dbus_connection_close(cd);
     } while (--close_connection);
   }
-  return ECORE_CALLBACK_RENEW;
 }
 
 EAPI E_DBus_Connection *
 e_dbus_bus_get(DBusBusType type)
 {
-  DBusError err;
   E_DBus_Connection *econn;
-  DBusConnection *conn;
 
   /* each app only needs a single connection to either bus */
   if (type == DBUS_BUS_SYSTEM || type == DBUS_BUS_SESSION)
   {
-    if (shared_connections[type]) 
+    econn = shared_connections[type];
+    if (econn && !econn->ready && econn->hello_pending)
+    {
+      /* an e_dbus_bus_get_async() connection, wait for its Hello reply
+       * that runs cb_hello(), this getter only hands out ready ones */
+      DBG("waiting for the Hello reply of the shared connection");
+      e_dbus_connection_ref(econn);
+      dbus_pending_call_block(econn->hello_pending);
+      if (shared_connections[type] != econn)
+      {
+        /* Hello failed and the connection was released */
+        e_dbus_connection_close(econn);
+        econn = NULL;
+      }
+      else
+        return econn;
+    }
+    else if (econn)
     {
-      e_dbus_connection_ref(shared_connections[type]);
-      return shared_connections[type];
+      e_dbus_connection_ref(econn);
+      return econn;
     }
   }
 
+  econn = e_dbus_bus_get_private(type);
+  if (!econn) return NULL;
+
+  if (type == DBUS_BUS_SYSTEM || type == DBUS_BUS_SESSION)
+  {
+    econn->shared_type = type;
+    shared_connections[type] = econn;
+  }
+  return econn;
+}
+
+E_DBus_Connection *
+e_dbus_bus_get_private(DBusBusType type)
+{
+  DBusError err;
+  E_DBus_Connection *econn;
+  DBusConnection *conn;
+
   dbus_error_init(&err);
 
   conn = dbus_bus_get_private(type, &err);
@@ -462,16 +616,194 @@ e_dbus_bus_get(DBusBusType type)
     return NULL;
   }
 
+  dbus_error_free(&err);
+  e_dbus_connection_ref(econn);
+  return econn;
+}
+
+static void
+e_dbus_connection_ready_notify(E_DBus_Connection *cd, DBusError *err)
+{
+  E_DBus_Ready_Waiter *w;
+
+  if (cd->ready_idler)
+  {
+    ecore_idler_del(cd->ready_idler);
+    cd->ready_idler = NULL;
+  }
+
+  EINA_LIST_FREE(cd->ready_waiters, w)
+  {
+    w->cb(w->data, cd, err);
+    free(w);
+  }
+}
+
+static Eina_Bool
+e_dbus_connection_ready_idler(void *data)
+{
+  E_DBus_Connection *cd = data;
+  DBusError err;
+
+  cd->ready_idler = NULL;
+  dbus_error_init(&err);
+  e_dbus_connection_ready_notify(cd, &err);
+  return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+cb_hello(void *data, DBusMessage *msg, DBusError *err)
+{
+  E_DBus_Connection *cd = data;
+  const char *name = NULL;
+
+  cd->hello_pending = NULL;
+  if (!dbus_error_is_set(err))
+    dbus_message_get_args(msg, err, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID);
+
+  if (dbus_error_is_set(err))
+  {
+    ERR("Error registering on the bus: %s", err->message);
+    /* never hand out this connection again, the waiters get the error */
+    if (cd->shared_type != (unsigned int)-1)
+    {
+      if (shared_connections[cd->shared_type] == cd)
+        shared_connections[cd->shared_type] = NULL;
+      cd->shared_type = (unsigned int)-1;
+    }
+    e_dbus_connection_ready_notify(cd, err);
+    e_dbus_connection_close(cd);
+    return;
+  }
+
+  DBG("Connected! Name: %s", name);
+  dbus_bus_set_unique_name(cd->conn, name);
+  free(cd->conn_name);
+  cd->conn_name = strdup(name);
+  cd->ready = 1;
+  e_dbus_connection_ready_notify(cd, err);
+  e_dbus_connection_close(cd);
+}
+
+static const char *
+e_dbus_bus_address_get(DBusBusType type)
+{
+  const char *address;
+
+  switch (type)
+  {
+    case DBUS_BUS_SESSION:
+      return getenv("DBUS_SESSION_BUS_ADDRESS");
+    case DBUS_BUS_SYSTEM:
+      address = getenv("DBUS_SYSTEM_BUS_ADDRESS");
+      return address ? address : E_DBUS_SYSTEM_BUS_DEFAULT_ADDRESS;
+    case DBUS_BUS_STARTER:
+      return getenv("DBUS_STARTER_ADDRESS");
+    default:
+      return NULL;
+  }
+}
+
+EAPI E_DBus_Connection *
+e_dbus_bus_get_async(DBusBusType type, E_DBus_Connection_Ready_Cb cb, const void *data)
+{
+  DBusError err;
+  E_DBus_Connection *econn;
+  DBusConnection *conn;
+  DBusMessage *msg;
+  const char *address;
+
+  econn = NULL;
   if (type == DBUS_BUS_SYSTEM || type == DBUS_BUS_SESSION)
+    econn = shared_connections[type];
+
+  if (econn)
+    e_dbus_connection_ref(econn);
+  else
   {
-    econn->shared_type = type;
-    shared_connections[type] = econn;
+    address = e_dbus_bus_address_get(type);
+    if (!address)
+    {
+      /* no address to connect to, let libdbus autolaunch or find it */
+      DBG("no bus address for type %d, connecting synchronously", type);
+      econn = e_dbus_bus_get(type);
+      if (!econn) return NULL;
+    }
   }
-  dbus_error_free(&err);
-  e_dbus_connection_ref(econn);
+
+  if (!econn)
+  {
+    dbus_error_init(&err);
+    conn = dbus_connection_open_private(address, &err);
+    if (dbus_error_is_set(&err))
+    {
+      ERR("Error connecting to bus: %s", err.message);
+      dbus_error_free(&err);
+      return NULL;
+    }
+
+    econn = e_dbus_connection_setup(conn);
+    if (!econn)
+    {
+      ERR("Error setting up dbus connection.");
+      dbus_connection_close(conn);
+      dbus_connection_unref(conn);
+      return NULL;
+    }
+    econn->ready = 0;
+
+    /* one reference for the caller and one held by the Hello call, dropped
+     * in cb_hello() */
+    e_dbus_connection_ref(econn);
+    e_dbus_connection_ref(econn);
+    msg = dbus_message_new_method_call(E_DBUS_FDO_BUS, E_DBUS_FDO_PATH,
+                                       E_DBUS_FDO_INTERFACE, "Hello");
+    if (msg)
+      econn->hello_pending = e_dbus_message_send(econn, msg, cb_hello, -1, econn);
+    if (!econn->hello_pending)
+    {
+      ERR("Error sending Hello to the bus.");
+      if (msg) dbus_message_unref(msg);
+      e_dbus_connection_close(econn);
+      e_dbus_connection_close(econn);
+      return NULL;
+    }
+    dbus_message_unref(msg);
+
+    if (type == DBUS_BUS_SYSTEM || type == DBUS_BUS_SESSION)
+    {
+      econn->shared_type = type;
+      shared_connections[type] = econn;
+    }
+  }
+
+  if (cb)
+  {
+    E_DBus_Ready_Waiter *w;
+
+    w = malloc(sizeof(E_DBus_Ready_Waiter));
+    if (!w)
+    {
+      ERR("could not allocate ready waiter.");
+      return econn;
+    }
+    w->cb = cb;
+    w->data = (void *)data;
+    econn->ready_waiters = eina_list_append(econn->ready_waiters, w);
+    if (econn->ready && !econn->ready_idler)
+      econn->ready_idler = ecore_idler_add(e_dbus_connection_ready_idler, econn);
+  }
+
   return econn;
 }
 
+EAPI Eina_Bool
+e_dbus_connection_ready_get(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, EINA_FALSE);
+  return !!conn->ready;
+}
+
 EAPI E_DBus_Connection *
 e_dbus_connection_setup(DBusConnection *conn)
 {
@@ -503,6 +835,7 @@ e_dbus_connection_setup(DBusConnection *conn)
   dbus_connection_add_filter(cd->conn, e_dbus_filter, cd, NULL);
 
   cb_dispatch_status(cd->conn, dbus_connection_get_dispatch_status(cd->conn), cd);
+  e_dbus_connection_record_env(cd);
 
   return cd;
 }
@@ -520,6 +853,13 @@ e_dbus_connection_close(E_DBus_Connection *conn)
   }
   if (--(conn->refcount) != 0) return;
 
+  e_dbus_connection_cork_flush(conn);
+  if (conn->uncorker)
+    {
+      ecore_idle_enterer_del(conn->uncorker);
+      conn->uncorker = NULL;
+    }
+
   dbus_connection_free_data_slot(&connection_slot);
   dbus_connection_remove_filter(conn->conn, e_dbus_filter, conn);
   dbus_connection_set_watch_functions (conn->conn,
@@ -549,6 +889,216 @@ e_dbus_connection_close(E_DBus_Connection *conn)
   // Note: the E_DBus_Connection gets freed when the dbus_connection is cleaned up by the previous unref
 }
 
+void
+e_dbus_connection_outgoing_check(E_DBus_Connection *conn)
+{
+  long size;
+
+  if (!conn->outgoing_high) return;
+
+  size = dbus_connection_get_outgoing_size(conn->conn);
+  if (!conn->outgoing_congested && size >= conn->outgoing_high)
+  {
+    DBG("outgoing queue over high water mark (%ld bytes)", size);
+    conn->outgoing_congested = 1;
+    if (conn->outgoing_cb)
+      conn->outgoing_cb(conn->outgoing_data, conn, EINA_TRUE);
+  }
+  else if (conn->outgoing_congested && size <= conn->outgoing_low)
+  {
+    DBG("outgoing queue under low water mark (%ld bytes)", size);
+    conn->outgoing_congested = 0;
+    if (conn->outgoing_cb)
+      conn->outgoing_cb(conn->outgoing_data, conn, EINA_FALSE);
+  }
+}
+
+EAPI void
+e_dbus_connection_outgoing_limits_set(E_DBus_Connection *conn, long high, long low, E_DBus_Outgoing_Cb cb, const void *data)
+{
+  EINA_SAFETY_ON_NULL_RETURN(conn);
+  EINA_SAFETY_ON_TRUE_RETURN(high < 0 || low < 0);
+  EINA_SAFETY_ON_TRUE_RETURN(high && low >= high);
+
+  /* release a producer that throttled itself before the limits go away */
+  if (!high && conn->outgoing_congested)
+  {
+    conn->outgoing_congested = 0;
+    if (conn->outgoing_cb)
+      conn->outgoing_cb(conn->outgoing_data, conn, EINA_FALSE);
+  }
+
+  conn->outgoing_high = high;
+  conn->outgoing_low = low;
+  conn->outgoing_cb = cb;
+  conn->outgoing_data = (void *)data;
+  if (!high) return;
+  e_dbus_connection_outgoing_check(conn);
+}
+
+static Eina_Bool
+e_dbus_uncorker(void *data)
+{
+  E_DBus_Connection *cd = data;
+
+  cd->uncorker = NULL;
+  e_dbus_connection_cork_flush(cd);
+  return ECORE_CALLBACK_CANCEL;
+}
+
+Eina_Bool
+e_dbus_connection_cork_queue(E_DBus_Connection *conn, DBusMessage *msg)
+{
+  if (!conn->corked) return EINA_FALSE;
+
+  dbus_message_ref(msg);
+  conn->corked_messages = eina_list_append(conn->corked_messages, msg);
+  if (!conn->uncorker)
+    conn->uncorker = ecore_idle_enterer_add(e_dbus_uncorker, conn);
+  return EINA_TRUE;
+}
+
+void
+e_dbus_connection_cork_flush(E_DBus_Connection *conn)
+{
+  DBusMessage *msg;
+
+  if (!conn->corked_messages) return;
+
+  DBG("flushing %d corked messages", eina_list_count(conn->corked_messages));
+  EINA_LIST_FREE(conn->corked_messages, msg)
+  {
+    dbus_connection_send(conn->conn, msg, NULL);
+    if (conn->record) e_dbus_connection_record(conn, msg, E_DBUS_RECORD_OUT);
+    E_DBUS_TRACE(conn, msg, E_DBUS_TRACE_SEND);
+    dbus_message_unref(msg);
+  }
+  e_dbus_connection_outgoing_check(conn);
+}
+
+EAPI void
+e_dbus_connection_cork(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN(conn);
+  conn->corked++;
+}
+
+EAPI void
+e_dbus_connection_uncork(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN(conn);
+  EINA_SAFETY_ON_FALSE_RETURN(conn->corked > 0);
+
+  if (--conn->corked) return;
+
+  if (conn->uncorker)
+  {
+    ecore_idle_enterer_del(conn->uncorker);
+    conn->uncorker = NULL;
+  }
+  e_dbus_connection_cork_flush(conn);
+}
+
+EAPI Eina_Bool
+e_dbus_connection_congested_get(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, EINA_FALSE);
+  return !!conn->outgoing_congested;
+}
+
+EAPI long
+e_dbus_connection_outgoing_size_get(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, 0);
+  return dbus_connection_get_outgoing_size(conn->conn);
+}
+
+EAPI unsigned int
+e_dbus_connection_outgoing_dropped_get(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, 0);
+  return conn->outgoing_dropped;
+}
+
+EAPI Eina_Bool
+e_dbus_connection_priority_set(E_DBus_Connection *conn, const char *interface, const char *member, E_DBus_Priority priority)
+{
+  char key[512];
+
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, EINA_FALSE);
+  EINA_SAFETY_ON_TRUE_RETURN_VAL(!interface && !member, EINA_FALSE);
+  EINA_SAFETY_ON_TRUE_RETURN_VAL(priority < E_DBUS_PRIORITY_NORMAL || priority > E_DBUS_PRIORITY_BULK, EINA_FALSE);
+
+  snprintf(key, sizeof(key), "%s %s", interface ? interface : "", member ? member : "");
+  if (priority == E_DBUS_PRIORITY_NORMAL)
+  {
+    if (conn->priorities) eina_hash_del_by_key(conn->priorities, key);
+    return EINA_TRUE;
+  }
+
+  if (!conn->priorities)
+  {
+    conn->priorities = eina_hash_string_superfast_new(NULL);
+    if (!conn->priorities) return EINA_FALSE;
+  }
+  eina_hash_set(conn->priorities, key, (void *)((long)priority + 1));
+  return EINA_TRUE;
+}
+
+EAPI void
+e_dbus_connection_handler_budget_set(E_DBus_Connection *conn, double budget, E_DBus_Slow_Handler_Cb cb, const void *data)
+{
+  EINA_SAFETY_ON_NULL_RETURN(conn);
+  EINA_SAFETY_ON_TRUE_RETURN(budget < 0.0);
+
+  conn->handler_budget = budget;
+  conn->slow_cb = cb;
+  conn->slow_data = (void *)data;
+}
+
+EAPI double
+e_dbus_connection_handler_budget_get(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, 0.0);
+  return conn->handler_budget;
+}
+
+EAPI unsigned int
+e_dbus_connection_slow_handlers_get(E_DBus_Connection *conn, double *worst)
+{
+  if (worst) *worst = 0.0;
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, 0);
+  if (worst) *worst = conn->slow_worst;
+  return conn->slow_count;
+}
+
+EAPI double
+e_dbus_connection_handler_begin(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, 0.0);
+  if (conn->handler_budget <= 0.0) return 0.0;
+  return ecore_time_get();
+}
+
+EAPI void
+e_dbus_connection_handler_end(E_DBus_Connection *conn, double start, const char *kind, const char *interface, const char *member)
+{
+  double duration;
+
+  if (start <= 0.0) return;
+  EINA_SAFETY_ON_NULL_RETURN(conn);
+  if (conn->handler_budget <= 0.0) return;
+
+  duration = ecore_time_get() - start;
+  if (duration <= conn->handler_budget) return;
+
+  conn->slow_count++;
+  if (duration > conn->slow_worst) conn->slow_worst = duration;
+  DBG("slow %s handler for %s.%s: %.3fs", kind, interface ? interface : "", member ? member : "", duration);
+  if (conn->slow_cb)
+    conn->slow_cb(conn->slow_data, conn, kind, interface, member, duration);
+}
+
 EAPI void
 e_dbus_connection_ref(E_DBus_Connection *conn)
 {
@@ -592,6 +1142,7 @@ e_dbus_init(void)
 
   E_DBUS_EVENT_SIGNAL = ecore_event_type_new();
   e_dbus_object_init();
+  e_dbus_trace_env();
 
   return _edbus_init_count;
 }
@@ -607,6 +1158,7 @@ e_dbus_shutdown(void)
    if (--_edbus_init_count)
     return _edbus_init_count;
 
+  e_dbus_trace_stop();
   e_dbus_object_shutdown();
   ecore_shutdown();
   eina_log_domain_unregister(_e_dbus_log_dom);
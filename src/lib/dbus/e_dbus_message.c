@@ -10,16 +10,34 @@
 typedef struct E_DBus_Pending_Call_Data E_DBus_Pending_Call_Data;
 struct E_DBus_Pending_Call_Data
 {
+  E_DBus_Connection      *conn;
   E_DBus_Method_Return_Cb cb_return;
   void                   *data;
+  unsigned long long      sent;
+  const char             *interface; /* of the call, only with a handler budget */
+  const char             *member;
 };
 
+E_DBUS_PROBE_DEFINE(edbus, reply);
+
+static void
+e_dbus_pending_call_data_free(void *user_data)
+{
+  E_DBus_Pending_Call_Data *data = user_data;
+
+  eina_stringshare_del(data->interface);
+  eina_stringshare_del(data->member);
+  free(data);
+}
+
 static void
 cb_pending(DBusPendingCall *pending, void *user_data)
 {
   DBusMessage *msg;
   DBusError err;
   E_DBus_Pending_Call_Data *data = user_data;
+  unsigned long long t0 = 0;
+  double start;
 
   if (!dbus_pending_call_get_completed(pending))
   {
@@ -42,6 +60,14 @@ cb_pending(DBusPendingCall *pending, void *user_data)
     return;
   }
 
+  /* replies to pending calls never reach the connection filter */
+  if (data->conn->record)
+    e_dbus_connection_record(data->conn, msg, E_DBUS_RECORD_IN);
+  E_DBUS_TRACE(data->conn, msg, E_DBUS_TRACE_DISPATCH);
+
+  if (E_DBUS_PROBE_ENABLED(edbus, reply)) t0 = E_DBUS_PROBE_TIME();
+  start = e_dbus_connection_handler_begin(data->conn);
+
   if (dbus_set_error_from_message(&err, msg))
   {
     if (data->cb_return)
@@ -54,6 +80,12 @@ cb_pending(DBusPendingCall *pending, void *user_data)
       data->cb_return(data->data, msg, &err);
   }
 
+  e_dbus_connection_handler_end(data->conn, start, "reply", data->interface, data->member);
+  if (t0)
+    E_DBUS_PROBE3(edbus, reply, dbus_message_get_reply_serial(msg),
+                  data->sent ? t0 - data->sent : 0,
+                  E_DBUS_PROBE_TIME() - t0);
+
   dbus_message_unref(msg);
   dbus_pending_call_unref(pending);
 }
@@ -64,20 +96,39 @@ e_dbus_message_send(E_DBus_Connection *conn, DBusMessage *msg, E_DBus_Method_Ret
 {
   DBusPendingCall *pending;
 
+  if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_METHOD_CALL)
+  {
+    if (e_dbus_connection_cork_queue(conn, msg)) return NULL;
+  }
+  else
+    e_dbus_connection_cork_flush(conn);
+
   if (!dbus_connection_send_with_reply(conn->conn, msg, &pending, timeout))
     return NULL;
+  if (conn->record) e_dbus_connection_record(conn, msg, E_DBUS_RECORD_OUT);
+  E_DBUS_TRACE(conn, msg, E_DBUS_TRACE_SEND);
+  e_dbus_connection_outgoing_check(conn);
 
   if (cb_return && pending)
   {
     E_DBus_Pending_Call_Data *pdata;
 
     pdata = malloc(sizeof(E_DBus_Pending_Call_Data));
+    pdata->conn = conn;
     pdata->cb_return = cb_return;
     pdata->data = data;
+    pdata->sent = E_DBUS_PROBE_ENABLED(edbus, reply) ? E_DBUS_PROBE_TIME() : 0;
+    pdata->interface = NULL;
+    pdata->member = NULL;
+    if (conn->handler_budget > 0.0)
+    {
+      pdata->interface = eina_stringshare_add(dbus_message_get_interface(msg));
+      pdata->member = eina_stringshare_add(dbus_message_get_member(msg));
+    }
 
-    if (!dbus_pending_call_set_notify(pending, cb_pending, pdata, free))
+    if (!dbus_pending_call_set_notify(pending, cb_pending, pdata, e_dbus_pending_call_data_free))
     {
-      free(pdata);
+      e_dbus_pending_call_data_free(pdata);
       dbus_message_unref(msg);
       dbus_pending_call_cancel(pending);
       return NULL;
@@ -87,6 +138,41 @@ e_dbus_message_send(E_DBus_Connection *conn, DBusMessage *msg, E_DBus_Method_Ret
   return pending;
 }
 
+EAPI DBusPendingCall *
+e_dbus_message_send_try(E_DBus_Connection *conn, DBusMessage *msg, E_DBus_Method_Return_Cb cb_return, int timeout, void *data)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, NULL);
+  EINA_SAFETY_ON_NULL_RETURN_VAL(msg, NULL);
+
+  if (conn->outgoing_congested)
+  {
+    DBG("connection congested, not sending %s", dbus_message_get_member(msg));
+    return NULL;
+  }
+  return e_dbus_message_send(conn, msg, cb_return, timeout, data);
+}
+
+EAPI Eina_Bool
+e_dbus_signal_send(E_DBus_Connection *conn, DBusMessage *msg)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, EINA_FALSE);
+  EINA_SAFETY_ON_NULL_RETURN_VAL(msg, EINA_FALSE);
+
+  if (conn->outgoing_congested)
+  {
+    conn->outgoing_dropped++;
+    DBG("connection congested, dropping signal %s", dbus_message_get_member(msg));
+    return EINA_FALSE;
+  }
+
+  if (e_dbus_connection_cork_queue(conn, msg)) return EINA_TRUE;
+  if (!dbus_connection_send(conn->conn, msg, NULL))
+    return EINA_FALSE;
+  if (conn->record) e_dbus_connection_record(conn, msg, E_DBUS_RECORD_OUT);
+  e_dbus_connection_outgoing_check(conn);
+  return EINA_TRUE;
+}
+
 static void
 cb_method_call(void *data, DBusMessage *msg, DBusError *err)
 {
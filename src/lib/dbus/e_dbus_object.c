@@ -45,6 +45,9 @@ static DBusObjectPathVTable vtable = {
   NULL
 };
 
+E_DBUS_PROBE_DEFINE(edbus, method_entry);
+E_DBUS_PROBE_DEFINE(edbus, method_return);
+
 struct E_DBus_Object
 {
   E_DBus_Connection *conn;
@@ -518,6 +521,8 @@ e_dbus_object_handler(DBusConnection *conn, DBusMessage *message, void *user_dat
   E_DBus_Method *m;
   DBusMessage *reply;
   dbus_uint32_t serial;
+  unsigned long long t0 = 0;
+  double start;
 
   obj = user_data;
   if (!obj)
@@ -529,16 +534,36 @@ e_dbus_object_handler(DBusConnection *conn, DBusMessage *message, void *user_dat
   if (!m) 
     return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
 
+  if (E_DBUS_PROBE_ENABLED(edbus, method_entry))
+    E_DBUS_PROBE3(edbus, method_entry, dbus_message_get_serial(message),
+                  dbus_message_get_interface(message), dbus_message_get_member(message));
+  if (E_DBUS_PROBE_ENABLED(edbus, method_return)) t0 = E_DBUS_PROBE_TIME();
+  start = e_dbus_connection_handler_begin(obj->conn);
+
   if (m->signature && !dbus_message_has_signature(message, m->signature))
     reply = dbus_message_new_error_printf(message, "org.enlightenment.InvalidSignature", "Expected signature: %s", m->signature);
   else
     reply = m->func(obj, message);
 
+  e_dbus_connection_handler_end(obj->conn, start, "method", dbus_message_get_interface(message),
+                                dbus_message_get_member(message));
+  if (t0)
+    E_DBUS_PROBE4(edbus, method_return, dbus_message_get_serial(message),
+                  dbus_message_get_interface(message), dbus_message_get_member(message),
+                  E_DBUS_PROBE_TIME() - t0);
+
   /* user can choose reply later */
   if (!reply)
     return DBUS_HANDLER_RESULT_HANDLED;
 
-  dbus_connection_send(conn, reply, &serial);
+  if (!e_dbus_connection_cork_queue(obj->conn, reply))
+  {
+    dbus_connection_send(conn, reply, &serial);
+    if (obj->conn->record)
+      e_dbus_connection_record(obj->conn, reply, E_DBUS_RECORD_OUT);
+    E_DBUS_TRACE(obj->conn, reply, E_DBUS_TRACE_SEND);
+    e_dbus_connection_outgoing_check(obj->conn);
+  }
   dbus_message_unref(reply);
 
   return DBUS_HANDLER_RESULT_HANDLED;
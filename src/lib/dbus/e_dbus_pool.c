@@ -0,0 +1,133 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "e_dbus_private.h"
+
+struct E_DBus_Connection_Pool
+{
+  DBusBusType type;
+  unsigned int size;
+  unsigned int next;
+  E_DBus_Connection **conns;
+  Eina_Hash *destinations;
+};
+
+EAPI E_DBus_Connection_Pool *
+e_dbus_connection_pool_new(DBusBusType type, unsigned int size)
+{
+  E_DBus_Connection_Pool *pool;
+  unsigned int i;
+
+  EINA_SAFETY_ON_TRUE_RETURN_VAL(size < 1, NULL);
+
+  pool = calloc(1, sizeof(E_DBus_Connection_Pool));
+  if (!pool) return NULL;
+
+  pool->conns = calloc(size, sizeof(E_DBus_Connection *));
+  if (!pool->conns) goto error;
+
+  pool->destinations = eina_hash_string_superfast_new(NULL);
+  if (!pool->destinations) goto error;
+
+  pool->type = type;
+  pool->conns[0] = e_dbus_bus_get(type);
+  if (!pool->conns[0]) goto error;
+  pool->size = 1;
+
+  for (i = 1; i < size; i++)
+  {
+    pool->conns[i] = e_dbus_bus_get_private(type);
+    if (!pool->conns[i])
+    {
+      ERR("could only open %u of %u pool connections.", i, size);
+      break;
+    }
+    pool->size++;
+  }
+
+  DBG("connection pool %p with %u connections", pool, pool->size);
+  return pool;
+
+error:
+  ERR("could not create connection pool.");
+  if (pool->destinations) eina_hash_free(pool->destinations);
+  free(pool->conns);
+  free(pool);
+  return NULL;
+}
+
+EAPI void
+e_dbus_connection_pool_free(E_DBus_Connection_Pool *pool)
+{
+  unsigned int i;
+
+  if (!pool) return;
+
+  for (i = 0; i < pool->size; i++)
+    e_dbus_connection_close(pool->conns[i]);
+
+  eina_hash_free(pool->destinations);
+  free(pool->conns);
+  free(pool);
+}
+
+EAPI E_DBus_Connection *
+e_dbus_connection_pool_primary_get(E_DBus_Connection_Pool *pool)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(pool, NULL);
+  return pool->conns[0];
+}
+
+EAPI E_DBus_Connection *
+e_dbus_connection_pool_get(E_DBus_Connection_Pool *pool, const char *destination)
+{
+  unsigned long idx;
+  void *found;
+
+  EINA_SAFETY_ON_NULL_RETURN_VAL(pool, NULL);
+
+  if (pool->size == 1) return pool->conns[0];
+  if (destination && !strcmp(destination, E_DBUS_FDO_BUS))
+    return pool->conns[0];
+
+  if (!destination)
+  {
+    idx = pool->next++ % pool->size;
+    return pool->conns[idx];
+  }
+
+  /* unique names come and go, binding them would grow the table without
+   * bound, hashing still keeps each one on a single connection */
+  if (destination[0] == ':')
+    return pool->conns[(unsigned int)eina_hash_superfast(destination, strlen(destination)) % pool->size];
+
+  /* indexes are stored off by one so that 0 means "not bound yet" */
+  found = eina_hash_find(pool->destinations, destination);
+  if (found) return pool->conns[(unsigned long)found - 1];
+
+  idx = pool->next++ % pool->size;
+  eina_hash_add(pool->destinations, destination, (void *)(idx + 1));
+  DBG("destination %s bound to pool connection %lu", destination, idx);
+  return pool->conns[idx];
+}
+
+EAPI DBusPendingCall *
+e_dbus_connection_pool_message_send(E_DBus_Connection_Pool *pool, DBusMessage *msg, E_DBus_Method_Return_Cb cb_return, int timeout, void *data)
+{
+  E_DBus_Connection *conn;
+
+  EINA_SAFETY_ON_NULL_RETURN_VAL(pool, NULL);
+  EINA_SAFETY_ON_NULL_RETURN_VAL(msg, NULL);
+
+  /* only calls are spread, signals and replies carry the sender's name and
+   * must leave from the primary connection the peers know */
+  if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_METHOD_CALL)
+    conn = e_dbus_connection_pool_get(pool, dbus_message_get_destination(msg));
+  else
+    conn = pool->conns[0];
+  return e_dbus_message_send(conn, msg, cb_return, timeout, data);
+}
@@ -4,6 +4,7 @@
 #include <Ecore.h>
 
 #include "E_DBus.h"
+#include "e_dbus_probes.h"
 
 #ifndef E_DBUS_COLOR_DEFAULT
 #define E_DBUS_COLOR_DEFAULT EINA_COLOR_CYAN
@@ -15,6 +16,8 @@ EAPI extern int _e_dbus_log_dom;
 #define ERR(...)   EINA_LOG_DOM_ERR(_e_dbus_log_dom, __VA_ARGS__)
 
 
+typedef struct E_DBus_Record E_DBus_Record;
+
 struct E_DBus_Connection
 {
   DBusBusType shared_type;
@@ -28,6 +31,34 @@ struct E_DBus_Connection
 
   Ecore_Idler *idler;
 
+  long outgoing_high;
+  long outgoing_low;
+  int outgoing_congested;
+  unsigned int outgoing_dropped;
+  E_DBus_Outgoing_Cb outgoing_cb;
+  void *outgoing_data;
+
+  int corked;
+  Eina_List *corked_messages;
+  Ecore_Idle_Enterer *uncorker;
+
+  int ready;
+  Eina_List *ready_waiters;
+  Ecore_Idler *ready_idler;
+  DBusPendingCall *hello_pending;
+
+  E_DBus_Record *record;
+
+  double handler_budget;
+  E_DBus_Slow_Handler_Cb slow_cb;
+  void *slow_data;
+  unsigned int slow_count;
+  double slow_worst;
+
+  Eina_Hash *priorities;
+  Eina_List *bulk_signals;
+  unsigned int bulk_interleave;
+
   int refcount;
 };
 
@@ -39,12 +70,27 @@ struct E_DBus_Callback
   void *user_data;
 };
 
+E_DBus_Connection *e_dbus_bus_get_private(DBusBusType type);
+
 int  e_dbus_object_init(void);
 void e_dbus_object_shutdown(void);
 
 extern int e_dbus_idler_active;
+void e_dbus_connection_outgoing_check(E_DBus_Connection *conn);
+Eina_Bool e_dbus_connection_cork_queue(E_DBus_Connection *conn, DBusMessage *msg);
+void e_dbus_connection_cork_flush(E_DBus_Connection *conn);
 void e_dbus_signal_handlers_clean(E_DBus_Connection *conn);
+void e_dbus_deferred_run(E_DBus_Connection *cd);
 void e_dbus_signal_handlers_free_all(E_DBus_Connection *conn);
+void e_dbus_connection_record(E_DBus_Connection *conn, DBusMessage *msg, unsigned char direction);
+void e_dbus_connection_record_env(E_DBus_Connection *conn);
+
+extern int e_dbus_trace_active;
+void e_dbus_trace_message(E_DBus_Connection *conn, DBusMessage *msg, unsigned char event);
+void e_dbus_trace_read(E_DBus_Connection *conn);
+void e_dbus_trace_env(void);
+#define E_DBUS_TRACE(conn, msg, event) \
+  do { if (e_dbus_trace_active) e_dbus_trace_message(conn, msg, event); } while (0)
 
 
 const char *e_dbus_basic_type_as_string(int type);
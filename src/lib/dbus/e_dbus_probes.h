@@ -0,0 +1,77 @@
+#ifndef E_DBUS_PROBES_H
+#define E_DBUS_PROBES_H
+
+/*
+ * Static tracepoints (USDT) for perf, bpftrace or systemtap.
+ *
+ * libedbus, provider "edbus":
+ *   message_receive(type, serial, interface, member)  e_dbus_filter()
+ *   dispatch_start(connection)                        e_dbus_idler()
+ *   dispatch_end(connection, duration_us)
+ *   method_entry(serial, interface, member)           e_dbus_object_handler()
+ *   method_return(serial, interface, member, duration_us)
+ *   reply(reply_serial, latency_us, duration_us)      cb_pending()
+ *   signal_handler(serial, interface, member, duration_us)
+ *
+ * and the element based libraries, providers "ebluez", "econnman" and
+ * "eofono":
+ *   property_update(path, name, type, changed)
+ *
+ * latency_us is the time from sending the call, or 0 if nothing was
+ * attached then; changed is 1 when the value changed, 0 when it was the
+ * same and 2 for a new property.  For example:
+ *
+ *   bpftrace -e 'usdt:libedbus.so:edbus:method_return
+ *     { @[str(arg1), str(arg2)] = hist(arg3); }'
+ *
+ * Each probe has a semaphore that tracers increment while attached.  The
+ * probe sites check it with E_DBUS_PROBE_ENABLED() before reading their
+ * arguments from the message or taking timestamps, since STAP_PROBE*
+ * evaluates its operands even with no tracer.  Without sys/sdt.h it all
+ * compiles away.  A probe is declared once in the file using it with
+ * E_DBUS_PROBE_DEFINE(provider, name).
+ */
+
+#ifdef HAVE_SYS_SDT_H
+
+# define _SDT_HAS_SEMAPHORES 1
+# include <sys/sdt.h>
+
+# define E_DBUS_PROBE_DEFINE(provider, name) \
+   __extension__ unsigned short provider##_##name##_semaphore \
+   __attribute__((used, section(".probes"), visibility("hidden")))
+
+# define E_DBUS_PROBE_ENABLED(provider, name) \
+   __builtin_expect(provider##_##name##_semaphore, 0)
+
+# define E_DBUS_PROBE1(provider, name, a) \
+   STAP_PROBE1(provider, name, a)
+# define E_DBUS_PROBE2(provider, name, a, b) \
+   STAP_PROBE2(provider, name, a, b)
+# define E_DBUS_PROBE3(provider, name, a, b, c) \
+   STAP_PROBE3(provider, name, a, b, c)
+# define E_DBUS_PROBE4(provider, name, a, b, c, d) \
+   STAP_PROBE4(provider, name, a, b, c, d)
+
+#else
+
+# define E_DBUS_PROBE_DEFINE(provider, name) \
+   extern int e_dbus_probes_unused
+# define E_DBUS_PROBE_ENABLED(provider, name) 0
+/* never evaluated, only keeps the arguments "used" */
+# define E_DBUS_PROBE1(provider, name, a) \
+   do { if (0) { (void)(a); } } while (0)
+# define E_DBUS_PROBE2(provider, name, a, b) \
+   do { if (0) { (void)(a); (void)(b); } } while (0)
+# define E_DBUS_PROBE3(provider, name, a, b, c) \
+   do { if (0) { (void)(a); (void)(b); (void)(c); } } while (0)
+# define E_DBUS_PROBE4(provider, name, a, b, c, d) \
+   do { if (0) { (void)(a); (void)(b); (void)(c); (void)(d); } } while (0)
+
+#endif
+
+/* timestamp in microseconds for the duration arguments */
+#define E_DBUS_PROBE_TIME() \
+   ((unsigned long long)(ecore_time_get() * 1000000.0))
+
+#endif
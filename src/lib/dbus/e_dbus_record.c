@@ -0,0 +1,121 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "e_dbus_private.h"
+
+#if (DBUS_VERSION_MAJOR == 1 && DBUS_VERSION_MINOR == 1 && DBUS_VERSION_MICRO>= 1) || (DBUS_VERSION_MAJOR == 1 && DBUS_VERSION_MINOR > 1) || (DBUS_VERSION_MAJOR > 1)
+#define E_DBUS_RECORD_SUPPORTED 1
+#endif
+
+struct E_DBus_Record
+{
+  FILE *file;
+  double start;
+};
+
+static unsigned int record_env_count = 0;
+
+void
+e_dbus_connection_record(E_DBus_Connection *conn, DBusMessage *msg, unsigned char direction)
+{
+#ifdef E_DBUS_RECORD_SUPPORTED
+  E_DBus_Record_Entry entry;
+  char *buf = NULL;
+  int len = 0;
+
+  if (!dbus_message_marshal(msg, &buf, &len))
+  {
+    ERR("could not marshal message for the capture");
+    return;
+  }
+
+  memset(&entry, 0, sizeof(entry));
+  entry.usec = (ecore_time_get() - conn->record->start) * 1000000.0;
+  entry.length = len;
+  entry.direction = direction;
+
+  if ((fwrite(&entry, sizeof(entry), 1, conn->record->file) != 1) ||
+      (fwrite(buf, len, 1, conn->record->file) != 1))
+  {
+    ERR("could not write the capture, stopping it");
+    e_dbus_connection_record_stop(conn);
+  }
+  free(buf);
+#else
+  (void)conn;
+  (void)msg;
+  (void)direction;
+#endif
+}
+
+void
+e_dbus_connection_record_env(E_DBus_Connection *conn)
+{
+  const char *prefix;
+  char file[4096];
+
+  prefix = getenv("E_DBUS_RECORD");
+  if (!prefix || !prefix[0]) return;
+
+  snprintf(file, sizeof(file), "%s.%d.%u", prefix, (int)getpid(), record_env_count++);
+  if (e_dbus_connection_record_start(conn, file))
+    INFO("recording connection %p to %s", conn, file);
+}
+
+EAPI Eina_Bool
+e_dbus_connection_record_start(E_DBus_Connection *conn, const char *file)
+{
+#ifdef E_DBUS_RECORD_SUPPORTED
+  E_DBus_Record *record;
+
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, EINA_FALSE);
+  EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+
+  e_dbus_connection_record_stop(conn);
+
+  record = calloc(1, sizeof(E_DBus_Record));
+  if (!record) return EINA_FALSE;
+
+  record->file = fopen(file, "wb");
+  if (!record->file)
+  {
+    ERR("could not create capture file %s", file);
+    free(record);
+    return EINA_FALSE;
+  }
+  if (fwrite(E_DBUS_RECORD_MAGIC, 8, 1, record->file) != 1)
+  {
+    ERR("could not write capture file %s", file);
+    fclose(record->file);
+    free(record);
+    return EINA_FALSE;
+  }
+
+  record->start = ecore_time_get();
+  conn->record = record;
+  return EINA_TRUE;
+#else
+  EINA_SAFETY_ON_NULL_RETURN_VAL(conn, EINA_FALSE);
+  EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+  ERR("libdbus is too old to record messages, 1.1.1 is needed");
+  return EINA_FALSE;
+#endif
+}
+
+EAPI void
+e_dbus_connection_record_stop(E_DBus_Connection *conn)
+{
+  EINA_SAFETY_ON_NULL_RETURN(conn);
+
+  if (!conn->record) return;
+
+  fclose(conn->record->file);
+  free(conn->record);
+  conn->record = NULL;
+}
@@ -30,9 +30,27 @@ struct E_DBus_Signal_Handler
    DBusPendingCall *get_name_owner_pending;
    void *data;
    unsigned char delete_me : 1;
+
+   E_DBus_Connection *conn;
+   double coalesce_window;
+   int coalesce_arg;
+   Ecore_Timer *coalesce_timer;
+   Eina_Hash *coalesce_pending; /* key -> E_DBus_Coalesced */
+   Eina_List *coalesce_order;
+};
+
+typedef struct E_DBus_Coalesced E_DBus_Coalesced;
+
+struct E_DBus_Coalesced
+{
+   char *key;
+   DBusMessage *msg;
 };
 
 static void cb_signal_dispatcher(E_DBus_Connection *conn, DBusMessage *msg);
+static void e_dbus_signal_handler_coalesce_flush(E_DBus_Signal_Handler *sh, Eina_Bool deliver);
+
+E_DBUS_PROBE_DEFINE(edbus, signal_handler);
 
 /*
  * Free a signal handler
@@ -41,6 +59,8 @@ static void cb_signal_dispatcher(E_DBus_Connection *conn, DBusMessage *msg);
 static void
 e_dbus_signal_handler_free(E_DBus_Signal_Handler *sh)
 {
+  e_dbus_signal_handler_coalesce_flush(sh, EINA_FALSE);
+  if (sh->coalesce_pending) eina_hash_free(sh->coalesce_pending);
   free(sh->sender);
   free(sh->interface);
   free(sh->path);
@@ -101,7 +121,6 @@ e_dbus_signal_handler_add(E_DBus_Connection *conn, const char *sender, const cha
 {
   E_DBus_Signal_Handler *sh;
   Eina_Strbuf *match;
-  DBusError err;
 
   sh = calloc(1, sizeof(E_DBus_Signal_Handler));
   if (!sh)
@@ -128,9 +147,26 @@ e_dbus_signal_handler_add(E_DBus_Connection *conn, const char *sender, const cha
   sh->get_name_owner_pending = NULL;
   sh->data = data;
   sh->delete_me = 0;
+  sh->conn = conn;
+  sh->coalesce_arg = -1;
+
+  /* while an e_dbus_bus_get_async() connection waits for its Hello reply
+   * do not block on the daemon, the match is queued in order after Hello.
+   */
+  if (conn->ready)
+    {
+       DBusError err;
 
-  dbus_error_init(&err);
-  dbus_bus_add_match(conn->conn, sh->match, &err);
+       dbus_error_init(&err);
+       dbus_bus_add_match(conn->conn, sh->match, &err);
+       if (dbus_error_is_set(&err))
+         {
+            ERR("could not add match %s: %s", sh->match, err.message);
+            dbus_error_free(&err);
+         }
+    }
+  else
+    dbus_bus_add_match(conn->conn, sh->match, NULL);
 
   if (!conn->signal_handlers) conn->signal_dispatcher = cb_signal_dispatcher;
 
@@ -199,6 +235,153 @@ e_dbus_signal_handler_del(E_DBus_Connection *conn, E_DBus_Signal_Handler *sh)
    e_dbus_signal_handler_free(sh);
 }
 
+static void
+e_dbus_signal_handler_call(E_DBus_Connection *conn, E_DBus_Signal_Handler *sh, DBusMessage *msg)
+{
+  if ((conn->handler_budget > 0.0) || E_DBUS_PROBE_ENABLED(edbus, signal_handler))
+  {
+    double start = ecore_time_get();
+
+    sh->cb_signal(sh->data, msg);
+    E_DBUS_PROBE4(edbus, signal_handler, dbus_message_get_serial(msg),
+                  dbus_message_get_interface(msg), dbus_message_get_member(msg),
+                  (unsigned long long)((ecore_time_get() - start) * 1000000.0));
+    e_dbus_connection_handler_end(conn, start, "signal", dbus_message_get_interface(msg),
+                                  dbus_message_get_member(msg));
+  }
+  else
+    sh->cb_signal(sh->data, msg);
+}
+
+static void
+e_dbus_signal_handler_coalesce_flush(E_DBus_Signal_Handler *sh, Eina_Bool deliver)
+{
+  E_DBus_Coalesced *c;
+  Eina_List *order;
+
+  if (sh->coalesce_timer)
+  {
+    ecore_timer_del(sh->coalesce_timer);
+    sh->coalesce_timer = NULL;
+  }
+
+  /* the handler may be deleted, or coalesce again, from its callback */
+  order = sh->coalesce_order;
+  sh->coalesce_order = NULL;
+  EINA_LIST_FREE(order, c)
+  {
+    eina_hash_del_by_key(sh->coalesce_pending, c->key);
+    if (deliver && !sh->delete_me)
+      e_dbus_signal_handler_call(sh->conn, sh, c->msg);
+    dbus_message_unref(c->msg);
+    free(c->key);
+    free(c);
+  }
+}
+
+static Eina_Bool
+cb_signal_coalesce_timer(void *data)
+{
+  E_DBus_Signal_Handler *sh = data;
+  E_DBus_Connection *conn = sh->conn;
+
+  /* defer deletions and closes from the callbacks as during dispatch */
+  sh->coalesce_timer = NULL;
+  e_dbus_idler_active++;
+  e_dbus_signal_handler_coalesce_flush(sh, EINA_TRUE);
+  e_dbus_idler_active--;
+  e_dbus_deferred_run(conn);
+  return ECORE_CALLBACK_CANCEL;
+}
+
+static void
+e_dbus_signal_handler_coalesce(E_DBus_Signal_Handler *sh, DBusMessage *msg)
+{
+  E_DBus_Coalesced *c;
+  DBusMessageIter iter;
+  const char *arg = NULL, *sender;
+  char *key;
+  int i, len;
+
+  /* peer to peer connections have no sender */
+  sender = dbus_message_get_sender(msg);
+  if (!sender) sender = "";
+
+  if ((sh->coalesce_arg >= 0) && dbus_message_iter_init(msg, &iter))
+  {
+    for (i = 0; i < sh->coalesce_arg; i++)
+      if (!dbus_message_iter_next(&iter)) break;
+    if (i == sh->coalesce_arg)
+    {
+      int type = dbus_message_iter_get_arg_type(&iter);
+      if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+        dbus_message_iter_get_basic(&iter, &arg);
+    }
+  }
+
+  len = snprintf(NULL, 0, "%s %s %s %s", sender,
+                 dbus_message_get_path(msg), dbus_message_get_member(msg),
+                 arg ? arg : "");
+  key = malloc(len + 1);
+  if (!key) return;
+  snprintf(key, len + 1, "%s %s %s %s", sender,
+           dbus_message_get_path(msg), dbus_message_get_member(msg),
+           arg ? arg : "");
+
+  c = eina_hash_find(sh->coalesce_pending, key);
+  if (c)
+  {
+    /* superseded before anyone looked at it */
+    free(key);
+    dbus_message_unref(c->msg);
+    c->msg = dbus_message_ref(msg);
+    return;
+  }
+
+  c = malloc(sizeof(E_DBus_Coalesced));
+  if (!c)
+  {
+    free(key);
+    return;
+  }
+  c->key = key;
+  c->msg = dbus_message_ref(msg);
+  eina_hash_add(sh->coalesce_pending, key, c);
+  sh->coalesce_order = eina_list_append(sh->coalesce_order, c);
+
+  if (!sh->coalesce_timer)
+    sh->coalesce_timer = ecore_timer_add(sh->coalesce_window, cb_signal_coalesce_timer, sh);
+}
+
+EAPI void
+e_dbus_signal_handler_coalesce_set(E_DBus_Signal_Handler *sh, double window, int arg)
+{
+  E_DBus_Connection *conn;
+
+  EINA_SAFETY_ON_NULL_RETURN(sh);
+  EINA_SAFETY_ON_TRUE_RETURN(window < 0.0);
+
+  /* do not hold back what was already coalesced with the old settings,
+   * deferring deletions from the callbacks as cb_signal_coalesce_timer() */
+  conn = sh->conn;
+  e_dbus_idler_active++;
+  e_dbus_signal_handler_coalesce_flush(sh, EINA_TRUE);
+  e_dbus_idler_active--;
+
+  /* a callback may have deleted the handler, it is only freed below */
+  if (!sh->delete_me)
+  {
+    sh->coalesce_window = window;
+    sh->coalesce_arg = arg;
+    if ((window > 0.0) && (!sh->coalesce_pending))
+      sh->coalesce_pending = eina_hash_string_superfast_new(NULL);
+  }
+
+  /* inside a dispatch the handler list is being walked, leave it to the idler */
+  if (!e_dbus_idler_active)
+    e_dbus_deferred_run(conn);
+}
+
 static void
 cb_signal_dispatcher(E_DBus_Connection *conn, DBusMessage *msg)
 {
@@ -241,7 +424,10 @@ cb_signal_dispatcher(E_DBus_Connection *conn, DBusMessage *msg)
     if (sh->interface && !dbus_message_has_interface(msg, sh->interface)) continue;
     if (sh->member && !dbus_message_has_member(msg, sh->member)) continue;
 
-    sh->cb_signal(sh->data, msg);
+    if (sh->coalesce_window > 0.0)
+      e_dbus_signal_handler_coalesce(sh, msg);
+    else
+      e_dbus_signal_handler_call(conn, sh, msg);
   }
 }
 
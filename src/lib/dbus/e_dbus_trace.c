@@ -0,0 +1,163 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "e_dbus_private.h"
+
+#define E_DBUS_TRACE_BUFFER_SIZE 4096
+
+int e_dbus_trace_active = 0;
+
+static FILE *trace_file = NULL;
+/* only allocated while tracing, most processes never trace */
+static E_DBus_Trace_Entry *trace_buffer = NULL;
+static unsigned int trace_count = 0;
+
+static void
+e_dbus_trace_flush(void)
+{
+  if (!trace_count) return;
+
+  if (fwrite(trace_buffer, sizeof(E_DBus_Trace_Entry), trace_count, trace_file) != trace_count)
+  {
+    ERR("could not write the trace, stopping it");
+    trace_count = 0;
+    e_dbus_trace_stop();
+    return;
+  }
+  trace_count = 0;
+}
+
+static E_DBus_Trace_Entry *
+e_dbus_trace_entry_new(E_DBus_Connection *conn, unsigned char event)
+{
+  E_DBus_Trace_Entry *entry;
+
+  if (trace_count == E_DBUS_TRACE_BUFFER_SIZE)
+  {
+    e_dbus_trace_flush();
+    if (!e_dbus_trace_active) return NULL;
+  }
+
+  entry = trace_buffer + trace_count++;
+  memset(entry, 0, sizeof(E_DBus_Trace_Entry));
+  entry->usec = ecore_time_get() * 1000000.0;
+  entry->event = event;
+  if (conn->conn_name)
+    eina_strlcpy(entry->self, conn->conn_name, sizeof(entry->self));
+  return entry;
+}
+
+void
+e_dbus_trace_message(E_DBus_Connection *conn, DBusMessage *msg, unsigned char event)
+{
+  E_DBus_Trace_Entry *entry;
+  const char *caller = NULL, *member = NULL;
+  unsigned int serial;
+  int type;
+
+  /* the caller's unique name and serial identify a call on both sides */
+  type = dbus_message_get_type(msg);
+  switch (type)
+  {
+    case DBUS_MESSAGE_TYPE_METHOD_CALL:
+      if (event == E_DBUS_TRACE_SEND) caller = conn->conn_name;
+      else caller = dbus_message_get_sender(msg);
+      serial = dbus_message_get_serial(msg);
+      member = dbus_message_get_member(msg);
+      break;
+    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
+    case DBUS_MESSAGE_TYPE_ERROR:
+      if (event == E_DBUS_TRACE_SEND) caller = dbus_message_get_destination(msg);
+      else caller = conn->conn_name;
+      serial = dbus_message_get_reply_serial(msg);
+      break;
+    default:
+      return;
+  }
+
+  entry = e_dbus_trace_entry_new(conn, event);
+  if (!entry) return;
+  entry->serial = serial;
+  entry->type = type;
+  if (caller) eina_strlcpy(entry->caller, caller, sizeof(entry->caller));
+  if (member) eina_strlcpy(entry->member, member, sizeof(entry->member));
+}
+
+void
+e_dbus_trace_read(E_DBus_Connection *conn)
+{
+  e_dbus_trace_entry_new(conn, E_DBUS_TRACE_READ);
+}
+
+void
+e_dbus_trace_env(void)
+{
+  const char *prefix;
+  char file[4096];
+
+  prefix = getenv("E_DBUS_TRACE");
+  if (!prefix || !prefix[0]) return;
+
+  snprintf(file, sizeof(file), "%s.%d", prefix, (int)getpid());
+  if (e_dbus_trace_start(file))
+    INFO("tracing calls to %s", file);
+}
+
+EAPI Eina_Bool
+e_dbus_trace_start(const char *file)
+{
+  EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+
+  e_dbus_trace_stop();
+
+  trace_buffer = malloc(E_DBUS_TRACE_BUFFER_SIZE * sizeof(E_DBus_Trace_Entry));
+  if (!trace_buffer)
+  {
+    ERR("could not allocate the trace buffer");
+    return EINA_FALSE;
+  }
+
+  trace_file = fopen(file, "wb");
+  if (!trace_file)
+  {
+    ERR("could not create trace file %s", file);
+    free(trace_buffer);
+    trace_buffer = NULL;
+    return EINA_FALSE;
+  }
+  if (fwrite(E_DBUS_TRACE_MAGIC, 8, 1, trace_file) != 1)
+  {
+    ERR("could not write trace file %s", file);
+    fclose(trace_file);
+    trace_file = NULL;
+    free(trace_buffer);
+    trace_buffer = NULL;
+    return EINA_FALSE;
+  }
+
+  trace_count = 0;
+  e_dbus_trace_active = 1;
+  return EINA_TRUE;
+}
+
+EAPI void
+e_dbus_trace_stop(void)
+{
+  if (!trace_file) return;
+
+  e_dbus_trace_flush();
+  /* the flush stops the trace itself on a write error */
+  if (!trace_file) return;
+
+  e_dbus_trace_active = 0;
+  fclose(trace_file);
+  trace_file = NULL;
+  free(trace_buffer);
+  trace_buffer = NULL;
+}
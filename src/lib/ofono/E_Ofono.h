@@ -24,8 +24,16 @@ extern int E_OFONO_EVENT_MANAGER_OUT;
 extern int E_OFONO_EVENT_ELEMENT_ADD;
 extern int E_OFONO_EVENT_ELEMENT_DEL;
 extern int E_OFONO_EVENT_ELEMENT_UPDATED;
+extern int E_OFONO_EVENT_ELEMENT_MOVED;
+extern int E_OFONO_EVENT_ELEMENTS_UPDATED;
+extern int E_OFONO_EVENT_ELEMENTS_SYNCED;
 
 typedef struct _E_Ofono_Element   E_Ofono_Element;
+typedef struct _E_Ofono_Event_Elements_Updated E_Ofono_Event_Elements_Updated;
+typedef struct _E_Ofono_Element_Change E_Ofono_Element_Change;
+typedef struct _E_Ofono_Element_Changes E_Ofono_Element_Changes;
+typedef struct _E_Ofono_Elements_Iter E_Ofono_Elements_Iter;
+typedef union _E_Ofono_Value E_Ofono_Value;
 
 struct _E_Ofono_Element
 {
@@ -47,12 +55,87 @@ struct _E_Ofono_Element
    } _idler;
    Eina_Inlist *_listeners;
    int          _references;
+   struct
+   {
+      void       **slots;
+      unsigned int size;
+      unsigned int count;
+   } _props_index;
+   Eina_Bool    _dirty;
+   Eina_Bool    _sync_queued;
+   Eina_Bool    _stale;
+   Eina_Bool    _synced;
+   unsigned int _index[2];
+   struct
+   {
+      E_Ofono_Element_Change *items;
+      unsigned int            count;
+      unsigned int            size;
+   } _changes;
+};
+
+/* value of a basic type, strings and object paths are stringshared */
+union _E_Ofono_Value
+{
+   Eina_Bool      boolean;
+   unsigned char  byte;
+   unsigned short u16;
+   unsigned int   u32;
+   const char    *str;
+};
+
+/* A property that changed since the last update.  old_type is
+ * DBUS_TYPE_INVALID for a new property and type is for one that went
+ * away.  Values are only given for basic types, for arrays and dicts
+ * read the property from the element.
+ */
+struct _E_Ofono_Element_Change
+{
+   const char   *name;
+   int           type;
+   int           old_type;
+   E_Ofono_Value value;
+   E_Ofono_Value old_value;
+};
+
+struct _E_Ofono_Element_Changes
+{
+   E_Ofono_Element_Change *items;
+   unsigned int            count;
+};
+
+/* borrowed iteration over the elements, see e_ofono_elements_iter_init().
+ * Lives on the caller's stack, the fields are private.
+ */
+struct _E_Ofono_Elements_Iter
+{
+   void * const      *_items;
+   const char        *_interface;
+   unsigned int       _count;
+   unsigned int       _pos;
+   unsigned int       _generation;
+   Eina_Bool          _paths;
+};
+
+/* event info of E_OFONO_EVENT_ELEMENTS_UPDATED, valid during the event,
+ * changes[i] are those of elements[i] */
+struct _E_Ofono_Event_Elements_Updated
+{
+   unsigned int             count;
+   E_Ofono_Element        **elements;
+   E_Ofono_Element_Changes *changes;
 };
 
 /* General Public API */
 EAPI unsigned int         e_ofono_system_init(E_DBus_Connection *edbus_conn) EINA_ARG_NONNULL(1);
 EAPI unsigned int         e_ofono_system_shutdown(void);
 
+EAPI void                 e_ofono_elements_sync_window_set(unsigned int window);
+EAPI unsigned int         e_ofono_elements_sync_window_get(void);
+
+EAPI Eina_Bool            e_ofono_elements_snapshot_save(const char *file) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool            e_ofono_elements_snapshot_load(const char *file) EINA_ARG_NONNULL(1);
+
 /* Manager Methods */
 EAPI E_Ofono_Element *    e_ofono_manager_get(void) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_ofono_manager_modems_get(Eina_Array **array);
@@ -82,10 +165,15 @@ EAPI Eina_Bool            e_ofono_manager_sync_elements(void);
 
 EAPI Eina_Bool            e_ofono_elements_get_all(unsigned int *count, E_Ofono_Element ***p_elements) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_ofono_elements_get_all_type(const char *type, unsigned int *count, E_Ofono_Element ***p_elements) EINA_ARG_NONNULL(1, 2, 3) EINA_WARN_UNUSED_RESULT;
+EAPI void                 e_ofono_elements_iter_init(E_Ofono_Elements_Iter *iter, const char *interface) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool            e_ofono_element_objects_iter_init(E_Ofono_Elements_Iter *iter, const E_Ofono_Element *element, const char *property) EINA_ARG_NONNULL(1, 2, 3);
+EAPI E_Ofono_Element *    e_ofono_elements_iter_next(E_Ofono_Elements_Iter *iter) EINA_ARG_NONNULL(1);
 EAPI E_Ofono_Element *    e_ofono_element_get(const char *path, const char *interface) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
 
 EAPI void                 e_ofono_element_listener_add(E_Ofono_Element *element, void (*cb)(void *data, const E_Ofono_Element *element), const void *data, void (*free_data)(void *data)) EINA_ARG_NONNULL(1, 2);
 EAPI void                 e_ofono_element_listener_del(E_Ofono_Element *element, void (*cb)(void *data, const E_Ofono_Element *element), const void *data) EINA_ARG_NONNULL(1, 2);
+EAPI void                 e_ofono_element_changes_listener_add(E_Ofono_Element *element, void (*cb)(void *data, const E_Ofono_Element *element, const E_Ofono_Element_Changes *changes), const void *data, void (*free_data)(void *data), const char **names) EINA_ARG_NONNULL(1, 2);
+EAPI void                 e_ofono_element_changes_listener_del(E_Ofono_Element *element, void (*cb)(void *data, const E_Ofono_Element *element, const E_Ofono_Element_Changes *changes), const void *data) EINA_ARG_NONNULL(1, 2);
 
 EAPI int                  e_ofono_element_ref(E_Ofono_Element *element) EINA_ARG_NONNULL(1);
 EAPI int                  e_ofono_element_unref(E_Ofono_Element *element) EINA_ARG_NONNULL(1);
@@ -94,6 +182,7 @@ EAPI void                 e_ofono_element_print(FILE *fp, const E_Ofono_Element
 
 EAPI Eina_Bool            e_ofono_element_properties_sync(E_Ofono_Element *element) EINA_ARG_NONNULL(1);
 EAPI Eina_Bool            e_ofono_element_properties_sync_full(E_Ofono_Element *element, E_DBus_Method_Return_Cb cb, const void *data) EINA_ARG_NONNULL(1);
+EAPI Eina_Bool            e_ofono_element_is_stale(const E_Ofono_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
 
 EAPI Eina_Bool            e_ofono_element_property_set(E_Ofono_Element *element, const char *prop, int type, const void *value) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_ofono_element_property_set_full(E_Ofono_Element *element, const char *prop, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data) EINA_ARG_NONNULL(1, 2) EINA_WARN_UNUSED_RESULT;
@@ -106,6 +195,7 @@ EAPI Eina_Bool            e_ofono_element_property_type_get(const E_Ofono_Elemen
 EAPI Eina_Bool            e_ofono_element_property_dict_get_stringshared(const E_Ofono_Element *element, const char *dict_name, const char *key_name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_ofono_element_property_get_stringshared(const E_Ofono_Element *element, const char *name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_ofono_element_property_get(const E_Ofono_Element *element, const char *name, int *type, void *value) EINA_ARG_NONNULL(1, 2, 4) EINA_WARN_UNUSED_RESULT;
+EAPI Eina_Bool            e_ofono_element_strings_array_view(const E_Ofono_Element *element, const char *property, unsigned int *count, const char ***strings) EINA_ARG_NONNULL(1, 2, 3, 4) EINA_WARN_UNUSED_RESULT;
 
 EAPI Eina_Bool            e_ofono_element_is_manager(const E_Ofono_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
 EAPI Eina_Bool            e_ofono_element_is_modem(const E_Ofono_Element *element) EINA_ARG_NONNULL(1) EINA_WARN_UNUSED_RESULT;
@@ -16,6 +16,9 @@ EAPI int E_OFONO_EVENT_MANAGER_OUT = 0;
 EAPI int E_OFONO_EVENT_ELEMENT_ADD = 0;
 EAPI int E_OFONO_EVENT_ELEMENT_DEL = 0;
 EAPI int E_OFONO_EVENT_ELEMENT_UPDATED = 0;
+EAPI int E_OFONO_EVENT_ELEMENT_MOVED = 0;
+EAPI int E_OFONO_EVENT_ELEMENTS_UPDATED = 0;
+EAPI int E_OFONO_EVENT_ELEMENTS_SYNCED = 0;
 
 const char *e_ofono_iface_manager = NULL;
 const char *e_ofono_prop_modems = NULL;
@@ -55,7 +58,8 @@ e_ofono_system_bus_name_get(void)
  * and some element paths and then request their properties.
  *
  * This call will add events E_OFONO_EVENT_ELEMENT_ADD and
- * E_OFONO_EVENT_ELEMENT_UPDATED to the main loop.
+ * E_OFONO_EVENT_ELEMENT_UPDATED to the main loop, then
+ * E_OFONO_EVENT_ELEMENTS_SYNCED once all their properties arrived.
  *
  * This will not remove stale elements.
  *
@@ -71,7 +75,7 @@ e_ofono_manager_sync_elements(void)
 
    manager = e_ofono_element_register(manager_path, e_ofono_iface_manager);
    if (manager)
-      e_ofono_element_properties_sync(manager);
+      e_ofono_elements_sync(manager);
    else
       return FALSE;
 
@@ -192,6 +196,15 @@ _e_ofono_get_name_owner(void *data __UNUSED__, DBusMessage *msg, DBusError *err)
  *   - E_OFONO_EVENT_ELEMENT_DEL: element was deleted.
  *   - E_OFONO_EVENT_ELEMENT_UPDATED: element was updated (properties
  *     or state changed).
+ *   - E_OFONO_EVENT_ELEMENT_MOVED: element changed position in the list
+ *     property of another element, get that list again for the new order.
+ *   - E_OFONO_EVENT_ELEMENTS_UPDATED: all the elements updated during the
+ *     last main loop iteration, as E_Ofono_Event_Elements_Updated with
+ *     the properties that changed on each.  Each one also gets its own
+ *     E_OFONO_EVENT_ELEMENT_UPDATED.
+ *   - E_OFONO_EVENT_ELEMENTS_SYNCED: the properties of all the elements
+ *     found after the manager came in have arrived, no event information.
+ *     At most e_ofono_elements_sync_window_get() of them are fetched at once.
  *
  * Manager IN/OUT events do not provide any event information, just
  * tells you that system is usable or not. After manager is out, all
@@ -233,6 +246,15 @@ e_ofono_system_init(E_DBus_Connection *edbus_conn)
    if (E_OFONO_EVENT_ELEMENT_UPDATED == 0)
       E_OFONO_EVENT_ELEMENT_UPDATED = ecore_event_type_new();
 
+   if (E_OFONO_EVENT_ELEMENT_MOVED == 0)
+      E_OFONO_EVENT_ELEMENT_MOVED = ecore_event_type_new();
+
+   if (E_OFONO_EVENT_ELEMENTS_UPDATED == 0)
+      E_OFONO_EVENT_ELEMENTS_UPDATED = ecore_event_type_new();
+
+   if (E_OFONO_EVENT_ELEMENTS_SYNCED == 0)
+      E_OFONO_EVENT_ELEMENTS_SYNCED = ecore_event_type_new();
+
    if (!e_ofono_iface_manager)
       e_ofono_iface_manager = eina_stringshare_add("org.ofono.Manager");
 
@@ -2,6 +2,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "e_dbus_probes.h"
+
+E_DBUS_PROBE_DEFINE(eofono, property_update);
 
 /*
  * Maximum size for elements hash key.
@@ -14,6 +22,22 @@
  */
 #define MAX_KEY_SIZE 4096
 static Eina_Hash *elements = NULL;
+/* one PropertyChanged match for all elements, routed by path and interface */
+static E_DBus_Signal_Handler *property_changed_handler = NULL;
+/* elements with changes not yet delivered, see _elements_changed_flush() */
+static Eina_Array *changed_elements = NULL;
+static Ecore_Idle_Enterer *changed_flush = NULL;
+/* elements waiting for their GetProperties, see _elements_sync_pump() */
+static Eina_List *sync_queue = NULL;
+static unsigned int sync_in_flight = 0;
+/* calls from before the last shutdown complete late, see _sync_done() */
+static unsigned int sync_generation = 0;
+static unsigned int sync_window = 8;
+static Eina_Bool sync_initial = EINA_FALSE;
+/* manager whose GetProperties was sent outside of the queue */
+static E_Ofono_Element *sync_manager = NULL;
+/* bumped whenever an iterator would go stale, see _elements_index_add() */
+static unsigned int elements_generation = 0;
 
 typedef struct _E_Ofono_Element_Pending      E_Ofono_Element_Pending;
 typedef struct _E_Ofono_Element_Call_Data    E_Ofono_Element_Call_Data;
@@ -53,6 +77,7 @@ struct _E_Ofono_Element_Property
       void          *variant;
       E_Ofono_Array *array;
    } value;
+   Eina_Bool   stale; /* from a snapshot, not sent again yet */
 };
 
 struct _E_Ofono_Element_Dict_Entry
@@ -73,8 +98,10 @@ struct _E_Ofono_Element_Listener
 {
          EINA_INLIST;
    void  (*cb)(void *data, const E_Ofono_Element *element);
+   void  (*changes_cb)(void *data, const E_Ofono_Element *element, const E_Ofono_Element_Changes *changes);
    void *data;
    void  (*free_data)(void *data);
+   const char **names; /* stringshared and NULL terminated, or NULL for all */
 };
 
 static void
@@ -130,6 +157,20 @@ e_ofono_element_pending_cancel_and_free(Eina_Inlist **pending)
      }
 }
 
+static void
+_e_ofono_element_listener_names_free(const char **names)
+{
+   const char **name;
+
+   if (!names)
+      return;
+
+   for (name = names; *name; name++)
+      eina_stringshare_del(*name);
+
+   free(names);
+}
+
 void
 e_ofono_element_listener_add(E_Ofono_Element *element, void (*cb)(void *data, const E_Ofono_Element *element), const void *data, void (*free_data)(void *data))
 {
@@ -155,8 +196,10 @@ e_ofono_element_listener_add(E_Ofono_Element *element, void (*cb)(void *data, co
      }
 
    l->cb = cb;
+   l->changes_cb = NULL;
    l->data = (void *)data;
    l->free_data = free_data;
+   l->names = NULL;
 
    element->_listeners = eina_inlist_append
          (element->_listeners, EINA_INLIST_GET(l));
@@ -184,13 +227,149 @@ e_ofono_element_listener_del(E_Ofono_Element *element, void (*cb)(void *data, co
         if (l->free_data)
            l->free_data(l->data);
 
+        _e_ofono_element_listener_names_free(l->names);
+        free(l);
+        return;
+     }
+}
+
+/**
+ * Add a listener that is told which properties changed.
+ *
+ * Like e_ofono_element_listener_add(), but @a cb also gets the changes
+ * of this update, see E_Ofono_Element_Change.  With @a names, a NULL terminated
+ * array of property names, it is only called when one of them changed.
+ *
+ * @param element element to listen to.
+ * @param cb function to call on updates.
+ * @param data data to give to cb.
+ * @param free_data function to free data when the listener is removed.
+ * @param names properties to listen to, or NULL for all of them.
+ */
+void
+e_ofono_element_changes_listener_add(E_Ofono_Element *element, void (*cb)(void *data, const E_Ofono_Element *element, const E_Ofono_Element_Changes *changes), const void *data, void (*free_data)(void *data), const char **names)
+{
+   E_Ofono_Element_Listener *l;
+   unsigned int i, count = 0;
+
+   EINA_SAFETY_ON_FALSE_GOTO(element, error);
+   EINA_SAFETY_ON_FALSE_GOTO(cb, error);
+
+   l = malloc(sizeof(*l));
+   if (!l)
+     {
+        ERR("could not allocate E_Ofono_Element_Listener");
+        goto error;
+     }
+
+   l->cb = NULL;
+   l->changes_cb = cb;
+   l->data = (void *)data;
+   l->free_data = free_data;
+   l->names = NULL;
+
+   if (names)
+     {
+        while (names[count])
+           count++;
+
+        l->names = malloc((count + 1) * sizeof(char *));
+        if (!l->names)
+          {
+             ERR("could not allocate the names of E_Ofono_Element_Listener");
+             free(l);
+             goto error;
+          }
+
+        for (i = 0; i < count; i++)
+           l->names[i] = eina_stringshare_add(names[i]);
+        l->names[count] = NULL;
+     }
+
+   element->_listeners = eina_inlist_append
+         (element->_listeners, EINA_INLIST_GET(l));
+
+   return;
+
+error:
+   if (free_data)
+      free_data((void *)data);
+}
+
+void
+e_ofono_element_changes_listener_del(E_Ofono_Element *element, void (*cb)(void *data, const E_Ofono_Element *element, const E_Ofono_Element_Changes *changes), const void *data)
+{
+   E_Ofono_Element_Listener *l;
+
+   EINA_SAFETY_ON_NULL_RETURN(element);
+   EINA_SAFETY_ON_NULL_RETURN(cb);
+
+   EINA_INLIST_FOREACH(element->_listeners, l)
+   if ((l->changes_cb == cb) && (l->data == data))
+     {
+        element->_listeners = eina_inlist_remove
+              (element->_listeners, EINA_INLIST_GET(l));
+        if (l->free_data)
+           l->free_data(l->data);
+
+        _e_ofono_element_listener_names_free(l->names);
         free(l);
         return;
      }
 }
 
 static void
-_e_ofono_element_listeners_call_do(E_Ofono_Element *element)
+_e_ofono_element_listener_call(E_Ofono_Element *element, E_Ofono_Element_Listener *l, const E_Ofono_Element_Changes *changes)
+{
+   if (l->changes_cb)
+      l->changes_cb(l->data, element, changes);
+   else
+      l->cb(l->data, element);
+}
+
+/* listeners with names only wake for changes of those properties */
+static Eina_Bool
+_e_ofono_element_listener_wants(const E_Ofono_Element_Listener *l, const E_Ofono_Element_Changes *changes)
+{
+   const char **name;
+   unsigned int i;
+
+   if (!l->names)
+      return EINA_TRUE;
+
+   for (i = 0; i < changes->count; i++)
+      for (name = l->names; *name; name++)
+         if (changes->items[i].name == *name)
+            return EINA_TRUE;
+
+   return EINA_FALSE;
+}
+
+static void
+_e_ofono_element_listener_run(E_Ofono_Element *element, E_Ofono_Element_Listener *l, const E_Ofono_Element_Changes *changes)
+{
+   E_DBus_Connection *conn = e_ofono_conn;
+   const char *interface, *path;
+   double start;
+
+   start = conn ? e_dbus_connection_handler_begin(conn) : 0.0;
+   if (start <= 0.0)
+     {
+        _e_ofono_element_listener_call(element, l, changes);
+        return;
+     }
+
+   /* the listener may free the element */
+   interface = eina_stringshare_ref(element->interface);
+   path = eina_stringshare_ref(element->path);
+   _e_ofono_element_listener_call(element, l, changes);
+   e_dbus_connection_handler_end(conn, start, "listener", interface, path);
+   eina_stringshare_del(interface);
+   eina_stringshare_del(path);
+}
+
+static void
+_e_ofono_element_listeners_call_do(E_Ofono_Element *element, const E_Ofono_Element_Changes *changes)
 {
    E_Ofono_Element_Listener *l, **shadow;
    unsigned int i, count;
@@ -212,2271 +391,3938 @@ _e_ofono_element_listeners_call_do(E_Ofono_Element *element)
    shadow[i++] = l;
 
    for (i = 0; i < count; i++)
-      shadow[i]->cb(shadow[i]->data, element);
+      if (_e_ofono_element_listener_wants(shadow[i], changes))
+         _e_ofono_element_listener_run(element, shadow[i], changes);
 
 end:
    e_ofono_element_event_add(E_OFONO_EVENT_ELEMENT_UPDATED, element);
 }
 
-static Eina_Bool
-_e_ofono_element_listeners_call_idler(void *data)
-{
-   E_Ofono_Element *element = data;
-   _e_ofono_element_listeners_call_do(element);
-   element->_idler.changed = NULL;
-   return ECORE_CALLBACK_CANCEL;
-}
-
-static void
-_e_ofono_element_listeners_call(E_Ofono_Element *element)
-{
-   if (element->_idler.changed)
-      return;
-
-   element->_idler.changed = ecore_idler_add
-         (_e_ofono_element_listeners_call_idler, element);
-}
-
-/***********************************************************************
-* Property
-***********************************************************************/
-
 static void
-_e_ofono_element_dict_entry_free(E_Ofono_Element_Dict_Entry *entry)
+_e_ofono_element_value_keep(const E_Ofono_Element_Property *p, E_Ofono_Value *v)
 {
-   switch (entry->type)
+   memset(v, 0, sizeof(*v));
+   switch (p->type)
      {
       case DBUS_TYPE_BOOLEAN:
+         v->boolean = p->value.boolean;
+         break;
+
       case DBUS_TYPE_BYTE:
+         v->byte = p->value.byte;
+         break;
+
       case DBUS_TYPE_UINT16:
-      case DBUS_TYPE_UINT32:
+         v->u16 = p->value.u16;
          break;
 
-      case DBUS_TYPE_OBJECT_PATH:
-         eina_stringshare_del(entry->value.path);
+      case DBUS_TYPE_UINT32:
+         v->u32 = p->value.u32;
          break;
 
       case DBUS_TYPE_STRING:
-         eina_stringshare_del(entry->value.str);
+         v->str = eina_stringshare_ref(p->value.str);
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         v->str = eina_stringshare_ref(p->value.path);
          break;
 
       default:
-         ERR("don't know how to free dict entry '%s' of type %c (%d)",
-             entry->name, entry->type, entry->type);
+         break;
      }
-
-   eina_stringshare_del(entry->name);
-   free(entry);
 }
 
-static E_Ofono_Element_Dict_Entry *
-_e_ofono_element_dict_entry_new(DBusMessageIter *itr)
+static void
+_e_ofono_element_value_release(int type, E_Ofono_Value *v)
 {
-   E_Ofono_Element_Dict_Entry *entry;
-   DBusMessageIter e_itr, v_itr;
-   int t;
-   const char *key = NULL;
-   void *value = NULL;
+   if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+      eina_stringshare_del(v->str);
+}
 
-   dbus_message_iter_recurse(itr, &e_itr);
+/* Records that p changed for the next flush.  A property changed twice
+ * before it keeps its first old value.  Takes over old.
+ */
+static void
+_e_ofono_element_change_add(E_Ofono_Element *element, const E_Ofono_Element_Property *p, int old_type, E_Ofono_Value *old)
+{
+   E_Ofono_Element_Change *c;
+   unsigned int i;
 
-   t = dbus_message_iter_get_arg_type(&e_itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+   for (i = 0; i < element->_changes.count; i++)
      {
-        ERR("invalid format for dict entry. first type not a string: %c (%d)",
-            t, t);
-        return NULL;
-     }
+        c = element->_changes.items + i;
+        if (c->name != p->name)
+           continue;
 
-   dbus_message_iter_get_basic(&e_itr, &key);
-   if (!key || !key[0])
-     {
-        ERR("invalid format for dict entry. no key.");
-        return NULL;
+        _e_ofono_element_value_release(old_type, old);
+        _e_ofono_element_value_release(c->type, &c->value);
+        c->type = p->type;
+        _e_ofono_element_value_keep(p, &c->value);
+        return;
      }
 
-   dbus_message_iter_next(&e_itr);
-   t = dbus_message_iter_get_arg_type(&e_itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+   if (element->_changes.count == element->_changes.size)
      {
-        ERR("invalid format for dict entry '%s'. "
-            "second type not a variant: %c (%d)",
-            key, t, t);
-        return NULL;
-     }
-
-   dbus_message_iter_recurse(&e_itr, &v_itr);
+        unsigned int size = element->_changes.size ? element->_changes.size * 2 : 4;
 
-   t = dbus_message_iter_get_arg_type(&v_itr);
-   if ((t == DBUS_TYPE_INVALID) || (t == DBUS_TYPE_ARRAY))
-     {
-        ERR("invalid type for dict value for entry '%s': %c (%d)",
-            key, t, t);
-        return NULL;
-     }
+        c = realloc(element->_changes.items, size * sizeof(E_Ofono_Element_Change));
+        if (!c)
+          {
+             ERR("could not record the change of %s on %s",
+                 p->name, element->path);
+             _e_ofono_element_value_release(old_type, old);
+             return;
+          }
 
-   entry = calloc(1, sizeof(*entry));
-   if (!entry)
-     {
-        ERR("could not allocate memory for dict entry.");
-        return NULL;
+        element->_changes.items = c;
+        element->_changes.size = size;
      }
 
-   dbus_message_iter_get_basic(&v_itr, &value);
-   switch (t)
-     {
-      case DBUS_TYPE_BOOLEAN:
-         entry->value.boolean = (Eina_Bool)(long)value;
-         break;
-
-      case DBUS_TYPE_BYTE:
-         entry->value.byte = (unsigned char)(long)value;
-         break;
-
-      case DBUS_TYPE_UINT16:
-         entry->value.u16 = (unsigned short)(long)value;
-         break;
-
-      case DBUS_TYPE_UINT32:
-         entry->value.u32 = (unsigned int)(long)value;
-         break;
+   c = element->_changes.items + element->_changes.count++;
+   c->name = eina_stringshare_ref(p->name);
+   c->type = p->type;
+   _e_ofono_element_value_keep(p, &c->value);
+   c->old_type = old_type;
+   c->old_value = *old;
+}
 
-      case DBUS_TYPE_STRING:
-         entry->value.str = eina_stringshare_add(value);
-         break;
+static void
+_e_ofono_element_changes_free(E_Ofono_Element_Changes *changes)
+{
+   unsigned int i;
 
-      case DBUS_TYPE_OBJECT_PATH:
-         entry->value.path = eina_stringshare_add(value);
-         break;
+   for (i = 0; i < changes->count; i++)
+     {
+        E_Ofono_Element_Change *c = changes->items + i;
 
-      default:
-         ERR("don't know how to create dict entry '%s' for of type %c (%d)",
-             key, t, t);
-         free(entry);
-         return NULL;
+        _e_ofono_element_value_release(c->type, &c->value);
+        _e_ofono_element_value_release(c->old_type, &c->old_value);
+        eina_stringshare_del(c->name);
      }
 
-   entry->name = eina_stringshare_add(key);
-   entry->type = t;
-   return entry;
+   free(changes->items);
+   changes->items = NULL;
+   changes->count = 0;
 }
 
-static E_Ofono_Element_Dict_Entry *
-_e_ofono_element_array_dict_find_stringshared(const E_Ofono_Array *array, const char *key)
+/* moves the changes recorded on element to changes */
+static void
+_e_ofono_element_changes_take(E_Ofono_Element *element, E_Ofono_Element_Changes *changes)
 {
-   E_Ofono_Element_Dict_Entry *entry;
-   Eina_Array_Iterator iterator;
-   unsigned int i;
-
-   EINA_ARRAY_ITER_NEXT(array->array, i, entry, iterator)
-   if (entry->name == key)
-      return entry;
-
-   return NULL;
+   changes->items = element->_changes.items;
+   changes->count = element->_changes.count;
+   element->_changes.items = NULL;
+   element->_changes.count = 0;
+   element->_changes.size = 0;
 }
 
 static void
-_e_ofono_element_array_free(E_Ofono_Array *array, E_Ofono_Array *new __UNUSED__)
+_e_ofono_elements_updated_free(void *data __UNUSED__, void *ev)
 {
-   Eina_Array_Iterator iterator;
+   E_Ofono_Event_Elements_Updated *event = ev;
    unsigned int i;
-   void *item;
 
-   if (!array)
-      return;
-
-   switch (array->type)
+   for (i = 0; i < event->count; i++)
      {
-      case DBUS_TYPE_BOOLEAN:
-      case DBUS_TYPE_BYTE:
-      case DBUS_TYPE_UINT16:
-      case DBUS_TYPE_UINT32:
-         break;
+        _e_ofono_element_changes_free(event->changes + i);
+        e_ofono_element_unref(event->elements[i]);
+     }
 
-      case DBUS_TYPE_OBJECT_PATH:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         eina_stringshare_del(item);
-         break;
+   free(event);
+}
 
-      case DBUS_TYPE_STRING:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         eina_stringshare_del(item);
-         break;
+/* Changed elements wait in a dirty set, each with a reference, until the
+ * main loop is about to go idle.  Then their listeners run and a single
+ * E_OFONO_EVENT_ELEMENTS_UPDATED carries them all.
+ */
+static Eina_Bool
+_e_ofono_elements_changed_flush(void *data __UNUSED__)
+{
+   E_Ofono_Event_Elements_Updated *event;
+   Eina_Array *changed = changed_elements;
+   unsigned int i, count;
 
-      case DBUS_TYPE_DICT_ENTRY:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         _e_ofono_element_dict_entry_free(item);
-         break;
+   /* elements changed by the listeners go to the next batch */
+   changed_elements = NULL;
+   changed_flush = NULL;
 
-      default:
-         ERR("don't know how to free array of values of type %c (%d)",
-             array->type, array->type);
-         break;
+   count = eina_array_count(changed);
+   event = malloc(sizeof(*event) +
+                  count * (sizeof(E_Ofono_Element_Changes) + sizeof(E_Ofono_Element *)));
+   if (event)
+     {
+        event->count = 0;
+        event->changes = (E_Ofono_Element_Changes *)(event + 1);
+        event->elements = (E_Ofono_Element **)(event->changes + count);
      }
-   eina_array_free(array->array);
-   free(array);
-}
+   else
+      ERR("could not allocate the updated elements event");
 
-static void
-_e_ofono_element_property_value_free(E_Ofono_Element_Property *property)
-{
-   switch (property->type)
+   for (i = 0; i < count; i++)
      {
-      case 0:
-         return;
-
-      case DBUS_TYPE_BOOLEAN:
-      case DBUS_TYPE_BYTE:
-      case DBUS_TYPE_UINT16:
-      case DBUS_TYPE_UINT32:
-         break;
+        E_Ofono_Element *element = eina_array_data_get(changed, i);
+        E_Ofono_Element_Changes changes;
+
+        element->_dirty = EINA_FALSE;
+        _e_ofono_element_changes_take(element, &changes);
+        /* skip those unregistered meanwhile, they got their DEL event, and
+         * all of them if a listener shut the system down */
+        if ((elements) && (e_ofono_element_get(element->path, element->interface) == element))
+          {
+             _e_ofono_element_listeners_call_do(element, &changes);
+             if (event)
+               {
+                  event->changes[event->count] = changes;
+                  event->elements[event->count++] = element;
+                  continue;
+               }
+          }
 
-      case DBUS_TYPE_STRING:
-         eina_stringshare_del(property->value.str);
-         break;
+        _e_ofono_element_changes_free(&changes);
+        e_ofono_element_unref(element);
+     }
 
-      case DBUS_TYPE_OBJECT_PATH:
-         eina_stringshare_del(property->value.path);
-         break;
+   eina_array_free(changed);
 
-      case DBUS_TYPE_ARRAY:
-         _e_ofono_element_array_free(property->value.array, NULL);
-         break;
+   if ((event) && (event->count))
+      ecore_event_add(E_OFONO_EVENT_ELEMENTS_UPDATED, event,
+                      _e_ofono_elements_updated_free, NULL);
+   else
+      free(event);
 
-      default:
-         ERR("don't know how to free value of property type %c (%d)",
-             property->type, property->type);
-     }
+   return ECORE_CALLBACK_CANCEL;
 }
 
-static const char *
-_e_ofono_element_get_interface(const char *key)
+static void
+_e_ofono_element_listeners_call(E_Ofono_Element *element)
 {
-   const char *interface = NULL, *tail;
-   char head;
-
-   head = key[0];
-   tail = key + 1;
+   if (element->_dirty)
+      return;
 
-   switch (head)
+   if (!changed_elements)
      {
-      case 'M':
-         if (strcmp(tail, "odems") == 0)
-            interface = e_ofono_iface_modem;
-
-         break;
-
-      default:
-         break;
+        changed_elements = eina_array_new(32);
+        if (!changed_elements)
+          {
+             ERR("could not allocate the changed elements");
+             return;
+          }
      }
 
-   if (!interface)
-      ERR("failed to find interface for property \"%s\"", key);
-
-   return interface;
-}
-
-static E_Ofono_Element *
-_e_ofono_element_item_register(const char *key, const char *item)
-{
-   E_Ofono_Element *element;
-   const char *interface;
-
-   interface = _e_ofono_element_get_interface(key);
-   if (!interface)
-      return NULL;
+   if (!eina_array_push(changed_elements, element))
+     {
+        ERR("could not mark element %s as changed", element->path);
+        return;
+     }
 
-   element = e_ofono_element_register(item, interface);
-   if ((element) && (!e_ofono_element_properties_sync(element)))
-      WRN("could not get properties of %s", element->path);
+   element->_dirty = EINA_TRUE;
+   e_ofono_element_ref(element);
 
-   return element;
+   if (!changed_flush)
+      changed_flush = ecore_idle_enterer_add
+            (_e_ofono_elements_changed_flush, NULL);
 }
 
-/* Match 2 arrays to find which are new and which are old elements
- * For new elements, register them under prop_name property
- * For old elements, unregister them, sending proper DEL event
+/* GetProperties of the elements go through a queue, at most sync_window
+ * of them in flight, so the elements found in the manager's reply are
+ * fetched in parallel instead of all at once or one after the other.
+ * Once the queue started by e_ofono_elements_sync() drains, a single
+ * E_OFONO_EVENT_ELEMENTS_SYNCED tells everything is known.
  */
+static void _e_ofono_elements_sync_pump(void);
+
 static void
-_e_ofono_element_array_match(E_Ofono_Array *old, E_Ofono_Array *new, const char *prop_name, E_Ofono_Element *element)
+_e_ofono_element_sync_done(void *data, DBusMessage *msg __UNUSED__, DBusError *err __UNUSED__)
 {
-   Eina_List *deleted = NULL;
-   Eina_Array_Iterator iter_old, iter_new;
-   unsigned int i_old = 0, i_new = 0;
-   void *item_old = NULL, *item_new;
-   Eina_List *l;
-   void *data;
-   Eina_Bool interfaces = EINA_FALSE;
-
-   if (!old)
-      return;
-
-   if ((old->type != DBUS_TYPE_OBJECT_PATH) &&
-       (old->type != DBUS_TYPE_STRING))
+   /* canceled along with the elements of an older sync, not counted */
+   if ((unsigned long)data != sync_generation)
       return;
 
-   /* is this a list of interfaces? */
-   interfaces = !strcmp(prop_name, "Interfaces");
+   if (sync_in_flight > 0)
+      sync_in_flight--;
+   _e_ofono_elements_sync_pump();
+}
 
-   if ((!new) || (!new->array) || eina_array_count(new->array) == 0)
+static void
+_e_ofono_elements_sync_pump(void)
+{
+   while ((sync_queue) && ((!sync_window) || (sync_in_flight < sync_window)))
      {
-        if ((!old) || (!old->array) || eina_array_count(old->array) == 0)
-          {
-             return;
-          }
-        else
+        E_Ofono_Element *element = eina_list_data_get(sync_queue);
+
+        sync_queue = eina_list_remove_list(sync_queue, sync_queue);
+        element->_sync_queued = EINA_FALSE;
+        /* skip those unregistered while waiting */
+        if ((elements) && (e_ofono_element_get(element->path, element->interface) == element))
           {
-             iter_old = old->array->data;
-             goto out_remove_remaining;
+             if (e_ofono_element_properties_sync_full
+                    (element, _e_ofono_element_sync_done,
+                    (void *)(unsigned long)sync_generation))
+                sync_in_flight++;
+             else
+                WRN("could not get properties of %s", element->path);
           }
+        e_ofono_element_unref(element);
      }
 
-   iter_new = new->array->data;
-   item_new = *iter_new;
-   EINA_ARRAY_ITER_NEXT(old->array, i_old, item_old, iter_old)
-   {
-      if (item_old == item_new)
-        {
-           i_new++;
-           if (i_new >= eina_array_count(new->array))
-             {
-                i_old++;
-                break;
-             }
+   if ((sync_initial) && (!sync_queue) && (!sync_in_flight))
+     {
+        sync_initial = EINA_FALSE;
+        DBG("all elements synced");
+        ecore_event_add(E_OFONO_EVENT_ELEMENTS_SYNCED, NULL, NULL, NULL);
+     }
+}
 
-           iter_new++;
-           item_new = *iter_new;
-        }
-      else
-        {
-           deleted = eina_list_append(deleted, item_old);
-        }
+static void
+_e_ofono_elements_sync_clear(void)
+{
+   E_Ofono_Element *element;
+
+   sync_initial = EINA_FALSE;
+   sync_manager = NULL;
+   EINA_LIST_FREE(sync_queue, element)
+   {
+      element->_sync_queued = EINA_FALSE;
+      e_ofono_element_unref(element);
    }
+}
 
-   for(; i_new < eina_array_count(new->array); iter_new++, i_new++)
-     {
-        Eina_Bool found = EINA_FALSE;
-        item_new = *iter_new;
-        if (!item_new)
-           break;
+/**
+ * Queue a GetProperties() of the given element.
+ *
+ * Nothing is queued if the element is already waiting or if its
+ * properties are on their way.
+ * @internal
+ */
+void
+e_ofono_element_sync_queue(E_Ofono_Element *element)
+{
+   unsigned int count;
 
-        EINA_LIST_FOREACH(deleted, l, data)
-        {
-           if (data == item_new)
-             {
-                deleted = eina_list_remove_list(deleted, l);
-                found = EINA_TRUE;
-                break;
-             }
-        }
-        if (!found)
-          {
-             E_Ofono_Element *e = NULL;
+   EINA_SAFETY_ON_NULL_RETURN(element);
 
-             if (interfaces)
-                e = e_ofono_element_register(item_new, element->path);
-             else
-                e = _e_ofono_element_item_register(prop_name, item_new);
+   if ((element->_sync_queued) || (element->_pending.properties_get))
+      return;
 
-             if (e)
-                DBG("Add element %s (%s)\n", e->path, e->interface);
-          }
+   count = eina_list_count(sync_queue);
+   sync_queue = eina_list_append(sync_queue, element);
+   if (eina_list_count(sync_queue) == count)
+     {
+        ERR("could not queue the sync of %s", element->path);
+        return;
      }
 
-   /* everybody after i_old on old->array + everybody from deleted list
-      will be removed
-    */
-   EINA_LIST_FREE(deleted, data)
-   {
-      E_Ofono_Element *e;
-      if (interfaces)
-         e = e_ofono_element_get(element->path, item_old);
-      else
-         e = e_ofono_element_get(data,
-                                 _e_ofono_element_get_interface(prop_name));
-
-      if (e)
-        {
-           e_ofono_element_unregister(e);
-           DBG("Deleted element %s %s\n", e->path, e->interface);
-        }
-   }
-
-out_remove_remaining:
-   for(; i_old < eina_array_count(old->array); iter_old++, i_old++)
-     {
-        E_Ofono_Element *e;
-        item_old = *iter_old;
-        if (!item_old)
-           break;
+   element->_sync_queued = EINA_TRUE;
+   e_ofono_element_ref(element);
+   _e_ofono_elements_sync_pump();
+}
 
-        if (interfaces)
-           e = e_ofono_element_get(element->path, item_old);
-        else
-           e = e_ofono_element_get(item_old,
-                                   _e_ofono_element_get_interface(prop_name));
+/**
+ * Start the initial sync from the manager.
+ *
+ * E_OFONO_EVENT_ELEMENTS_SYNCED is posted once the properties of the manager
+ * and of all the elements found from it arrived.
+ * @internal
+ */
+void
+e_ofono_elements_sync(E_Ofono_Element *manager)
+{
+   EINA_SAFETY_ON_NULL_RETURN(manager);
 
-        if (e)
-          {
-             e_ofono_element_unregister(e);
-             DBG("Deleted element %s %s\n", e->path, e->interface);
-          }
+   sync_initial = EINA_TRUE;
+   /* already on its way outside of the queue, wait for that reply */
+   if ((manager->_pending.properties_get) && (!sync_manager))
+     {
+        sync_manager = manager;
+        sync_in_flight++;
      }
+   else
+      e_ofono_element_sync_queue(manager);
 }
 
-static Eina_Bool
-_e_ofono_element_property_update(E_Ofono_Element_Property *property, int type, void *data, E_Ofono_Element *element)
+/**
+ * Set how many GetProperties() may be in flight at once.
+ *
+ * The default of 8 keeps the server busy without flooding it.  Zero
+ * removes the limit.
+ *
+ * @param window maximum number of calls waiting for a reply.
+ */
+void
+e_ofono_elements_sync_window_set(unsigned int window)
 {
-   Eina_Bool changed = EINA_FALSE;
-
-   if ((type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH) && data)
-      data = (char *)eina_stringshare_add(data);
+   sync_window = window;
+   _e_ofono_elements_sync_pump();
+}
 
-   if (property->type != type)
-     {
-        if (property->type)
-           DBG("property type changed from '%c' to '%c'",
-               property->type, type);
+/**
+ * Get how many GetProperties() may be in flight at once.
+ *
+ * @return the window, zero if unlimited.
+ */
+unsigned int
+e_ofono_elements_sync_window_get(void)
+{
+   return sync_window;
+}
 
-        _e_ofono_element_property_value_free(property);
-        memset(&property->value, 0, sizeof(property->value));
-        property->type = type;
-        changed = EINA_TRUE;
-     }
+/***********************************************************************
+* Property
+***********************************************************************/
 
-   switch (type)
+static void
+_e_ofono_element_dict_entry_free(E_Ofono_Element_Dict_Entry *entry)
+{
+   switch (entry->type)
      {
       case DBUS_TYPE_BOOLEAN:
-         if (changed || property->value.boolean != (Eina_Bool)(long)data)
-           {
-              property->value.boolean = (Eina_Bool)(long)data;
-              changed = EINA_TRUE;
-           }
-
-         break;
-
       case DBUS_TYPE_BYTE:
-         if (changed || property->value.byte != (unsigned char)(long)data)
-           {
-              property->value.byte = (unsigned char)(long)data;
-              changed = EINA_TRUE;
-           }
-
-         break;
-
       case DBUS_TYPE_UINT16:
-         if (changed || property->value.u16 != (unsigned short)(long)data)
-           {
-              property->value.u16 = (unsigned short)(long)data;
-              changed = EINA_TRUE;
-           }
-
-         break;
-
       case DBUS_TYPE_UINT32:
-         if (changed || property->value.u32 != (unsigned int)(long)data)
-           {
-              property->value.u32 = (unsigned int)(long)data;
-              changed = EINA_TRUE;
-           }
+         break;
 
+      case DBUS_TYPE_OBJECT_PATH:
+         eina_stringshare_del(entry->value.path);
          break;
 
       case DBUS_TYPE_STRING:
-         if (changed)
-           {
-              property->value.str = data;
-           }
-         else
-           {
-              if (property->value.str)
-                 eina_stringshare_del(property->value.str);
-
-              if (property->value.str != data)
-                {
-                   property->value.str = data;
-                   changed = EINA_TRUE;
-                }
-           }
-
-         break;
-
-      case DBUS_TYPE_OBJECT_PATH:
-         if (changed)
-           {
-              property->value.path = data;
-           }
-         else
-           {
-              if (property->value.path)
-                 eina_stringshare_del(property->value.path);
-
-              if (property->value.path != data)
-                {
-                   property->value.path = data;
-                   changed = EINA_TRUE;
-                }
-           }
-
-         break;
-
-      case DBUS_TYPE_ARRAY:
-         if (!changed)
-            if (property->value.array)
-              {
-                 _e_ofono_element_array_match(property->value.array, data,
-                                              property->name, element);
-                 _e_ofono_element_array_free(property->value.array, data);
-              }
-
-         property->value.array = data;
-         changed = EINA_TRUE;
+         eina_stringshare_del(entry->value.str);
          break;
 
       default:
-         ERR("don't know how to update property type %c (%d)", type, type);
+         ERR("don't know how to free dict entry '%s' of type %c (%d)",
+             entry->name, entry->type, entry->type);
      }
 
-   return changed;
+   eina_stringshare_del(entry->name);
+   free(entry);
 }
 
-static E_Ofono_Element_Property *
-_e_ofono_element_property_new(const char *name, int type, void *data, E_Ofono_Element *element)
+static E_Ofono_Element_Dict_Entry *
+_e_ofono_element_dict_entry_new(DBusMessageIter *itr)
 {
-   E_Ofono_Element_Property *property;
+   E_Ofono_Element_Dict_Entry *entry;
+   DBusMessageIter e_itr, v_itr;
+   int t;
+   const char *key = NULL;
+   void *value = NULL;
 
-   property = calloc(1, sizeof(*property));
-   if (!property)
+   dbus_message_iter_recurse(itr, &e_itr);
+
+   t = dbus_message_iter_get_arg_type(&e_itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
      {
-        eina_stringshare_del(name);
-        ERR("could not allocate property: %s", strerror(errno));
+        ERR("invalid format for dict entry. first type not a string: %c (%d)",
+            t, t);
         return NULL;
      }
 
-   property->name = name;
-   _e_ofono_element_property_update(property, type, data, element);
-   return property;
-}
-
-static void
-_e_ofono_element_property_free(E_Ofono_Element_Property *property)
-{
-   _e_ofono_element_property_value_free(property);
-   eina_stringshare_del(property->name);
-   free(property);
-}
-
-/***********************************************************************
-* Element
-***********************************************************************/
-unsigned char *
-e_ofono_element_bytes_array_get_stringshared(const E_Ofono_Element *element, const char *property, unsigned int *count)
-{
-   Eina_Array_Iterator iterator;
-   E_Ofono_Array *array;
-   unsigned char *ret, *p;
-   unsigned int i;
-   void *item;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, NULL);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(property, NULL);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, NULL);
-
-   *count = 0;
+   dbus_message_iter_get_basic(&e_itr, &key);
+   if (!key || !key[0])
+     {
+        ERR("invalid format for dict entry. no key.");
+        return NULL;
+     }
 
-   if (!e_ofono_element_property_get_stringshared
-          (element, property, NULL, &array))
-      return NULL;
+   dbus_message_iter_next(&e_itr);
+   t = dbus_message_iter_get_arg_type(&e_itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+     {
+        ERR("invalid format for dict entry '%s'. "
+            "second type not a variant: %c (%d)",
+            key, t, t);
+        return NULL;
+     }
 
-   if ((!array) || (!(array->array)))
-      return NULL;
+   dbus_message_iter_recurse(&e_itr, &v_itr);
 
-   *count = eina_array_count(array->array);
-   ret = malloc(*count * sizeof(unsigned char));
-   if (!ret)
+   t = dbus_message_iter_get_arg_type(&v_itr);
+   if ((t == DBUS_TYPE_INVALID) || (t == DBUS_TYPE_ARRAY))
      {
-        ERR("could not allocate return array of %d bytes: %s",
-            *count, strerror(errno));
+        ERR("invalid type for dict value for entry '%s': %c (%d)",
+            key, t, t);
         return NULL;
      }
 
-   p = ret;
-
-   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-   {
-      *p = (unsigned char)(long)item;
-      p++;
-   }
-   return ret;
-}
+   entry = calloc(1, sizeof(*entry));
+   if (!entry)
+     {
+        ERR("could not allocate memory for dict entry.");
+        return NULL;
+     }
 
-Eina_Bool
-e_ofono_element_objects_array_get_stringshared(const E_Ofono_Element *element, const char *property, unsigned int *count, E_Ofono_Element ***p_elements)
-{
-   E_Ofono_Element **ret, **p;
-   Eina_Array_Iterator iterator;
-   E_Ofono_Array *array;
-   unsigned int i;
-   int type;
-   void *item;
+   dbus_message_iter_get_basic(&v_itr, &value);
+   switch (t)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         entry->value.boolean = (Eina_Bool)(long)value;
+         break;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+      case DBUS_TYPE_BYTE:
+         entry->value.byte = (unsigned char)(long)value;
+         break;
 
-   *count = 0;
-   *p_elements = NULL;
+      case DBUS_TYPE_UINT16:
+         entry->value.u16 = (unsigned short)(long)value;
+         break;
 
-   if (!e_ofono_element_property_get_stringshared
-          (element, property, &type, &array))
-      return EINA_FALSE;
+      case DBUS_TYPE_UINT32:
+         entry->value.u32 = (unsigned int)(long)value;
+         break;
 
-   if (type != DBUS_TYPE_ARRAY)
-     {
-        ERR("property %s is not an array!", property);
-        return EINA_FALSE;
-     }
+      case DBUS_TYPE_STRING:
+         entry->value.str = eina_stringshare_add(value);
+         break;
 
-   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
-      return EINA_FALSE;
+      case DBUS_TYPE_OBJECT_PATH:
+         entry->value.path = eina_stringshare_add(value);
+         break;
 
-   if (array->type != DBUS_TYPE_OBJECT_PATH)
-     {
-        ERR("property %s is not an array of object paths!", property);
-        return EINA_FALSE;
+      default:
+         ERR("don't know how to create dict entry '%s' for of type %c (%d)",
+             key, t, t);
+         free(entry);
+         return NULL;
      }
 
-   *count = eina_array_count(array->array);
-   ret = malloc(*count * sizeof(E_Ofono_Element *));
-   if (!ret)
-     {
-        ERR("could not allocate return array of %d elements: %s",
-            *count, strerror(errno));
-        *count = 0;
-        return EINA_FALSE;
-     }
+   entry->name = eina_stringshare_add(key);
+   entry->type = t;
+   return entry;
+}
 
-   p = ret;
+static E_Ofono_Element_Dict_Entry *
+_e_ofono_element_array_dict_find_stringshared(const E_Ofono_Array *array, const char *key)
+{
+   E_Ofono_Element_Dict_Entry *entry;
+   Eina_Array_Iterator iterator;
+   unsigned int i;
 
-   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-   {
-      E_Ofono_Element *e = e_ofono_element_get(item, property);
-      if (!e)
-         continue;
+   EINA_ARRAY_ITER_NEXT(array->array, i, entry, iterator)
+   if (entry->name == key)
+      return entry;
 
-      *p = e;
-      p++;
-   }
-   *count = p - ret;
-   *p_elements = ret;
-   return EINA_TRUE;
+   return NULL;
 }
 
-/* strings are just pointers (references), no strdup or stringshare_add/ref */
-Eina_Bool
-e_ofono_element_strings_array_get_stringshared(const E_Ofono_Element *element, const char *property, unsigned int *count, const char ***strings)
+static void
+_e_ofono_element_array_free(E_Ofono_Array *array, E_Ofono_Array *new __UNUSED__)
 {
-   const char **ret, **p;
    Eina_Array_Iterator iterator;
-   E_Ofono_Array *array;
    unsigned int i;
-   int type;
    void *item;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(strings, EINA_FALSE);
-
-   *count = 0;
-   *strings = NULL;
-
-   if (!e_ofono_element_property_get_stringshared
-          (element, property, &type, &array))
-      return EINA_FALSE;
+   if (!array)
+      return;
 
-   if (type != DBUS_TYPE_ARRAY)
+   switch (array->type)
      {
-        ERR("property %s is not an array!", property);
-        return EINA_FALSE;
-     }
+      case DBUS_TYPE_BOOLEAN:
+      case DBUS_TYPE_BYTE:
+      case DBUS_TYPE_UINT16:
+      case DBUS_TYPE_UINT32:
+         break;
 
-   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
-      return EINA_FALSE;
+      case DBUS_TYPE_OBJECT_PATH:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         eina_stringshare_del(item);
+         break;
 
-   if (array->type != DBUS_TYPE_STRING)
-     {
-        ERR("property %s is not an array of strings!", property);
-        return EINA_FALSE;
-     }
-
-   *count = eina_array_count(array->array);
-   ret = malloc(*count * sizeof(char *));
-   if (!ret)
-     {
-        ERR("could not allocate return array of %d strings: %s",
-            *count, strerror(errno));
-        *count = 0;
-        return EINA_FALSE;
-     }
-
-   p = ret;
+      case DBUS_TYPE_STRING:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         eina_stringshare_del(item);
+         break;
 
-   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-   {
-      if (!item)
-         continue;
+      case DBUS_TYPE_DICT_ENTRY:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         _e_ofono_element_dict_entry_free(item);
+         break;
 
-      *p = item;
-      p++;
-   }
-   *count = p - ret;
-   *strings = ret;
-   return EINA_TRUE;
+      default:
+         ERR("don't know how to free array of values of type %c (%d)",
+             array->type, array->type);
+         break;
+     }
+   eina_array_free(array->array);
+   free(array);
 }
 
+/* iterators may borrow the object paths of a property, stop them */
 static void
-_e_ofono_element_array_print(FILE *fp, E_Ofono_Array *array)
+_e_ofono_element_property_array_free(E_Ofono_Array *array)
 {
-   Eina_Array_Iterator iterator;
-   unsigned int i;
-   void *item;
+   if ((array) && (array->type == DBUS_TYPE_OBJECT_PATH))
+      elements_generation++;
 
-   if (!array)
-      return;
+   _e_ofono_element_array_free(array, NULL);
+}
 
-   switch (array->type)
+static void
+_e_ofono_element_property_value_free(E_Ofono_Element_Property *property)
+{
+   switch (property->type)
      {
-      case DBUS_TYPE_OBJECT_PATH:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "\"%s\", ", (const char *)item);
-         break;
-
-      case DBUS_TYPE_STRING:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "\"%s\", ", (const char *)item);
-         break;
+      case 0:
+         return;
 
+      case DBUS_TYPE_BOOLEAN:
       case DBUS_TYPE_BYTE:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "%#02hhx (\"%c\"), ", (unsigned char)(long)item,
-                 (unsigned char)(long)item);
-         break;
-
       case DBUS_TYPE_UINT16:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "%#04hx (%hu), ", (unsigned short)(long)item,
-                 (unsigned short)(long)item);
-         break;
-
       case DBUS_TYPE_UINT32:
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         fprintf(fp, "%#08x (%u), ", (unsigned int)(long)item,
-                 (unsigned int)(long)item);
          break;
 
-      case DBUS_TYPE_DICT_ENTRY:
-         fputs("{ ", fp);
-         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
-         {
-            E_Ofono_Element_Dict_Entry *entry = item;
-            fprintf(fp, "%s: ", entry->name);
-            switch (entry->type)
-              {
-               case DBUS_TYPE_OBJECT_PATH:
-                  fprintf(fp, "\"%s\", ", entry->value.path);
-                  break;
-
-               case DBUS_TYPE_STRING:
-                  fprintf(fp, "\"%s\", ", entry->value.str);
-                  break;
-
-               case DBUS_TYPE_BYTE:
-                  fprintf(fp, "%#02hhx (\"%c\"), ",
-                          entry->value.byte, entry->value.byte);
-                  break;
-
-               case DBUS_TYPE_UINT16:
-                  fprintf(fp, "%#04hx (%hu), ",
-                          entry->value.u16, entry->value.u16);
-                  break;
+      case DBUS_TYPE_STRING:
+         eina_stringshare_del(property->value.str);
+         break;
 
-               case DBUS_TYPE_UINT32:
-                  fprintf(fp, "%#08x (%u), ",
-                          entry->value.u32, entry->value.u32);
-                  break;
+      case DBUS_TYPE_OBJECT_PATH:
+         eina_stringshare_del(property->value.path);
+         break;
 
-               default:
-                  fprintf(fp, "<UNKNOWN TYPE '%c'>", entry->type);
-              }
-         }
-         fputs("}", fp);
+      case DBUS_TYPE_ARRAY:
+         _e_ofono_element_property_array_free(property->value.array);
          break;
 
       default:
-         fprintf(fp, "<UNKNOWN ARRAY TYPE '%c'>", array->type);
+         ERR("don't know how to free value of property type %c (%d)",
+             property->type, property->type);
      }
 }
 
-/**
- * Print element to file descriptor.
- */
-void
-e_ofono_element_print(FILE *fp, const E_Ofono_Element *element)
+static const char *
+_e_ofono_element_get_interface(const char *key)
 {
-   const E_Ofono_Element_Property *p;
-
-   EINA_SAFETY_ON_NULL_RETURN(fp);
-   if (!element)
-     {
-        fputs("Error: no element to print\n", fp);
-        return;
-     }
-
-   fprintf(fp,
-           "Element %p: %s [%s]\n"
-           "\tProperties:\n",
-           element, element->path, element->interface);
-
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      fprintf(fp, "\t\t%s (%c) = ", p->name, p->type);
-
-      switch (p->type)
-        {
-         case DBUS_TYPE_STRING:
-            fprintf(fp, "\"%s\"", p->value.str);
-            break;
-
-         case DBUS_TYPE_OBJECT_PATH:
-            fprintf(fp, "\"%s\"", p->value.path);
-            break;
-
-         case DBUS_TYPE_BOOLEAN:
-            fprintf(fp, "%hhu", p->value.boolean);
-            break;
+   const char *interface = NULL, *tail;
+   char head;
 
-         case DBUS_TYPE_BYTE:
-            fprintf(fp, "%#02hhx (%d), ", p->value.byte, p->value.byte);
-            break;
+   head = key[0];
+   tail = key + 1;
 
-         case DBUS_TYPE_UINT16:
-            fprintf(fp, "%hu", p->value.u16);
-            break;
+   switch (head)
+     {
+      case 'M':
+         if (strcmp(tail, "odems") == 0)
+            interface = e_ofono_iface_modem;
 
-         case DBUS_TYPE_UINT32:
-            fprintf(fp, "%u", p->value.u32);
-            break;
+         break;
 
-         case DBUS_TYPE_ARRAY:
-            _e_ofono_element_array_print(fp, p->value.array);
-            break;
+      default:
+         break;
+     }
 
-         default:
-            fputs("don't know how to print type", fp);
-        }
+   if (!interface)
+      ERR("failed to find interface for property \"%s\"", key);
 
-      fputc('\n', fp);
-   }
+   return interface;
 }
 
 static E_Ofono_Element *
-e_ofono_element_new(const char *path, const char *interface)
+_e_ofono_element_item_register(const char *key, const char *item)
 {
    E_Ofono_Element *element;
+   const char *interface;
 
-   element = calloc(1, sizeof(*element));
-   if (!element)
-     {
-        ERR("could not allocate element: %s",   strerror(errno));
-        return NULL;
-     }
+   interface = _e_ofono_element_get_interface(key);
+   if (!interface)
+      return NULL;
 
-   element->path = eina_stringshare_add(path);
-   element->interface = eina_stringshare_ref(interface);
-   element->_references = 1;
+   /* those synced already follow their PropertyChanged signals */
+   element = e_ofono_element_register(item, interface);
+   if ((element) && (!element->_synced))
+      e_ofono_element_sync_queue(element);
 
    return element;
 }
 
-static void
-e_ofono_element_extra_properties_free(E_Ofono_Element *element)
+static E_Ofono_Element *
+_e_ofono_element_array_item_get(E_Ofono_Element *element, const char *prop_name, Eina_Bool interfaces, const char *item)
 {
-   while (element->props)
-     {
-        E_Ofono_Element_Property *prop;
-        prop = (E_Ofono_Element_Property *)element->props;
-        element->props = element->props->next;
-        _e_ofono_element_property_free(prop);
-     }
+   if (interfaces)
+      return e_ofono_element_get(element->path, item);
+
+   return e_ofono_element_get(item, _e_ofono_element_get_interface(prop_name));
 }
 
+/* Match 2 arrays to find which are new, which are old and which moved
+ * For new elements, register them under prop_name property
+ * For old elements, unregister them, sending proper DEL event
+ * For elements still there but out of order, send a MOVED event
+ *
+ * Items are stringshares, so they are matched by pointer against a hash
+ * of the old positions.  The moved ones are those left out of the longest
+ * run of kept items that is still in the old order, so raising one item
+ * to the top of a long list reports just that item.
+ */
+#define ARRAY_MATCH_IN_ORDER ((unsigned int)-1)
+
 static void
-e_ofono_element_free(E_Ofono_Element *element)
+_e_ofono_element_array_match(E_Ofono_Array *old, E_Ofono_Array *new, const char *prop_name, E_Ofono_Element *element)
 {
-   if (element->_idler.changed)
-      ecore_idler_del(element->_idler.changed);
+   unsigned int n_old, n_new, n_kept = 0, n_run = 0, i;
+   unsigned int *from, *to, *tails, *prev;
+   Eina_Hash *positions;
+   E_Ofono_Element *e;
+   void *item;
+   Eina_Bool interfaces = EINA_FALSE;
 
-   while (element->_listeners)
+   if (!old)
+      return;
+
+   if ((old->type != DBUS_TYPE_OBJECT_PATH) &&
+       (old->type != DBUS_TYPE_STRING))
+      return;
+
+   /* is this a list of interfaces? */
+   interfaces = !strcmp(prop_name, "Interfaces");
+
+   n_old = old->array ? eina_array_count(old->array) : 0;
+   n_new = ((new) && (new->array)) ? eina_array_count(new->array) : 0;
+   if ((n_old == 0) && (n_new == 0))
+      return;
+
+   positions = eina_hash_pointer_new(NULL);
+   from = malloc(4 * (n_new + 1) * sizeof(unsigned int));
+   if ((!positions) || (!from))
      {
-        E_Ofono_Element_Listener *l = (void *)element->_listeners;
-        element->_listeners = eina_inlist_remove
-              (element->_listeners, element->_listeners);
+        ERR("could not match the items of %s", prop_name);
+        if (positions)
+           eina_hash_free(positions);
 
-        if (l->free_data)
-           l->free_data(l->data);
+        free(from);
+        return;
+     }
+   to = from + n_new + 1;
+   tails = to + n_new + 1;
+   prev = tails + n_new + 1;
 
-        free(l);
+   for (i = 0; i < n_old; i++)
+     {
+        item = eina_array_data_get(old->array, i);
+        if (!eina_hash_find(positions, &item))
+           eina_hash_add(positions, &item, (void *)(uintptr_t)(i + 1));
      }
 
-   e_ofono_element_pending_cancel_and_free(&element->_pending.properties_get);
-   e_ofono_element_pending_cancel_and_free(&element->_pending.property_set);
-   e_ofono_element_pending_cancel_and_free(&element->_pending.send_sms);
+   /* from[] and to[] are the old and new indexes of each kept item */
+   for (i = 0; i < n_new; i++)
+     {
+        uintptr_t pos;
 
-   e_ofono_element_extra_properties_free(element);
-   eina_stringshare_del(element->interface);
-   eina_stringshare_del(element->path);
-   free(element);
-}
-
-/**
- * Add reference to element.
- */
-int
-e_ofono_element_ref(E_Ofono_Element *element)
-{
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
-   return ++element->_references;
-}
+        item = eina_array_data_get(new->array, i);
+        pos = (uintptr_t)eina_hash_find(positions, &item);
+        if (pos)
+          {
+             eina_hash_del_by_key(positions, &item);
+             from[n_kept] = pos - 1;
+             to[n_kept] = i;
+             n_kept++;
+          }
+        else
+          {
+             if (interfaces)
+                e = e_ofono_element_register(element->path, item);
+             else
+                e = _e_ofono_element_item_register(prop_name, item);
 
-/**
- * Remove reference from element.
- *
- * If reference count drops to 0 element will be freed.
- */
-int
-e_ofono_element_unref(E_Ofono_Element *element)
-{
-   int i;
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
+             if (e)
+                DBG("Add element %s (%s)\n", e->path, e->interface);
+          }
+     }
 
-   i = --element->_references;
-   if (i == 0)
-      e_ofono_element_free(element);
-   else if (i < 0)
-      ERR("element %p references %d < 0", element, i);
+   /* whatever is still in positions is gone */
+   for (i = 0; i < n_old; i++)
+     {
+        item = eina_array_data_get(old->array, i);
+        if (!eina_hash_find(positions, &item))
+           continue;
 
-   return i;
-}
+        eina_hash_del_by_key(positions, &item);
+        e = _e_ofono_element_array_item_get(element, prop_name, interfaces, item);
+        if (e)
+          {
+             e_ofono_element_unregister(e);
+             DBG("Deleted element %s %s\n", e->path, e->interface);
+          }
+     }
+   eina_hash_free(positions);
 
-/**
- * Send message with callbacks set to work with ofono elements.
- *
- * If this call fails (returns 0), pending callbacks will not be called,
- * not even with error messages.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_ofono_element_message_send(E_Ofono_Element *element, const char *method_name, const char *interface, E_DBus_Method_Return_Cb cb, DBusMessage *msg, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
-{
-   E_Ofono_Element_Call_Data *data;
-   E_Ofono_Element_Pending *p;
+   /* longest increasing run of from[], tails[k] ends the best of length k + 1 */
+   for (i = 0; i < n_kept; i++)
+     {
+        unsigned int lo = 0, hi = n_run;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(msg, EINA_FALSE);
+        while (lo < hi)
+          {
+             unsigned int mid = (lo + hi) / 2;
 
-   interface = interface ? : element->interface;
+             if (from[tails[mid]] < from[i])
+                lo = mid + 1;
+             else
+                hi = mid;
+          }
 
-   data = malloc(sizeof(*data));
-   if (!data)
-     {
-        ERR("could not alloc e_ofono_element_call_data: %s",
-            strerror(errno));
-        dbus_message_unref(msg);
-        return EINA_FALSE;
+        prev[i] = lo ? tails[lo - 1] : ARRAY_MATCH_IN_ORDER;
+        tails[lo] = i;
+        if (lo == n_run)
+           n_run++;
      }
 
-   p = malloc(sizeof(*p));
-   if (!p)
+   if (n_run)
+      for (i = tails[n_run - 1]; i != ARRAY_MATCH_IN_ORDER; i = prev[i])
+         to[i] = ARRAY_MATCH_IN_ORDER;
+
+   for (i = 0; i < n_kept; i++)
      {
-        ERR("could not alloc E_Ofono_Element_Pending: %s",
-            strerror(errno));
-        free(data);
-        dbus_message_unref(msg);
-        return EINA_FALSE;
-     }
+        if (to[i] == ARRAY_MATCH_IN_ORDER)
+           continue;
 
-   data->element = element;
-   data->cb = cb;
-   data->pending = p;
-   data->p_list = pending;
-   p->user_cb = user_cb;
-   p->user_data = (void *)user_data;
-   p->data = data;
-   p->pending = e_dbus_message_send
-         (e_ofono_conn, msg, e_ofono_element_call_dispatch_and_free, -1, data);
-   dbus_message_unref(msg);
+        item = eina_array_data_get(new->array, to[i]);
+        e = _e_ofono_element_array_item_get(element, prop_name, interfaces, item);
+        if (!e)
+           continue;
 
-   if (p->pending)
-     {
-        *pending = eina_inlist_append(*pending, EINA_INLIST_GET(p));
-        return EINA_TRUE;
+        e_ofono_element_event_add(E_OFONO_EVENT_ELEMENT_MOVED, e);
+        DBG("Moved element %s %s\n", e->path, e->interface);
      }
 
-   ERR("failed to call %s (obj=%s, path=%s, iface=%s)",
-       method_name, e_ofono_system_bus_name_get(),
-       element->path, interface);
-   free(data);
-   free(p);
-   return EINA_FALSE;
+   free(from);
 }
 
-Eina_Bool
-e_ofono_element_call_full(E_Ofono_Element *element, const char *method_name, const char *interface, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+#undef ARRAY_MATCH_IN_ORDER
+
+static Eina_Bool
+_e_ofono_element_dict_entry_equal(const E_Ofono_Element_Dict_Entry *a, const E_Ofono_Element_Dict_Entry *b)
 {
-   DBusMessage *msg;
+   if ((a->name != b->name) || (a->type != b->type))
+      return EINA_FALSE;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+   switch (a->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         return a->value.boolean == b->value.boolean;
 
-   interface = interface ? : element->interface;
+      case DBUS_TYPE_BYTE:
+         return a->value.byte == b->value.byte;
 
-   msg = dbus_message_new_method_call
-         (e_ofono_system_bus_name_get(), element->path, interface,
-         method_name);
+      case DBUS_TYPE_UINT16:
+         return a->value.u16 == b->value.u16;
 
-   return e_ofono_element_message_send
-             (element, method_name, interface, cb, msg, pending, user_cb, user_data);
+      case DBUS_TYPE_UINT32:
+         return a->value.u32 == b->value.u32;
+
+      case DBUS_TYPE_STRING:
+         return a->value.str == b->value.str;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         return a->value.path == b->value.path;
+
+      default:
+         return EINA_FALSE;
+     }
 }
 
+/* items are stringshares or integers, so they compare as pointers */
 static Eina_Bool
-_e_ofono_element_property_value_add(E_Ofono_Element *element, const char *name, int type, void *value)
+_e_ofono_element_array_equal(const E_Ofono_Array *a, const E_Ofono_Array *b)
 {
-   E_Ofono_Element_Property *p;
+   unsigned int i, count;
 
-   name = eina_stringshare_add(name);
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      if (p->name == name)
-        {
-           eina_stringshare_del(name);
-           return _e_ofono_element_property_update(p, type, value, element);
-        }
-   }
+   if ((!a) || (!b))
+      return a == b;
 
-   p = _e_ofono_element_property_new(name, type, value, element);
-   if (!p)
+   count = eina_array_count(a->array);
+   if ((a->type != b->type) || (count != eina_array_count(b->array)))
+      return EINA_FALSE;
+
+   for (i = 0; i < count; i++)
      {
-        ERR("could not create property %s (%c)", name, type);
-        return EINA_FALSE;
+        void *x = eina_array_data_get(a->array, i);
+        void *y = eina_array_data_get(b->array, i);
+
+        if (a->type == DBUS_TYPE_DICT_ENTRY)
+          {
+             if (!_e_ofono_element_dict_entry_equal(x, y))
+                return EINA_FALSE;
+          }
+        else if (x != y)
+           return EINA_FALSE;
      }
 
-   element->props = eina_inlist_append(element->props, EINA_INLIST_GET(p));
    return EINA_TRUE;
 }
 
-static E_Ofono_Array *
-_e_ofono_element_iter_get_array(DBusMessageIter *itr, const char *key)
+static Eina_Bool
+_e_ofono_element_property_update(E_Ofono_Element_Property *property, int type, void *data, E_Ofono_Element *element)
 {
-   E_Ofono_Array *array;
-   DBusMessageIter e_itr;
+   Eina_Bool changed = EINA_FALSE;
 
-   array = malloc(sizeof(E_Ofono_Array));
-   if (!array)
-     {
-        ERR("could not create new e_ofono array.");
-        return NULL;
-     }
+   if ((type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH) && data)
+      data = (char *)eina_stringshare_add(data);
 
-   array->array = eina_array_new(16);
-   if (!(array->array))
+   if (property->type != type)
      {
-        ERR("could not create new eina array.");
-        free(array);
-        return NULL;
-     }
+        if (property->type)
+           DBG("property type changed from '%c' to '%c'",
+               property->type, type);
 
-   dbus_message_iter_recurse(itr, &e_itr);
-   array->type = dbus_message_iter_get_arg_type(&e_itr);
-   if (array->type == DBUS_TYPE_INVALID)
-     {
-        DBG("array %s is of type 'invalid' (empty?)", key);
-        eina_array_free(array->array);
-        free(array);
-        return NULL;
+        _e_ofono_element_property_value_free(property);
+        memset(&property->value, 0, sizeof(property->value));
+        property->type = type;
+        changed = EINA_TRUE;
      }
 
-   do
+   switch (type)
      {
-        switch (array->type)
-          {
-           case DBUS_TYPE_OBJECT_PATH:
+      case DBUS_TYPE_BOOLEAN:
+         if (changed || property->value.boolean != (Eina_Bool)(long)data)
            {
-              const char *path;
-
-              dbus_message_iter_get_basic(&e_itr, &path);
-              path = eina_stringshare_add(path);
-              eina_array_push(array->array, path);
-              _e_ofono_element_item_register(key, path);
+              property->value.boolean = (Eina_Bool)(long)data;
+              changed = EINA_TRUE;
            }
-           break;
 
-           case DBUS_TYPE_STRING:
-           {
-              const char *str;
+         break;
 
-              dbus_message_iter_get_basic(&e_itr, &str);
-              str = eina_stringshare_add(str);
-              eina_array_push(array->array, str);
+      case DBUS_TYPE_BYTE:
+         if (changed || property->value.byte != (unsigned char)(long)data)
+           {
+              property->value.byte = (unsigned char)(long)data;
+              changed = EINA_TRUE;
            }
-           break;
 
-           case DBUS_TYPE_BYTE:
+         break;
+
+      case DBUS_TYPE_UINT16:
+         if (changed || property->value.u16 != (unsigned short)(long)data)
            {
-              unsigned char byte;
-              dbus_message_iter_get_basic(&e_itr, &byte);
-              eina_array_push(array->array, (void *)(long)byte);
+              property->value.u16 = (unsigned short)(long)data;
+              changed = EINA_TRUE;
            }
-           break;
 
-           case DBUS_TYPE_DICT_ENTRY:
+         break;
+
+      case DBUS_TYPE_UINT32:
+         if (changed || property->value.u32 != (unsigned int)(long)data)
            {
-              E_Ofono_Element_Dict_Entry *entry;
-              entry = _e_ofono_element_dict_entry_new(&e_itr);
-              if (entry)
-                 eina_array_push(array->array, entry);
+              property->value.u32 = (unsigned int)(long)data;
+              changed = EINA_TRUE;
            }
-           break;
 
-           default:
-              ERR("don't know how to build array '%s' of type %c (%d)",
-                  key, array->type, array->type);
-              eina_array_free(array->array);
-              free(array);
-              return NULL;
-          }
-     }
-   while (dbus_message_iter_next(&e_itr));
-   return array;
-}
+         break;
+
+      case DBUS_TYPE_STRING:
+         if (changed)
+           {
+              property->value.str = data;
+           }
+         else
+           {
+              if (property->value.str)
+                 eina_stringshare_del(property->value.str);
+
+              if (property->value.str != data)
+                {
+                   property->value.str = data;
+                   changed = EINA_TRUE;
+                }
+           }
+
+         break;
+
+      case DBUS_TYPE_OBJECT_PATH:
+         if (changed)
+           {
+              property->value.path = data;
+           }
+         else
+           {
+              if (property->value.path)
+                 eina_stringshare_del(property->value.path);
+
+              if (property->value.path != data)
+                {
+                   property->value.path = data;
+                   changed = EINA_TRUE;
+                }
+           }
+
+         break;
+
+      case DBUS_TYPE_ARRAY:
+         if (changed)
+           {
+              property->value.array = data;
+              break;
+           }
+
+         /* an equal array keeps the old one, so its views stay valid.  A
+          * changed one is freed right away as the message is handled, not
+          * when the listeners are told later on. */
+         if (_e_ofono_element_array_equal(property->value.array, data))
+           {
+              _e_ofono_element_array_free(data, NULL);
+              break;
+           }
+
+         if (property->value.array)
+            _e_ofono_element_array_match(property->value.array, data,
+                                         property->name, element);
+         _e_ofono_element_property_array_free(property->value.array);
+         property->value.array = data;
+         changed = EINA_TRUE;
+         break;
+
+      default:
+         ERR("don't know how to update property type %c (%d)", type, type);
+     }
+
+   return changed;
+}
+
+static E_Ofono_Element_Property *
+_e_ofono_element_property_new(const char *name, int type, void *data, E_Ofono_Element *element)
+{
+   E_Ofono_Element_Property *property;
+
+   property = calloc(1, sizeof(*property));
+   if (!property)
+     {
+        eina_stringshare_del(name);
+        ERR("could not allocate property: %s", strerror(errno));
+        return NULL;
+     }
+
+   property->name = name;
+   _e_ofono_element_property_update(property, type, data, element);
+   return property;
+}
+
+static void
+_e_ofono_element_property_free(E_Ofono_Element_Property *property)
+{
+   _e_ofono_element_property_value_free(property);
+   eina_stringshare_del(property->name);
+   free(property);
+}
+
+/***********************************************************************
+* Element
+***********************************************************************/
+unsigned char *
+e_ofono_element_bytes_array_get_stringshared(const E_Ofono_Element *element, const char *property, unsigned int *count)
+{
+   Eina_Array_Iterator iterator;
+   E_Ofono_Array *array;
+   unsigned char *ret, *p;
+   unsigned int i;
+   void *item;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, NULL);
+
+   *count = 0;
+
+   if (!e_ofono_element_property_get_stringshared
+          (element, property, NULL, &array))
+      return NULL;
+
+   if ((!array) || (!(array->array)))
+      return NULL;
+
+   *count = eina_array_count(array->array);
+   ret = malloc(*count * sizeof(unsigned char));
+   if (!ret)
+     {
+        ERR("could not allocate return array of %d bytes: %s",
+            *count, strerror(errno));
+        return NULL;
+     }
+
+   p = ret;
+
+   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+   {
+      *p = (unsigned char)(long)item;
+      p++;
+   }
+   return ret;
+}
+
+Eina_Bool
+e_ofono_element_objects_array_get_stringshared(const E_Ofono_Element *element, const char *property, unsigned int *count, E_Ofono_Element ***p_elements)
+{
+   E_Ofono_Element **ret, **p;
+   Eina_Array_Iterator iterator;
+   E_Ofono_Array *array;
+   unsigned int i;
+   int type;
+   void *item;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+
+   *count = 0;
+   *p_elements = NULL;
+
+   if (!e_ofono_element_property_get_stringshared
+          (element, property, &type, &array))
+      return EINA_FALSE;
+
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s is not an array!", property);
+        return EINA_FALSE;
+     }
+
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_FALSE;
+
+   if (array->type != DBUS_TYPE_OBJECT_PATH)
+     {
+        ERR("property %s is not an array of object paths!", property);
+        return EINA_FALSE;
+     }
+
+   *count = eina_array_count(array->array);
+   ret = malloc(*count * sizeof(E_Ofono_Element *));
+   if (!ret)
+     {
+        ERR("could not allocate return array of %d elements: %s",
+            *count, strerror(errno));
+        *count = 0;
+        return EINA_FALSE;
+     }
+
+   p = ret;
+
+   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+   {
+      E_Ofono_Element *e = e_ofono_element_get(item, property);
+      if (!e)
+         continue;
+
+      *p = e;
+      p++;
+   }
+   *count = p - ret;
+   *p_elements = ret;
+   return EINA_TRUE;
+}
+
+/* the caller owns the returned array, the strings are still borrowed */
+static Eina_Bool
+_e_ofono_element_strings_array_copy(unsigned int *count, const char ***strings)
+{
+   const char **ret;
+
+   ret = malloc(*count * sizeof(char *));
+   if (!ret)
+     {
+        ERR("could not allocate return array of %d strings: %s",
+            *count, strerror(errno));
+        *count = 0;
+        *strings = NULL;
+        return EINA_FALSE;
+     }
+
+   memcpy(ret, *strings, *count * sizeof(char *));
+   *strings = ret;
+   return EINA_TRUE;
+}
+
+/**
+ * Get a view of an array of strings property.
+ *
+ * Nothing is allocated or copied, @a strings points into the array kept
+ * by the element itself, so it must not be modified or freed.  Updates
+ * with the same strings keep it, but a change frees it as soon as the
+ * message is handled, before the listeners are told, so do not keep it
+ * past a return to the main loop.  The strings are stringshared,
+ * eina_stringshare_ref() them to keep them.
+ *
+ * @param element the element with the property.
+ * @param property name of an array of strings property.
+ * @param count where to return the number of strings.
+ * @param strings where to return the strings, just set if return is
+ *        @c EINA_TRUE.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the property is not
+ *         set or not an array of strings.
+ */
+Eina_Bool
+e_ofono_element_strings_array_view(const E_Ofono_Element *element, const char *property, unsigned int *count, const char ***strings)
+{
+   E_Ofono_Array *array;
+   int type;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(strings, EINA_FALSE);
+
+   *count = 0;
+   *strings = NULL;
+
+   if (!e_ofono_element_property_get_stringshared
+          (element, property, &type, &array))
+      return EINA_FALSE;
+
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s is not an array!", property);
+        return EINA_FALSE;
+     }
+
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_FALSE;
+
+   if (array->type != DBUS_TYPE_STRING)
+     {
+        ERR("property %s is not an array of strings!", property);
+        return EINA_FALSE;
+     }
+
+   *count = eina_array_count(array->array);
+   *strings = (const char **)array->array->data;
+   return EINA_TRUE;
+}
+
+/* the returned array is malloc()ed, strings are just pointers (references),
+ * no strdup or stringshare_add/ref
+ */
+Eina_Bool
+e_ofono_element_strings_array_get_stringshared(const E_Ofono_Element *element, const char *property, unsigned int *count, const char ***strings)
+{
+   if (!e_ofono_element_strings_array_view(element, property, count, strings))
+      return EINA_FALSE;
+
+   return _e_ofono_element_strings_array_copy(count, strings);
+}
+
+static void
+_e_ofono_element_array_print(FILE *fp, E_Ofono_Array *array)
+{
+   Eina_Array_Iterator iterator;
+   unsigned int i;
+   void *item;
+
+   if (!array)
+      return;
+
+   switch (array->type)
+     {
+      case DBUS_TYPE_OBJECT_PATH:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "\"%s\", ", (const char *)item);
+         break;
+
+      case DBUS_TYPE_STRING:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "\"%s\", ", (const char *)item);
+         break;
+
+      case DBUS_TYPE_BYTE:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "%#02hhx (\"%c\"), ", (unsigned char)(long)item,
+                 (unsigned char)(long)item);
+         break;
+
+      case DBUS_TYPE_UINT16:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "%#04hx (%hu), ", (unsigned short)(long)item,
+                 (unsigned short)(long)item);
+         break;
+
+      case DBUS_TYPE_UINT32:
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         fprintf(fp, "%#08x (%u), ", (unsigned int)(long)item,
+                 (unsigned int)(long)item);
+         break;
+
+      case DBUS_TYPE_DICT_ENTRY:
+         fputs("{ ", fp);
+         EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+         {
+            E_Ofono_Element_Dict_Entry *entry = item;
+            fprintf(fp, "%s: ", entry->name);
+            switch (entry->type)
+              {
+               case DBUS_TYPE_OBJECT_PATH:
+                  fprintf(fp, "\"%s\", ", entry->value.path);
+                  break;
+
+               case DBUS_TYPE_STRING:
+                  fprintf(fp, "\"%s\", ", entry->value.str);
+                  break;
+
+               case DBUS_TYPE_BYTE:
+                  fprintf(fp, "%#02hhx (\"%c\"), ",
+                          entry->value.byte, entry->value.byte);
+                  break;
+
+               case DBUS_TYPE_UINT16:
+                  fprintf(fp, "%#04hx (%hu), ",
+                          entry->value.u16, entry->value.u16);
+                  break;
+
+               case DBUS_TYPE_UINT32:
+                  fprintf(fp, "%#08x (%u), ",
+                          entry->value.u32, entry->value.u32);
+                  break;
+
+               default:
+                  fprintf(fp, "<UNKNOWN TYPE '%c'>", entry->type);
+              }
+         }
+         fputs("}", fp);
+         break;
+
+      default:
+         fprintf(fp, "<UNKNOWN ARRAY TYPE '%c'>", array->type);
+     }
+}
+
+/**
+ * Print element to file descriptor.
+ */
+void
+e_ofono_element_print(FILE *fp, const E_Ofono_Element *element)
+{
+   const E_Ofono_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN(fp);
+   if (!element)
+     {
+        fputs("Error: no element to print\n", fp);
+        return;
+     }
+
+   fprintf(fp,
+           "Element %p: %s [%s]\n"
+           "\tProperties:\n",
+           element, element->path, element->interface);
+
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      fprintf(fp, "\t\t%s (%c) = ", p->name, p->type);
+
+      switch (p->type)
+        {
+         case DBUS_TYPE_STRING:
+            fprintf(fp, "\"%s\"", p->value.str);
+            break;
+
+         case DBUS_TYPE_OBJECT_PATH:
+            fprintf(fp, "\"%s\"", p->value.path);
+            break;
+
+         case DBUS_TYPE_BOOLEAN:
+            fprintf(fp, "%hhu", p->value.boolean);
+            break;
+
+         case DBUS_TYPE_BYTE:
+            fprintf(fp, "%#02hhx (%d), ", p->value.byte, p->value.byte);
+            break;
+
+         case DBUS_TYPE_UINT16:
+            fprintf(fp, "%hu", p->value.u16);
+            break;
+
+         case DBUS_TYPE_UINT32:
+            fprintf(fp, "%u", p->value.u32);
+            break;
+
+         case DBUS_TYPE_ARRAY:
+            _e_ofono_element_array_print(fp, p->value.array);
+            break;
+
+         default:
+            fputs("don't know how to print type", fp);
+        }
+
+      fputc('\n', fp);
+   }
+}
+
+static E_Ofono_Element *
+e_ofono_element_new(const char *path, const char *interface)
+{
+   E_Ofono_Element *element;
+
+   element = calloc(1, sizeof(*element));
+   if (!element)
+     {
+        ERR("could not allocate element: %s",   strerror(errno));
+        return NULL;
+     }
+
+   element->path = eina_stringshare_add(path);
+   element->interface = eina_stringshare_ref(interface);
+   element->_references = 1;
+
+   return element;
+}
+
+static void
+e_ofono_element_extra_properties_free(E_Ofono_Element *element)
+{
+   while (element->props)
+     {
+        E_Ofono_Element_Property *prop;
+        prop = (E_Ofono_Element_Property *)element->props;
+        element->props = element->props->next;
+        _e_ofono_element_property_free(prop);
+     }
+
+   free(element->_props_index.slots);
+   element->_props_index.slots = NULL;
+   element->_props_index.size = 0;
+   element->_props_index.count = 0;
+}
+
+static void
+e_ofono_element_free(E_Ofono_Element *element)
+{
+   E_Ofono_Element_Changes changes;
+
+   if (element->_idler.changed)
+      ecore_idler_del(element->_idler.changed);
+
+   _e_ofono_element_changes_take(element, &changes);
+   _e_ofono_element_changes_free(&changes);
+
+   while (element->_listeners)
+     {
+        E_Ofono_Element_Listener *l = (void *)element->_listeners;
+        element->_listeners = eina_inlist_remove
+              (element->_listeners, element->_listeners);
+
+        if (l->free_data)
+           l->free_data(l->data);
+
+        _e_ofono_element_listener_names_free(l->names);
+        free(l);
+     }
+
+   e_ofono_element_pending_cancel_and_free(&element->_pending.properties_get);
+   e_ofono_element_pending_cancel_and_free(&element->_pending.property_set);
+   e_ofono_element_pending_cancel_and_free(&element->_pending.send_sms);
+
+   e_ofono_element_extra_properties_free(element);
+   eina_stringshare_del(element->interface);
+   eina_stringshare_del(element->path);
+   free(element);
+}
+
+/**
+ * Add reference to element.
+ */
+int
+e_ofono_element_ref(E_Ofono_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
+   return ++element->_references;
+}
+
+/**
+ * Remove reference from element.
+ *
+ * If reference count drops to 0 element will be freed.
+ */
+int
+e_ofono_element_unref(E_Ofono_Element *element)
+{
+   int i;
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, 0);
+
+   i = --element->_references;
+   if (i == 0)
+      e_ofono_element_free(element);
+   else if (i < 0)
+      ERR("element %p references %d < 0", element, i);
+
+   return i;
+}
+
+/**
+ * Send message with callbacks set to work with ofono elements.
+ *
+ * If this call fails (returns 0), pending callbacks will not be called,
+ * not even with error messages.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_message_send(E_Ofono_Element *element, const char *method_name, const char *interface, E_DBus_Method_Return_Cb cb, DBusMessage *msg, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   E_Ofono_Element_Call_Data *data;
+   E_Ofono_Element_Pending *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(msg, EINA_FALSE);
+
+   interface = interface ? : element->interface;
+
+   data = malloc(sizeof(*data));
+   if (!data)
+     {
+        ERR("could not alloc e_ofono_element_call_data: %s",
+            strerror(errno));
+        dbus_message_unref(msg);
+        return EINA_FALSE;
+     }
+
+   p = malloc(sizeof(*p));
+   if (!p)
+     {
+        ERR("could not alloc E_Ofono_Element_Pending: %s",
+            strerror(errno));
+        free(data);
+        dbus_message_unref(msg);
+        return EINA_FALSE;
+     }
+
+   data->element = element;
+   data->cb = cb;
+   data->pending = p;
+   data->p_list = pending;
+   p->user_cb = user_cb;
+   p->user_data = (void *)user_data;
+   p->data = data;
+   p->pending = e_dbus_message_send
+         (e_ofono_conn, msg, e_ofono_element_call_dispatch_and_free, -1, data);
+   dbus_message_unref(msg);
+
+   if (p->pending)
+     {
+        *pending = eina_inlist_append(*pending, EINA_INLIST_GET(p));
+        return EINA_TRUE;
+     }
+
+   ERR("failed to call %s (obj=%s, path=%s, iface=%s)",
+       method_name, e_ofono_system_bus_name_get(),
+       element->path, interface);
+   free(data);
+   free(p);
+   return EINA_FALSE;
+}
+
+Eina_Bool
+e_ofono_element_call_full(E_Ofono_Element *element, const char *method_name, const char *interface, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+
+   interface = interface ? : element->interface;
+
+   msg = dbus_message_new_method_call
+         (e_ofono_system_bus_name_get(), element->path, interface,
+         method_name);
+
+   return e_ofono_element_message_send
+             (element, method_name, interface, cb, msg, pending, user_cb, user_data);
+}
+
+/* Properties are also indexed by their stringshared name in a small open
+ * addressing table, so lookups do not walk element->props.  They are
+ * removed all together, or a few after a snapshot was confirmed, so the
+ * table has no tombstones and is rebuilt in that case.
+ */
+#define PROPS_INDEX_MIN_SIZE 8
+
+static unsigned int
+_e_ofono_element_props_index_slot(const char *name, unsigned int size)
+{
+   uintptr_t h = (uintptr_t)name >> 3;
+
+   h ^= h >> 11;
+   return h & (size - 1);
+}
+
+static void
+_e_ofono_element_props_index_put(void **slots, unsigned int size, E_Ofono_Element_Property *p)
+{
+   unsigned int i = _e_ofono_element_props_index_slot(p->name, size);
+
+   while (slots[i])
+      i = (i + 1) & (size - 1);
+   slots[i] = p;
+}
+
+static Eina_Bool
+_e_ofono_element_props_index_add(E_Ofono_Element *element, E_Ofono_Element_Property *p)
+{
+   /* keep the load under 3/4 so the probes stay short */
+   if (4 * (element->_props_index.count + 1) > 3 * element->_props_index.size)
+     {
+        unsigned int size, i;
+        void **slots;
+
+        size = element->_props_index.size * 2;
+        if (size < PROPS_INDEX_MIN_SIZE)
+           size = PROPS_INDEX_MIN_SIZE;
+
+        slots = calloc(size, sizeof(void *));
+        if (!slots)
+          {
+             ERR("could not grow the property index of %s", element->path);
+             return EINA_FALSE;
+          }
+
+        for (i = 0; i < element->_props_index.size; i++)
+           if (element->_props_index.slots[i])
+              _e_ofono_element_props_index_put
+                 (slots, size, element->_props_index.slots[i]);
+
+        free(element->_props_index.slots);
+        element->_props_index.slots = slots;
+        element->_props_index.size = size;
+     }
+
+   _e_ofono_element_props_index_put
+      (element->_props_index.slots, element->_props_index.size, p);
+   element->_props_index.count++;
+   return EINA_TRUE;
+}
+
+/* name must be stringshared */
+static E_Ofono_Element_Property *
+_e_ofono_element_property_find(const E_Ofono_Element *element, const char *name)
+{
+   unsigned int size = element->_props_index.size, i;
+   void **slots = element->_props_index.slots;
+
+   if (!slots)
+      return NULL;
+
+   i = _e_ofono_element_props_index_slot(name, size);
+   while (slots[i])
+     {
+        E_Ofono_Element_Property *p = slots[i];
+
+        if (p->name == name)
+           return p;
+
+        i = (i + 1) & (size - 1);
+     }
+
+   return NULL;
+}
+
+/* name may not be stringshared: try it as one, then by its contents */
+static E_Ofono_Element_Property *
+_e_ofono_element_property_find_string(const E_Ofono_Element *element, const char *name)
+{
+   E_Ofono_Element_Property *p;
+
+   p = _e_ofono_element_property_find(element, name);
+   if (p)
+      return p;
+
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      if (strcmp(p->name, name) == 0)
+         return p;
+   }
+
+   return NULL;
+}
+
+/* the index has no tombstones, so it is rebuilt when properties go */
+static void
+_e_ofono_element_props_index_rebuild(E_Ofono_Element *element)
+{
+   E_Ofono_Element_Property *p;
+
+   if (!element->_props_index.slots)
+      return;
+
+   memset(element->_props_index.slots, 0,
+          element->_props_index.size * sizeof(void *));
+   element->_props_index.count = 0;
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      _e_ofono_element_props_index_put
+         (element->_props_index.slots, element->_props_index.size, p);
+      element->_props_index.count++;
+   }
+}
+
+/* First reply for an element loaded from a snapshot: what the server did
+ * not send again is gone, each reported as a change to DBUS_TYPE_INVALID.
+ */
+static Eina_Bool
+_e_ofono_element_stale_props_del(E_Ofono_Element *element)
+{
+   Eina_Inlist *l = element->props;
+   Eina_Bool changed = EINA_FALSE;
+
+   element->_stale = EINA_FALSE;
+   while (l)
+     {
+        E_Ofono_Element_Property *p = (E_Ofono_Element_Property *)l;
+        E_Ofono_Value old;
+        int old_type = p->type;
+
+        l = l->next;
+        if (!p->stale)
+           continue;
+
+        _e_ofono_element_value_keep(p, &old);
+        _e_ofono_element_property_value_free(p);
+        memset(&p->value, 0, sizeof(p->value));
+        p->type = DBUS_TYPE_INVALID;
+        _e_ofono_element_change_add(element, p, old_type, &old);
+
+        element->props = eina_inlist_remove(element->props, EINA_INLIST_GET(p));
+        _e_ofono_element_property_free(p);
+        changed = EINA_TRUE;
+     }
+
+   if (changed)
+      _e_ofono_element_props_index_rebuild(element);
+
+   return changed;
+}
+
+static Eina_Bool
+_e_ofono_element_property_value_add(E_Ofono_Element *element, const char *name, int type, void *value)
+{
+   E_Ofono_Element_Property *p;
+   E_Ofono_Value none;
+
+   name = eina_stringshare_add(name);
+   p = _e_ofono_element_property_find(element, name);
+   if (p)
+     {
+        E_Ofono_Value old;
+        Eina_Bool changed;
+        int old_type = p->type;
+
+        eina_stringshare_del(name);
+        p->stale = EINA_FALSE;
+        _e_ofono_element_value_keep(p, &old);
+        changed = _e_ofono_element_property_update(p, type, value, element);
+        if (changed)
+           _e_ofono_element_change_add(element, p, old_type, &old);
+        else
+           _e_ofono_element_value_release(old_type, &old);
+
+        E_DBUS_PROBE4(eofono, property_update, element->path, p->name, type, changed);
+        return changed;
+     }
+
+   p = _e_ofono_element_property_new(name, type, value, element);
+   if (!p)
+     {
+        ERR("could not create property %s (%c)", name, type);
+        return EINA_FALSE;
+     }
+
+   if (!_e_ofono_element_props_index_add(element, p))
+     {
+        _e_ofono_element_property_free(p);
+        return EINA_FALSE;
+     }
+
+   element->props = eina_inlist_append(element->props, EINA_INLIST_GET(p));
+   memset(&none, 0, sizeof(none));
+   _e_ofono_element_change_add(element, p, DBUS_TYPE_INVALID, &none);
+   E_DBUS_PROBE4(eofono, property_update, element->path, p->name, type, 2);
+   return EINA_TRUE;
+}
+
+static E_Ofono_Array *
+_e_ofono_element_iter_get_array(DBusMessageIter *itr, const char *key)
+{
+   E_Ofono_Array *array;
+   DBusMessageIter e_itr;
+
+   array = malloc(sizeof(E_Ofono_Array));
+   if (!array)
+     {
+        ERR("could not create new e_ofono array.");
+        return NULL;
+     }
+
+   array->array = eina_array_new(16);
+   if (!(array->array))
+     {
+        ERR("could not create new eina array.");
+        free(array);
+        return NULL;
+     }
+
+   dbus_message_iter_recurse(itr, &e_itr);
+   array->type = dbus_message_iter_get_arg_type(&e_itr);
+   if (array->type == DBUS_TYPE_INVALID)
+     {
+        DBG("array %s is of type 'invalid' (empty?)", key);
+        eina_array_free(array->array);
+        free(array);
+        return NULL;
+     }
+
+   do
+     {
+        switch (array->type)
+          {
+           case DBUS_TYPE_OBJECT_PATH:
+           {
+              const char *path;
+
+              dbus_message_iter_get_basic(&e_itr, &path);
+              path = eina_stringshare_add(path);
+              eina_array_push(array->array, path);
+              _e_ofono_element_item_register(key, path);
+           }
+           break;
+
+           case DBUS_TYPE_STRING:
+           {
+              const char *str;
+
+              dbus_message_iter_get_basic(&e_itr, &str);
+              str = eina_stringshare_add(str);
+              eina_array_push(array->array, str);
+           }
+           break;
+
+           case DBUS_TYPE_BYTE:
+           {
+              unsigned char byte;
+              dbus_message_iter_get_basic(&e_itr, &byte);
+              eina_array_push(array->array, (void *)(long)byte);
+           }
+           break;
+
+           case DBUS_TYPE_DICT_ENTRY:
+           {
+              E_Ofono_Element_Dict_Entry *entry;
+              entry = _e_ofono_element_dict_entry_new(&e_itr);
+              if (entry)
+                 eina_array_push(array->array, entry);
+           }
+           break;
+
+           default:
+              ERR("don't know how to build array '%s' of type %c (%d)",
+                  key, array->type, array->type);
+              eina_array_free(array->array);
+              free(array);
+              return NULL;
+          }
+     }
+   while (dbus_message_iter_next(&e_itr));
+   return array;
+}
+
+static void
+_e_ofono_element_get_properties_parse(E_Ofono_Element *element, DBusMessage *msg, DBusError *err)
+{
+   DBusMessageIter itr, s_itr;
+   int t, changed;
+
+   DBG("get_properties msg=%p", msg);
+
+   if (!_dbus_callback_check_and_init(msg, &itr, err))
+      return;
+
+   t = dbus_message_iter_get_arg_type(&itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_ARRAY))
+      return;
+
+   element->_synced = EINA_TRUE;
+   changed = 0;
+   dbus_message_iter_recurse(&itr, &s_itr);
+   do
+     {
+        DBusMessageIter e_itr, v_itr;
+        const char *key;
+        void *value = NULL;
+        int r;
+
+        t = dbus_message_iter_get_arg_type(&s_itr);
+        if (!_dbus_iter_type_check(t, DBUS_TYPE_DICT_ENTRY))
+           continue;
+
+        dbus_message_iter_recurse(&s_itr, &e_itr);
+
+        t = dbus_message_iter_get_arg_type(&e_itr);
+        if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+           continue;
+
+        dbus_message_iter_get_basic(&e_itr, &key);
+        dbus_message_iter_next(&e_itr);
+        t = dbus_message_iter_get_arg_type(&e_itr);
+        if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+           continue;
+
+        dbus_message_iter_recurse(&e_itr, &v_itr);
+        t = dbus_message_iter_get_arg_type(&v_itr);
+        if (t == DBUS_TYPE_ARRAY)
+          {
+             value = _e_ofono_element_iter_get_array(&v_itr, key);
+          }
+        else if (t != DBUS_TYPE_INVALID)
+          {
+             dbus_message_iter_get_basic(&v_itr, &value);
+          }
+        else
+          {
+             ERR("property has invalid type %s", key);
+             continue;
+          }
+
+        r = _e_ofono_element_property_value_add(element, key, t, value);
+        if (r < 0)
+          {
+             ERR("failed to add property value %s (%c)", key, t);
+          }
+        else if (r == 1)
+          {
+             INF("property value changed %s (%c)", key, t);
+             changed = 1;
+          }
+
+        /* also when unchanged, the interfaces may come from a snapshot */
+        if ((strcmp(key, "Interfaces") == 0) && value)
+          {
+             char *interface;
+             Eina_Array_Iterator iterator;
+             unsigned int i;
+             E_Ofono_Element *e;
+
+             EINA_ARRAY_ITER_NEXT(((E_Ofono_Array *)value)->array, i,
+                                  interface, iterator)
+             {
+                DBG("Found interface %s on %s", interface, element->path);
+                e = e_ofono_element_register(element->path, interface);
+                if ((e) && (!e->_synced))
+                   e_ofono_element_sync_queue(e);
+             }
+          }
+     }
+   while (dbus_message_iter_next(&s_itr));
+
+   if ((element->_stale) && (_e_ofono_element_stale_props_del(element)))
+      changed = 1;
+
+   if (changed)
+      _e_ofono_element_listeners_call(element);
+}
+
+static void
+_e_ofono_element_get_properties_callback(void *user_data, DBusMessage *msg, DBusError *err)
+{
+   E_Ofono_Element *element = user_data;
+
+   _e_ofono_element_get_properties_parse(element, msg, err);
+
+   /* the reply e_ofono_elements_sync() waited for, now that the elements
+    * it lists are queued */
+   if (element == sync_manager)
+     {
+        sync_manager = NULL;
+        if (sync_in_flight > 0)
+           sync_in_flight--;
+        _e_ofono_elements_sync_pump();
+     }
+}
+
+/**
+ * Sync element properties with server.
+ *
+ * Call method GetProperties() at the given element on server in order to sync
+ * them.
+ *
+ * @param element to call method on server.
+ * @param cb function to call when server replies or some error happens.
+ * @param data data to give to cb when it is called.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_properties_sync_full(E_Ofono_Element *element, E_DBus_Method_Return_Cb cb, const void *data)
+{
+   const char name[] = "GetProperties";
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return e_ofono_element_call_full
+             (element, name, element->interface,
+             _e_ofono_element_get_properties_callback,
+             &element->_pending.properties_get, cb, data);
+}
+
+/**
+ * Sync element properties with server, simple version.
+ *
+ * Call method GetProperties() at the given element on server in order to sync
+ * them. This is the simple version and there is no check of server reply
+ * for errors.
+ *
+ * @param element to call method on server.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_properties_sync(E_Ofono_Element *element)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   return e_ofono_element_properties_sync_full(element, NULL, NULL);
+}
+
+/**
+ * Call method SetProperty(prop, {key: value}) at the given element on server.
+ *
+ * This is a server call, not local, so it may fail and in that case
+ * no property is updated locally. If the value was set the event
+ * E_OFONO_EVENT_ELEMENT_UPDATED will be added to main loop.
+ *
+ * @param element to call method on server.
+ * @param prop property name.
+ * @param key dict key name.
+ * @param type DBus type to use for value.
+ * @param value pointer to value, just like regular DBus, see
+ *        dbus_message_iter_append_basic().
+ * @param cb function to call when server replies or some error happens.
+ * @param data data to give to cb when it is called.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_dict_set_full(E_Ofono_Element *element, const char *prop, const char *key, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+{
+   const char name[] = "SetProperty";
+   DBusMessage *msg;
+   DBusMessageIter itr, variant, dict, entry;
+   char typestr[32];
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_ofono_system_bus_name_get(), element->path, element->interface, name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+
+   if ((size_t)snprintf(typestr, sizeof(typestr),
+                        (DBUS_TYPE_ARRAY_AS_STRING
+                         DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                         DBUS_TYPE_STRING_AS_STRING
+                         "%c"
+                         DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
+                        type) >= sizeof(typestr))
+     {
+        ERR("sizeof(typestr) is too small!");
+        return EINA_FALSE;
+     }
+
+   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &variant))
+     {
+        snprintf(typestr, sizeof(typestr),
+                 (DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                     DBUS_TYPE_STRING_AS_STRING
+                     "%c"
+                     DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
+                 type);
+        
+        if (dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, typestr, &dict))
+          {
+             if (dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry))
+               {
+                  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+                  
+                  if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+                    dbus_message_iter_append_basic(&entry, type, &value);
+                  else
+                    dbus_message_iter_append_basic(&entry, type, value);
+                  
+                  dbus_message_iter_close_container(&dict, &entry);
+               }
+             else
+               {
+                  ERR("dbus_message_iter_open_container() failed");
+               }
+             dbus_message_iter_close_container(&variant, &dict);
+          }
+        else
+          {
+             ERR("dbus_message_iter_open_container() failed");
+          }
+        dbus_message_iter_close_container(&itr, &variant);
+     }
+   else
+     {
+        ERR("dbus_message_iter_open_container() failed");
+     }
+
+   return e_ofono_element_message_send
+             (element, name, NULL, NULL, msg,
+             &element->_pending.property_set, cb, data);
+}
+
+/**
+ * Call method SetProperty(prop, value) at the given element on server.
+ *
+ * This is a server call, not local, so it may fail and in that case
+ * no property is updated locally. If the value was set the event
+ * E_OFONO_EVENT_ELEMENT_UPDATED will be added to main loop.
+ *
+ * @param element to call method on server.
+ * @param prop property name.
+ * @param type DBus type to use for value.
+ * @param value pointer to value, just like regular DBus, see
+ *        dbus_message_iter_append_basic().
+ * @param cb function to call when server replies or some error happens.
+ * @param data data to give to cb when it is called.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_set_full(E_Ofono_Element *element, const char *prop, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+{
+   const char name[] = "SetProperty";
+   char typestr[2];
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_ofono_system_bus_name_get(), element->path, element->interface, name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   DBusMessageIter itr, v;
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+
+   typestr[0] = type;
+   typestr[1] = '\0';
+   dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &v);
+   if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
+     {
+        dbus_message_iter_append_basic(&v, type, &value);
+     }
+   else if (type == DBUS_TYPE_BOOLEAN)
+     {
+        unsigned int b = *(Eina_Bool *)value;
+        dbus_message_iter_append_basic(&v, type, &b);
+     }
+   else
+     {
+        dbus_message_iter_append_basic(&v, type, value);
+     }
+
+   dbus_message_iter_close_container(&itr, &v);
+
+   return e_ofono_element_message_send
+             (element, name, NULL, NULL, msg,
+             &element->_pending.property_set, cb, data);
+}
+
+/**
+ * Call method SetProperty(prop, value) at the given element on server.
+ *
+ * This is the simple version and there is no check of server reply
+ * for errors.
+ *
+ * @param element to call method on server.
+ * @param prop property name.
+ * @param type DBus type to use for value.
+ * @param value pointer to value, just like regular DBus, see
+ *        dbus_message_iter_append_basic().
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_set(E_Ofono_Element *element, const char *prop, int type, const void *value)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+   return e_ofono_element_property_set_full
+             (element, prop, type, value, NULL, NULL);
+}
+
+Eina_Bool
+e_ofono_element_call_with_path(E_Ofono_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   DBusMessageIter itr;
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_ofono_system_bus_name_get(), element->path, element->interface,
+         method_name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_OBJECT_PATH, &string);
+
+   return e_ofono_element_message_send
+             (element, method_name, NULL, cb, msg, pending, user_cb, user_data);
+}
+
+Eina_Bool
+e_ofono_element_call_with_string(E_Ofono_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   DBusMessageIter itr;
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_ofono_system_bus_name_get(), element->path, element->interface,
+         method_name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &string);
+
+   return e_ofono_element_message_send
+             (element, method_name, NULL, cb, msg, pending, user_cb, user_data);
+}
+
+Eina_Bool
+e_ofono_element_call_with_path_and_string(E_Ofono_Element *element, const char *method_name, const char *path, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+{
+   DBusMessageIter itr;
+   DBusMessage *msg;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(path, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
+
+   msg = dbus_message_new_method_call
+         (e_ofono_system_bus_name_get(), element->path, element->interface,
+         method_name);
+
+   if (!msg)
+      return EINA_FALSE;
+
+   dbus_message_iter_init_append(msg, &itr);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_OBJECT_PATH, &path);
+   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &string);
+
+   return e_ofono_element_message_send
+             (element, method_name, NULL, cb, msg, pending, user_cb, user_data);
+}
+
+/**
+ * Get property type.
+ *
+ * If zero is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name, must be previously stringshared
+ * @param type will contain the value type.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_type_get_stringshared(const E_Ofono_Element *element, const char *name, int *type)
+{
+   const E_Ofono_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(type, EINA_FALSE);
+
+   p = _e_ofono_element_property_find(element, name);
+   if (p)
+     {
+        *type = p->type;
+        return EINA_TRUE;
+     }
+
+   WRN("element %s (%p) has no property with name \"%s\".",
+       element->path, element, name);
+   return EINA_FALSE;
+}
+
+/**
+ * Get property type.
+ *
+ * If zero is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name
+ * @param type will contain the value type.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_type_get(const E_Ofono_Element *element, const char *name, int *type)
+{
+   const E_Ofono_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+
+   /* use the stored stringshare instead of adding one for each call */
+   p = _e_ofono_element_property_find_string(element, name);
+   if (p)
+      name = p->name;
+
+   return e_ofono_element_property_type_get_stringshared(element, name, type);
+}
+
+void
+e_ofono_element_list_properties(const E_Ofono_Element *element, Eina_Bool (*cb)(void *data, const E_Ofono_Element *element, const char *name, int type, const void *value), const void *data)
+{
+   const E_Ofono_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN(element);
+   EINA_SAFETY_ON_NULL_RETURN(cb);
+
+   EINA_INLIST_FOREACH(element->props, p)
+   {
+      const void *value = NULL;
+
+      switch (p->type)
+        {
+         case DBUS_TYPE_STRING:
+            value = &p->value.str;
+            break;
+
+         case DBUS_TYPE_OBJECT_PATH:
+            value = &p->value.path;
+            break;
+
+         case DBUS_TYPE_BOOLEAN:
+            value = (void *)(unsigned long)p->value.boolean;
+            break;
+
+         case DBUS_TYPE_UINT16:
+            value = &p->value.u16;
+            break;
+
+         case DBUS_TYPE_UINT32:
+            value = &p->value.u32;
+            break;
+
+         default:
+            ERR("unsupported type %c", p->type);
+        }
+
+      if (!cb((void *)data, element, p->name, p->type, value))
+         return;
+   }
+}
+
+/**
+ * Get dict value given its key inside a dict property.
+ *
+ * This will look into properties for one of type dict that contains
+ * the given key, to find the property.  If no property is found then
+ * 0 is returned.
+ *
+ * If zero is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param dict_name property name, must be previously stringshared
+ * @param key key inside dict, must be previously stringshared
+ * @param type if provided it will contain the value type.
+ * @param value where to store the property value, must be a pointer to the
+ *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_dict_get_stringshared(const E_Ofono_Element *element, const char *dict_name, const char *key, int *type, void *value)
+{
+   const E_Ofono_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(dict_name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(key, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+
+   p = _e_ofono_element_property_find(element, dict_name);
+   if (p)
+     {
+        E_Ofono_Element_Dict_Entry *entry;
+        E_Ofono_Array *array;
+
+        if (p->type != DBUS_TYPE_ARRAY)
+          {
+             WRN("element %s (%p) has property \"%s\" is not an array: %c (%d)",
+                 element->path, element, dict_name, p->type, p->type);
+             return EINA_FALSE;
+          }
+
+        array = p->value.array;
+        if ((!array) || (array->type != DBUS_TYPE_DICT_ENTRY))
+          {
+             int t = array ? array->type : DBUS_TYPE_INVALID;
+             WRN("element %s (%p) has property \"%s\" is not a dict: %c (%d)",
+                 element->path, element, dict_name, t, t);
+             return EINA_FALSE;
+          }
+
+        entry = _e_ofono_element_array_dict_find_stringshared(array, key);
+        if (!entry)
+          {
+             WRN("element %s (%p) has no dict property with name \"%s\" with "
+                 "key \"%s\".",
+                 element->path, element, dict_name, key);
+             return EINA_FALSE;
+          }
+
+        if (type)
+           *type = entry->type;
+
+        switch (entry->type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+              *(Eina_Bool *)value = entry->value.boolean;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_BYTE:
+              *(unsigned char *)value = entry->value.byte;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT16:
+              *(unsigned short *)value = entry->value.u16;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT32:
+              *(unsigned int *)value = entry->value.u32;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_STRING:
+              *(const char **)value = entry->value.str;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_OBJECT_PATH:
+              *(const char **)value = entry->value.path;
+              return EINA_TRUE;
+
+           default:
+              ERR("don't know how to get property %s, key %s type %c (%d)",
+                  dict_name, key, entry->type, entry->type);
+              return EINA_FALSE;
+          }
+     }
+
+   WRN("element %s (%p) has no property with name \"%s\".",
+       element->path, element, dict_name);
+   return EINA_FALSE;
+}
+
+/**
+ * Get property value given its name.
+ *
+ * This will look into properties, to find the property.
+ * If no property is found then 0 is returned.
+ *
+ * If zero is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name, must be previously stringshared
+ * @param type if provided it will contain the value type.
+ * @param value where to store the property value, must be a pointer to the
+ *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_get_stringshared(const E_Ofono_Element *element, const char *name, int *type, void *value)
+{
+   const E_Ofono_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+
+   p = _e_ofono_element_property_find(element, name);
+   if (p)
+     {
+        if (type)
+           *type = p->type;
+
+        switch (p->type)
+          {
+           case DBUS_TYPE_BOOLEAN:
+              *(Eina_Bool *)value = p->value.boolean;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_BYTE:
+              *(unsigned char *)value = p->value.byte;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT16:
+              *(unsigned short *)value = p->value.u16;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_UINT32:
+              *(unsigned int *)value = p->value.u32;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_STRING:
+              *(const char **)value = p->value.str;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_OBJECT_PATH:
+              *(const char **)value = p->value.path;
+              return EINA_TRUE;
+
+           case DBUS_TYPE_ARRAY:
+              *(E_Ofono_Array **)value = p->value.array;
+              return EINA_TRUE;
+
+           default:
+              ERR("don't know how to get property type %c (%d)",
+                  p->type, p->type);
+              return EINA_FALSE;
+          }
+     }
+
+   WRN("element %s (%p) has no property with name \"%s\".",
+       element->path, element, name);
+   return EINA_FALSE;
+}
+
+/**
+ * Get property value given its name.
+ *
+ * This will look into properties, to find the property.
+ * If no property is found then 0 is returned.
+ *
+ * If zero is returned, then this call failed and parameter-returned
+ * values shall be considered invalid.
+ *
+ * @param element which element to get the property
+ * @param name property name
+ * @param type if provided it will contain the value type.
+ * @param value where to store the property value, must be a pointer to the
+ *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_element_property_get(const E_Ofono_Element *element, const char *name, int *type, void *value)
+{
+   const E_Ofono_Element_Property *p;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
+
+   /* use the stored stringshare instead of adding one for each call */
+   p = _e_ofono_element_property_find_string(element, name);
+   if (p)
+      name = p->name;
+
+   return e_ofono_element_property_get_stringshared
+             (element, name, type, value);
+}
+
+struct e_ofono_elements_for_each_data
+{
+   Eina_Hash_Foreach cb;
+   void             *data;
+};
+
+static Eina_Bool
+_e_ofono_elements_for_each(Eina_Hash *hash __UNUSED__, const char *key, void *data, void *fdata)
+{
+   struct e_ofono_elements_for_each_data *each_data = fdata;
+
+   each_data->cb(elements, key, data, each_data->data);
+   return EINA_TRUE;
+}
+
+/**
+ * Call the given function for each existing element.
+ *
+ * @param cb function to call for each element. It will get as parameters,
+ *        in order: the element pointer and the given @a user_data.
+ * @param user_data data to give to @a cb for each element.
+ */
+void
+e_ofono_elements_for_each(Eina_Hash_Foreach cb, const void *user_data)
+{
+   struct e_ofono_elements_for_each_data data = {cb, (void *)user_data};
+
+   EINA_SAFETY_ON_NULL_RETURN(cb);
+
+   eina_hash_foreach
+      (elements, (Eina_Hash_Foreach)_e_ofono_elements_for_each, &data);
+}
+
+typedef struct _E_Ofono_Elements_Index E_Ofono_Elements_Index;
+
+struct _E_Ofono_Elements_Index
+{
+   E_Ofono_Element **items;
+   unsigned int       count;
+   unsigned int       size;
+   const char        *interface;
+};
+
+static E_Ofono_Elements_Index elements_all = {NULL, 0, 0, NULL};
+/* stringshared interface -> E_Ofono_Elements_Index */
+static Eina_Hash *elements_by_interface = NULL;
+
+/* Elements are also kept in flat arrays, one for all of them and one per
+ * interface, so listing them needs no walk of the hash.  Removal swaps the
+ * last element in, element->_index[] has the position in each.  Any change
+ * to these arrays or to an array property bumps elements_generation, which
+ * stops the iterators still running over the old ones.
+ */
+enum
+{
+   ELEMENTS_INDEX_ALL,
+   ELEMENTS_INDEX_INTERFACE
+};
+
+static Eina_Bool
+_e_ofono_elements_index_add(E_Ofono_Elements_Index *index, int which, E_Ofono_Element *element)
+{
+   if (index->count == index->size)
+     {
+        unsigned int size = index->size ? index->size * 2 : 16;
+        E_Ofono_Element **items;
+
+        items = realloc(index->items, size * sizeof(E_Ofono_Element *));
+        if (!items)
+          {
+             ERR("could not grow the index of %s: %s",
+                 element->path, strerror(errno));
+             return EINA_FALSE;
+          }
+        index->items = items;
+        index->size = size;
+     }
+
+   element->_index[which] = index->count;
+   index->items[index->count++] = element;
+   elements_generation++;
+   return EINA_TRUE;
+}
+
+static void
+_e_ofono_elements_index_del(E_Ofono_Elements_Index *index, int which, E_Ofono_Element *element)
+{
+   unsigned int pos = element->_index[which];
+   E_Ofono_Element *last;
+
+   if ((pos >= index->count) || (index->items[pos] != element))
+      return;
+
+   last = index->items[--index->count];
+   index->items[pos] = last;
+   last->_index[which] = pos;
+   elements_generation++;
+}
+
+static void
+_e_ofono_elements_index_free(void *data)
+{
+   E_Ofono_Elements_Index *index = data;
+
+   eina_stringshare_del(index->interface);
+   free(index->items);
+   free(index);
+}
+
+/* interface NULL is all the elements, NULL if none was seen */
+static E_Ofono_Elements_Index *
+_e_ofono_elements_index_find(const char *interface)
+{
+   E_Ofono_Elements_Index *index;
+
+   if (!interface)
+      return &elements_all;
+
+   if (!elements_by_interface)
+      return NULL;
+
+   interface = eina_stringshare_add(interface);
+   index = eina_hash_find(elements_by_interface, &interface);
+   eina_stringshare_del(interface);
+   return index;
+}
+
+static Eina_Bool
+_e_ofono_element_index_add(E_Ofono_Element *element)
+{
+   E_Ofono_Elements_Index *index;
+
+   index = eina_hash_find(elements_by_interface, &element->interface);
+   if (!index)
+     {
+        index = calloc(1, sizeof(E_Ofono_Elements_Index));
+        if (!index)
+          {
+             ERR("could not allocate the index of %s: %s",
+                 element->interface, strerror(errno));
+             return EINA_FALSE;
+          }
+
+        index->interface = eina_stringshare_ref(element->interface);
+        if (!eina_hash_add(elements_by_interface, &index->interface, index))
+          {
+             _e_ofono_elements_index_free(index);
+             return EINA_FALSE;
+          }
+     }
+
+   if (!_e_ofono_elements_index_add(&elements_all, ELEMENTS_INDEX_ALL, element))
+      return EINA_FALSE;
+
+   if (!_e_ofono_elements_index_add(index, ELEMENTS_INDEX_INTERFACE, element))
+     {
+        _e_ofono_elements_index_del(&elements_all, ELEMENTS_INDEX_ALL, element);
+        return EINA_FALSE;
+     }
+
+   return EINA_TRUE;
+}
+
+static void
+_e_ofono_element_index_del(E_Ofono_Element *element)
+{
+   E_Ofono_Elements_Index *index;
+
+   _e_ofono_elements_index_del(&elements_all, ELEMENTS_INDEX_ALL, element);
+   index = eina_hash_find(elements_by_interface, &element->interface);
+   if (index)
+      _e_ofono_elements_index_del(index, ELEMENTS_INDEX_INTERFACE, element);
+}
+
+static Eina_Bool
+_e_ofono_elements_index_copy(const E_Ofono_Elements_Index *index, unsigned int *count, E_Ofono_Element ***p_elements)
+{
+   *count = index ? index->count : 0;
+   if (*count == 0)
+     {
+        *p_elements = NULL;
+        return EINA_TRUE;
+     }
+
+   *p_elements = malloc(*count * sizeof(E_Ofono_Element *));
+   if (!*p_elements)
+     {
+        ERR("could not allocate return array of %d elements: %s",
+            *count, strerror(errno));
+        *count = 0;
+        return EINA_FALSE;
+     }
+
+   memcpy(*p_elements, index->items, *count * sizeof(E_Ofono_Element *));
+   return EINA_TRUE;
+}
+
+/**
+ * Get all known elements.
+ *
+ * No reference is added to these elements, since there are no threads
+ * in the system, you are free to add references yourself right after
+ * the return of this call without race condition, elements by the
+ * system (ie: elementRemoved signal)could only be touched on the next
+ * main loop iteration.
+ *
+ * @param count return the number of elements in array.
+ * @param p_elements array with all elements, these are not referenced
+ *        and in no particular order, just set if return is 1.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ */
+Eina_Bool
+e_ofono_elements_get_all(unsigned int *count, E_Ofono_Element ***p_elements)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+
+   return _e_ofono_elements_index_copy(&elements_all, count, p_elements);
+}
+
+/**
+ * Get all known elements of type.
+ *
+ * No reference is added to these elements, since there are no threads
+ * in the system, you are free to add references yourself right after
+ * the return of this call without race condition, elements by the
+ * system (ie: ElementRemoved signal) could only be touched on the next
+ * main loop iteration.
+ *
+ * @param type type to filter, or NULL to get all.
+ * @param count return the number of elements in array.
+ * @param p_elements array with all elements, these are not referenced
+ *        and in no particular order, just set if return is 1.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ *
+ * @see e_ofono_elements_get_all()
+ */
+Eina_Bool
+e_ofono_elements_get_all_type(const char *type, unsigned int *count, E_Ofono_Element ***p_elements)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+
+   return _e_ofono_elements_index_copy
+             (_e_ofono_elements_index_find(type), count, p_elements);
+}
+
+/**
+ * Start iterating over the known elements of an interface.
+ *
+ * Nothing is allocated and no reference is added to the elements, the
+ * iterator just borrows the library's own list.  If elements are added or
+ * removed before the iteration is over, e_ofono_elements_iter_next() stops
+ * and returns NULL.
+ *
+ * @param iter the iterator to start, usually on the stack.
+ * @param interface interface to filter, or NULL to get all.
+ */
+void
+e_ofono_elements_iter_init(E_Ofono_Elements_Iter *iter, const char *interface)
+{
+   E_Ofono_Elements_Index *index;
+
+   EINA_SAFETY_ON_NULL_RETURN(iter);
+
+   memset(iter, 0, sizeof(*iter));
+   iter->_generation = elements_generation;
+
+   index = _e_ofono_elements_index_find(interface);
+   if (!index)
+      return;
+
+   iter->_items = (void * const *)index->items;
+   iter->_count = index->count;
+}
+
+/**
+ * Start iterating over the elements listed in an object path array.
+ *
+ * Like e_ofono_elements_iter_init(), this borrows the property itself and
+ * stops when it is replaced.  Paths without an element are skipped.
+ *
+ * @param iter the iterator to start, usually on the stack.
+ * @param element the element with the property.
+ * @param property name of an array of object paths, like "Modems".
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the property is not an
+ *         array of object paths.
+ */
+Eina_Bool
+e_ofono_element_objects_iter_init(E_Ofono_Elements_Iter *iter, const E_Ofono_Element *element, const char *property)
+{
+   E_Ofono_Array *array;
+   int type;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(iter, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(property, EINA_FALSE);
+
+   memset(iter, 0, sizeof(*iter));
+   iter->_generation = elements_generation;
+   iter->_paths = EINA_TRUE;
+
+   if (!e_ofono_element_property_get(element, property, &type, &array))
+      return EINA_FALSE;
+
+   if (type != DBUS_TYPE_ARRAY)
+     {
+        ERR("property %s is not an array!", property);
+        return EINA_FALSE;
+     }
+
+   /* empty arrays are kept as NULL */
+   if ((!array) || (!array->array) || (array->type == DBUS_TYPE_INVALID))
+      return EINA_TRUE;
+
+   if (array->type != DBUS_TYPE_OBJECT_PATH)
+     {
+        ERR("property %s is not an array of object paths!", property);
+        return EINA_FALSE;
+     }
+
+   iter->_interface = _e_ofono_element_get_interface(property);
+   iter->_items = (void * const *)array->array->data;
+   iter->_count = eina_array_count(array->array);
+   return EINA_TRUE;
+}
+
+/**
+ * Get the next element of an iteration.
+ *
+ * @param iter an iterator started by e_ofono_elements_iter_init() or
+ *        e_ofono_element_objects_iter_init().
+ *
+ * @return the next element, no reference is added, or NULL at the end or
+ *         if the elements changed meanwhile.
+ */
+E_Ofono_Element *
+e_ofono_elements_iter_next(E_Ofono_Elements_Iter *iter)
+{
+   EINA_SAFETY_ON_NULL_RETURN_VAL(iter, NULL);
+
+   if (iter->_generation != elements_generation)
+     {
+        if (iter->_pos < iter->_count)
+           WRN("elements changed while iterating, stopping");
+        iter->_count = 0;
+        return NULL;
+     }
+
+   while (iter->_pos < iter->_count)
+     {
+        void *item = iter->_items[iter->_pos++];
+        E_Ofono_Element *element;
+
+        if (!iter->_paths)
+           return item;
+
+        element = e_ofono_element_get(item, iter->_interface);
+        if (element)
+           return element;
+     }
+
+   return NULL;
+}
+
+/**
+ * Get the element registered at given path.
+ *
+ * @param path the path to query for registered object.
+ *
+ * @return element pointer if found, NULL otherwise. No references are added.
+ */
+E_Ofono_Element *
+e_ofono_element_get(const char *path, const char *interface)
+{
+   E_Ofono_Element *element;
+   char key[MAX_KEY_SIZE];
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(interface, NULL);
+
+   snprintf(key, MAX_KEY_SIZE, "%s:%s", path, interface);
+   element = eina_hash_find(elements, key);
+
+   return element;
+}
 
 static void
-_e_ofono_element_get_properties_callback(void *user_data, DBusMessage *msg, DBusError *err)
+_e_ofono_element_property_changed_callback(void *data __UNUSED__, DBusMessage *msg)
 {
-   E_Ofono_Element *element = user_data;
-   DBusMessageIter itr, s_itr;
-   int t, changed;
+   E_Ofono_Element *element;
+   DBusMessageIter itr, v_itr;
+   int t, r, changed = 0;
+   const char *name = NULL, *path, *iface;
+   void *value = NULL;
 
-   DBG("get_properties msg=%p", msg);
+   path = dbus_message_get_path(msg);
+   iface = dbus_message_get_interface(msg);
+   if ((!path) || (!iface))
+      return;
 
-   if (!_dbus_callback_check_and_init(msg, &itr, err))
+   element = e_ofono_element_get(path, iface);
+   if (!element)
       return;
 
-   t = dbus_message_iter_get_arg_type(&itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_ARRAY))
+   DBG("Property changed in element %s %s", element->path, element->interface);
+
+   if (!_dbus_callback_check_and_init(msg, &itr, NULL))
       return;
 
-   changed = 0;
-   dbus_message_iter_recurse(&itr, &s_itr);
-   do
+   t = dbus_message_iter_get_arg_type(&itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
      {
-        DBusMessageIter e_itr, v_itr;
-        const char *key;
-        void *value = NULL;
-        int r;
+        ERR("missing name in property changed signal");
+        return;
+     }
 
-        t = dbus_message_iter_get_arg_type(&s_itr);
-        if (!_dbus_iter_type_check(t, DBUS_TYPE_DICT_ENTRY))
-           continue;
+   dbus_message_iter_get_basic(&itr, &name);
 
-        dbus_message_iter_recurse(&s_itr, &e_itr);
+   dbus_message_iter_next(&itr);
+   t = dbus_message_iter_get_arg_type(&itr);
+   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+     {
+        ERR("missing value in property changed signal");
+        return;
+     }
 
-        t = dbus_message_iter_get_arg_type(&e_itr);
-        if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
-           continue;
+   dbus_message_iter_recurse(&itr, &v_itr);
+   t = dbus_message_iter_get_arg_type(&v_itr);
 
-        dbus_message_iter_get_basic(&e_itr, &key);
-        dbus_message_iter_next(&e_itr);
-        t = dbus_message_iter_get_arg_type(&e_itr);
-        if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
-           continue;
+   if (t == DBUS_TYPE_ARRAY)
+     {
+        value = _e_ofono_element_iter_get_array(&v_itr, name);
+     }
+   else if (t != DBUS_TYPE_INVALID)
+     {
+        dbus_message_iter_get_basic(&v_itr, &value);
+     }
+   else
+     {
+        ERR("property has invalid type %s", name);
+        return;
+     }
 
-        dbus_message_iter_recurse(&e_itr, &v_itr);
-        t = dbus_message_iter_get_arg_type(&v_itr);
-        if (t == DBUS_TYPE_ARRAY)
-          {
-             value = _e_ofono_element_iter_get_array(&v_itr, key);
-          }
-        else if (t != DBUS_TYPE_INVALID)
-          {
-             dbus_message_iter_get_basic(&v_itr, &value);
-          }
-        else
+   r = _e_ofono_element_property_value_add(element, name, t, value);
+   if (r < 0)
+     {
+        ERR("failed to add property value %s (%c)", name, t);
+     }
+   else if (r == 1)
+     {
+        INF("property value changed %s (%c)", name, t);
+        changed = 1;
+        if ((strcmp(name, "Interfaces") == 0) && value)
           {
-             ERR("property has invalid type %s", key);
-             continue;
-          }
+             char *interface;
+             Eina_Array_Iterator iterator;
+             unsigned int i;
+             E_Ofono_Element *e;
 
-        r = _e_ofono_element_property_value_add(element, key, t, value);
-        if (r < 0)
-          {
-             ERR("failed to add property value %s (%c)", key, t);
-          }
-        else if (r == 1)
-          {
-             INF("property value changed %s (%c)", key, t);
-             changed = 1;
-             if ((strcmp(key, "Interfaces") == 0) && value)
-               {
-                  char *interface;
-                  Eina_Array_Iterator iterator;
-                  unsigned int i;
-                  E_Ofono_Element *e;
-
-                  EINA_ARRAY_ITER_NEXT(((E_Ofono_Array *)value)->array, i,
-                                       interface, iterator)
-                  {
-                     DBG("Found interface %s on %s", interface, element->path);
-                     e = e_ofono_element_register(element->path, interface);
-                     if ((e) && (!e_ofono_element_properties_sync(e)))
-                        WRN("could not get properties of %s", e->path);
-                  }
-               }
+             EINA_ARRAY_ITER_NEXT(((E_Ofono_Array *)value)->array, i,
+                                  interface, iterator)
+             {
+                DBG("Found interface %s on %s", interface, element->path);
+                e = e_ofono_element_register(element->path, interface);
+                if ((e) && (!e->_synced))
+                   e_ofono_element_sync_queue(e);
+             }
           }
      }
-   while (dbus_message_iter_next(&s_itr));
 
    if (changed)
       _e_ofono_element_listeners_call(element);
 }
 
 /**
- * Sync element properties with server.
- *
- * Call method GetProperties() at the given element on server in order to sync
- * them.
- *
- * @param element to call method on server.
- * @param cb function to call when server replies or some error happens.
- * @param data data to give to cb when it is called.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_ofono_element_sync_properties_full(E_Ofono_Element *element, E_DBus_Method_Return_Cb cb, const void *data)
-{
-   const char name[] = "GetProperties";
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return e_ofono_element_call_full
-             (element, name, element->interface,
-             _e_ofono_element_get_properties_callback,
-             &element->_pending.properties_get, cb, data);
-}
-
-/**
- * Sync element properties with server, simple version.
- *
- * Call method GetProperties() at the given element on server in order to sync
- * them. This is the simple version and there is no check of server reply
- * for errors.
- *
- * @param element to call method on server.
+ * Register the given pair (path, interface), possibly creating an
+ * element and return it.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_ofono_element_properties_sync(E_Ofono_Element *element)
-{
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return e_ofono_element_sync_properties_full(element, NULL, NULL);
-}
-
-/**
- * Call method SetProperty(prop, {key: value}) at the given element on server.
+ * This will check if (path, interface) is already registered, in
+ * that case the exiting element is returned. If it was not registered
+ * yet, a new element is created, registered and returned.
  *
- * This is a server call, not local, so it may fail and in that case
- * no property is updated locally. If the value was set the event
- * E_OFONO_EVENT_ELEMENT_UPDATED will be added to main loop.
+ * This call will not add extra references to the object.
  *
- * @param element to call method on server.
- * @param prop property name.
- * @param key dict key name.
- * @param type DBus type to use for value.
- * @param value pointer to value, just like regular DBus, see
- *        dbus_message_iter_append_basic().
- * @param cb function to call when server replies or some error happens.
- * @param data data to give to cb when it is called.
+ * @param path the path to register the element
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * @return the registered object, no references are added.
  */
-Eina_Bool
-e_ofono_element_property_dict_set_full(E_Ofono_Element *element, const char *prop, const char *key, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+E_Ofono_Element *
+e_ofono_element_register(const char *path, const char *interface)
 {
-   const char name[] = "SetProperty";
-   DBusMessage *msg;
-   DBusMessageIter itr, variant, dict, entry;
-   char typestr[32];
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
+   E_Ofono_Element *element;
+   char key[MAX_KEY_SIZE];
 
-   msg = dbus_message_new_method_call
-         (e_ofono_system_bus_name_get(), element->path, element->interface, name);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(interface, NULL);
 
-   if (!msg)
-      return EINA_FALSE;
+   snprintf(key, MAX_KEY_SIZE, "%s:%s", path, interface);
+   element = eina_hash_find(elements, key);
+   if (element)
+      return element;
 
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
+   element = e_ofono_element_new(path, interface);
+   if (!element)
+      return NULL;
 
-   if ((size_t)snprintf(typestr, sizeof(typestr),
-                        (DBUS_TYPE_ARRAY_AS_STRING
-                         DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
-                         DBUS_TYPE_STRING_AS_STRING
-                         "%c"
-                         DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
-                        type) >= sizeof(typestr))
+   if (!_e_ofono_element_index_add(element))
      {
-        ERR("sizeof(typestr) is too small!");
-        return EINA_FALSE;
+        e_ofono_element_free(element);
+        return NULL;
      }
 
-   if (dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &variant))
-     {
-        snprintf(typestr, sizeof(typestr),
-                 (DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
-                     DBUS_TYPE_STRING_AS_STRING
-                     "%c"
-                     DBUS_DICT_ENTRY_END_CHAR_AS_STRING),
-                 type);
-        
-        if (dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, typestr, &dict))
-          {
-             if (dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry))
-               {
-                  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
-                  
-                  if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
-                    dbus_message_iter_append_basic(&entry, type, &value);
-                  else
-                    dbus_message_iter_append_basic(&entry, type, value);
-                  
-                  dbus_message_iter_close_container(&dict, &entry);
-               }
-             else
-               {
-                  ERR("dbus_message_iter_open_container() failed");
-               }
-             dbus_message_iter_close_container(&variant, &dict);
-          }
-        else
-          {
-             ERR("dbus_message_iter_open_container() failed");
-          }
-        dbus_message_iter_close_container(&itr, &variant);
-     }
-   else
+   if (!eina_hash_add(elements, key, element))
      {
-        ERR("dbus_message_iter_open_container() failed");
+        _e_ofono_element_index_del(element);
+        ERR("could not add element %s to hash, delete it.", path);
+        e_ofono_element_free(element);
+        return NULL;
      }
 
-   return e_ofono_element_message_send
-             (element, name, NULL, NULL, msg,
-             &element->_pending.property_set, cb, data);
+   if (!property_changed_handler)
+      property_changed_handler =
+         e_dbus_signal_handler_add
+            (e_ofono_conn, e_ofono_system_bus_name_get(),
+            NULL, NULL, "PropertyChanged",
+            _e_ofono_element_property_changed_callback, NULL);
+
+   e_ofono_element_event_add(E_OFONO_EVENT_ELEMENT_ADD, element);
+
+   return element;
+}
+
+static void
+_e_ofono_element_event_unregister_and_free(void *data __UNUSED__, void *ev)
+{
+   E_Ofono_Element *element = ev;
+   e_ofono_element_unref(element);
+}
+
+static void
+_e_ofono_element_unregister_internal(E_Ofono_Element *element)
+{
+   _e_ofono_element_index_del(element);
+   ecore_event_add(E_OFONO_EVENT_ELEMENT_DEL, element,
+                   _e_ofono_element_event_unregister_and_free, NULL);
 }
 
 /**
- * Call method SetProperty(prop, value) at the given element on server.
- *
- * This is a server call, not local, so it may fail and in that case
- * no property is updated locally. If the value was set the event
- * E_OFONO_EVENT_ELEMENT_UPDATED will be added to main loop.
+ * Forget about the given element.
  *
- * @param element to call method on server.
- * @param prop property name.
- * @param type DBus type to use for value.
- * @param value pointer to value, just like regular DBus, see
- *        dbus_message_iter_append_basic().
- * @param cb function to call when server replies or some error happens.
- * @param data data to give to cb when it is called.
+ * This will remove the element from the pool of known objects, then
+ * add an E_OFONO_EVENT_ELEMENT_DEL and after that will unreference it,
+ * possible freeing it.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * @param element element to forget about. Its reference will be removed.
  */
-Eina_Bool
-e_ofono_element_property_set_full(E_Ofono_Element *element, const char *prop, int type, const void *value, E_DBus_Method_Return_Cb cb, const void *data)
+void
+e_ofono_element_unregister(E_Ofono_Element *element)
 {
-   const char name[] = "SetProperty";
-   char typestr[2];
-   DBusMessage *msg;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
-
-   msg = dbus_message_new_method_call
-         (e_ofono_system_bus_name_get(), element->path, element->interface, name);
-
-   if (!msg)
-      return EINA_FALSE;
-
-   DBusMessageIter itr, v;
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &prop);
-
-   typestr[0] = type;
-   typestr[1] = '\0';
-   dbus_message_iter_open_container(&itr, DBUS_TYPE_VARIANT, typestr, &v);
-   if ((type == DBUS_TYPE_STRING) || (type == DBUS_TYPE_OBJECT_PATH))
-     {
-        dbus_message_iter_append_basic(&v, type, &value);
-     }
-   else if (type == DBUS_TYPE_BOOLEAN)
-     {
-        unsigned int b = *(Eina_Bool *)value;
-        dbus_message_iter_append_basic(&v, type, &b);
-     }
-   else
-     {
-        dbus_message_iter_append_basic(&v, type, value);
-     }
+   char key[MAX_KEY_SIZE];
 
-   dbus_message_iter_close_container(&itr, &v);
+   if (!element)
+      return;
 
-   return e_ofono_element_message_send
-             (element, name, NULL, NULL, msg,
-             &element->_pending.property_set, cb, data);
+   snprintf(key, MAX_KEY_SIZE, "%s:%s", element->path, element->interface);
+   if (elements)
+      eina_hash_del_by_key(elements, key);
 }
 
 /**
- * Call method SetProperty(prop, value) at the given element on server.
+ * Remove all known elements.
  *
- * This is the simple version and there is no check of server reply
- * for errors.
+ * This will remove all known elements but will NOT add any
+ * E_OFONO_EVENT_ELEMENT_DEL to main loop.
  *
- * @param element to call method on server.
- * @param prop property name.
- * @param type DBus type to use for value.
- * @param value pointer to value, just like regular DBus, see
- *        dbus_message_iter_append_basic().
+ * This is just useful to make sure next e_ofono_manager_sync_elements()
+ * will not leave any stale elements. This is unlikely to happen, as
+ * E_Ofono is supposed to catch all required events to avoid stale elements.
+ */
+void
+e_ofono_manager_clear_elements(void)
+{
+   e_ofono_elements_shutdown();
+   e_ofono_elements_init();
+}
+
+/**
+ * Creates elements hash.
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * This has no init counter since its already guarded by other code.
+ * @internal
  */
-Eina_Bool
-e_ofono_element_property_set(E_Ofono_Element *element, const char *prop, int type, const void *value)
+void
+e_ofono_elements_init(void)
 {
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(prop, EINA_FALSE);
-   return e_ofono_element_property_set_full
-             (element, prop, type, value, NULL, NULL);
+   EINA_SAFETY_ON_FALSE_RETURN(!elements);
+   elements =
+      eina_hash_string_superfast_new
+         (EINA_FREE_CB(_e_ofono_element_unregister_internal));
+   elements_by_interface =
+      eina_hash_pointer_new(_e_ofono_elements_index_free);
 }
 
-Eina_Bool
-e_ofono_element_call_with_path(E_Ofono_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+void
+e_ofono_elements_shutdown(void)
 {
-   DBusMessageIter itr;
-   DBusMessage *msg;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
-
-   msg = dbus_message_new_method_call
-         (e_ofono_system_bus_name_get(), element->path, element->interface,
-         method_name);
+   EINA_SAFETY_ON_FALSE_RETURN(!!elements);
+   if (changed_flush)
+     {
+        ecore_idle_enterer_del(changed_flush);
+        changed_flush = NULL;
+     }
+   if (changed_elements)
+     {
+        E_Ofono_Element *element;
+        Eina_Array_Iterator iterator;
+        unsigned int i;
 
-   if (!msg)
-      return EINA_FALSE;
+        EINA_ARRAY_ITER_NEXT(changed_elements, i, element, iterator)
+        {
+           E_Ofono_Element_Changes changes;
 
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_OBJECT_PATH, &string);
+           element->_dirty = EINA_FALSE;
+           _e_ofono_element_changes_take(element, &changes);
+           _e_ofono_element_changes_free(&changes);
+           e_ofono_element_unref(element);
+        }
+        eina_array_free(changed_elements);
+        changed_elements = NULL;
+     }
+   _e_ofono_elements_sync_clear();
+   if (property_changed_handler)
+     {
+        e_dbus_signal_handler_del(e_ofono_conn, property_changed_handler);
+        property_changed_handler = NULL;
+     }
+   eina_hash_free(elements);
+   elements = NULL;
+   eina_hash_free(elements_by_interface);
+   elements_by_interface = NULL;
+   free(elements_all.items);
+   memset(&elements_all, 0, sizeof(elements_all));
+   elements_generation++;
+   /* the calls in flight were canceled with their elements, their
+    * completions still come and must not count against the next sync */
+   sync_in_flight = 0;
+   sync_generation++;
+}
 
-   return e_ofono_element_message_send
-             (element, method_name, NULL, cb, msg, pending, user_cb, user_data);
+static inline Eina_Bool
+_e_ofono_element_is(const E_Ofono_Element *element, const char *interface)
+{
+   return element->interface == interface;
 }
 
 Eina_Bool
-e_ofono_element_call_with_string(E_Ofono_Element *element, const char *method_name, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+e_ofono_element_is_manager(const E_Ofono_Element *element)
 {
-   DBusMessageIter itr;
-   DBusMessage *msg;
-
    EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
-
-   msg = dbus_message_new_method_call
-         (e_ofono_system_bus_name_get(), element->path, element->interface,
-         method_name);
-
-   if (!msg)
-      return EINA_FALSE;
-
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &string);
-
-   return e_ofono_element_message_send
-             (element, method_name, NULL, cb, msg, pending, user_cb, user_data);
+   return _e_ofono_element_is(element, e_ofono_iface_manager);
 }
 
 Eina_Bool
-e_ofono_element_call_with_path_and_string(E_Ofono_Element *element, const char *method_name, const char *path, const char *string, E_DBus_Method_Return_Cb cb, Eina_Inlist **pending, E_DBus_Method_Return_Cb user_cb, const void *user_data)
+e_ofono_element_is_modem(const E_Ofono_Element *element)
 {
-   DBusMessageIter itr;
-   DBusMessage *msg;
-
    EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(method_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(path, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(string, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(pending, EINA_FALSE);
-
-   msg = dbus_message_new_method_call
-         (e_ofono_system_bus_name_get(), element->path, element->interface,
-         method_name);
-
-   if (!msg)
-      return EINA_FALSE;
-
-   dbus_message_iter_init_append(msg, &itr);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_OBJECT_PATH, &path);
-   dbus_message_iter_append_basic(&itr, DBUS_TYPE_STRING, &string);
-
-   return e_ofono_element_message_send
-             (element, method_name, NULL, cb, msg, pending, user_cb, user_data);
+   return _e_ofono_element_is(element, e_ofono_iface_modem);
 }
 
-/**
- * Get property type.
- *
- * If zero is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
- *
- * @param element which element to get the property
- * @param name property name, must be previously stringshared
- * @param type will contain the value type.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
 Eina_Bool
-e_ofono_element_property_type_get_stringshared(const E_Ofono_Element *element, const char *name, int *type)
+e_ofono_element_is_netreg(const E_Ofono_Element *element)
 {
-   const E_Ofono_Element_Property *p;
-
    EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(type, EINA_FALSE);
-
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      if (p->name == name)
-        {
-           *type = p->type;
-           return EINA_TRUE;
-        }
-   }
-
-   WRN("element %s (%p) has no property with name \"%s\".",
-       element->path, element, name);
-   return EINA_FALSE;
+   return _e_ofono_element_is(element, e_ofono_iface_netreg);
 }
 
-/**
- * Get property type.
- *
- * If zero is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
+/***********************************************************************
+* Snapshot
+***********************************************************************/
+
+/* A snapshot is the elements hash written to a file, so the next start
+ * shows the last known state before the server answers.  It is a cache
+ * in native byte order: the header, then all the strings NUL terminated
+ * and padded to 4 bytes as a whole, then 32 bit words:
  *
- * @param element which element to get the property
- * @param name property name
- * @param type will contain the value type.
+ *   element:  path interface n_props prop...
+ *   prop:     name type value
+ *   value:    the integer types as is, strings and paths as the offset
+ *             of the string, arrays as type count item...
+ *   item:     a value, or name type value for dict entries
  *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
+ * Each string is stored once, so the file is small and read in place
+ * through mmap().
  */
-Eina_Bool
-e_ofono_element_property_type_get(const E_Ofono_Element *element, const char *name, int *type)
+#define SNAPSHOT_MAGIC "EDBSNAP1"
+
+typedef struct _E_Ofono_Snapshot_Header E_Ofono_Snapshot_Header;
+typedef struct _E_Ofono_Snapshot_Writer E_Ofono_Snapshot_Writer;
+typedef struct _E_Ofono_Snapshot_Reader E_Ofono_Snapshot_Reader;
+
+struct _E_Ofono_Snapshot_Header
 {
-   Eina_Bool ret;
-   name = eina_stringshare_add(name);
-   ret = e_ofono_element_property_type_get_stringshared(element, name, type);
-   eina_stringshare_del(name);
-   return ret;
-}
+   char     magic[8];
+   char     system[8];
+   uint32_t strings_size;
+   uint32_t n_elements;
+   uint32_t n_words;
+   uint32_t reserved;
+};
 
-void
-e_ofono_element_list_properties(const E_Ofono_Element *element, Eina_Bool (*cb)(void *data, const E_Ofono_Element *element, const char *name, int type, const void *value), const void *data)
+struct _E_Ofono_Snapshot_Writer
 {
-   const E_Ofono_Element_Property *p;
+   Eina_Hash *offsets; /* stringshare -> offset + 1 */
+   char      *strings;
+   uint32_t   strings_size;
+   uint32_t   strings_alloc;
+   uint32_t  *words;
+   uint32_t   n_words;
+   uint32_t   words_alloc;
+   uint32_t   n_elements;
+   Eina_Bool  failed;
+};
 
-   EINA_SAFETY_ON_NULL_RETURN(element);
-   EINA_SAFETY_ON_NULL_RETURN(cb);
+struct _E_Ofono_Snapshot_Reader
+{
+   const char     *strings;
+   uint32_t        strings_size;
+   const uint32_t *words;
+   uint32_t        n_words;
+   uint32_t        pos;
+   Eina_Bool       failed;
+};
 
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      const void *value = NULL;
+static void
+_e_ofono_snapshot_word_add(E_Ofono_Snapshot_Writer *w, uint32_t word)
+{
+   if (w->n_words == w->words_alloc)
+     {
+        uint32_t size = w->words_alloc ? w->words_alloc * 2 : 1024;
+        uint32_t *tmp;
 
-      switch (p->type)
-        {
-         case DBUS_TYPE_STRING:
-            value = &p->value.str;
-            break;
+        tmp = realloc(w->words, size * sizeof(uint32_t));
+        if (!tmp)
+          {
+             w->failed = EINA_TRUE;
+             return;
+          }
+        w->words = tmp;
+        w->words_alloc = size;
+     }
 
-         case DBUS_TYPE_OBJECT_PATH:
-            value = &p->value.path;
-            break;
+   w->words[w->n_words++] = word;
+}
 
-         case DBUS_TYPE_BOOLEAN:
-            value = (void *)(unsigned long)p->value.boolean;
-            break;
+/* s is a stringshare, so the same string is found by its pointer */
+static void
+_e_ofono_snapshot_string_add(E_Ofono_Snapshot_Writer *w, const char *s)
+{
+   uintptr_t offset;
 
-         case DBUS_TYPE_UINT16:
-            value = &p->value.u16;
-            break;
+   if (!s)
+      s = "";
 
-         case DBUS_TYPE_UINT32:
-            value = &p->value.u32;
-            break;
+   offset = (uintptr_t)eina_hash_find(w->offsets, &s);
+   if (!offset)
+     {
+        uint32_t len = strlen(s) + 1;
 
-         default:
-            ERR("unsupported type %c", p->type);
-        }
+        if (w->strings_size + len > w->strings_alloc)
+          {
+             uint32_t size = w->strings_alloc ? w->strings_alloc * 2 : 4096;
+             char *tmp;
 
-      if (!cb((void *)data, element, p->name, p->type, value))
-         return;
-   }
-}
+             while (size < w->strings_size + len)
+                size *= 2;
 
-/**
- * Get dict value given its key inside a dict property.
- *
- * This will look into properties for one of type dict that contains
- * the given key, to find the property.  If no property is found then
- * 0 is returned.
- *
- * If zero is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
- *
- * @param element which element to get the property
- * @param dict_name property name, must be previously stringshared
- * @param key key inside dict, must be previously stringshared
- * @param type if provided it will contain the value type.
- * @param value where to store the property value, must be a pointer to the
- *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_ofono_element_property_dict_get_stringshared(const E_Ofono_Element *element, const char *dict_name, const char *key, int *type, void *value)
-{
-   const E_Ofono_Element_Property *p;
+             tmp = realloc(w->strings, size);
+             if (!tmp)
+               {
+                  w->failed = EINA_TRUE;
+                  return;
+               }
+             w->strings = tmp;
+             w->strings_alloc = size;
+          }
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(dict_name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(key, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+        memcpy(w->strings + w->strings_size, s, len);
+        offset = w->strings_size + 1;
+        w->strings_size += len;
+        if (!eina_hash_add(w->offsets, &s, (void *)offset))
+           w->failed = EINA_TRUE;
+     }
 
-   EINA_INLIST_FOREACH(element->props, p)
-   {
-      E_Ofono_Element_Dict_Entry *entry;
-      E_Ofono_Array *array;
+   _e_ofono_snapshot_word_add(w, offset - 1);
+}
 
-      if (p->name != dict_name)
-         continue;
+static void
+_e_ofono_snapshot_dict_entry_add(E_Ofono_Snapshot_Writer *w, const E_Ofono_Element_Dict_Entry *entry)
+{
+   _e_ofono_snapshot_string_add(w, entry->name);
+   _e_ofono_snapshot_word_add(w, entry->type);
+   switch (entry->type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         _e_ofono_snapshot_word_add(w, entry->value.boolean);
+         break;
 
-      if (p->type != DBUS_TYPE_ARRAY)
-        {
-           WRN("element %s (%p) has property \"%s\" is not an array: %c (%d)",
-               element->path, element, dict_name, p->type, p->type);
-           return EINA_FALSE;
-        }
+      case DBUS_TYPE_BYTE:
+         _e_ofono_snapshot_word_add(w, entry->value.byte);
+         break;
 
-      array = p->value.array;
-      if ((!array) || (array->type != DBUS_TYPE_DICT_ENTRY))
-        {
-           int t = array ? array->type : DBUS_TYPE_INVALID;
-           WRN("element %s (%p) has property \"%s\" is not a dict: %c (%d)",
-               element->path, element, dict_name, t, t);
-           return EINA_FALSE;
-        }
+      case DBUS_TYPE_UINT16:
+         _e_ofono_snapshot_word_add(w, entry->value.u16);
+         break;
 
-      entry = _e_ofono_element_array_dict_find_stringshared(array, key);
-      if (!entry)
-        {
-           WRN("element %s (%p) has no dict property with name \"%s\" with "
-               "key \"%s\".",
-               element->path, element, dict_name, key);
-           return EINA_FALSE;
-        }
+      case DBUS_TYPE_UINT32:
+         _e_ofono_snapshot_word_add(w, entry->value.u32);
+         break;
 
-      if (type)
-         *type = entry->type;
+      case DBUS_TYPE_STRING:
+         _e_ofono_snapshot_string_add(w, entry->value.str);
+         break;
 
-      switch (entry->type)
-        {
-         case DBUS_TYPE_BOOLEAN:
-            *(Eina_Bool *)value = entry->value.boolean;
-            return EINA_TRUE;
+      case DBUS_TYPE_OBJECT_PATH:
+         _e_ofono_snapshot_string_add(w, entry->value.path);
+         break;
 
-         case DBUS_TYPE_BYTE:
-            *(unsigned char *)value = entry->value.byte;
-            return EINA_TRUE;
+      default:
+         ERR("don't know how to save dict entry '%s' of type %c (%d)",
+             entry->name, entry->type, entry->type);
+         w->failed = EINA_TRUE;
+     }
+}
 
-         case DBUS_TYPE_UINT16:
-            *(unsigned short *)value = entry->value.u16;
-            return EINA_TRUE;
+static void
+_e_ofono_snapshot_array_add(E_Ofono_Snapshot_Writer *w, const E_Ofono_Array *array)
+{
+   Eina_Array_Iterator iterator;
+   unsigned int i;
+   void *item;
 
-         case DBUS_TYPE_UINT32:
-            *(unsigned int *)value = entry->value.u32;
-            return EINA_TRUE;
+   /* empty arrays are kept as NULL */
+   if (!array)
+     {
+        _e_ofono_snapshot_word_add(w, DBUS_TYPE_INVALID);
+        _e_ofono_snapshot_word_add(w, 0);
+        return;
+     }
 
+   _e_ofono_snapshot_word_add(w, array->type);
+   _e_ofono_snapshot_word_add(w, eina_array_count(array->array));
+   EINA_ARRAY_ITER_NEXT(array->array, i, item, iterator)
+   {
+      switch (array->type)
+        {
          case DBUS_TYPE_STRING:
-            *(const char **)value = entry->value.str;
-            return EINA_TRUE;
-
          case DBUS_TYPE_OBJECT_PATH:
-            *(const char **)value = entry->value.path;
-            return EINA_TRUE;
+            _e_ofono_snapshot_string_add(w, item);
+            break;
+
+         case DBUS_TYPE_DICT_ENTRY:
+            _e_ofono_snapshot_dict_entry_add(w, item);
+            break;
 
          default:
-            ERR("don't know how to get property %s, key %s type %c (%d)",
-                dict_name, key, entry->type, entry->type);
-            return EINA_FALSE;
+            _e_ofono_snapshot_word_add(w, (uint32_t)(uintptr_t)item);
         }
    }
-
-   WRN("element %s (%p) has no property with name \"%s\".",
-       element->path, element, dict_name);
-   return EINA_FALSE;
 }
 
-/**
- * Get property value given its name.
- *
- * This will look into properties, to find the property.
- * If no property is found then 0 is returned.
- *
- * If zero is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
- *
- * @param element which element to get the property
- * @param name property name, must be previously stringshared
- * @param type if provided it will contain the value type.
- * @param value where to store the property value, must be a pointer to the
- *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_ofono_element_property_get_stringshared(const E_Ofono_Element *element, const char *name, int *type, void *value)
+static void
+_e_ofono_snapshot_element_add(E_Ofono_Snapshot_Writer *w, const E_Ofono_Element *element)
 {
    const E_Ofono_Element_Property *p;
+   uint32_t n_props = 0, at;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(name, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(value, EINA_FALSE);
+   _e_ofono_snapshot_string_add(w, element->path);
+   _e_ofono_snapshot_string_add(w, element->interface);
+   at = w->n_words;
+   _e_ofono_snapshot_word_add(w, 0);
 
    EINA_INLIST_FOREACH(element->props, p)
    {
-      if (p->name != name)
-         continue;
+      switch (p->type)
+        {
+         case DBUS_TYPE_BOOLEAN:
+         case DBUS_TYPE_BYTE:
+         case DBUS_TYPE_UINT16:
+         case DBUS_TYPE_UINT32:
+         case DBUS_TYPE_STRING:
+         case DBUS_TYPE_OBJECT_PATH:
+         case DBUS_TYPE_ARRAY:
+            break;
 
-      if (type)
-         *type = p->type;
+         default:
+            continue;
+        }
 
+      _e_ofono_snapshot_string_add(w, p->name);
+      _e_ofono_snapshot_word_add(w, p->type);
       switch (p->type)
         {
          case DBUS_TYPE_BOOLEAN:
-            *(Eina_Bool *)value = p->value.boolean;
-            return EINA_TRUE;
+            _e_ofono_snapshot_word_add(w, p->value.boolean);
+            break;
 
          case DBUS_TYPE_BYTE:
-            *(unsigned char *)value = p->value.byte;
-            return EINA_TRUE;
+            _e_ofono_snapshot_word_add(w, p->value.byte);
+            break;
 
          case DBUS_TYPE_UINT16:
-            *(unsigned short *)value = p->value.u16;
-            return EINA_TRUE;
+            _e_ofono_snapshot_word_add(w, p->value.u16);
+            break;
 
          case DBUS_TYPE_UINT32:
-            *(unsigned int *)value = p->value.u32;
-            return EINA_TRUE;
+            _e_ofono_snapshot_word_add(w, p->value.u32);
+            break;
 
          case DBUS_TYPE_STRING:
-            *(const char **)value = p->value.str;
-            return EINA_TRUE;
+            _e_ofono_snapshot_string_add(w, p->value.str);
+            break;
 
          case DBUS_TYPE_OBJECT_PATH:
-            *(const char **)value = p->value.path;
-            return EINA_TRUE;
+            _e_ofono_snapshot_string_add(w, p->value.path);
+            break;
 
          case DBUS_TYPE_ARRAY:
-            *(E_Ofono_Array **)value = p->value.array;
-            return EINA_TRUE;
-
-         default:
-            ERR("don't know how to get property type %c (%d)",
-                p->type, p->type);
-            return EINA_FALSE;
+            _e_ofono_snapshot_array_add(w, p->value.array);
+            break;
         }
+      n_props++;
    }
 
-   WRN("element %s (%p) has no property with name \"%s\".",
-       element->path, element, name);
-   return EINA_FALSE;
-}
-
-/**
- * Get property value given its name.
- *
- * This will look into properties, to find the property.
- * If no property is found then 0 is returned.
- *
- * If zero is returned, then this call failed and parameter-returned
- * values shall be considered invalid.
- *
- * @param element which element to get the property
- * @param name property name
- * @param type if provided it will contain the value type.
- * @param value where to store the property value, must be a pointer to the
- *        exact type, (Eina_Bool *) for booleans, (char **) for strings, and so on.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_ofono_element_property_get(const E_Ofono_Element *element, const char *name, int *type, void *value)
-{
-   Eina_Bool ret;
-   name = eina_stringshare_add(name);
-   ret = e_ofono_element_property_get_stringshared
-         (element, name, type, value);
-   eina_stringshare_del(name);
-   return ret;
+   if (!w->failed)
+      w->words[at] = n_props;
 }
 
-struct e_ofono_elements_for_each_data
-{
-   Eina_Hash_Foreach cb;
-   void             *data;
-};
-
 static Eina_Bool
-_e_ofono_elements_for_each(Eina_Hash *hash __UNUSED__, const char *key, void *data, void *fdata)
-{
-   struct e_ofono_elements_for_each_data *each_data = fdata;
-
-   each_data->cb(elements, key, data, each_data->data);
-   return EINA_TRUE;
-}
-
-/**
- * Call the given function for each existing element.
- *
- * @param cb function to call for each element. It will get as parameters,
- *        in order: the element pointer and the given @a user_data.
- * @param user_data data to give to @a cb for each element.
- */
-void
-e_ofono_elements_for_each(Eina_Hash_Foreach cb, const void *user_data)
+_e_ofono_snapshot_element_add_cb(const Eina_Hash *hash __UNUSED__, const void *key __UNUSED__, void *data, void *fdata)
 {
-   struct e_ofono_elements_for_each_data data = {cb, (void *)user_data};
-
-   EINA_SAFETY_ON_NULL_RETURN(cb);
+   E_Ofono_Snapshot_Writer *w = fdata;
 
-   eina_hash_foreach
-      (elements, (Eina_Hash_Foreach)_e_ofono_elements_for_each, &data);
+   _e_ofono_snapshot_element_add(w, data);
+   w->n_elements++;
+   return !w->failed;
 }
 
-static Eina_Bool
-_e_ofono_elements_get_allocate(unsigned int *count, E_Ofono_Element ***p_elements)
+static uint32_t
+_e_ofono_snapshot_word_get(E_Ofono_Snapshot_Reader *r)
 {
-   *count = eina_hash_population(elements);
-   if (*count == 0)
-     {
-        *p_elements = NULL;
-        return EINA_TRUE;
-     }
-
-   *p_elements = malloc(*count * sizeof(E_Ofono_Element *));
-   if (!*p_elements)
+   if (r->pos >= r->n_words)
      {
-        ERR("could not allocate return array of %d elements: %s",
-            *count, strerror(errno));
-        *count = 0;
-        return EINA_FALSE;
+        r->failed = EINA_TRUE;
+        return 0;
      }
 
-   return EINA_TRUE;
-}
-
-static Eina_Bool
-_e_ofono_elements_get_all(Eina_Hash *hash __UNUSED__, const char *key __UNUSED__, void *data, void *fdata)
-{
-   E_Ofono_Element *element = data;
-   E_Ofono_Element ***p_ret = fdata;
-
-   **p_ret = element;
-   (*p_ret)++;
-   return EINA_TRUE;
+   return r->words[r->pos++];
 }
 
-/**
- * Get all known elements.
- *
- * No reference is added to these elements, since there are no threads
- * in the system, you are free to add references yourself right after
- * the return of this call without race condition, elements by the
- * system (ie: elementRemoved signal)could only be touched on the next
- * main loop iteration.
- *
- * @param count return the number of elements in array.
- * @param p_elements array with all elements, these are not referenced
- *        and in no particular order, just set if return is 1.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- */
-Eina_Bool
-e_ofono_elements_get_all(unsigned int *count, E_Ofono_Element ***p_elements)
+static const char *
+_e_ofono_snapshot_string_get(E_Ofono_Snapshot_Reader *r)
 {
-   E_Ofono_Element **p;
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+   uint32_t offset = _e_ofono_snapshot_word_get(r);
 
-   if (!_e_ofono_elements_get_allocate(count, p_elements))
-      return EINA_FALSE;
+   if (offset >= r->strings_size)
+     {
+        r->failed = EINA_TRUE;
+        return "";
+     }
 
-   p = *p_elements;
-   eina_hash_foreach
-      (elements, (Eina_Hash_Foreach)_e_ofono_elements_get_all, &p);
-   return EINA_TRUE;
+   return r->strings + offset;
 }
 
-struct e_ofono_elements_get_all_str_data
-{
-   E_Ofono_Element **elements;
-   int               count;
-   const char       *str;
-};
-
-static Eina_Bool
-_e_ofono_elements_get_all_type(Eina_Hash *hash __UNUSED__, const char *key __UNUSED__, void *e, void *user_data)
+static E_Ofono_Element_Dict_Entry *
+_e_ofono_snapshot_dict_entry_get(E_Ofono_Snapshot_Reader *r)
 {
-   struct e_ofono_elements_get_all_str_data *data = user_data;
-   E_Ofono_Element *element = e;
-
-   if ((data->str) && (element->interface != data->str))
-      return EINA_TRUE;
+   E_Ofono_Element_Dict_Entry *entry;
+   const char *name;
+   int type;
 
-   data->elements[data->count] = element;
-   data->count++;
-   return EINA_TRUE;
-}
+   name = _e_ofono_snapshot_string_get(r);
+   type = _e_ofono_snapshot_word_get(r);
+   if (r->failed)
+      return NULL;
 
-/**
- * Get all known elements of type.
- *
- * No reference is added to these elements, since there are no threads
- * in the system, you are free to add references yourself right after
- * the return of this call without race condition, elements by the
- * system (ie: ElementRemoved signal) could only be touched on the next
- * main loop iteration.
- *
- * @param type type to filter, or NULL to get all.
- * @param count return the number of elements in array.
- * @param p_elements array with all elements, these are not referenced
- *        and in no particular order, just set if return is 1.
- *
- * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
- *
- * @see e_ofono_elements_get_all()
- */
-Eina_Bool
-e_ofono_elements_get_all_type(const char *type, unsigned int *count, E_Ofono_Element ***p_elements)
-{
-   struct e_ofono_elements_get_all_str_data data;
+   entry = calloc(1, sizeof(*entry));
+   if (!entry)
+     {
+        ERR("could not allocate memory for dict entry.");
+        r->failed = EINA_TRUE;
+        return NULL;
+     }
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(count, EINA_FALSE);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(p_elements, EINA_FALSE);
+   switch (type)
+     {
+      case DBUS_TYPE_BOOLEAN:
+         entry->value.boolean = !!_e_ofono_snapshot_word_get(r);
+         break;
 
-   if (!_e_ofono_elements_get_allocate(count, p_elements))
-      return EINA_FALSE;
+      case DBUS_TYPE_BYTE:
+         entry->value.byte = _e_ofono_snapshot_word_get(r);
+         break;
 
-   data.elements = *p_elements;
-   data.count = 0;
-   data.str = eina_stringshare_add(type);
-   eina_hash_foreach(elements,
-                     (Eina_Hash_Foreach)_e_ofono_elements_get_all_type,
-                     &data);
+      case DBUS_TYPE_UINT16:
+         entry->value.u16 = _e_ofono_snapshot_word_get(r);
+         break;
 
-   eina_stringshare_del(data.str);
-   *count = data.count;
-   return EINA_TRUE;
-}
+      case DBUS_TYPE_UINT32:
+         entry->value.u32 = _e_ofono_snapshot_word_get(r);
+         break;
 
-/**
- * Get the element registered at given path.
- *
- * @param path the path to query for registered object.
- *
- * @return element pointer if found, NULL otherwise. No references are added.
- */
-E_Ofono_Element *
-e_ofono_element_get(const char *path, const char *interface)
-{
-   E_Ofono_Element *element;
-   char key[MAX_KEY_SIZE];
+      case DBUS_TYPE_STRING:
+         entry->value.str =
+            eina_stringshare_add(_e_ofono_snapshot_string_get(r));
+         break;
 
-   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(interface, NULL);
+      case DBUS_TYPE_OBJECT_PATH:
+         entry->value.path =
+            eina_stringshare_add(_e_ofono_snapshot_string_get(r));
+         break;
 
-   snprintf(key, MAX_KEY_SIZE, "%s:%s", path, interface);
-   element = eina_hash_find(elements, key);
+      default:
+         r->failed = EINA_TRUE;
+         free(entry);
+         return NULL;
+     }
 
-   return element;
+   entry->name = eina_stringshare_add(name);
+   entry->type = type;
+   return entry;
 }
 
-static void
-_e_ofono_element_property_changed_callback(void *data, DBusMessage *msg)
+static E_Ofono_Array *
+_e_ofono_snapshot_array_get(E_Ofono_Snapshot_Reader *r)
 {
-   E_Ofono_Element *element = (E_Ofono_Element *)data;
-   DBusMessageIter itr, v_itr;
-   int t, r, changed = 0;
-   const char *name = NULL;
-   void *value = NULL;
-
-   DBG("Property changed in element %s %s", element->path, element->interface);
+   E_Ofono_Array *array;
+   uint32_t count, i;
+   int type;
 
-   if (!_dbus_callback_check_and_init(msg, &itr, NULL))
-      return;
+   type = _e_ofono_snapshot_word_get(r);
+   count = _e_ofono_snapshot_word_get(r);
+   if ((r->failed) || (type == DBUS_TYPE_INVALID))
+      return NULL;
 
-   t = dbus_message_iter_get_arg_type(&itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_STRING))
+   if (count > r->n_words - r->pos)
      {
-        ERR("missing name in property changed signal");
-        return;
+        r->failed = EINA_TRUE;
+        return NULL;
      }
 
-   dbus_message_iter_get_basic(&itr, &name);
-
-   dbus_message_iter_next(&itr);
-   t = dbus_message_iter_get_arg_type(&itr);
-   if (!_dbus_iter_type_check(t, DBUS_TYPE_VARIANT))
+   array = malloc(sizeof(E_Ofono_Array));
+   if (!array)
      {
-        ERR("missing value in property changed signal");
-        return;
+        ERR("could not create new e_ofono array.");
+        r->failed = EINA_TRUE;
+        return NULL;
      }
 
-   dbus_message_iter_recurse(&itr, &v_itr);
-   t = dbus_message_iter_get_arg_type(&v_itr);
-
-   if (t == DBUS_TYPE_ARRAY)
+   array->type = type;
+   array->array = eina_array_new(16);
+   if (!(array->array))
      {
-        value = _e_ofono_element_iter_get_array(&v_itr, name);
+        ERR("could not create new eina array.");
+        free(array);
+        r->failed = EINA_TRUE;
+        return NULL;
      }
-   else if (t != DBUS_TYPE_INVALID)
+
+   for (i = 0; (i < count) && (!r->failed); i++)
      {
-        dbus_message_iter_get_basic(&v_itr, &value);
+        void *item;
+
+        switch (type)
+          {
+           case DBUS_TYPE_STRING:
+           case DBUS_TYPE_OBJECT_PATH:
+              item = (void *)eina_stringshare_add(_e_ofono_snapshot_string_get(r));
+              break;
+
+           case DBUS_TYPE_DICT_ENTRY:
+              item = _e_ofono_snapshot_dict_entry_get(r);
+              break;
+
+           case DBUS_TYPE_BOOLEAN:
+           case DBUS_TYPE_BYTE:
+           case DBUS_TYPE_UINT16:
+           case DBUS_TYPE_UINT32:
+              item = (void *)(long)_e_ofono_snapshot_word_get(r);
+              break;
+
+           default:
+              r->failed = EINA_TRUE;
+              continue;
+          }
+
+        if (item)
+           eina_array_push(array->array, item);
      }
-   else
+
+   if (r->failed)
      {
-        ERR("property has invalid type %s", name);
-        return;
+        _e_ofono_element_array_free(array, NULL);
+        return NULL;
      }
 
-   r = _e_ofono_element_property_value_add(element, name, t, value);
-   if (r < 0)
+   return array;
+}
+
+static void
+_e_ofono_snapshot_element_get(E_Ofono_Snapshot_Reader *r)
+{
+   E_Ofono_Element_Property *p;
+   E_Ofono_Element *element;
+   const char *path, *interface;
+   uint32_t n_props, i;
+
+   path = _e_ofono_snapshot_string_get(r);
+   interface = eina_stringshare_add(_e_ofono_snapshot_string_get(r));
+   n_props = _e_ofono_snapshot_word_get(r);
+   element = r->failed ? NULL : e_ofono_element_register(path, interface);
+   eina_stringshare_del(interface);
+   if (!element)
      {
-        ERR("failed to add property value %s (%c)", name, t);
+        r->failed = EINA_TRUE;
+        return;
      }
-   else if (r == 1)
+
+   for (i = 0; (i < n_props) && (!r->failed); i++)
      {
-        INF("property value changed %s (%c)", name, t);
-        changed = 1;
-        if ((strcmp(name, "Interfaces") == 0) && value)
+        const char *name;
+        void *value;
+        int type;
+
+        name = _e_ofono_snapshot_string_get(r);
+        type = _e_ofono_snapshot_word_get(r);
+        switch (type)
           {
-             char *interface;
-             Eina_Array_Iterator iterator;
-             unsigned int i;
-             E_Ofono_Element *e;
+           case DBUS_TYPE_BOOLEAN:
+           case DBUS_TYPE_BYTE:
+           case DBUS_TYPE_UINT16:
+           case DBUS_TYPE_UINT32:
+              value = (void *)(long)_e_ofono_snapshot_word_get(r);
+              break;
 
-             EINA_ARRAY_ITER_NEXT(((E_Ofono_Array *)value)->array, i,
-                                  interface, iterator)
-             {
-                DBG("Found interface %s on %s", interface, element->path);
-                e_ofono_element_register(element->path, interface);
-                e = e_ofono_element_register(element->path, interface);
-                if ((e) && (!e_ofono_element_properties_sync(e)))
-                   WRN("could not get properties of %s", e->path);
-             }
+           case DBUS_TYPE_STRING:
+           case DBUS_TYPE_OBJECT_PATH:
+              value = (void *)_e_ofono_snapshot_string_get(r);
+              break;
+
+           case DBUS_TYPE_ARRAY:
+              value = _e_ofono_snapshot_array_get(r);
+              break;
+
+           default:
+              r->failed = EINA_TRUE;
+              continue;
           }
+
+        if (!r->failed)
+           _e_ofono_element_property_value_add(element, name, type, value);
      }
 
-   if (changed)
+   element->_stale = EINA_TRUE;
+   EINA_INLIST_FOREACH(element->props, p)
+      p->stale = EINA_TRUE;
+
+   if (element->props)
       _e_ofono_element_listeners_call(element);
 }
 
 /**
- * Register the given pair (path, interface), possibly creating an
- * element and return it.
- *
- * This will check if (path, interface) is already registered, in
- * that case the exiting element is returned. If it was not registered
- * yet, a new element is created, registered and returned.
+ * Write all the elements and their properties to a snapshot file.
  *
- * This call will not add extra references to the object.
+ * Give it to e_ofono_elements_snapshot_load() on the next start.  The file
+ * is replaced atomically.
  *
- * @param path the path to register the element
+ * @param file where to write the snapshot.
  *
- * @return the registered object, no references are added.
+ * @return @c EINA_TRUE on success, @c EINA_FALSE otherwise.
  */
-E_Ofono_Element *
-e_ofono_element_register(const char *path, const char *interface)
+Eina_Bool
+e_ofono_elements_snapshot_save(const char *file)
 {
-   E_Ofono_Element *element;
-   char key[MAX_KEY_SIZE];
-
-   EINA_SAFETY_ON_NULL_RETURN_VAL(path, NULL);
-   EINA_SAFETY_ON_NULL_RETURN_VAL(interface, NULL);
+   static const char pad[4] = { 0, 0, 0, 0 };
+   E_Ofono_Snapshot_Header header;
+   E_Ofono_Snapshot_Writer w;
+   Eina_Bool ret = EINA_FALSE;
+   uint32_t n_pad;
+   size_t len;
+   char *tmp;
+   FILE *fp;
+   int fd;
+
+   EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(elements, EINA_FALSE);
+
+   memset(&w, 0, sizeof(w));
+   w.offsets = eina_hash_pointer_new(NULL);
+   if (!w.offsets)
+      return EINA_FALSE;
 
-   snprintf(key, MAX_KEY_SIZE, "%s:%s", path, interface);
-   element = eina_hash_find(elements, key);
-   if (element)
-      return element;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+   eina_strlcpy(header.system, "ofono", sizeof(header.system));
 
-   element = e_ofono_element_new(path, interface);
-   if (!element)
-      return NULL;
+   eina_hash_foreach(elements, _e_ofono_snapshot_element_add_cb, &w);
 
-   if (!eina_hash_add(elements, key, element))
+   if (w.failed)
      {
-        ERR("could not add element %s to hash, delete it.", path);
-        e_ofono_element_free(element);
-        return NULL;
+        ERR("could not build the snapshot for %s", file);
+        goto end;
      }
 
-   element->signal_handler =
-      e_dbus_signal_handler_add
-         (e_ofono_conn, e_ofono_system_bus_name_get(),
-         element->path, element->interface, "PropertyChanged",
-         _e_ofono_element_property_changed_callback, element);
+   n_pad = ((w.strings_size + 3) & ~3U) - w.strings_size;
+   header.strings_size = w.strings_size + n_pad;
+   header.n_elements = w.n_elements;
+   header.n_words = w.n_words;
 
-   e_ofono_element_event_add(E_OFONO_EVENT_ELEMENT_ADD, element);
+   len = strlen(file) + sizeof(".XXXXXX");
+   tmp = alloca(len);
+   snprintf(tmp, len, "%s.XXXXXX", file);
+   fd = mkstemp(tmp);
+   if (fd < 0)
+     {
+        ERR("could not create %s: %s", tmp, strerror(errno));
+        goto end;
+     }
 
-   return element;
-}
+   fp = fdopen(fd, "wb");
+   if (!fp)
+     {
+        ERR("could not open %s: %s", tmp, strerror(errno));
+        close(fd);
+        unlink(tmp);
+        goto end;
+     }
 
-static void
-_e_ofono_element_event_unregister_and_free(void *data __UNUSED__, void *ev)
-{
-   E_Ofono_Element *element = ev;
-   e_ofono_element_unref(element);
-}
+   if ((fwrite(&header, sizeof(header), 1, fp) != 1) ||
+       (fwrite(w.strings, 1, w.strings_size, fp) != w.strings_size) ||
+       (fwrite(pad, 1, n_pad, fp) != n_pad) ||
+       (fwrite(w.words, sizeof(uint32_t), w.n_words, fp) != w.n_words))
+     {
+        ERR("could not write %s: %s", tmp, strerror(errno));
+        fclose(fp);
+        unlink(tmp);
+        goto end;
+     }
 
-static void
-_e_ofono_element_unregister_internal(E_Ofono_Element *element)
-{
-   if (element->signal_handler)
+   if ((fclose(fp) != 0) || (rename(tmp, file) < 0))
      {
-        e_dbus_signal_handler_del(e_ofono_conn, element->signal_handler);
-        element->signal_handler = NULL;
+        ERR("could not save %s: %s", file, strerror(errno));
+        unlink(tmp);
+        goto end;
      }
 
-   ecore_event_add(E_OFONO_EVENT_ELEMENT_DEL, element,
-                   _e_ofono_element_event_unregister_and_free, NULL);
+   DBG("saved %u elements to %s", header.n_elements, file);
+   ret = EINA_TRUE;
+
+end:
+   eina_hash_free(w.offsets);
+   free(w.strings);
+   free(w.words);
+   return ret;
 }
 
 /**
- * Forget about the given element.
+ * Add the elements saved by e_ofono_elements_snapshot_save().
  *
- * This will remove the element from the pool of known objects, then
- * add an E_OFONO_EVENT_ELEMENT_DEL and after that will unreference it,
- * possible freeing it.
+ * Call it right after e_ofono_system_init(), before the manager comes in.
+ * The elements are added at once with their last known properties and
+ * are stale, see e_ofono_element_is_stale(), until their GetProperties()
+ * reply arrives.  Listeners then only hear about the properties that
+ * differ, and those the server did not send are removed.  Elements gone
+ * meanwhile are removed when the lists holding them are synced.
  *
- * @param element element to forget about. Its reference will be removed.
+ * @param file the snapshot to load.
+ *
+ * @return @c EINA_TRUE on success, @c EINA_FALSE if the file is missing or
+ *         invalid, or if there are elements already.
  */
-void
-e_ofono_element_unregister(E_Ofono_Element *element)
+Eina_Bool
+e_ofono_elements_snapshot_load(const char *file)
 {
-   char key[MAX_KEY_SIZE];
+   const E_Ofono_Snapshot_Header *header;
+   E_Ofono_Snapshot_Reader r;
+   uint32_t n_elements, i;
+   struct stat st;
+   void *map;
+   int fd;
 
-   if (!element)
-      return;
+   EINA_SAFETY_ON_NULL_RETURN_VAL(file, EINA_FALSE);
+   EINA_SAFETY_ON_NULL_RETURN_VAL(elements, EINA_FALSE);
 
-   snprintf(key, MAX_KEY_SIZE, "%s:%s", element->path, element->interface);
-   if (elements)
-      eina_hash_del_by_key(elements, key);
-}
+   if (eina_hash_population(elements) > 0)
+     {
+        ERR("elements already known, not loading snapshot %s", file);
+        return EINA_FALSE;
+     }
 
-/**
- * Remove all known elements.
- *
- * This will remove all known elements but will NOT add any
- * E_OFONO_EVENT_ELEMENT_DEL to main loop.
- *
- * This is just useful to make sure next e_ofono_manager_sync_elements()
- * will not leave any stale elements. This is unlikely to happen, as
- * E_Ofono is supposed to catch all required events to avoid stale elements.
- */
-void
-e_ofono_manager_clear_elements(void)
-{
-   e_ofono_elements_shutdown();
-   e_ofono_elements_init();
-}
+   fd = open(file, O_RDONLY);
+   if (fd < 0)
+     {
+        DBG("no snapshot %s: %s", file, strerror(errno));
+        return EINA_FALSE;
+     }
 
-/**
- * Creates elements hash.
- *
- * This has no init counter since its already guarded by other code.
- * @internal
- */
-void
-e_ofono_elements_init(void)
-{
-   EINA_SAFETY_ON_FALSE_RETURN(!elements);
-   elements =
-      eina_hash_string_superfast_new
-         (EINA_FREE_CB(_e_ofono_element_unregister_internal));
-}
+   if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(*header)))
+     {
+        ERR("invalid snapshot %s", file);
+        close(fd);
+        return EINA_FALSE;
+     }
 
-void
-e_ofono_elements_shutdown(void)
-{
-   EINA_SAFETY_ON_FALSE_RETURN(!!elements);
-   eina_hash_free(elements);
-   elements = NULL;
-}
+   map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED)
+     {
+        ERR("could not map %s: %s", file, strerror(errno));
+        return EINA_FALSE;
+     }
 
-static inline Eina_Bool
-_e_ofono_element_is(const E_Ofono_Element *element, const char *interface)
-{
-   return element->interface == interface;
-}
+   header = map;
+   if ((memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) ||
+       (strncmp(header->system, "ofono", sizeof(header->system)) != 0) ||
+       (header->strings_size % 4) ||
+       /* only subtract and divide, the sizes in the file could overflow */
+       (header->strings_size > (size_t)st.st_size - sizeof(*header)) ||
+       (((size_t)st.st_size - sizeof(*header)) % sizeof(uint32_t)) ||
+       (header->n_words != ((size_t)st.st_size - sizeof(*header) -
+                            header->strings_size) / sizeof(uint32_t)))
+     {
+        ERR("invalid snapshot %s", file);
+        munmap(map, st.st_size);
+        return EINA_FALSE;
+     }
 
-Eina_Bool
-e_ofono_element_is_manager(const E_Ofono_Element *element)
-{
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return _e_ofono_element_is(element, e_ofono_iface_manager);
-}
+   memset(&r, 0, sizeof(r));
+   r.strings = (const char *)(header + 1);
+   r.strings_size = header->strings_size;
+   r.words = (const uint32_t *)(r.strings + r.strings_size);
+   r.n_words = header->n_words;
+   n_elements = header->n_elements;
 
-Eina_Bool
-e_ofono_element_is_modem(const E_Ofono_Element *element)
-{
-   EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return _e_ofono_element_is(element, e_ofono_iface_modem);
+   /* the last string is terminated, so all of them are */
+   if ((r.strings_size) && (r.strings[r.strings_size - 1] != '\0'))
+      r.failed = EINA_TRUE;
+
+   for (i = 0; (i < n_elements) && (!r.failed); i++)
+      _e_ofono_snapshot_element_get(&r);
+
+   munmap(map, st.st_size);
+
+   if (r.failed)
+     {
+        ERR("snapshot %s is corrupt, dropping it", file);
+        e_ofono_manager_clear_elements();
+        return EINA_FALSE;
+     }
+
+   DBG("loaded %u elements from %s", n_elements, file);
+   return EINA_TRUE;
 }
 
+/**
+ * Tell if the element still has the properties of a snapshot.
+ *
+ * @param element which element to query.
+ *
+ * @return @c EINA_TRUE until the server answered for the element.
+ */
 Eina_Bool
-e_ofono_element_is_netreg(const E_Ofono_Element *element)
+e_ofono_element_is_stale(const E_Ofono_Element *element)
 {
    EINA_SAFETY_ON_NULL_RETURN_VAL(element, EINA_FALSE);
-   return _e_ofono_element_is(element, e_ofono_iface_netreg);
+   return element->_stale;
 }
-
@@ -113,6 +113,8 @@ void                 e_ofono_manager_clear_elements(void);
 
 void                 e_ofono_elements_init(void);
 void                 e_ofono_elements_shutdown(void);
+void                 e_ofono_elements_sync(E_Ofono_Element *manager);
+void                 e_ofono_element_sync_queue(E_Ofono_Element *element);
 
 E_Ofono_Element *    e_ofono_element_register(const char *path, const char *interface);
 void                 e_ofono_element_unregister(E_Ofono_Element *element);